@@ -0,0 +1,38 @@
+// NOTE: Shared helpers of the benchmarks in this directory. Every benchmark is a single translation unit
+//       that defines rstd_Implementation before including this file.
+
+#pragma once
+
+#define rstd_Debug 0
+#include "../rstd.h"
+#include <cstdio>
+#include <chrono>
+using namespace rstd;
+using namespace rstd::memory_size_literals;
+
+#define fn static auto
+
+fn GetSeconds()
+{ return std::chrono::duration<f64>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+// NOTE: Keeps the compiler from throwing away a result the benchmark never reads
+template<class type> fn KeepValue
+(const type& Value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(Value) : "memory");
+#else
+    static volatile const void* Sink;
+    Sink = &Value;
+#endif
+}
+
+// NOTE: xorshift64, benchmarks need more than 32 random bits for big ranges
+fn NextRandom
+(u64& State)
+{
+    State ^= State << 13;
+    State ^= State >> 7;
+    State ^= State << 17;
+    return State;
+}
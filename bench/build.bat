@@ -0,0 +1,16 @@
+@echo off
+
+set CompilerFlags=-O2 -MT -nologo -fp:fast -fp:except- -Gm- -GR- -EHsc -Zo -Oi -W3 -std:c++20 -D_CRT_SECURE_NO_WARNINGS -wd4201 -wd4100 -wd4189 -wd4505 -wd4127 -FC -Z7
+set LinkerFlags= -incremental:no -opt:ref user32.lib
+
+echo Compiling benchmarks...
+
+cl %CompilerFlags% platform.cpp /link %LinkerFlags% | more
+cl %CompilerFlags% concurrent_arena.cpp /link %LinkerFlags% | more
+cl %CompilerFlags% huge_pages.cpp /link %LinkerFlags% | more
+cl %CompilerFlags% -Drstd_MemoryProfilerEnabled=0 memory_profiler.cpp -Fememory_profiler_off.exe /link %LinkerFlags% | more
+cl %CompilerFlags% -Drstd_MemoryProfilerEnabled=1 memory_profiler.cpp -Fememory_profiler_on.exe /link %LinkerFlags% | more
+cl %CompilerFlags% zeroing.cpp /link %LinkerFlags% | more
+cl %CompilerFlags% dynamic_array.cpp /link %LinkerFlags% | more
+cl %CompilerFlags% hash_map.cpp /link %LinkerFlags% | more
+cl %CompilerFlags% unrolled_list.cpp /link %LinkerFlags% | more
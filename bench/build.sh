@@ -0,0 +1,13 @@
+#!/bin/sh
+
+echo Compiling benchmarks...
+
+g++ -std=c++20 -O2 platform.cpp -o platform -lpthread
+g++ -std=c++20 -O2 concurrent_arena.cpp -o concurrent_arena -lpthread
+g++ -std=c++20 -O2 huge_pages.cpp -o huge_pages -lpthread
+g++ -std=c++20 -O2 -Drstd_MemoryProfilerEnabled=0 memory_profiler.cpp -o memory_profiler_off -lpthread
+g++ -std=c++20 -O2 -Drstd_MemoryProfilerEnabled=1 memory_profiler.cpp -o memory_profiler_on -lpthread
+g++ -std=c++20 -O2 zeroing.cpp -o zeroing -lpthread
+g++ -std=c++20 -O2 dynamic_array.cpp -o dynamic_array -lpthread
+g++ -std=c++20 -O2 hash_map.cpp -o hash_map -lpthread
+g++ -std=c++20 -O2 unrolled_list.cpp -o unrolled_list -lpthread
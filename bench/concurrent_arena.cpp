@@ -0,0 +1,80 @@
+// NOTE: Scaling of concurrent_arena pushes over 1-64 threads against arena shared behind mutex,
+//       which is what code did before concurrent_arena existed.
+//       Usage: concurrent_arena
+
+#define rstd_Implementation
+#include "bench.h"
+#include <thread>
+#include <vector>
+
+struct item
+{
+    u64 Thread;
+    u64 Index;
+};
+
+constexpr u32 PushCount = 4000000; // split between all threads
+
+template<class push_function> fn RunThreads
+(u32 ThreadCount, push_function Push)
+{
+    f64 Start = GetSeconds();
+    std::vector<std::thread> Threads;
+    for(u32 ThreadIndex = 0; ThreadIndex < ThreadCount; ++ThreadIndex)
+    {
+        Threads.emplace_back([=]
+                             {
+                                 for(u32 Index = 0; Index < PushCount / ThreadCount; ++Index)
+                                     Push(ThreadIndex, Index);
+                             });
+    }
+    for(auto& Thread : Threads)
+        Thread.join();
+    return GetSeconds() - Start;
+}
+
+int main()
+{
+    concurrent_arena ConcurrentArena = rstd_AllocateConcurrentArena(64_MB, "Benchmark");
+    arena Arena = rstd_AllocateArenaZero(64_MB, "Benchmark");
+    mutex ArenaMutex;
+
+    printf("Pushes of 16 byte struct (%u split between threads), ns per push\n", PushCount);
+    printf("  %7s %16s %16s\n", "threads", "concurrent_arena", "arena + mutex");
+    for(u32 ThreadCount = 1; ThreadCount <= 64; ThreadCount *= 2)
+    {
+        // NOTE: Best of 3, first run also faults in the pages
+        f64 ConcurrentTime = 1e9;
+        f64 MutexTime = 1e9;
+        for(u32 Run = 0; Run < 3; ++Run)
+        {
+            f64 Time = RunThreads(ThreadCount, [&](u32 ThreadIndex, u32 Index)
+                                  {
+                                      auto& Item = PushStructZero<item>(ConcurrentArena);
+                                      Item = {ThreadIndex, Index};
+                                      KeepValue(&Item);
+                                  });
+            if(Time < ConcurrentTime)
+                ConcurrentTime = Time;
+
+            Time = RunThreads(ThreadCount, [&](u32 ThreadIndex, u32 Index)
+                              {
+                                  rstd_ScopeLock(ArenaMutex);
+                                  auto& Item = rstd_PushStructZero(Arena, item);
+                                  Item = {ThreadIndex, Index};
+                                  KeepValue(&Item);
+                              });
+            if(Time < MutexTime)
+                MutexTime = Time;
+
+            Clear(ConcurrentArena);
+            Clear(Arena);
+        }
+
+        printf("  %7u %16.2f %16.2f\n", ThreadCount, ConcurrentTime / PushCount * 1e9, MutexTime / PushCount * 1e9);
+    }
+
+    Deallocate(ConcurrentArena);
+    DeallocateArena(Arena);
+    return 0;
+}
@@ -0,0 +1,90 @@
+// NOTE: dynamic_array against std::vector and the node based lists it replaces for data of unknown size.
+//       Build pushes N u32 into empty container (so it includes growing), iterate sums them.
+//       Lists and dynamic_array share one arena that is cleared before every build.
+//       Usage: dynamic_array
+
+#define rstd_Implementation
+#include "bench.h"
+#include <vector>
+
+constexpr u32 ElementsPerRun = 50000000; // build and iterate repeat until they handle this many elements
+
+struct result
+{
+    f64 Build;
+    f64 Iterate;
+};
+
+template<class container, class make_function> fn Run
+(arena& Arena, u32 Count, make_function Make)
+{
+    result Result = {1e9, 1e9};
+    u32 Repeats = ElementsPerRun / Count;
+    for(u32 Run = 0; Run < 3; ++Run)
+    {
+        f64 Build = 0;
+        f64 Iterate = 0;
+        for(u32 Repeat = 0; Repeat < Repeats; ++Repeat)
+        {
+            Clear(Arena);
+            f64 Start = GetSeconds();
+            container Container = Make();
+            for(u32 Index = 0; Index < Count; ++Index)
+                Container.Push(Index);
+            Build += GetSeconds() - Start;
+
+            Start = GetSeconds();
+            u64 Sum = 0;
+            for(u32 Value : Container)
+                Sum += Value;
+            Iterate += GetSeconds() - Start;
+            KeepValue(Sum);
+        }
+
+        if(Build < Result.Build)
+            Result.Build = Build;
+        if(Iterate < Result.Iterate)
+            Result.Iterate = Iterate;
+    }
+
+    f64 Elements = (f64)Repeats * Count;
+    Result.Build = Result.Build / Elements * 1e9;
+    Result.Iterate = Result.Iterate / Elements * 1e9;
+    return Result;
+}
+
+// NOTE: Same Push() name as the rstd containers, so one Run() measures all of them
+struct std_vector : std::vector<u32>
+{
+    void Push(u32 Value)
+    { push_back(Value); }
+};
+
+int main()
+{
+    arena Arena = rstd_AllocateArenaZero(256_MB, "Benchmark");
+
+    printf("u32 elements, ns per element (build = push into empty container, iterate = sum)\n");
+    printf("  %9s %22s %22s %22s %22s\n", "", "dynamic_array", "std::vector", "doubly_linked_list", "backward_singly_list");
+    printf("  %9s", "count");
+    for(u32 Column = 0; Column < 4; ++Column)
+        printf(" %10s %11s", "build", "iterate");
+    printf("\n");
+
+    for(u32 Count = 1000; Count <= 10000000; Count *= 10)
+    {
+        result Results[4];
+        Results[0] = Run<dynamic_array<u32>>(Arena, Count, [&] { return dynamic_array<u32>(ShareArena(Arena)); });
+        Results[1] = Run<std_vector>(Arena, Count, [] { return std_vector(); });
+        Results[2] = Run<doubly_linked_list<u32>>(Arena, Count, [&] { return doubly_linked_list<u32>(ShareArena(Arena)); });
+        Results[3] = Run<backward_singly_linked_list<u32>>(Arena, Count, [&] { return backward_singly_linked_list<u32>(ShareArena(Arena)); });
+
+        printf("  %9u", Count);
+        for(auto& Result : Results)
+            printf(" %10.2f %11.2f", Result.Build, Result.Iterate);
+        printf("\n");
+    }
+
+    DeallocateArena(Arena);
+    return 0;
+}
@@ -0,0 +1,104 @@
+// NOTE: hash_map against std::unordered_map with random u64 keys and values. Hits and misses look up
+//       keys in random order, misses use keys that aren't in the map. Remove takes out every key.
+//       Usage: hash_map [max element count], default 10M
+
+#define rstd_Implementation
+#include "bench.h"
+#include <cstdlib>
+#include <unordered_map>
+
+struct result
+{
+    f64 Insert;
+    f64 Hit;
+    f64 Miss;
+    f64 Remove;
+};
+
+struct input
+{
+    u64* Keys;
+    u32* Order; // indices into Keys in lookup order
+    u32 Count;
+    u32 LookupCount;
+};
+
+template<class insert_function, class find_function, class remove_function> fn Run
+(input& Input, insert_function Insert, find_function Find, remove_function Remove)
+{
+    result Result;
+    u64 Sum = 0;
+
+    f64 Start = GetSeconds();
+    for(u32 Index = 0; Index < Input.Count; ++Index)
+        Insert(Input.Keys[Index], Index);
+    Result.Insert = (GetSeconds() - Start) / Input.Count * 1e9;
+
+    Start = GetSeconds();
+    for(u32 Lookup = 0; Lookup < Input.LookupCount; ++Lookup)
+        Sum += *Find(Input.Keys[Input.Order[Lookup]]);
+    Result.Hit = (GetSeconds() - Start) / Input.LookupCount * 1e9;
+
+    Start = GetSeconds();
+    for(u32 Lookup = 0; Lookup < Input.LookupCount; ++Lookup)
+        Sum += Find(~Input.Keys[Input.Order[Lookup]]) != nullptr;
+    Result.Miss = (GetSeconds() - Start) / Input.LookupCount * 1e9;
+
+    Start = GetSeconds();
+    for(u32 Index = 0; Index < Input.Count; ++Index)
+        Remove(Input.Keys[Index]);
+    Result.Remove = (GetSeconds() - Start) / Input.Count * 1e9;
+
+    KeepValue(Sum);
+    return Result;
+}
+
+int main(int ArgumentCount, char** Arguments)
+{
+    u32 MaxCount = ArgumentCount > 1 ? (u32)atoll(Arguments[1]) : 10000000;
+    if(!MaxCount)
+        MaxCount = 10000000;
+
+    printf("u64 -> u64, random keys, ns per operation (hash_map / std::unordered_map)\n");
+    printf("  %10s %16s %16s %16s %16s\n", "count", "insert", "hit", "miss", "remove");
+    for(u32 Count = 1000; Count <= MaxCount; Count *= 10)
+    {
+        // NOTE: Keys are odd, so their complement used for misses never is a key
+        input Input;
+        Input.Count = Count;
+        Input.LookupCount = Count < 10000000 ? 10000000 : Count;
+        Input.Keys = (u64*)PageAlloc(Align((size)Count * sizeof(u64), MemoryPageSize));
+        Input.Order = (u32*)PageAlloc(Align((size)Input.LookupCount * sizeof(u32), MemoryPageSize));
+        u64 RandomState = 88172645463325252ull;
+        for(u32 Index = 0; Index < Count; ++Index)
+            Input.Keys[Index] = NextRandom(RandomState) | 1;
+        for(u32 Lookup = 0; Lookup < Input.LookupCount; ++Lookup)
+            Input.Order[Lookup] = (u32)(NextRandom(RandomState) % Count);
+
+        result Map;
+        {
+            hash_map<u64, u64> HashMap;
+            Map = Run(Input,
+                      [&](u64 Key, u64 Value) { HashMap.Insert(Key, Value); },
+                      [&](u64 Key) { return HashMap.Find(Key); },
+                      [&](u64 Key) { HashMap.Remove(Key); });
+            HashMap.Free();
+        }
+
+        result Std;
+        {
+            std::unordered_map<u64, u64> UnorderedMap;
+            Std = Run(Input,
+                      [&](u64 Key, u64 Value) { UnorderedMap[Key] = Value; },
+                      [&](u64 Key) { auto It = UnorderedMap.find(Key); return It == UnorderedMap.end() ? nullptr : &It->second; },
+                      [&](u64 Key) { UnorderedMap.erase(Key); });
+        }
+
+        printf("  %10u %7.1f / %6.1f %7.1f / %6.1f %7.1f / %6.1f %7.1f / %6.1f\n", Count,
+               Map.Insert, Std.Insert, Map.Hit, Std.Hit, Map.Miss, Std.Miss, Map.Remove, Std.Remove);
+
+        PageFree(Input.Keys, Align((size)Count * sizeof(u64), MemoryPageSize));
+        PageFree(Input.Order, Align((size)Input.LookupCount * sizeof(u32), MemoryPageSize));
+    }
+    return 0;
+}
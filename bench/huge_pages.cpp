@@ -0,0 +1,63 @@
+// NOTE: Random access over an arena backed by normal pages against one created with ArenaFlag_HugePages.
+//       Working set is far bigger than what 4 KB pages TLB covers, so the difference is mostly TLB misses.
+//       First touch of every page is measured separately, huge pages also need much fewer page faults.
+//       On Linux huge pages come from /proc/sys/vm/nr_hugepages if reserved, transparent huge pages otherwise.
+//       Usage: huge_pages [working set in MB]
+
+#define rstd_Implementation
+#include "bench.h"
+#include <cstdlib>
+
+constexpr u32 AccessCount = 50000000;
+
+struct result
+{
+    f64 FirstTouchTime;
+    f64 RandomAccessTime;
+};
+
+fn Run
+(arena& Arena, size Bytes)
+{
+    result Result;
+    size Count = Bytes / sizeof(u64);
+    u64* Data = rstd_PushArrayUninitialized(Arena, u64, Count);
+
+    f64 Start = GetSeconds();
+    for(size Index = 0; Index < Count; Index += MemoryPageSize / sizeof(u64))
+        Data[Index] = Index;
+    Result.FirstTouchTime = GetSeconds() - Start;
+
+    u64 RandomState = 88172645463325252ull;
+    u64 Sum = 0;
+    Start = GetSeconds();
+    for(u32 Access = 0; Access < AccessCount; ++Access)
+        Sum += ++Data[NextRandom(RandomState) % Count];
+    Result.RandomAccessTime = GetSeconds() - Start;
+
+    KeepValue(Sum);
+    return Result;
+}
+
+int main(int ArgumentCount, char** Arguments)
+{
+    size Bytes = ArgumentCount > 1 ? MegabytesToBytes((size)atoll(Arguments[1])) : 1_GB;
+    if(!Bytes)
+        Bytes = 1_GB;
+
+    arena NormalArena = rstd_AllocateArenaZero(Bytes, "Normal pages");
+    result Normal = Run(NormalArena, Bytes);
+    DeallocateArena(NormalArena);
+
+    arena HugeArena = rstd_AllocateArenaZero(Bytes, "Huge pages", ArenaFlag_HugePages);
+    size HugeBlockSize = HugeArena.MemoryBlock->Size + sizeof(memory_block);
+    result Huge = Run(HugeArena, Bytes);
+    DeallocateArena(HugeArena);
+
+    printf("Working set %llu MB (huge page block %llu MB), %u random increments\n",
+           (unsigned long long)(Bytes / 1_MB), (unsigned long long)(HugeBlockSize / 1_MB), AccessCount);
+    printf("  %12s %18s %20s\n", "", "first touch [ms]", "ns per random access");
+    printf("  %12s %18.1f %20.2f\n", "normal pages", Normal.FirstTouchTime * 1e3, Normal.RandomAccessTime / AccessCount * 1e9);
+    printf("  %12s %18.1f %20.2f\n", "huge pages", Huge.FirstTouchTime * 1e3, Huge.RandomAccessTime / AccessCount * 1e9);
+    return 0;
+}
@@ -0,0 +1,90 @@
+// NOTE: Cost of the memory profiler on arena pushes. Built twice by build scripts, memory_profiler_off without
+//       the profiler and memory_profiler_on with it, compare the two outputs.
+//       Tight loop pushes from one place, which profiler coalesces into one event. Alternating loop pushes from
+//       two places so every push records its own event. Mixed loop is frame-like, structs and arrays of random
+//       size from a few places into two arenas.
+//       Usage: memory_profiler_off, memory_profiler_on
+
+#define rstd_Implementation
+#include "bench.h"
+
+constexpr u32 PushCount = 10000000;
+constexpr u32 PushesPerClear = 500000;
+
+struct entity
+{
+    u64 Id;
+    f32 Position[3];
+    u32 NameLength;
+    char* Name;
+    u32* Children;
+};
+
+template<class loop_function> fn BestOf
+(arena& Arena, loop_function Loop)
+{
+    f64 Best = 1e9;
+    for(u32 Run = 0; Run < 5; ++Run)
+    {
+        f64 Start = GetSeconds();
+        for(u32 Round = 0; Round < PushCount / PushesPerClear; ++Round)
+        {
+            Loop();
+            Clear(Arena);
+        }
+        f64 Time = GetSeconds() - Start;
+        if(Time < Best)
+            Best = Time;
+    }
+    return Best / PushCount * 1e9;
+}
+
+int main()
+{
+    MemoryDebug::Init();
+    arena Arena = rstd_AllocateArenaZero(64_MB, "Benchmark");
+    arena NameArena = rstd_AllocateArenaZero(64_MB, "Benchmark names");
+
+    f64 Tight = BestOf(Arena, [&]
+                       {
+                           for(u32 Index = 0; Index < PushesPerClear; ++Index)
+                               KeepValue(rstd_PushSizeUninitialized(Arena, 24));
+                       });
+
+    f64 Alternating = BestOf(Arena, [&]
+                             {
+                                 for(u32 Index = 0; Index < PushesPerClear; Index += 2)
+                                 {
+                                     KeepValue(rstd_PushSizeUninitialized(Arena, 24));
+                                     KeepValue(rstd_PushSizeUninitialized(Arena, 40));
+                                 }
+                             });
+
+    u64 RandomState = 88172645463325252ull;
+    f64 Mixed = BestOf(Arena, [&]
+                       {
+                           // NOTE: Three pushes per entity
+                           for(u32 Index = 0; Index < PushesPerClear; Index += 3)
+                           {
+                               u64 Random = NextRandom(RandomState);
+                               auto& Entity = rstd_PushStructZero(Arena, entity);
+                               Entity.Id = Index;
+                               Entity.NameLength = 4 + (u32)(Random % 28);
+                               Entity.Name = rstd_PushArrayUninitialized(NameArena, char, Entity.NameLength);
+                               Entity.Name[0] = (char)Random;
+                               Entity.Children = rstd_PushArrayZero(Arena, u32, 1 + (Random >> 8) % 8);
+                               KeepValue(&Entity);
+                           }
+                           Clear(NameArena);
+                       });
+
+    DeallocateArena(NameArena);
+    DeallocateArena(Arena);
+
+    printf("Arena pushes with memory profiler %s (%u pushes), ns per push\n",
+           rstd_MemoryProfilerEnabled ? "enabled" : "disabled", PushCount);
+    printf("  tight loop       %6.2f\n", Tight);
+    printf("  alternating      %6.2f\n", Alternating);
+    printf("  mixed            %6.2f\n", Mixed);
+    return 0;
+}
@@ -0,0 +1,197 @@
+// NOTE: Compares the platform layer with what programs use without rstd: PageAlloc() and arenas against
+//       malloc, thread_pool against std::thread, Atomic* functions against std::atomic.
+//       Usage: platform [thread count]
+
+#define rstd_Implementation
+#include "bench.h"
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// NOTE: Every allocation is touched once per page so both sides pay for page faults. glibc raises its mmap
+//       threshold after the first free of a mapped chunk, so malloc keeps reusing resident pages up to 32 MB.
+fn BenchPageAllocation()
+{
+    printf("Page allocation (allocate, touch every page, free), us per allocation\n");
+    printf("  %10s %12s %12s\n", "size", "PageAlloc", "malloc");
+    for(size Bytes = 64_KB; Bytes <= 64_MB; Bytes *= 4)
+    {
+        u32 Repeats = (u32)(1_GB / Bytes);
+        if(Repeats > 2000)
+            Repeats = 2000;
+
+        f64 Start = GetSeconds();
+        for(u32 Repeat = 0; Repeat < Repeats; ++Repeat)
+        {
+            u8* Memory = (u8*)PageAlloc(Bytes);
+            for(size Offset = 0; Offset < Bytes; Offset += MemoryPageSize)
+                Memory[Offset] = (u8)Repeat;
+            KeepValue(Memory);
+            PageFree(Memory, Bytes);
+        }
+        f64 PageAllocTime = GetSeconds() - Start;
+
+        Start = GetSeconds();
+        for(u32 Repeat = 0; Repeat < Repeats; ++Repeat)
+        {
+            u8* Memory = (u8*)malloc(Bytes);
+            for(size Offset = 0; Offset < Bytes; Offset += MemoryPageSize)
+                Memory[Offset] = (u8)Repeat;
+            KeepValue(Memory);
+            free(Memory);
+        }
+        f64 MallocTime = GetSeconds() - Start;
+
+        printf("  %8llu KB %12.2f %12.2f\n", (unsigned long long)(Bytes / 1024),
+               PageAllocTime / Repeats * 1e6, MallocTime / Repeats * 1e6);
+    }
+}
+
+// NOTE: Frame-like workload, many small objects that all die together
+fn BenchSmallAllocations()
+{
+    constexpr u32 AllocationCount = 1000000;
+    constexpr u32 FrameCount = 20;
+    static void* Pointers[AllocationCount];
+
+    arena Arena = rstd_AllocateArenaZero(256_MB);
+    u64 RandomState = 88172645463325252ull;
+
+    f64 Start = GetSeconds();
+    for(u32 Frame = 0; Frame < FrameCount; ++Frame)
+    {
+        for(u32 Index = 0; Index < AllocationCount; ++Index)
+        {
+            size Bytes = 16 + NextRandom(RandomState) % 240;
+            u8* Memory = rstd_PushArrayUninitialized(Arena, u8, Bytes);
+            Memory[0] = (u8)Index;
+            Pointers[Index] = Memory;
+        }
+        KeepValue(Pointers[AllocationCount - 1]);
+        Clear(Arena);
+    }
+    f64 ArenaTime = GetSeconds() - Start;
+
+    Start = GetSeconds();
+    for(u32 Frame = 0; Frame < FrameCount; ++Frame)
+    {
+        for(u32 Index = 0; Index < AllocationCount; ++Index)
+        {
+            size Bytes = 16 + NextRandom(RandomState) % 240;
+            u8* Memory = (u8*)malloc(Bytes);
+            Memory[0] = (u8)Index;
+            Pointers[Index] = Memory;
+        }
+        KeepValue(Pointers[AllocationCount - 1]);
+        for(u32 Index = 0; Index < AllocationCount; ++Index)
+            free(Pointers[Index]);
+    }
+    f64 MallocTime = GetSeconds() - Start;
+
+    DeallocateArena(Arena);
+
+    f64 Count = (f64)AllocationCount * FrameCount;
+    printf("\nSmall allocations (16-255 B, freed together), ns per allocation\n");
+    printf("  arena push + Clear %6.2f\n", ArenaTime / Count * 1e9);
+    printf("  malloc + free      %6.2f\n", MallocTime / Count * 1e9);
+}
+
+static volatile u32 JobCounter;
+
+static void IncrementJob(void*)
+{ AtomicIncrement(JobCounter); }
+
+// NOTE: thread_pool keeps its threads, std::thread side spawns a thread per worker for every batch
+//       which is what code without a pool ends up doing
+fn BenchJobs
+(u32 ThreadCount)
+{
+    constexpr u32 JobCount = 4096;
+    constexpr u32 BatchCount = 200;
+
+    thread_pool Pool;
+    Init(Pool, ThreadCount, rstd_AllocateArenaZero(1_MB));
+
+    f64 Start = GetSeconds();
+    for(u32 Batch = 0; Batch < BatchCount; ++Batch)
+    {
+        for(u32 Index = 0; Index < JobCount; ++Index)
+            PushJob(Pool, nullptr, IncrementJob);
+        CompleteAllJobs(Pool);
+    }
+    f64 PoolTime = GetSeconds() - Start;
+    rstd_RAssert(JobCounter == JobCount * BatchCount, "Thread pool lost jobs");
+
+    std::atomic<u32> NextJob;
+    std::atomic<u32> StdCounter = 0;
+    Start = GetSeconds();
+    for(u32 Batch = 0; Batch < BatchCount; ++Batch)
+    {
+        NextJob = 0;
+        std::vector<std::thread> Threads;
+        for(u32 ThreadIndex = 0; ThreadIndex < ThreadCount; ++ThreadIndex)
+        {
+            Threads.emplace_back([&]
+                                 {
+                                     while(NextJob.fetch_add(1) < JobCount)
+                                         StdCounter.fetch_add(1);
+                                 });
+        }
+        for(auto& Thread : Threads)
+            Thread.join();
+    }
+    f64 StdTime = GetSeconds() - Start;
+    rstd_RAssert(StdCounter == JobCount * BatchCount, "std::thread lost jobs");
+
+    printf("\nJobs (%u batches of %u tiny jobs, %u threads), us per batch\n", BatchCount, JobCount, ThreadCount);
+    printf("  thread_pool %8.1f\n", PoolTime / BatchCount * 1e6);
+    printf("  std::thread %8.1f\n", StdTime / BatchCount * 1e6);
+}
+
+fn BenchAtomics
+(u32 ThreadCount)
+{
+    constexpr u32 IncrementsPerThread = 2000000;
+
+    static volatile u32 RstdCounter;
+    f64 Start = GetSeconds();
+    {
+        std::vector<std::thread> Threads;
+        for(u32 ThreadIndex = 0; ThreadIndex < ThreadCount; ++ThreadIndex)
+            Threads.emplace_back([] { for(u32 Index = 0; Index < IncrementsPerThread; ++Index) AtomicIncrement(RstdCounter); });
+        for(auto& Thread : Threads)
+            Thread.join();
+    }
+    f64 RstdTime = GetSeconds() - Start;
+
+    std::atomic<u32> StdCounter = 0;
+    Start = GetSeconds();
+    {
+        std::vector<std::thread> Threads;
+        for(u32 ThreadIndex = 0; ThreadIndex < ThreadCount; ++ThreadIndex)
+            Threads.emplace_back([&] { for(u32 Index = 0; Index < IncrementsPerThread; ++Index) StdCounter.fetch_add(1); });
+        for(auto& Thread : Threads)
+            Thread.join();
+    }
+    f64 StdTime = GetSeconds() - Start;
+
+    rstd_RAssert(RstdCounter == StdCounter, "Atomic counters differ");
+    f64 Count = (f64)IncrementsPerThread * ThreadCount;
+    printf("\nContended increments (%u threads), ns per increment\n", ThreadCount);
+    printf("  AtomicIncrement      %6.2f\n", RstdTime / Count * 1e9);
+    printf("  std::atomic fetch_add %5.2f\n", StdTime / Count * 1e9);
+}
+
+int main(int ArgumentCount, char** Arguments)
+{
+    u32 ThreadCount = ArgumentCount > 1 ? (u32)atoi(Arguments[1]) : std::thread::hardware_concurrency();
+    if(!ThreadCount)
+        ThreadCount = 4;
+
+    BenchPageAllocation();
+    BenchSmallAllocations();
+    BenchJobs(ThreadCount);
+    BenchAtomics(ThreadCount);
+    return 0;
+}
@@ -0,0 +1,98 @@
+// NOTE: unrolled_list against doubly_linked_list for 4, 16 and 64 byte elements. Push appends N elements,
+//       iterate sums them, remove takes out every other element through iterators (unrolled_list merges
+//       half empty nodes on the way). Memory is arena bytes per element after the pushes.
+//       Usage: unrolled_list
+
+#define rstd_Implementation
+#include "bench.h"
+
+constexpr u32 ElementsPerRun = 20000000; // every measurement repeats until it handled this many elements
+
+template<u32 byte_count> struct element
+{ u32 Values[byte_count / sizeof(u32)]; };
+
+struct result
+{
+    f64 Push;
+    f64 Iterate;
+    f64 Remove;
+    f64 BytesPerElement;
+};
+
+template<class list, class type> fn Run
+(arena& Arena, u32 Count)
+{
+    result Result = {};
+    u32 Repeats = ElementsPerRun / Count;
+    for(u32 Repeat = 0; Repeat < Repeats; ++Repeat)
+    {
+        Clear(Arena);
+        list List(ShareArena(Arena));
+
+        f64 Start = GetSeconds();
+        for(u32 Index = 0; Index < Count; ++Index)
+        {
+            type Element = {};
+            Element.Values[0] = Index;
+            List.Push(Element);
+        }
+        Result.Push += GetSeconds() - Start;
+        Result.BytesPerElement = (f64)GetUsed(Arena) / Count;
+
+        Start = GetSeconds();
+        u64 Sum = 0;
+        for(auto& Element : List)
+            Sum += Element.Values[0];
+        Result.Iterate += GetSeconds() - Start;
+        KeepValue(Sum);
+
+        Start = GetSeconds();
+        u32 Removed = 0;
+        for(auto It = List.Begin(); It != List.End(); ++It)
+        {
+            if((*It).Values[0] & 1)
+            {
+                It = List.Remove(It);
+                ++Removed;
+            }
+        }
+        Result.Remove += GetSeconds() - Start;
+        KeepValue(Removed);
+    }
+
+    f64 Elements = (f64)Repeats * Count;
+    Result.Push = Result.Push / Elements * 1e9;
+    Result.Iterate = Result.Iterate / Elements * 1e9;
+    Result.Remove = Result.Remove / Elements * 1e9;
+    return Result;
+}
+
+template<u32 byte_count> fn RunElementSize
+(arena& Arena, u32 Count)
+{
+    using type = element<byte_count>;
+    result Results[2] = {Run<doubly_linked_list<type>, type>(Arena, Count), Run<unrolled_list<type>, type>(Arena, Count)};
+    const char* Names[2] = {"doubly_linked_list", "unrolled_list"};
+    for(u32 Index = 0; Index < 2; ++Index)
+    {
+        printf("  %4u B %9u %-19s %8.2f %8.2f %8.2f %8.1f\n", byte_count, Count, Names[Index],
+               Results[Index].Push, Results[Index].Iterate, Results[Index].Remove, Results[Index].BytesPerElement);
+    }
+}
+
+int main()
+{
+    arena Arena = rstd_AllocateArenaZero(64_MB, "Benchmark");
+
+    printf("ns per element (remove = every other element), arena bytes per element\n");
+    printf("  %6s %9s %-19s %8s %8s %8s %8s\n", "elem", "count", "list", "push", "iterate", "remove", "memory");
+    for(u32 Count = 1000; Count <= 10000000; Count *= 100)
+    {
+        RunElementSize<4>(Arena, Count);
+        RunElementSize<16>(Arena, Count);
+        RunElementSize<64>(Arena, Count);
+    }
+
+    DeallocateArena(Arena);
+    return 0;
+}
@@ -0,0 +1,111 @@
+// NOTE: PushArrayZero() right after RevertArena() of dirty range of the same size, which is when arena has
+//       to zero garbage. Compares default arena (memset, non-temporal stores from rstd_NonTemporalZeroThreshold),
+//       ArenaFlag_ZeroByPageReset and ArenaFlag_ZeroInBackground, plain memset of the range for reference.
+//       Background zeroing is measured with idle gap before the push, when job had time to finish,
+//       and without it, when the push takes over chunks that job didn't get to yet.
+//       Usage: zeroing
+
+#define rstd_Implementation
+#include "bench.h"
+#include <cstring>
+#include <thread>
+
+constexpr size MaxBytes = 256_MB;
+
+enum mode
+{
+    Mode_Default,
+    Mode_PageReset,
+    Mode_BackgroundIdle,
+    Mode_BackgroundBusy,
+    Mode_Count,
+};
+
+fn GetRepeatCount
+(size Bytes)
+{
+    size Repeats = 1_GB / Bytes;
+    if(Repeats > 2000)
+        Repeats = 2000;
+    if(Repeats < 4)
+        Repeats = 4;
+    return (u32)Repeats;
+}
+
+fn RunMode
+(mode Mode, size Bytes)
+{
+    u32 Flags = Mode == Mode_PageReset ? ArenaFlag_ZeroByPageReset :
+                Mode == Mode_Default ? 0 : ArenaFlag_ZeroInBackground;
+    arena Arena = rstd_AllocateArenaZero(MaxBytes + 1_MB, "Benchmark", Flags);
+
+    u32 Repeats = GetRepeatCount(Bytes);
+    f64 Time = 0;
+    for(u32 Repeat = 0; Repeat < Repeats; ++Repeat)
+    {
+        auto RevertPoint = GetArenaRevertPoint(Arena);
+        u8* Dirty = rstd_PushArrayUninitialized(Arena, u8, Bytes);
+        memset(Dirty, 1, Bytes);
+        RevertArena(Arena, RevertPoint);
+
+        // NOTE: About twice as long as the job needs
+        if(Mode == Mode_BackgroundIdle)
+            std::this_thread::sleep_for(std::chrono::microseconds(Bytes / 2000 + 50));
+
+        f64 Start = GetSeconds();
+        u8* Zeroed = rstd_PushArrayZero(Arena, u8, Bytes);
+        Time += GetSeconds() - Start;
+        KeepValue(Zeroed);
+        RevertArena(Arena, RevertPoint);
+    }
+
+    DeallocateArena(Arena);
+    return Time / Repeats;
+}
+
+fn RunMemset
+(size Bytes)
+{
+    u8* Memory = (u8*)PageAlloc(Bytes);
+    memset(Memory, 1, Bytes);
+
+    u32 Repeats = GetRepeatCount(Bytes);
+    f64 Time = 0;
+    for(u32 Repeat = 0; Repeat < Repeats; ++Repeat)
+    {
+        memset(Memory, 1, Bytes);
+        f64 Start = GetSeconds();
+        memset(Memory, 0, Bytes);
+        Time += GetSeconds() - Start;
+        KeepValue(Memory);
+    }
+
+    PageFree(Memory, Bytes);
+    return Time / Repeats;
+}
+
+int main()
+{
+    thread_pool Pool;
+    Init(Pool, 1, rstd_AllocateArenaZero(1_MB));
+    SetBackgroundZeroingPool(&Pool);
+
+    printf("PushArrayZero after revert of dirty range of the same size, us per push\n");
+    printf("  %10s %10s %10s %10s %10s %10s\n", "size", "memset", "default", "page reset", "bg idle", "bg busy");
+    for(size Bytes = 64; Bytes <= MaxBytes; Bytes *= 4)
+    {
+        f64 Times[Mode_Count];
+        for(u32 Mode = 0; Mode < Mode_Count; ++Mode)
+            Times[Mode] = RunMode((mode)Mode, Bytes);
+
+        if(Bytes >= 1_MB)
+            printf("  %7llu MB", (unsigned long long)(Bytes / 1_MB));
+        else if(Bytes >= 1_KB)
+            printf("  %7llu KB", (unsigned long long)(Bytes / 1_KB));
+        else
+            printf("  %8llu B", (unsigned long long)Bytes);
+        printf(" %10.2f %10.2f %10.2f %10.2f %10.2f\n", RunMemset(Bytes) * 1e6, Times[Mode_Default] * 1e6,
+               Times[Mode_PageReset] * 1e6, Times[Mode_BackgroundIdle] * 1e6, Times[Mode_BackgroundBusy] * 1e6);
+    }
+    return 0;
+}
@@ -0,0 +1,8 @@
+@echo off
+
+set CompilerFlags=-O2 -MT -nologo -fp:fast -fp:except- -Gm- -GR- -EHa- -Zo -Oi -W3 -std:c++20 -D_CRT_SECURE_NO_WARNINGS -wd4201 -wd4100 -wd4189 -wd4505 -wd4127 -FC -Z7
+set LinkerFlags= -incremental:no -opt:ref user32.lib
+
+echo Compiling memory trace analyzer...
+
+cl %CompilerFlags% memory_trace.cpp /link %LinkerFlags% | more
@@ -0,0 +1,5 @@
+#!/bin/sh
+
+echo Compiling memory trace analyzer...
+
+g++ -std=c++20 -O2 memory_trace.cpp -o memory_trace -lpthread
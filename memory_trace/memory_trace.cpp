@@ -0,0 +1,734 @@
+// NOTE: Replays trace written by MemoryDebug::BeginTrace() and prints fragmentation, memory group peaks and timeline.
+//       Statistics are computed the same way as in rstd MemoryDebug so numbers match what program saw in-process.
+//       Usage: memory_trace <trace file> [timeline row count]
+
+#define rstd_Implementation
+#define rstd_Debug 0
+#include "../rstd.h"
+#include <cstdio>
+using namespace rstd;
+using namespace rstd::memory_size_literals;
+using namespace rstd::MemoryDebug;
+
+#define fn static auto
+
+struct statistics
+{
+    size
+        Used, UsedPeak,
+    Size, SizePeak,
+    Wasted, Unused,
+    AlignmentPadding;
+};
+
+struct arena_data
+{
+    const char* Name;
+    const char* MasterArenaName;
+    u32 MemoryGroupIndex;
+    u32 MemoryBlockCount;
+    u32 TemporaryMemoryDepth;
+    u32 FirstGroupPushes; // index + 1 into replay::ArenaGroupPushes, 0 means none
+    rstd_bool Created;
+    statistics Stats;
+};
+
+// NOTE: Live pushes into one arena within one memory group, released on clear
+//       the same way rstd MemoryDebug releases its arena sites
+struct arena_group_pushes
+{
+    u32 MemoryGroupIndex;
+    u32 NextInArena; // index + 1, 0 ends the list
+    size Bytes;
+    size AlignmentPadding;
+};
+
+struct memory_group
+{
+    const char* Name;
+    statistics Stats;
+};
+
+struct gen_allocation
+{
+    u64 Address;
+    size Size; // number of frees for early frees
+    u32 MemoryGroupIndex;
+};
+
+struct gen_allocation_table
+{
+    gen_allocation* Slots;
+    u32 Capacity;
+    u32 Count;
+};
+
+struct timeline_sample
+{
+    u64 Time;
+    size Used;
+    size Size;
+    size Wasted;
+};
+
+// NOTE: Arrays grow in place in reserved address space, Get() pushes zeroed elements up to Index
+template<class type>
+struct growing_array
+{
+    arena Arena;
+    type* Elements;
+    u32 Count;
+};
+
+template<class type> fn MakeGrowingArray()
+{
+    growing_array<type> Array;
+    Array.Arena = rstd_ReserveArena(16_GB);
+    Array.Elements = (type*)Array.Arena.MemoryBlock->Base;
+    Array.Count = 0;
+    return Array;
+}
+
+template<class type> fn Get
+(growing_array<type>& Array, u32 Index) -> type&
+{
+    if(Index >= Array.Count)
+    {
+        rstd_PushArrayZero(Array.Arena, type, Index + 1 - Array.Count);
+        Array.Count = Index + 1;
+    }
+    return Array.Elements[Index];
+}
+
+template<class type> fn Add
+(growing_array<type>& Array) -> type&
+{ return Get(Array, Array.Count); }
+
+struct trace_reader
+{
+    file File;
+    u64 FilePos;
+    u8* Buffer;
+    u8* At;
+    u8* End;
+    rstd_bool FileEnded;
+};
+
+constexpr u32 ReaderBufferSize = 4*1024*1024;
+constexpr u32 ReaderRefillThreshold = 1024*1024;
+
+// NOTE: Keeps at least ReaderRefillThreshold bytes ahead unless file ends
+fn Refill
+(trace_reader& R)
+{
+    if(R.FileEnded || R.End - R.At >= ReaderRefillThreshold)
+        return;
+
+    u32 Remaining = (u32)(R.End - R.At);
+    memmove(R.Buffer, R.At, Remaining);
+    u32 ReadBytes = Read(R.Buffer + Remaining, R.File, R.FilePos, ReaderBufferSize - Remaining);
+    R.FilePos += ReadBytes;
+    R.FileEnded = ReadBytes < ReaderBufferSize - Remaining;
+    R.At = R.Buffer;
+    R.End = R.Buffer + Remaining + ReadBytes;
+}
+
+fn ReadVarint
+(trace_reader& R, u64* Dest)
+{
+    u64 Value = 0;
+    for(u32 Shift = 0; Shift < 64; Shift += 7)
+    {
+        if(R.At == R.End)
+            return false;
+        u8 Byte = *R.At++;
+        Value |= (u64)(Byte & 0x7F) << Shift;
+        if(!(Byte & 0x80))
+        {
+            *Dest = Value;
+            return true;
+        }
+    }
+    return false;
+}
+
+fn ReadVarints
+(trace_reader& R, u64* Dest, u32 Count)
+{
+    for(u32 Index = 0; Index < Count; ++Index)
+    {
+        if(!ReadVarint(R, Dest + Index))
+            return false;
+    }
+    return true;
+}
+
+fn HashAddress(u64 Address)
+{ return (u32)((Address * 0x9E3779B97F4A7C15) >> 32); }
+
+fn Find
+(gen_allocation_table& Table, u64 Address) -> gen_allocation*
+{
+    if(!Table.Count)
+        return nullptr;
+
+    u32 Mask = Table.Capacity - 1;
+    for(u32 SlotIndex = HashAddress(Address) & Mask;; SlotIndex = (SlotIndex + 1) & Mask)
+    {
+        auto& Slot = Table.Slots[SlotIndex];
+        if(Slot.Address == Address)
+            return &Slot;
+        if(!Slot.Address)
+            return nullptr;
+    }
+}
+
+fn Insert
+(gen_allocation_table& Table, u64 Address) -> gen_allocation&
+{
+    if((Table.Count + 1) * 2 > Table.Capacity)
+    {
+        gen_allocation_table OldTable = Table;
+        Table.Capacity = OldTable.Capacity ? OldTable.Capacity * 2 : 1024;
+        Table.Count = 0;
+        Table.Slots = (gen_allocation*)PageAlloc(Align(Table.Capacity * sizeof(gen_allocation), MemoryPageSize));
+        rstd_RAssert(Table.Slots, "OS Allocation call failed (probably your machine ran out of memory)");
+        for(u32 SlotIndex = 0; SlotIndex < OldTable.Capacity; ++SlotIndex)
+        {
+            if(OldTable.Slots[SlotIndex].Address)
+                Insert(Table, OldTable.Slots[SlotIndex].Address) = OldTable.Slots[SlotIndex];
+        }
+        if(OldTable.Slots)
+            PageFree(OldTable.Slots, Align(OldTable.Capacity * sizeof(gen_allocation), MemoryPageSize));
+    }
+
+    u32 Mask = Table.Capacity - 1;
+    u32 SlotIndex = HashAddress(Address) & Mask;
+    while(Table.Slots[SlotIndex].Address)
+        SlotIndex = (SlotIndex + 1) & Mask;
+
+    auto& Slot = Table.Slots[SlotIndex];
+    Slot.Address = Address;
+    ++Table.Count;
+    return Slot;
+}
+
+fn Remove
+(gen_allocation_table& Table, gen_allocation* Removed)
+{
+    u32 Mask = Table.Capacity - 1;
+    u32 HoleIndex = (u32)(Removed - Table.Slots);
+    for(u32 SlotIndex = (HoleIndex + 1) & Mask; Table.Slots[SlotIndex].Address; SlotIndex = (SlotIndex + 1) & Mask)
+    {
+        auto& Slot = Table.Slots[SlotIndex];
+        u32 HomeIndex = HashAddress(Slot.Address) & Mask;
+        if(((SlotIndex - HomeIndex) & Mask) >= ((SlotIndex - HoleIndex) & Mask))
+        {
+            Table.Slots[HoleIndex] = Slot;
+            HoleIndex = SlotIndex;
+        }
+    }
+    Table.Slots[HoleIndex].Address = 0;
+    --Table.Count;
+}
+
+fn AddStatistic
+(size* Statistic, size* MaxStatistic, size Delta)
+{
+    *Statistic += Delta;
+    if(*Statistic > *MaxStatistic)
+        *MaxStatistic = *Statistic;
+}
+
+fn AddPush
+(statistics* Stats, size Size, size AlignmentPadding)
+{
+    AddStatistic(&Stats->Used, &Stats->UsedPeak, Size);
+    Stats->Unused -= Size + AlignmentPadding;
+    Stats->AlignmentPadding += AlignmentPadding;
+}
+
+fn RemovePush
+(statistics* Stats, size Size, size AlignmentPadding)
+{
+    Stats->Used -= Size;
+    Stats->Unused += Size + AlignmentPadding;
+    Stats->AlignmentPadding -= AlignmentPadding;
+}
+
+fn SubtractUsedAndAddUnused
+(statistics* Stats, size Delta)
+{
+    Stats->Used -= Delta;
+    Stats->Unused += Delta;
+}
+
+fn AddSizeAndUnused
+(statistics* Stats, size Delta)
+{
+    AddStatistic(&Stats->Size, &Stats->SizePeak, Delta);
+    Stats->Unused += Delta;
+}
+
+fn AlterStatsOnMemoryBlockAllocation
+(statistics* Stats, size NewMemoryBlockSize, size PrevMemoryBlockUnusedBytes)
+{
+    AddSizeAndUnused(Stats, NewMemoryBlockSize);
+    Stats->Unused -= PrevMemoryBlockUnusedBytes;
+    Stats->Wasted += PrevMemoryBlockUnusedBytes;
+}
+
+fn AlterStatsOnMemoryBlockDeallocation
+(statistics* Stats, size MemoryBlockToDeallocateSize, size PrevMemoryBlockUnusedBytes)
+{
+    Stats->Size -= MemoryBlockToDeallocateSize;
+    Stats->Unused -= MemoryBlockToDeallocateSize;
+    Stats->Unused += PrevMemoryBlockUnusedBytes;
+    Stats->Wasted -= PrevMemoryBlockUnusedBytes;
+}
+
+struct replay
+{
+    arena StringArena;
+    growing_array<const char*> Strings; // indexed by string id
+    growing_array<u32> MemoryGroupIndices; // MemoryGroupIndex + 1, indexed by string id of group name
+    growing_array<memory_group> MemoryGroups;
+    growing_array<arena_data> Arenas; // indexed by arena id
+    growing_array<arena_group_pushes> ArenaGroupPushes;
+    u32 FirstFreeGroupPushes; // index + 1
+    growing_array<timeline_sample> Timeline;
+    gen_allocation_table GenAllocations;
+    gen_allocation_table EarlyGenFrees;
+    statistics Stats;
+    u64 RecordCount;
+    u64 LastTime;
+};
+
+fn GetMemoryGroupIndex
+(replay& Replay, u64 NameId)
+{
+    if(!NameId)
+        return 0u;
+
+    auto& MemoryGroupIndex = Get(Replay.MemoryGroupIndices, (u32)NameId);
+    if(!MemoryGroupIndex)
+    {
+        // NOTE: Different string ids can hold the same group name (different pointers in the program)
+        const char* Name = Get(Replay.Strings, (u32)NameId);
+        for(u32 GroupIndex = 0; GroupIndex < Replay.MemoryGroups.Count; ++GroupIndex)
+        {
+            if(Name && strcmp(Replay.MemoryGroups.Elements[GroupIndex].Name, Name) == 0)
+            {
+                MemoryGroupIndex = GroupIndex + 1;
+                break;
+            }
+        }
+
+        if(!MemoryGroupIndex)
+        {
+            Add(Replay.MemoryGroups).Name = Name ? Name : "unknown";
+            MemoryGroupIndex = Replay.MemoryGroups.Count;
+        }
+    }
+    return MemoryGroupIndex - 1;
+}
+
+// NOTE: Arenas created before trace began are known only by their id
+fn GetArena
+(replay& Replay, u64 ArenaId) -> arena_data&
+{
+    auto& Arena = Get(Replay.Arenas, (u32)ArenaId);
+    if(!Arena.Created && !Arena.Name)
+    {
+        Arena.Name = ArenaId ? rstd_PushStringCopy(Replay.StringArena, Format<string<64>>("arena % (created before trace)", ArenaId).GetCString()) :
+            "unregistered arenas";
+        Arena.MemoryBlockCount = 1;
+    }
+    return Arena;
+}
+
+fn GetGroupPushes
+(replay& Replay, arena_data& Arena, u32 MemoryGroupIndex) -> arena_group_pushes&
+{
+    for(u32 Entry = Arena.FirstGroupPushes; Entry; Entry = Replay.ArenaGroupPushes.Elements[Entry - 1].NextInArena)
+    {
+        auto& GroupPushes = Replay.ArenaGroupPushes.Elements[Entry - 1];
+        if(GroupPushes.MemoryGroupIndex == MemoryGroupIndex)
+            return GroupPushes;
+    }
+
+    u32 EntryIndex;
+    if(Replay.FirstFreeGroupPushes)
+    {
+        EntryIndex = Replay.FirstFreeGroupPushes - 1;
+        Replay.FirstFreeGroupPushes = Replay.ArenaGroupPushes.Elements[EntryIndex].NextInArena;
+    }
+    else
+    {
+        EntryIndex = Replay.ArenaGroupPushes.Count;
+    }
+
+    auto& GroupPushes = Get(Replay.ArenaGroupPushes, EntryIndex);
+    GroupPushes.MemoryGroupIndex = MemoryGroupIndex;
+    GroupPushes.Bytes = 0;
+    GroupPushes.AlignmentPadding = 0;
+    GroupPushes.NextInArena = Arena.FirstGroupPushes;
+    Arena.FirstGroupPushes = EntryIndex + 1;
+    return GroupPushes;
+}
+
+// NOTE: All pushes into the arena stop being live
+fn ReleaseGroupPushes
+(replay& Replay, arena_data& Arena)
+{
+    for(u32 Entry = Arena.FirstGroupPushes; Entry;)
+    {
+        auto& GroupPushes = Replay.ArenaGroupPushes.Elements[Entry - 1];
+        RemovePush(&Arena.Stats, GroupPushes.Bytes, GroupPushes.AlignmentPadding);
+        RemovePush(&Replay.MemoryGroups.Elements[GroupPushes.MemoryGroupIndex].Stats, GroupPushes.Bytes, GroupPushes.AlignmentPadding);
+        RemovePush(&Replay.Stats, GroupPushes.Bytes, GroupPushes.AlignmentPadding);
+
+        u32 Next = GroupPushes.NextInArena;
+        GroupPushes.NextInArena = Replay.FirstFreeGroupPushes;
+        Replay.FirstFreeGroupPushes = Entry;
+        Entry = Next;
+    }
+    Arena.FirstGroupPushes = 0;
+}
+
+fn ReplayRecord
+(replay& Replay, trace_reader& R, trace_record_type Type)
+{
+    u64 F[10];
+    switch(Type)
+    {
+        case trace_record_type::String:
+        {
+            if(!ReadVarints(R, F, 2) || F[1] > (u64)(R.End - R.At))
+                return false;
+            char* String = (char*)rstd_PushSizeUninitialized(Replay.StringArena, F[1] + 1);
+            memcpy(String, R.At, F[1]);
+            String[F[1]] = 0;
+            R.At += F[1];
+            Get(Replay.Strings, (u32)F[0]) = String;
+        } break;
+
+        case trace_record_type::Time:
+        {
+            if(!ReadVarint(R, F))
+                return false;
+            Replay.LastTime = F[0];
+            auto& Sample = Add(Replay.Timeline);
+            Sample.Time = F[0];
+            Sample.Used = Replay.Stats.Used;
+            Sample.Size = Replay.Stats.Size;
+            Sample.Wasted = Replay.Stats.Wasted;
+        } break;
+
+        case trace_record_type::CreateArena:
+        {
+            if(!ReadVarints(R, F, 9))
+                return false;
+            auto& Arena = Get(Replay.Arenas, (u32)F[0]);
+            ZeroStruct(Arena);
+            Arena.Created = true;
+            Arena.Name = F[1] ? Get(Replay.Strings, (u32)F[1]) :
+                rstd_PushStringCopy(Replay.StringArena, Format<string<32>>("nameless %", F[0]).GetCString());
+            Arena.MasterArenaName = Get(Replay.Strings, (u32)F[2]);
+            Arena.MemoryGroupIndex = GetMemoryGroupIndex(Replay, F[3]);
+            Arena.MemoryBlockCount = 1;
+            AddSizeAndUnused(&Arena.Stats, F[7]);
+            AddSizeAndUnused(&Replay.MemoryGroups.Elements[Arena.MemoryGroupIndex].Stats, F[7]);
+            AddSizeAndUnused(&Replay.Stats, F[7]);
+        } break;
+
+        case trace_record_type::ArenaPush:
+        {
+            if(!ReadVarints(R, F, 8))
+                return false;
+            auto& Arena = GetArena(Replay, F[0]);
+            if(Arena.TemporaryMemoryDepth)
+                break;
+            u32 MemoryGroupIndex = GetMemoryGroupIndex(Replay, F[1]);
+            auto& GroupPushes = GetGroupPushes(Replay, Arena, MemoryGroupIndex);
+            GroupPushes.Bytes += F[6];
+            GroupPushes.AlignmentPadding += F[7];
+            AddPush(&Arena.Stats, F[6], F[7]);
+            AddPush(&Replay.MemoryGroups.Elements[MemoryGroupIndex].Stats, F[6], F[7]);
+            AddPush(&Replay.Stats, F[6], F[7]);
+        } break;
+
+        case trace_record_type::ShrinkLastPush:
+        {
+            if(!ReadVarints(R, F, 6))
+                return false;
+            auto& Arena = GetArena(Replay, F[0]);
+            if(Arena.TemporaryMemoryDepth)
+                break;
+            u32 MemoryGroupIndex = GetMemoryGroupIndex(Replay, F[1]);
+            GetGroupPushes(Replay, Arena, MemoryGroupIndex).Bytes -= F[5];
+            SubtractUsedAndAddUnused(&Arena.Stats, F[5]);
+            SubtractUsedAndAddUnused(&Replay.MemoryGroups.Elements[MemoryGroupIndex].Stats, F[5]);
+            SubtractUsedAndAddUnused(&Replay.Stats, F[5]);
+        } break;
+
+        case trace_record_type::AllocateNextMemoryBlock:
+        case trace_record_type::DeallocateMemoryBlock:
+        {
+            rstd_bool Allocation = Type == trace_record_type::AllocateNextMemoryBlock;
+            if(!ReadVarints(R, F, Allocation ? 4 : 3))
+                return false;
+            auto& Arena = GetArena(Replay, F[0]);
+            auto& GroupStats = Replay.MemoryGroups.Elements[Arena.MemoryGroupIndex].Stats;
+            if(Allocation)
+            {
+                ++Arena.MemoryBlockCount;
+                AlterStatsOnMemoryBlockAllocation(&Arena.Stats, F[1], F[2]);
+                AlterStatsOnMemoryBlockAllocation(&GroupStats, F[1], F[2]);
+                AlterStatsOnMemoryBlockAllocation(&Replay.Stats, F[1], F[2]);
+            }
+            else
+            {
+                if(--Arena.MemoryBlockCount == 0)
+                    ReleaseGroupPushes(Replay, Arena);
+                AlterStatsOnMemoryBlockDeallocation(&Arena.Stats, F[1], F[2]);
+                AlterStatsOnMemoryBlockDeallocation(&GroupStats, F[1], F[2]);
+                AlterStatsOnMemoryBlockDeallocation(&Replay.Stats, F[1], F[2]);
+            }
+        } break;
+
+        case trace_record_type::BeginTemporaryMemory:
+        case trace_record_type::EndTemporaryMemory:
+        case trace_record_type::ClearArena:
+        {
+            if(!ReadVarint(R, F))
+                return false;
+            auto& Arena = GetArena(Replay, F[0]);
+            if(Type == trace_record_type::BeginTemporaryMemory)
+                ++Arena.TemporaryMemoryDepth;
+            else if(Type == trace_record_type::EndTemporaryMemory)
+                --Arena.TemporaryMemoryDepth;
+            else if(F[0])
+                ReleaseGroupPushes(Replay, Arena);
+        } break;
+
+        case trace_record_type::GenAlloc:
+        {
+            if(!ReadVarints(R, F, 6))
+                return false;
+            if(auto* EarlyFree = Find(Replay.EarlyGenFrees, F[0]))
+            {
+                if(--EarlyFree->Size == 0)
+                    Remove(Replay.EarlyGenFrees, EarlyFree);
+                break;
+            }
+
+            u32 MemoryGroupIndex = GetMemoryGroupIndex(Replay, F[1]);
+            auto& Alloc = Insert(Replay.GenAllocations, F[0]);
+            Alloc.Size = F[5];
+            Alloc.MemoryGroupIndex = MemoryGroupIndex;
+
+            auto& GroupStats = Replay.MemoryGroups.Elements[MemoryGroupIndex].Stats;
+            AddPush(&GroupStats, F[5], 0);
+            AddSizeAndUnused(&GroupStats, F[5]);
+            AddPush(&Replay.Stats, F[5], 0);
+            AddSizeAndUnused(&Replay.Stats, F[5]);
+        } break;
+
+        case trace_record_type::GenFree:
+        {
+            if(!ReadVarint(R, F))
+                return false;
+            auto* Alloc = Find(Replay.GenAllocations, F[0]);
+            if(!Alloc)
+            {
+                auto* EarlyFree = Find(Replay.EarlyGenFrees, F[0]);
+                if(!EarlyFree)
+                {
+                    EarlyFree = &Insert(Replay.EarlyGenFrees, F[0]);
+                    EarlyFree->Size = 0;
+                }
+                ++EarlyFree->Size;
+                break;
+            }
+
+            auto& GroupStats = Replay.MemoryGroups.Elements[Alloc->MemoryGroupIndex].Stats;
+            GroupStats.Used -= Alloc->Size;
+            GroupStats.Size -= Alloc->Size;
+            Replay.Stats.Used -= Alloc->Size;
+            Replay.Stats.Size -= Alloc->Size;
+            Remove(Replay.GenAllocations, Alloc);
+        } break;
+
+        default:
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+fn SizeText
+(size Bytes)
+{
+    string<32> Text;
+    if(Bytes < 1024)
+        snprintf(Text.Characters, 32, "%llu B", (unsigned long long)Bytes);
+    else if(Bytes < 1024*1024)
+        snprintf(Text.Characters, 32, "%.1f KB", (f64)Bytes / 1024);
+    else if(Bytes < (size)1024*1024*1024)
+        snprintf(Text.Characters, 32, "%.2f MB", (f64)Bytes / (1024*1024));
+    else
+        snprintf(Text.Characters, 32, "%.2f GB", (f64)Bytes / (1024*1024*1024));
+    Text.UpdateCount();
+    return Text;
+}
+
+fn PrintStatistics
+(const char* Indent, statistics& Stats)
+{
+    printf("%sUsed: %s (peak %s)\n", Indent, SizeText(Stats.Used).GetCString(), SizeText(Stats.UsedPeak).GetCString());
+    printf("%sSize: %s (peak %s)\n", Indent, SizeText(Stats.Size).GetCString(), SizeText(Stats.SizePeak).GetCString());
+    printf("%sWasted: %s, alignment padding: %s\n", Indent, SizeText(Stats.Wasted).GetCString(), SizeText(Stats.AlignmentPadding).GetCString());
+}
+
+fn TicksToSeconds(u64 Ticks)
+{ return (f64)Ticks / 10000000.0; }
+
+int main(int ArgumentCount, char** Arguments)
+{
+    if(ArgumentCount < 2)
+    {
+        printf("Usage: memory_trace <trace file> [timeline row count]\n");
+        return 1;
+    }
+
+    u32 TimelineRowCount = ArgumentCount > 2 ? (u32)atoi(Arguments[2]) : 20;
+    if(!TimelineRowCount)
+        TimelineRowCount = 20;
+
+    trace_reader R = {};
+    R.File = OpenFile(Arguments[1], io_mode::Read);
+    if(!R.File)
+    {
+        printf("Couldn't open %s\n", Arguments[1]);
+        return 1;
+    }
+    rstd_defer(Close(R.File));
+
+    trace_file_header Header;
+    if(Read(&Header, R.File, 0, sizeof(Header)) != sizeof(Header) ||
+       Header.Magic != TraceFileMagic || Header.Version != TraceFileVersion)
+    {
+        printf("%s is not memory trace of this rstd version\n", Arguments[1]);
+        return 1;
+    }
+
+    arena ReaderArena = rstd_AllocateArenaZero(ReaderBufferSize + MemoryPageSize);
+    R.Buffer = rstd_PushArrayUninitialized(ReaderArena, u8, ReaderBufferSize);
+    R.At = R.End = R.Buffer;
+    R.FilePos = sizeof(Header);
+
+    replay Replay = {};
+    Replay.StringArena = rstd_AllocateArenaZero(1_MB);
+    Replay.Strings = MakeGrowingArray<const char*>();
+    Replay.MemoryGroupIndices = MakeGrowingArray<u32>();
+    Replay.MemoryGroups = MakeGrowingArray<memory_group>();
+    Replay.Arenas = MakeGrowingArray<arena_data>();
+    Replay.ArenaGroupPushes = MakeGrowingArray<arena_group_pushes>();
+    Replay.Timeline = MakeGrowingArray<timeline_sample>();
+    Add(Replay.MemoryGroups).Name = "Others";
+
+    rstd_bool Truncated = false;
+    for(;;)
+    {
+        Refill(R);
+        if(R.At == R.End)
+            break;
+
+        auto Type = (trace_record_type)*R.At++;
+        if(!ReplayRecord(Replay, R, Type))
+        {
+            Truncated = true;
+            break;
+        }
+        ++Replay.RecordCount;
+    }
+
+    printf("Trace %s: %llu records, %.3f s", Arguments[1], (unsigned long long)Replay.RecordCount, TicksToSeconds(Replay.LastTime));
+    if(Header.SamplingInterval)
+        printf(", sampled every %llu bytes (pushes and gen allocations are estimates)", (unsigned long long)Header.SamplingInterval);
+    printf("\n");
+    if(Truncated)
+        printf("Trace ends in the middle of a record (program probably crashed), showing state at the last complete record\n");
+    if(Replay.EarlyGenFrees.Count)
+        printf("%u gen frees without matching allocation\n", Replay.EarlyGenFrees.Count);
+
+    printf("\nTotal\n");
+    PrintStatistics("  ", Replay.Stats);
+
+    // NOTE: Wasted is memory left at the end of memory blocks when arena had to allocate the next one
+    printf("\nFragmentation (arenas by Wasted)\n");
+    {
+        u32 PrintedCount = 0;
+        growing_array<u32> Order = MakeGrowingArray<u32>();
+        for(u32 ArenaId = 0; ArenaId < Replay.Arenas.Count; ++ArenaId)
+        {
+            auto& Arena = Replay.Arenas.Elements[ArenaId];
+            if(Arena.Name && (Arena.Stats.Wasted || Arena.Stats.Size))
+                Add(Order) = ArenaId;
+        }
+        std::sort(Order.Elements, Order.Elements + Order.Count, [&](u32 A, u32 B)
+                  { return Replay.Arenas.Elements[A].Stats.Wasted > Replay.Arenas.Elements[B].Stats.Wasted; });
+
+        for(u32 OrderIndex = 0; OrderIndex < Order.Count && PrintedCount < 20; ++OrderIndex, ++PrintedCount)
+        {
+            auto& Arena = Replay.Arenas.Elements[Order.Elements[OrderIndex]];
+            f64 WastedPercentage = Arena.Stats.Size ? 100.0 * (f64)Arena.Stats.Wasted / (f64)Arena.Stats.Size : 0;
+            printf("  %s [%s]%s: wasted %s of %s (%.1f%%), %u memory blocks\n", Arena.Name,
+                   Replay.MemoryGroups.Elements[Arena.MemoryGroupIndex].Name, Arena.MemoryBlockCount ? "" : " (deallocated)",
+                   SizeText(Arena.Stats.Wasted).GetCString(), SizeText(Arena.Stats.Size).GetCString(),
+                   WastedPercentage, Arena.MemoryBlockCount);
+        }
+        if(!Order.Count)
+            printf("  no arenas\n");
+    }
+
+    printf("\nMemory groups\n");
+    for(u32 GroupIndex = 0; GroupIndex < Replay.MemoryGroups.Count; ++GroupIndex)
+    {
+        auto& MemoryGroup = Replay.MemoryGroups.Elements[GroupIndex];
+        printf("  %s\n", MemoryGroup.Name);
+        PrintStatistics("    ", MemoryGroup.Stats);
+    }
+
+    printf("\nTimeline (state at the end of each period and the highest Size within it)\n");
+    printf("  %12s %12s %12s %12s %12s\n", "time [s]", "Size", "Size peak", "Used", "Wasted");
+    if(Replay.Timeline.Count && Replay.LastTime)
+    {
+        u32 SampleIndex = 0;
+        for(u32 Row = 1; Row <= TimelineRowCount; ++Row)
+        {
+            u64 RowEnd = Replay.LastTime * Row / TimelineRowCount;
+            size SizePeak = 0;
+            timeline_sample* Last = nullptr;
+            for(; SampleIndex < Replay.Timeline.Count && Replay.Timeline.Elements[SampleIndex].Time <= RowEnd; ++SampleIndex)
+            {
+                Last = Replay.Timeline.Elements + SampleIndex;
+                if(Last->Size > SizePeak)
+                    SizePeak = Last->Size;
+            }
+            if(!Last)
+                continue;
+
+            printf("  %12.3f %12s %12s %12s %12s\n", TicksToSeconds(RowEnd), SizeText(Last->Size).GetCString(),
+                   SizeText(SizePeak).GetCString(), SizeText(Last->Used).GetCString(), SizeText(Last->Wasted).GetCString());
+        }
+    }
+    else
+    {
+        printf("  trace has no time records\n");
+    }
+
+    return 0;
+}
@@ -22,6 +22,9 @@ Define rstd_Debug to 0 to turn off assertions and to make release only code be c
 // TODO: Get rid of these headers
 #include <algorithm>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
 #include <cmath>
 
 #ifndef rstd_Debug
@@ -32,11 +35,15 @@ Define rstd_Debug to 0 to turn off assertions and to make release only code be c
 #define rstd_MemoryProfileFunction
 #endif
 
-// TODO: Make memory profiler not suck
 #ifndef rstd_MemoryProfilerEnabled
 #define rstd_MemoryProfilerEnabled 0
 #endif
 
+// NOTE: Average number of bytes between sampled allocations, 0 records every allocation
+#ifndef rstd_MemoryProfilerSamplingInterval
+#define rstd_MemoryProfilerSamplingInterval 0
+#endif
+
 #ifndef rstd_FileDebugEnabled
 #define rstd_FileDebugEnabled 0
 #endif
@@ -45,12 +52,44 @@ Define rstd_Debug to 0 to turn off assertions and to make release only code be c
 #define rstd_MultiThreadingEnabled 1
 #endif
 
+#ifndef rstd_ScratchArenaCount
+#define rstd_ScratchArenaCount 2
+#endif
+
+#ifndef rstd_ScratchArenaReserveSize
+#define rstd_ScratchArenaReserveSize ((rstd::size)1024*1024*1024)
+#endif
+
 #ifndef rstd_bool
 #define rstd_bool bool
 #endif
 
+// NOTE: Alignment of pushes that don't specify one, 1 packs strings and bytes tightly,
+//       structs pushed with PushStruct() or the *Aligned macros get alignof(type) either way
+#ifndef rstd_ArenaDefaultAlignment
+#define rstd_ArenaDefaultAlignment 1
+#endif
+
+// NOTE: Zero() switches to non-temporal stores from this size up, 0 turns them off
+#ifndef rstd_NonTemporalZeroThreshold
+#define rstd_NonTemporalZeroThreshold ((rstd::size)16*1024*1024)
+#endif
+
+// NOTE: Smaller reverted ranges of ArenaFlag_ZeroInBackground arenas aren't worth a job and are zeroed on push
+#ifndef rstd_BackgroundZeroingMinBytes
+#define rstd_BackgroundZeroingMinBytes ((rstd::size)256*1024)
+#endif
+
 #ifdef _WIN32
 #include "intrin.h"
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define rstd_SSE2 1
+#else
+#define rstd_SSE2 0
 #endif
 
 namespace rstd
@@ -77,6 +116,8 @@ namespace rstd
     using f32 = float;
     using f64 = double;
     
+    using umm = uintptr_t;
+    
     ///////////////
     // constants //
     ///////////////
@@ -87,7 +128,7 @@ namespace rstd
     static constexpr uint8_t MaxU8 = 255;
     static constexpr uint16_t MaxU16 = 65535;
     static constexpr uint32_t MaxU32 = 4294967295;
-    static constexpr uint64_t MaxU64 = 18446744073709551615;
+    static constexpr uint64_t MaxU64 = 18446744073709551615ULL;
     
     static constexpr int8_t MaxI8 = 127;
     static constexpr int8_t MinI8 = -MaxI8 - 1;
@@ -267,23 +308,27 @@ namespace rstd
     ////////////
     static rstd_bool AdvanceIfStringsMatchUntilRightStringTerminates(char** APtr, const char* B);
     
-    // TODO: Try to change it into template function
+    // NOTE: These are defined after Format<string>(), debug macros below expand to them
+    //       so that templates using assertions don't need string to be complete
+    template<class... args> static void InternalFormatAndPrintInDebugger(const char* Fmt, args... Args);
+    template<class... args> static void InternalFormatWarningMessageBox(const char* Fmt, args... Args);
+    template<class... args> static void InternalFormatErrorMessageBoxAndExitProcess(const char* Fmt, args... Args);
+    template<class... args> static void InternalAssertionFailedMessageBox(const char* File, u32 Line, const char* Message, args... Args);
+    
 #define rstd_PrintInDebugger(_Fmt, ...) \
-InternalPrintInDebugger(Format<string<>>(_Fmt, __VA_ARGS__));
+InternalFormatAndPrintInDebugger(_Fmt, ##__VA_ARGS__);
     
     //////////////////
     // DEBUG MACROS //
     //////////////////
-    // TODO: Try to change it into template function
 #define rstd_RInvalidCodePath(_String, ...) \
-{ ShowErrorMessageBoxAndExitProcess(Format<string<>>(_String, __VA_ARGS__).GetCString()); }
+{ rstd::InternalFormatErrorMessageBoxAndExitProcess(_String, ##__VA_ARGS__); }
     
-    // TODO: Try to change it into template function
 #define rstd_WarningMessageBox(_String, ...) \
-{ InternalWarningMessageBox(Format<string<1020>>(_String, __VA_ARGS__).GetCString()); }
+{ rstd::InternalFormatWarningMessageBox(_String, ##__VA_ARGS__); }
     
 #define rstd_RAssert(Expression, String, ...) \
-if(!(Expression)){rstd_RInvalidCodePath(String, __VA_ARGS__)}
+if(!(Expression)){rstd_RInvalidCodePath(String, ##__VA_ARGS__)}
     
 #define rstd_Concat2(_A, _B) _A ## _B
 #define rstd_Concat(_A, _B) rstd_Concat2(_A, _B)
@@ -293,14 +338,20 @@ if(!(Expression)){rstd_RInvalidCodePath(String, __VA_ARGS__)}
     
 #define rstd_DebugOnly(Code) Code
 #define rstd_ReleaseOnly(Code)
+#ifdef _MSC_VER
 #define rstd_BreakInDebugger __debugbreak()
+#elif defined(__clang__)
+#define rstd_BreakInDebugger __builtin_debugtrap()
+#else
+#define rstd_BreakInDebugger __builtin_trap()
+#endif
     
 #define rstd_InvalidCodePath {\
 rstd_WarningMessageBox("InvalidCodePath! file:% line:%", __FILE__, __LINE__); \
 rstd_BreakInDebugger;}
     
 #define rstd_InvalidCodePathM(Message, ...) {\
-rstd_WarningMessageBox("InvalidCodePath! \n%\n file:% line:%", Message, __VA_ARGS__, __FILE__, __LINE__); \
+rstd_WarningMessageBox("InvalidCodePath! \n%\n file:% line:%", Message, ##__VA_ARGS__, __FILE__, __LINE__); \
 rstd_BreakInDebugger;}
     
 #define rstd_RawAssert(_Expr) if(!(_Expr)){\
@@ -314,8 +365,7 @@ rstd_BreakInDebugger;}
 #define rstd_AssertM(Expr, Message, ...) \
 if(!(Expr))\
 {\
-rstd_WarningMessageBox("Assertion failed! \n%\n file:% line:%",\
-Format<string<1020>>(Message, __VA_ARGS__), __FILE__, __LINE__);\
+rstd::InternalAssertionFailedMessageBox(__FILE__, __LINE__, Message, ##__VA_ARGS__);\
 rstd_BreakInDebugger;\
 }
     
@@ -325,11 +375,20 @@ rstd_BreakInDebugger;\
     
 #define rstd_DebugOnly(Code)
 #define rstd_ReleaseOnly(Code) Code
+#define rstd_BreakInDebugger
+#define rstd_RawAssert(Expr)
 #define rstd_Assert(Expr) 
-#define rstd_AssertM(Expr, Message) 
+#define rstd_AssertM(Expr, Message, ...) 
 #define rstd_InvalidCodePath
+#define rstd_InvalidCodePathM(Message, ...)
 #define rstd_InvalidDefaultCase
     
+#endif
+    
+#if rstd_MemoryProfilerEnabled
+#define rstd_MemoryProfilerOnly(Code) Code
+#else
+#define rstd_MemoryProfilerOnly(Code)
 #endif
     
     template<class code> struct _defer 
@@ -445,6 +504,7 @@ rstd_BreakInDebugger;\
     
     time GetUtcTime();
     time GetLocalTime();
+    u64 GetSystemTimeAsUnixEpoch(); // 100 nanosecond intervals
     
     ////////////
     // RANDOM //
@@ -661,14 +721,14 @@ view<iterator> GetView() \
         character& operator[]
  (size Index)
         {
-            rstd_AssertM(Index < Count, Format<string<>>("You tried to get character [%], but this string has only % characters", Index, Count).GetCString());
+            rstd_AssertM(Index < Count, "You tried to get character [%], but this string has only % characters", Index, Count);
             return Characters[Index];
         }
         
         character operator[]
  (size Index) const
         {
-            rstd_AssertM(Index < Count, Format<string<>>("You tried to get character [%], but this string has only % characters", Index, Count).GetCString());
+            rstd_AssertM(Index < Count, "You tried to get character [%], but this string has only % characters", Index, Count);
             return Characters[Index];
         }
         
@@ -978,7 +1038,7 @@ view<iterator> GetView() \
     static auto ToString(const char* C)
     { return C; }
     
-    template<u32 Size> static auto ToString(string<Size>& String)
+    template<size Size> static auto ToString(string<Size>& String)
     { return String; }
     
     static char* GetNullTerminator
@@ -1402,6 +1462,33 @@ view<iterator> GetView() \
         return Hash;
     }
     
+    static u64 HashString
+ (const char* String, size Count)
+    {
+        // NOTE: Murmur string hash, one byte at a time version
+        
+        u64 Hash = 525201411107845655;
+        for(size CharIndex = 0; CharIndex < Count; ++CharIndex)
+        {
+            Hash ^= String[CharIndex];
+            Hash *= 0x5bd1e9955bd1e995;
+            Hash ^= Hash >> 47;
+        }
+        return Hash;
+    }
+    
+    // NOTE: Murmur3 finalizer, all bits of Value affect both low and high bits of hash
+    static u64 HashU64
+ (u64 Value)
+    {
+        Value ^= Value >> 33;
+        Value *= 0xff51afd7ed558ccd;
+        Value ^= Value >> 33;
+        Value *= 0xc4ceb9fe1a85ec53;
+        Value ^= Value >> 33;
+        return Value;
+    }
+    
 #ifdef rstd_FastMathStringFunctions
 #include "rstd_fast_math_string_functions.h"
 #endif
@@ -1475,37 +1562,56 @@ view<iterator> GetView() \
         return Res;
     }
     
+    template<class... args> static void InternalFormatAndPrintInDebugger
+ (const char* Fmt, args... Args)
+    { InternalPrintInDebugger(Format<string<>>(Fmt, Args...).GetCString()); }
+    
+    template<class... args> static void InternalFormatWarningMessageBox
+ (const char* Fmt, args... Args)
+    { InternalWarningMessageBox(Format<string<1020>>(Fmt, Args...).GetCString()); }
+    
+    template<class... args> static void InternalFormatErrorMessageBoxAndExitProcess
+ (const char* Fmt, args... Args)
+    { ShowErrorMessageBoxAndExitProcess(Format<string<>>(Fmt, Args...).GetCString()); }
+    
+    template<class... args> static void InternalAssertionFailedMessageBox
+ (const char* File, u32 Line, const char* Message, args... Args)
+    {
+        auto FormattedMessage = Format<string<1020>>(Message, Args...);
+        InternalFormatWarningMessageBox("Assertion failed! \n%\n file:% line:%", FormattedMessage, File, Line);
+    }
+    
     template<class type> const char* TypeName()
     { return " YOU DIDN'T SPECIFY TypeName() "; }
     
-    template<> const char* TypeName<u64>()
+    template<> inline const char* TypeName<u64>()
     { return "u64"; }
     
-    template<> const char* TypeName<u32>()
+    template<> inline const char* TypeName<u32>()
     { return "u32"; }
     
-    template<> const char* TypeName<u16>()
+    template<> inline const char* TypeName<u16>()
     { return "u16"; }
     
-    template<> const char* TypeName<u8>()
+    template<> inline const char* TypeName<u8>()
     { return "u8"; }
     
-    template<> const char* TypeName<i64>()
+    template<> inline const char* TypeName<i64>()
     { return "i64"; }
     
-    template<> const char* TypeName<i32>()
+    template<> inline const char* TypeName<i32>()
     { return "i32"; }
     
-    template<> const char* TypeName<i16>()
+    template<> inline const char* TypeName<i16>()
     { return "i16"; }
     
-    template<> const char* TypeName<i8>()
+    template<> inline const char* TypeName<i8>()
     { return "i8"; }
     
-    template<> const char* TypeName<f32>()
+    template<> inline const char* TypeName<f32>()
     { return "f32"; }
     
-    template<> const char* TypeName<f64>()
+    template<> inline const char* TypeName<f64>()
     { return "f64"; }
     
     // TODO: Add iterators, Add more helper functions
@@ -1586,7 +1692,7 @@ view<iterator> GetView() \
     //////////
     // TIME //
     //////////
-    rstd_bool operator==
+    static rstd_bool operator==
  (time A, time B)
     {
         if(A.Year == B.Year && A.Month == B.Month && A.Day == B.Day)
@@ -1597,7 +1703,7 @@ view<iterator> GetView() \
         return false;
     }
     
-    rstd_bool operator<=
+    static rstd_bool operator<=
  (time A, time B)
     {
         if(A.DayMonthYearPack < B.DayMonthYearPack)
@@ -1608,7 +1714,7 @@ view<iterator> GetView() \
             return A.MillisecondSecondMinuteHourPack <= B.MillisecondSecondMinuteHourPack;
     }
     
-    rstd_bool operator>=
+    static rstd_bool operator>=
  (time A, time B)
     {
         if(A.DayMonthYearPack > B.DayMonthYearPack)
@@ -1619,10 +1725,10 @@ view<iterator> GetView() \
             return A.MillisecondSecondMinuteHourPack >= B.MillisecondSecondMinuteHourPack;
     }
     
-    rstd_bool operator<(time A, time B)
+    static rstd_bool operator<(time A, time B)
     { return !(A >= B); }
     
-    rstd_bool operator>(time A, time B)
+    static rstd_bool operator>(time A, time B)
     { return !(A <= B); }
     
     // TODO: Those functions can be implemented better with having static array of month strings.
@@ -1748,6 +1854,8 @@ view<iterator> GetView() \
     
     using allocator_name = string<16>;
     
+    struct background_zeroing_job;
+    
     struct memory_block
     {
         memory_block* Prev;
@@ -1755,20 +1863,51 @@ view<iterator> GetView() \
         size Used;
         size MaxHistoricalUsed;
         size Size;
+        size Committed; // less than Size only in blocks created with ReserveArena()
+        memory_block* Opposite; // other end of double_ended_arena, both ends share [Base, Base + Size)
+        background_zeroing_job* BackgroundZeroing; // zeroes [Used, MaxHistoricalUsed) on thread pool
+        rstd_bool HugePages; // such blocks are never decommitted nor cached
+        rstd_bool GrowsDown; // Used is counted from Base + Size towards Base
+    };
+    
+    enum arena_flag : u32
+    {
+        ArenaFlag_DecommitOnRevert = 1 << 0, // RevertArena(), EndTemporaryMemory() and Clear() give committed pages back to OS
+        ArenaFlag_SubArena = 1 << 1, // set by SubArena(), first memory block belongs to master arena
+        ArenaFlag_HugePages = 1 << 2, // blocks are backed by huge pages if OS can give them, block sizes are rounded up by AlignToHugePages()
+        ArenaFlag_GrowsDown = 1 << 3, // pushes go from the end of memory block towards its beginning
+        ArenaFlag_ZeroInBackground = 1 << 4, // reverted bytes are zeroed by thread pool passed to SetBackgroundZeroingPool()
+        ArenaFlag_ZeroByPageReset = 1 << 5, // PushSizeZero() resets big garbage ranges with ZeroPages() instead of writing them
+    };
+    
+    enum class arena_growth_policy : u8
+    {
+        Fixed, // every new block is MinimalAllocationSize big (or bigger if push doesn't fit)
+        Geometric, // every new block is twice as big as the previous one, up to MaxAllocationSize
+        FitNextPush, // new block is just big enough for the push that didn't fit
     };
     
     struct arena
     {
         memory_block* MemoryBlock;
         size MinimalAllocationSize;
+        size MaxAllocationSize; // cap for arena_growth_policy::Geometric
+        arena_growth_policy GrowthPolicy;
         u32 TempMemCount;
+        u32 Flags;
+        u32 DefaultAlignment; // used by pushes that don't specify alignment, rstd_ArenaDefaultAlignment by default
+        u32 PurgeDecayMilliseconds; // 0 means pages are purged only by PurgeArena()
+        size DecayPeakUsed;
+        u64 DecayWindowBegin;
         rstd_DebugOnly(const char* DebugName;)
+        rstd_MemoryProfilerOnly(u32 DebugId;) // set by MemoryDebug::RegisterCreateArena(), 0 means not registered
     };
     
     struct push_size_uninitialized_ex_res
     {
         u8* Memory;
         size GarbageBytes;
+        size AlignmentPadding;
         rstd_DebugOnly(rstd_bool NewMemoryBlockWasAllocated;)
     };
     
@@ -1781,10 +1920,13 @@ view<iterator> GetView() \
     };
     
 #define rstd_AllocateArenaZero(_Size, ...) \
-InternalAllocateArenaZero(_Size, rstd_GetCallingInfo(), __VA_ARGS__)
+InternalAllocateArenaZero(_Size, rstd_GetCallingInfo(), ##__VA_ARGS__)
+    
+#define rstd_ReserveArena(_ReserveSize, ...) \
+InternalReserveArena(_ReserveSize, rstd_GetCallingInfo(), ##__VA_ARGS__)
     
 #define rstd_SubArena(_MasterArena, _Size, ...) \
-InternalSubArena(_MasterArena, _Size, rstd_GetCallingInfo(), __VA_ARGS__)
+InternalSubArena(_MasterArena, _Size, rstd_GetCallingInfo(), ##__VA_ARGS__)
     
 #define rstd_PushSizeUninitialized(_Arena, _Size) \
 InternalPushSizeUninitialized(_Arena, _Size, rstd_GetCallingInfo())
@@ -1804,9 +1946,34 @@ InternalPushSizeZero(_Arena, _Size, rstd_GetCallingInfo())
 #define rstd_PushArrayZero(_Arena, _Type, _ArrayCount) \
 (_Type*)(rstd_PushSizeZero(_Arena, sizeof(_Type) * _ArrayCount))
     
+#define rstd_PushSizeUninitializedAligned(_Arena, _Size, _Alignment) \
+InternalPushSizeUninitializedAligned(_Arena, _Size, _Alignment, rstd_GetCallingInfo())
+    
+#define rstd_PushSizeZeroAligned(_Arena, _Size, _Alignment) \
+InternalPushSizeZeroAligned(_Arena, _Size, _Alignment, rstd_GetCallingInfo())
+    
+#define rstd_PushStructUninitializedAligned(_Arena, _Type) \
+(*(_Type*)(rstd_PushSizeUninitializedAligned(_Arena, sizeof(_Type), alignof(_Type))))
+    
+#define rstd_PushStructZeroAligned(_Arena, _Type) \
+(*(_Type*)(rstd_PushSizeZeroAligned(_Arena, sizeof(_Type), alignof(_Type))))
+    
+#define rstd_PushArrayUninitializedAligned(_Arena, _Type, _ArrayCount) \
+(_Type*)(rstd_PushSizeUninitializedAligned(_Arena, sizeof(_Type) * _ArrayCount, alignof(_Type)))
+    
+#define rstd_PushArrayZeroAligned(_Arena, _Type, _ArrayCount) \
+(_Type*)(rstd_PushSizeZeroAligned(_Arena, sizeof(_Type) * _ArrayCount, alignof(_Type)))
+    
 #define rstd_PushStringCopy(_Arena, _InitString) \
 InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
     
+#define rstd_ResizeLastPushUninitialized(_Arena, _Memory, _OldSize, _NewSize) \
+InternalResizeLastPush(_Arena, _Memory, _OldSize, _NewSize, false, rstd_GetCallingInfo())
+    
+#define rstd_ResizeLastPushZero(_Arena, _Memory, _OldSize, _NewSize) \
+InternalResizeLastPush(_Arena, _Memory, _OldSize, _NewSize, true, rstd_GetCallingInfo())
+    
+    struct concurrent_arena;
     
     namespace MemoryDebug
     {
@@ -1819,29 +1986,154 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
             GenAlloc,
         };
         
+        // NOTE: Trace file is trace_file_header followed by records. Record is trace_record_type byte followed by
+        //       fields below, all of them LEB128 varints. Strings are sent once in String record and then referenced
+        //       by id, id 0 is nullptr. Sizes of sampled allocations are already scaled up
+        constexpr u32 TraceFileMagic = 0x746d7372; // "rsmt"
+        constexpr u32 TraceFileVersion = 2;
+        
+        struct trace_file_header
+        {
+            u32 Magic;
+            u32 Version;
+            u64 SamplingInterval;
+            u64 StartTime; // GetSystemTimeAsUnixEpoch()
+        };
+        
+        enum class trace_record_type : u8
+        {
+            String, // Id, Length, Length bytes
+            Time, // 100 ns ticks since StartTime, events that follow happened before it
+            CreateArena, // ArenaId, NameId, MasterNameId, MemoryGroupId, FileId, FunctionId, Line, Size, GrowthPolicy
+            ArenaPush, // ArenaId, MemoryGroupId, FileId, FunctionId, Line, Count, Size, AlignmentPadding
+            AllocateNextMemoryBlock, // ArenaId, Size, UnusedBytesOfPrevBlock, GrowthPolicy
+            DeallocateMemoryBlock, // ArenaId, Size, UnusedBytesOfPrevBlock
+            BeginTemporaryMemory, // ArenaId
+            EndTemporaryMemory, // ArenaId
+            GenAlloc, // Address, MemoryGroupId, FileId, FunctionId, Line, Size
+            GenFree, // Address
+            ClearArena, // ArenaId
+            ShrinkLastPush, // ArenaId, MemoryGroupId, FileId, FunctionId, Line, Size (bytes given back)
+        };
+        
         static void DummyScopeMemoryGroup(){}
         
 #if rstd_MemoryProfilerEnabled
+#define rstd_MemoryProfilerLinkage
 #define rstd_MemoryProfilerFunctionSignature
 #else
+#define rstd_MemoryProfilerLinkage static
 #define rstd_MemoryProfilerFunctionSignature {}
-#define ScopeMemoryGroup(Name) DummyScopeMemoryGroup()
+#define ScopeMemoryGroup(Name) rstd::MemoryDebug::DummyScopeMemoryGroup()
 #endif
         
-        static void Init() rstd_MemoryProfilerFunctionSignature;
-        static void BeginMemoryGroup(const char*) rstd_MemoryProfilerFunctionSignature;
-        static void EndMemoryGroup() rstd_MemoryProfilerFunctionSignature;
-        static void NextCallMemoryGroup(const char*) rstd_MemoryProfilerFunctionSignature;
-        static void RegisterArenaPush(arena, push_size_uninitialized_ex_res, size Size, allocation_type, calling_info) rstd_MemoryProfilerFunctionSignature;
-        static void RegisterGenAlloc(void* Memory, size Size, calling_info) rstd_MemoryProfilerFunctionSignature;
-        static void RegisterGenFree(void* Memory, calling_info) rstd_MemoryProfilerFunctionSignature;
-        static void RegisterCreateArena(arena&, const char* ArenaName, const char* MasterArenaName, calling_info) rstd_MemoryProfilerFunctionSignature;
-        static void RegisterDeallocateArena(arena, calling_info) rstd_MemoryProfilerFunctionSignature;
-        static void RegisterArenaAllocateNextMemoryBlock(arena) rstd_MemoryProfilerFunctionSignature;
-        static void RegisterArenaDeallocateMemoryBlock(arena) rstd_MemoryProfilerFunctionSignature;
-        static void RegisterBeginTemporaryMemory(temporary_memory TempMem) rstd_MemoryProfilerFunctionSignature;
-        static void RegisterEndTemporaryMemory(temporary_memory TempMem) rstd_MemoryProfilerFunctionSignature;
+        // NOTE: Register functions only append an event to per-thread buffer. Full buffers are merged
+        //       into shared state by whichever thread gets the profiler lock first, queries merge everything first.
+        // NOTE: With SamplingInterval != 0 only pushes and gen allocations picked by Poisson process over allocated bytes
+        //       are recorded (about one per SamplingInterval bytes) and their sizes are scaled up by 1 / sampling probability.
+        //       Used, UsedPeak, Unused and AlignmentPadding then become estimates, memory block statistics stay exact
+        rstd_MemoryProfilerLinkage void Init(size SamplingInterval = rstd_MemoryProfilerSamplingInterval) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void BeginMemoryGroup(const char*) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void EndMemoryGroup() rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void NextCallMemoryGroup(const char*) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void RegisterArenaPush(arena&, const push_size_uninitialized_ex_res&, size Size, allocation_type, calling_info) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void RegisterArenaShrinkLastPush(arena&, size Size, calling_info) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void RegisterGenAlloc(void* Memory, size Size, calling_info) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void RegisterGenFree(void* Memory, calling_info) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void RegisterCreateArena(arena&, const char* ArenaName, const char* MasterArenaName, calling_info) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void RegisterDeallocateArena(arena&, calling_info) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void RegisterClearArena(arena&) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void RegisterArenaAllocateNextMemoryBlock(arena&) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void RegisterArenaDeallocateMemoryBlock(arena&) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void RegisterCreateArena(concurrent_arena&, const char* ArenaName, calling_info) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void RegisterArenaPush(concurrent_arena&, const push_size_uninitialized_ex_res&, size Size, calling_info) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void RegisterClearArena(concurrent_arena&) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void RegisterArenaAllocateNextMemoryBlock(concurrent_arena&, memory_block& NewMemBlock) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void RegisterArenaDeallocateMemoryBlock(concurrent_arena&, memory_block& MemBlock) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void RegisterBeginTemporaryMemory(temporary_memory TempMem) rstd_MemoryProfilerFunctionSignature;
+        rstd_MemoryProfilerLinkage void RegisterEndTemporaryMemory(temporary_memory TempMem) rstd_MemoryProfilerFunctionSignature;
+        
+#if rstd_MemoryProfilerEnabled
+        struct statistics
+        {
+            size
+                Used, UsedPeak,
+            Size, SizePeak,
+            Wasted, Unused,
+            AlignmentPadding;
+        };
+        
+        struct arena_debug_data
+        {
+            const char* Name;
+            const char* MasterArenaName;
+            const char* MemoryGroupName;
+            statistics Stats;
+            calling_info CreationCallingInfo;
+            u32 MemoryBlockCount;
+            u32 TemporaryMemoryDepth;
+            arena_growth_policy GrowthPolicy;
+            rstd_bool HasNamelessName;
+            rstd_bool Deallocated;
+        };
+        
+        void Flush(); // merges events of all threads, including buffers they are still filling
+        statistics GetStatistics();
+        rstd_bool GetMemoryGroupStatistics(const char* MemoryGroupName, statistics* Dest);
+        rstd_bool GetArenaDebugData(arena& Arena, arena_debug_data* Dest);
+        rstd_bool GetArenaDebugData(concurrent_arena& Arena, arena_debug_data* Dest);
+        u32 GetUnmatchedGenFreeCount(); // frees of memory that wasn't allocated (or whose allocation is still in unmerged buffer)
+        size GetSamplingInterval();
+        u64 GetSampleCount(); // number of recorded sampled allocations
+        
+        // NOTE: Aggregated pushes and gen allocations of one rstd_GetCallingInfo() place.
+        //       Pushes stay live until their arena is cleared or deallocated, pushes inside temporary memory are never live.
+        //       With sampling on Count and byte counts are estimates
+        struct allocation_site
+        {
+            calling_info CallingInfo;
+            u64 Count;
+            size Bytes;
+            size LiveBytes;
+            size PeakLiveBytes;
+        };
+        
+        enum class allocation_site_order
+        {
+            Bytes,
+            Count,
+            LiveBytes,
+            PeakLiveBytes,
+        };
+        
+        enum class allocation_site_dump_format
+        {
+            Text,
+            Csv,
+        };
+        
+        // NOTE: Streams every merged event into binary file (format is above trace_file_header).
+        //       Trace is written each time events are merged, so after a crash only unmerged events are missing.
+        //       Arenas created before BeginTrace() show up in trace only through their later events
+        rstd_bool BeginTrace(const char* FilePath);
+        void EndTrace();
         
+        u32 GetAllocationSiteCount();
+        u32 GetTopAllocationSites(allocation_site* Dest, u32 MaxSiteCount, allocation_site_order = allocation_site_order::Bytes); // returns number of written sites
+        rstd_bool DumpAllocationSites(const char* FilePath, allocation_site_dump_format, u32 MaxSiteCount = MaxU32,
+                                      allocation_site_order = allocation_site_order::Bytes);
+        
+        struct scope_memory_group
+        {
+            scope_memory_group(const char* Name)
+            { BeginMemoryGroup(Name); }
+            
+            ~scope_memory_group()
+            { EndMemoryGroup(); }
+        };
+        
+#define ScopeMemoryGroup(_Name) rstd::MemoryDebug::scope_memory_group ScopeMemGroup##__LINE__(_Name)
+#endif
     }
     
     template<class type> static type BytesToKilobytes
@@ -1874,18 +2166,120 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
         
         constexpr size operator"" _MB(unsigned long long Megabytes)
         { return (size)Megabytes * 1024 * 1024; }
+        
+        constexpr size operator"" _GB(unsigned long long Gigabytes)
+        { return (size)Gigabytes * 1024 * 1024 * 1024; }
     }
     
     constexpr size MemoryPageSize = 4*1024; // 4_KB
+    constexpr size HugePageSize = 2*1024*1024; // 2_MB
+    constexpr size GiganticPageSize = 1024*1024*1024; // 1_GB, Linux only, needs reserved pages
     
     static size Align(size Size, size Alignment)
     { return (Size + Alignment - 1) & ~(Alignment - 1); }
     
+    // NOTE: Allocations of at least GiganticPageSize are rounded to it so HugePageAlloc() can try gigantic pages for them
+    static size AlignToHugePages(size Bytes)
+    { return Align(Bytes, Bytes >= GiganticPageSize ? GiganticPageSize : HugePageSize); }
+    
+    static rstd_bool IsPowerOfTwo(size Value)
+    { return Value && !(Value & (Value - 1)); }
+    
+    // NOTE: Value must not be 0
+    static u32 CountTrailingZeros
+ (u32 Value)
+    {
+#ifdef _WIN32
+        unsigned long Index;
+        _BitScanForward(&Index, Value);
+        return (u32)Index;
+#else
+        return (u32)__builtin_ctz(Value);
+#endif
+    }
+    
+    // NOTE: Value must not be 0
+    static u32 CountTrailingZeros
+ (u64 Value)
+    {
+#ifdef _WIN32
+        unsigned long Index;
+        _BitScanForward64(&Index, Value);
+        return (u32)Index;
+#else
+        return (u32)__builtin_ctzll(Value);
+#endif
+    }
+    
+    // NOTE: Value must not be 0
+    static u32 CountLeadingZeros
+ (u32 Value)
+    {
+#ifdef _WIN32
+        unsigned long Index;
+        _BitScanReverse(&Index, Value);
+        return 31 - (u32)Index;
+#else
+        return (u32)__builtin_clz(Value);
+#endif
+    }
+    
+    static u32 CountSetBits
+ (u64 Value)
+    {
+#ifdef _WIN32
+        return (u32)__popcnt64(Value);
+#else
+        return (u32)__builtin_popcountll(Value);
+#endif
+    }
+    
+    static size GetAlignmentPadding(void* Ptr, size Alignment)
+    { return (size)(0 - (umm)Ptr) & (Alignment - 1); }
+    
     constexpr size ConstAlign(size Size, size Alignment)
     { return (Size + Alignment - 1) & ~(Alignment - 1); }
     
-    static void Zero(void* Ptr, size Size)
-    { memset(Ptr, 0, Size); }
+    // NOTE: Streaming stores bypass the cache, so zeroing big ranges doesn't evict the working set
+    //       and doesn't read lines it is going to overwrite. Cold ranges get zeroed about twice as fast,
+    //       ranges still in cache slower (dirty lines are written back first), so default threshold
+    //       is about the size of last level cache.
+    static void ZeroNonTemporal
+ (void* Ptr, size Size)
+    {
+#if rstd_SSE2
+        u8* Byte = (u8*)Ptr;
+        size HeadBytes = GetAlignmentPadding(Byte, 64);
+        if(HeadBytes > Size)
+            HeadBytes = Size;
+        memset(Byte, 0, HeadBytes);
+        Byte += HeadBytes;
+        Size -= HeadBytes;
+        
+        __m128i Zeros = _mm_setzero_si128();
+        u8* LinesEnd = Byte + (Size & ~(size)63);
+        for(; Byte < LinesEnd; Byte += 64)
+        {
+            _mm_stream_si128((__m128i*)Byte, Zeros);
+            _mm_stream_si128((__m128i*)(Byte + 16), Zeros);
+            _mm_stream_si128((__m128i*)(Byte + 32), Zeros);
+            _mm_stream_si128((__m128i*)(Byte + 48), Zeros);
+        }
+        memset(Byte, 0, Size & 63);
+        _mm_sfence();
+#else
+        memset(Ptr, 0, Size);
+#endif
+    }
+    
+    static void Zero
+ (void* Ptr, size Size)
+    {
+        if(rstd_NonTemporalZeroThreshold != 0 && Size >= rstd_NonTemporalZeroThreshold)
+            ZeroNonTemporal(Ptr, Size);
+        else
+            memset(Ptr, 0, Size);
+    }
     
     template<class type> static void ZeroStruct(type& Instance)
     { Zero(&Instance, sizeof(type)); }
@@ -1941,11 +2335,18 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
     static string<> GetChoppedSizeText(u32 Size)
     { return GetChoppedSizeText((u64)Size); }
     
+    // NOTE: Size-class allocator. Allocations up to GenMaxSmallSize come from 64 KB spans owned by per-thread heaps,
+    // bigger ones go straight to the OS. Everything is 16 byte aligned.
+    void* GenAllocatorAlloc(size Size);
+    void GenAllocatorFree(void* Memory);
+    void* GenAllocatorRealloc(void* Memory, size NewSize);
+    size GetGenAllocationSize(void* Memory); // can be bigger than requested size
+    
     static void* InternalGenAlloc
- (u32 Size, calling_info CallingInfo)
+ (size Size, calling_info CallingInfo)
     {
         rstd_MemoryProfileFunction;
-        void* Memory = malloc(Size);
+        void* Memory = GenAllocatorAlloc(Size);
         MemoryDebug::RegisterGenAlloc(Memory, Size, CallingInfo);
         return Memory;
     }
@@ -1956,56 +2357,320 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
         rstd_MemoryProfileFunction;
         rstd_Assert(Memory);
         MemoryDebug::RegisterGenFree(Memory, CallingInfo);
-        free(Memory);
+        GenAllocatorFree(Memory);
+    }
+    
+    static void* InternalGenRealloc
+ (void* Memory, size NewSize, calling_info CallingInfo)
+    {
+        rstd_MemoryProfileFunction;
+        if(Memory)
+            MemoryDebug::RegisterGenFree(Memory, CallingInfo);
+        void* NewMemory = GenAllocatorRealloc(Memory, NewSize);
+        MemoryDebug::RegisterGenAlloc(NewMemory, NewSize, CallingInfo);
+        return NewMemory;
     }
     
 #define GenAllocSize(_Size) InternalGenAlloc(_Size, rstd_GetCallingInfo())
 #define GenAllocStruct(_Type) (_Type*)GenAllocSize(sizeof(_Type))
 #define GenAllocArray(_Type, _Count) (_Type*)GenAllocSize(sizeof(_Type) * _Count)
+#define GenRealloc(_Memory, _NewSize) InternalGenRealloc(_Memory, _NewSize, rstd_GetCallingInfo())
 #define GenFree(_Memory) InternalGenFree(_Memory, rstd_GetCallingInfo())
     
     void* PageAlloc(size Bytes);
-    void PageFree(void* Memory);
+    void* HugePageAlloc(size Bytes); // Bytes has to be multiple of HugePageSize, multiples of GiganticPageSize try those first, falls back to normal pages
+    void PageFree(void* Memory, size Bytes);
+    void* PageReserve(size Bytes);
+    rstd_bool PageCommit(void* Memory, size Bytes);
+    void PageDecommit(void* Memory, size Bytes);
+    rstd_bool PageReset(void* Memory, size Bytes); // pages stay usable and read as zero on next touch, false if OS refused (e.g. large pages)
+    
+    // NOTE: Whole pages in the range are given back to OS instead of written. That costs about as much as
+    //       writing them, but touching them again costs several times more (page faults), so it pays off only
+    //       for ranges that mostly stay untouched. It also drops them from resident set right away.
+    static void ZeroPages
+ (void* Ptr, size Size)
+    {
+        u8* Begin = (u8*)Ptr;
+        u8* PagesBegin = Begin + GetAlignmentPadding(Begin, MemoryPageSize);
+        u8* PagesEnd = (u8*)((umm)(Begin + Size) & ~(umm)(MemoryPageSize - 1));
+        if(PagesBegin >= PagesEnd || !PageReset(PagesBegin, PagesEnd - PagesBegin))
+        {
+            Zero(Ptr, Size);
+            return;
+        }
+        Zero(Begin, PagesBegin - Begin);
+        Zero(PagesEnd, Begin + Size - PagesEnd);
+    }
     
-    static push_size_uninitialized_ex_res PushSizeUninitializedEx
- (arena& Arena, size Size)
+    static void FreeMemoryBlock(memory_block* MemBlock)
+    { PageFree(MemBlock->Base, MemBlock->Size + sizeof(memory_block)); }
+    
+    //////////////////////////
+    // MEMORY BLOCK CACHING //
+    //////////////////////////
+    // NOTE: Blocks freed by Clear(), EndTemporaryMemory() and RevertArena() go to per-thread cache,
+    //       then to process-wide cache and only then back to OS. PushSizeUninitializedEx() takes them from there
+    //       instead of calling PageAlloc(). Only blocks up to twice the requested size are reused.
+    //       Set both limits to 0 to turn caching off.
+    struct memory_block_cache_limits
     {
-        rstd_MemoryProfileFunction;
+        size MaxThreadCacheBytes;
+        size MaxGlobalCacheBytes;
+    };
+    
+    struct memory_block_cache_stats
+    {
+        u32 ThreadCacheHits;
+        u32 GlobalCacheHits;
+        u32 Misses;
+        u32 CachedBlocks;
+        u32 BlocksReleasedToOs;
+    };
+    
+    void SetMemoryBlockCacheLimits(memory_block_cache_limits Limits);
+    memory_block_cache_limits GetMemoryBlockCacheLimits();
+    memory_block_cache_stats GetMemoryBlockCacheStats();
+    memory_block* PopCachedMemoryBlock(size AllocationSize);
+    rstd_bool CacheMemoryBlock(memory_block* MemBlock);
+    
+    static void ReleaseMemoryBlock
+ (memory_block* MemBlock)
+    {
+        if(!CacheMemoryBlock(MemBlock))
+            FreeMemoryBlock(MemBlock);
+    }
+    
+    static rstd_bool TryCommitMemoryBlock
+ (memory_block& MemBlock, size UsedAfterAllocation, size CommitGranularity)
+    {
+        if(UsedAfterAllocation > MemBlock.Size)
+            return false;
+        
+        auto Min = [](size A, size B){ return A < B ? A : B; };
+        size NewCommitted = Min(Align(UsedAfterAllocation, CommitGranularity), MemBlock.Size);
+        rstd_RAssert(PageCommit(MemBlock.Base + MemBlock.Committed, NewCommitted - MemBlock.Committed),
+                     "OS Commit call failed (probably your machine ran out of memory)");
+        MemBlock.Committed = NewCommitted;
+        return true;
+    }
+    
+    // NOTE: Ends of double_ended_arena share one block and Committed is the part that one end has claimed.
+    //       Claim grows into whatever the other end doesn't use right now.
+    static rstd_bool TryExtendMemoryBlock
+ (memory_block& MemBlock, size UsedAfterAllocation, size CommitGranularity)
+    {
+        if(!MemBlock.Opposite)
+            return TryCommitMemoryBlock(MemBlock, UsedAfterAllocation, CommitGranularity);
+        
+        auto& Opposite = *MemBlock.Opposite;
+        size Claimable = MemBlock.Size - Opposite.Used;
+        if(UsedAfterAllocation > Claimable)
+            return false;
+        
+        // bytes that the other end used and gave back are garbage for this end
+        if(Opposite.MaxHistoricalUsed > Opposite.Used)
+        {
+            if(Claimable > MemBlock.MaxHistoricalUsed)
+                MemBlock.MaxHistoricalUsed = Claimable;
+            Opposite.MaxHistoricalUsed = Opposite.Used;
+        }
+        Opposite.Committed = Opposite.Used;
+        MemBlock.Committed = Claimable;
+        return true;
+    }
+    
+    // NOTE: Decommitted pages come back zeroed, so MaxHistoricalUsed is lowered
+    //       and InternalPushSizeZero() doesn't have to zero them
+    static void DecommitMemoryBlock
+ (memory_block& MemBlock, size KeepCommitted)
+    {
+        size NewCommitted = Align(KeepCommitted, MemoryPageSize);
+        if(NewCommitted >= MemBlock.Committed)
+            return;
+        
+        // memory_block lives in the last page of reservation, that page stays committed
+        size HeaderPageBegin = MemBlock.Size & ~(MemoryPageSize - 1);
+        if(NewCommitted < HeaderPageBegin)
+        {
+            size DecommitEnd = MemBlock.Committed < HeaderPageBegin ? MemBlock.Committed : HeaderPageBegin;
+            PageDecommit(MemBlock.Base + NewCommitted, DecommitEnd - NewCommitted);
+        }
+        
+        size HeaderPageUsedEnd = MemBlock.MaxHistoricalUsed < MemBlock.Size ? MemBlock.MaxHistoricalUsed : MemBlock.Size;
+        size HeaderPageGarbageBegin = NewCommitted > HeaderPageBegin ? NewCommitted : HeaderPageBegin;
+        if(HeaderPageUsedEnd > HeaderPageGarbageBegin)
+            Zero(MemBlock.Base + HeaderPageGarbageBegin, HeaderPageUsedEnd - HeaderPageGarbageBegin);
+        
+        MemBlock.Committed = NewCommitted;
+        if(MemBlock.MaxHistoricalUsed > NewCommitted)
+            MemBlock.MaxHistoricalUsed = NewCommitted;
+    }
+    
+    static rstd_bool OwnsMemoryBlock
+ (arena& Arena, memory_block* MemBlock)
+    { return !(Arena.Flags & ArenaFlag_SubArena) || MemBlock->Prev; }
+    
+    static rstd_bool CanDecommitMemoryBlock
+ (arena& Arena, memory_block* MemBlock)
+    { return OwnsMemoryBlock(Arena, MemBlock) && !MemBlock->HugePages && !MemBlock->GrowsDown; }
+    
+    static void ResetPurgeDecayWindow
+ (arena& Arena)
+    {
+        Arena.DecayPeakUsed = Arena.MemoryBlock->Used;
+        Arena.DecayWindowBegin = GetSystemTimeAsUnixEpoch();
+    }
+    
+    // NOTE: ArenaFlag_ZeroInBackground arenas hand bytes freed by RevertArena(), EndTemporaryMemory() and Clear()
+    //       to a thread pool job. Whatever touches the block again first waits for the job, or cancels it
+    //       if it hasn't started yet, and then the bytes are zeroed on push as usual.
+    //       Only current block of an arena can have a job, every push waits for it before chaining a new block.
+    void StartBackgroundZeroing(memory_block& MemBlock);
+    void FinishBackgroundZeroing(memory_block& MemBlock);
+    
+    static void WaitForBackgroundZeroing
+ (memory_block& MemBlock)
+    {
+        if(MemBlock.BackgroundZeroing)
+            FinishBackgroundZeroing(MemBlock);
+    }
+    
+    // NOTE: Called after RevertArena(), EndTemporaryMemory() and Clear().
+    //       Decay purges pages of current block that weren't used during the whole last PurgeDecayMilliseconds
+    static void DecommitAfterRevert
+ (arena& Arena, size UsedBeforeRevert)
+    {
+        auto& MemBlock = *Arena.MemoryBlock;
+        if(CanDecommitMemoryBlock(Arena, &MemBlock))
+        {
+            if(Arena.Flags & ArenaFlag_DecommitOnRevert)
+            {
+                DecommitMemoryBlock(MemBlock, Align(MemBlock.Used, Arena.MinimalAllocationSize));
+            }
+            else if(Arena.PurgeDecayMilliseconds)
+            {
+                if(UsedBeforeRevert > Arena.DecayPeakUsed)
+                    Arena.DecayPeakUsed = UsedBeforeRevert;
+                
+                u64 Now = GetSystemTimeAsUnixEpoch();
+                if(Now - Arena.DecayWindowBegin >= (u64)Arena.PurgeDecayMilliseconds * 10000)
+                {
+                    DecommitMemoryBlock(MemBlock, Align(Arena.DecayPeakUsed, Arena.MinimalAllocationSize));
+                    Arena.DecayPeakUsed = MemBlock.Used;
+                    Arena.DecayWindowBegin = Now;
+                }
+            }
+        }
+        
+        if((Arena.Flags & ArenaFlag_ZeroInBackground) && !MemBlock.GrowsDown && !MemBlock.Opposite &&
+           MemBlock.MaxHistoricalUsed >= MemBlock.Used + rstd_BackgroundZeroingMinBytes)
+            StartBackgroundZeroing(MemBlock);
+    }
+    
+    // NOTE: Gives back to OS pages above Used + KeepBytes of current block and unused ends of older blocks.
+    //       Pages come back zeroed on next push, so no zeroing is needed later.
+    static void PurgeArena
+ (arena& Arena, size KeepBytes = 0)
+    {
+        WaitForBackgroundZeroing(*Arena.MemoryBlock);
+        for(auto* MemBlock = Arena.MemoryBlock; MemBlock; MemBlock = MemBlock->Prev)
+        {
+            if(CanDecommitMemoryBlock(Arena, MemBlock))
+            {
+                size KeepCommitted = MemBlock->Used + (MemBlock == Arena.MemoryBlock ? KeepBytes : 0);
+                DecommitMemoryBlock(*MemBlock, KeepCommitted);
+            }
+        }
+        
+        if(Arena.PurgeDecayMilliseconds)
+            ResetPurgeDecayWindow(Arena);
+    }
+    
+    static void SetPurgeDecay
+ (arena& Arena, u32 Milliseconds)
+    {
+        Arena.PurgeDecayMilliseconds = Milliseconds;
+        if(Milliseconds)
+            ResetPurgeDecayWindow(Arena);
+    }
+    
+    static size GetNextMemoryBlockAllocationSize
+ (arena& Arena, size RequiredAllocationSize)
+    {
+        size AllocationSize = Arena.MinimalAllocationSize;
+        switch(Arena.GrowthPolicy)
+        {
+            case arena_growth_policy::Fixed:
+                break;
+            
+            case arena_growth_policy::Geometric:
+            {
+                size DoubledAllocationSize = 2 * (Arena.MemoryBlock->Size + sizeof(memory_block));
+                if(DoubledAllocationSize > AllocationSize)
+                    AllocationSize = DoubledAllocationSize;
+                if(AllocationSize > Arena.MaxAllocationSize)
+                    AllocationSize = Arena.MaxAllocationSize;
+            } break;
+            
+            case arena_growth_policy::FitNextPush:
+                AllocationSize = 0;
+                break;
+        }
         
+        if(RequiredAllocationSize > AllocationSize)
+            AllocationSize = RequiredAllocationSize;
+        return (Arena.Flags & ArenaFlag_HugePages) ? AlignToHugePages(AllocationSize) : Align(AllocationSize, MemoryPageSize);
+    }
+    
+    // NOTE: Used of GrowsDown block is counted from the end of block, so MaxHistoricalUsed can't say
+    //       which bytes of a push are garbage. Push that overlaps it is reported as garbage whole.
+    static push_size_uninitialized_ex_res PushSizeUninitializedDownEx
+ (arena& Arena, size Size, size Alignment)
+    {
         push_size_uninitialized_ex_res Res = {};
         
         auto* MemBlock = Arena.MemoryBlock;
         size UsedBeforeAllocation = MemBlock->Used;
         size UsedAfterAllocation = UsedBeforeAllocation + Size;
+        size AlignmentPadding = 0;
+        if(UsedAfterAllocation <= MemBlock->Size)
+        {
+            AlignmentPadding = (umm)(MemBlock->Base + MemBlock->Size - UsedAfterAllocation) & (Alignment - 1);
+            UsedAfterAllocation += AlignmentPadding;
+        }
         
-        if(UsedAfterAllocation > MemBlock->Size)
+        if(UsedAfterAllocation > MemBlock->Committed &&
+           !TryExtendMemoryBlock(*MemBlock, UsedAfterAllocation, Arena.MinimalAllocationSize))
         {
-            rstd_Assert(Arena.MinimalAllocationSize >= MemoryPageSize);
-            
-            auto Max = [](size A, size B){ return A > B ? A : B; };
-            size AllocationSize = Max(Size + (size)sizeof(memory_block), Arena.MinimalAllocationSize);
-            u8* NewBase = (u8*)PageAlloc(AllocationSize);
+            size MaxAlignmentPadding = Alignment > MemoryPageSize ? Alignment : 0;
+            size AllocationSize = GetNextMemoryBlockAllocationSize(Arena, Size + MaxAlignmentPadding + sizeof(memory_block));
+            rstd_bool HugePages = Arena.Flags & ArenaFlag_HugePages;
+            u8* NewBase = (u8*)(HugePages ? HugePageAlloc(AllocationSize) : PageAlloc(AllocationSize));
             rstd_RAssert(NewBase, "OS Allocation call failed (probably your machine ran out of memory)");
             
             size NewMemBlockSize = AllocationSize - sizeof(memory_block);
             auto* NewMemBlock = (memory_block*)(NewBase + NewMemBlockSize);
+            AlignmentPadding = (umm)(NewBase + NewMemBlockSize - Size) & (Alignment - 1);
             NewMemBlock->Prev = MemBlock;
             NewMemBlock->Base = NewBase;
-            NewMemBlock->Used = Size;
-            NewMemBlock->MaxHistoricalUsed = Size;
+            NewMemBlock->Used = AlignmentPadding + Size;
+            NewMemBlock->MaxHistoricalUsed = AlignmentPadding + Size;
             NewMemBlock->Size = NewMemBlockSize;
+            NewMemBlock->Committed = NewMemBlockSize;
+            NewMemBlock->HugePages = HugePages;
+            NewMemBlock->GrowsDown = true;
             Arena.MemoryBlock = NewMemBlock;
             
-            Res.Memory = NewMemBlock->Base;
+            Res.Memory = NewBase + NewMemBlockSize - NewMemBlock->Used;
             
             MemoryDebug::RegisterArenaAllocateNextMemoryBlock(Arena);
         }
         else
         {
-            Res.Memory = MemBlock->Base + MemBlock->Used;
-            
-            if(UsedBeforeAllocation < MemBlock->MaxHistoricalUsed)
-                Res.GarbageBytes = MemBlock->MaxHistoricalUsed - UsedBeforeAllocation;
+            Res.Memory = MemBlock->Base + MemBlock->Size - UsedAfterAllocation;
+            if(UsedBeforeAllocation + AlignmentPadding < MemBlock->MaxHistoricalUsed)
+                Res.GarbageBytes = Size;
             
             if(UsedAfterAllocation > MemBlock->MaxHistoricalUsed)
                 MemBlock->MaxHistoricalUsed = UsedAfterAllocation;
@@ -2013,40 +2678,216 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
             MemBlock->Used = UsedAfterAllocation;
         }
         
+        Res.AlignmentPadding = AlignmentPadding;
         return Res;
     }
     
-    static u8* InternalPushSizeUninitialized
- (arena& Arena, size Size, calling_info CallingInfo)
-    { 
-        rstd_MemoryProfileFunction;
-        
-        auto Res = PushSizeUninitializedEx(Arena, Size);
-        MemoryDebug::RegisterArenaPush(Arena, Res, Size,
-                                       MemoryDebug::allocation_type::ArenaPushUninitialized,
-                                       CallingInfo);
-        return Res.Memory;
-    }
-    
-    static u8* InternalPushSizeZero
- (arena& Arena, u32 Size, calling_info CallingInfo)
+    // NOTE: Alignment is applied to the address, not to Used, so it works for SubArena() blocks too
+    static push_size_uninitialized_ex_res PushSizeUninitializedEx
+ (arena& Arena, size Size, size Alignment)
     {
         rstd_MemoryProfileFunction;
+        rstd_Assert(IsPowerOfTwo(Alignment));
         
-        auto Res = PushSizeUninitializedEx(Arena, Size);
-        if(Res.GarbageBytes)
-            Zero(Res.Memory, Res.GarbageBytes);
-        
-        MemoryDebug::RegisterArenaPush(Arena, Res, Size,
-                                       MemoryDebug::allocation_type::ArenaPushZero, CallingInfo);
+        if(Arena.Flags & ArenaFlag_GrowsDown)
+            return PushSizeUninitializedDownEx(Arena, Size, Alignment);
         
-        return Res.Memory;
-    }
-    
-    static char* InternalPushStringCopy
- (arena& Arena, const char* InitString, calling_info CallingInfo)
-    {
-        rstd_MemoryProfileFunction;
+        push_size_uninitialized_ex_res Res = {};
+        
+        auto* MemBlock = Arena.MemoryBlock;
+        WaitForBackgroundZeroing(*MemBlock);
+        size UsedBeforeAllocation = MemBlock->Used;
+        size AlignmentPadding = GetAlignmentPadding(MemBlock->Base + UsedBeforeAllocation, Alignment);
+        size UsedAfterAllocation = UsedBeforeAllocation + AlignmentPadding + Size;
+        
+        if(UsedAfterAllocation > MemBlock->Committed &&
+           !TryExtendMemoryBlock(*MemBlock, UsedAfterAllocation, Arena.MinimalAllocationSize))
+        {
+            rstd_Assert(Arena.MinimalAllocationSize >= MemoryPageSize);
+            
+            // NOTE: New blocks are page aligned, so only bigger alignments need extra space
+            size MaxAlignmentPadding = Alignment > MemoryPageSize ? Alignment : 0;
+            
+            size AllocationSize = GetNextMemoryBlockAllocationSize(Arena, Size + MaxAlignmentPadding + sizeof(memory_block));
+            rstd_bool HugePages = Arena.Flags & ArenaFlag_HugePages;
+            auto* NewMemBlock = HugePages ? nullptr : PopCachedMemoryBlock(AllocationSize);
+            if(NewMemBlock)
+            {
+                AlignmentPadding = GetAlignmentPadding(NewMemBlock->Base, Alignment);
+                size UsedAfterAllocationInNewBlock = AlignmentPadding + Size;
+                
+                if(NewMemBlock->MaxHistoricalUsed > AlignmentPadding)
+                {
+                    size GarbageBytes = NewMemBlock->MaxHistoricalUsed - AlignmentPadding;
+                    Res.GarbageBytes = GarbageBytes < Size ? GarbageBytes : Size;
+                }
+                
+                if(UsedAfterAllocationInNewBlock > NewMemBlock->MaxHistoricalUsed)
+                    NewMemBlock->MaxHistoricalUsed = UsedAfterAllocationInNewBlock;
+            }
+            else
+            {
+                u8* NewBase = (u8*)(HugePages ? HugePageAlloc(AllocationSize) : PageAlloc(AllocationSize));
+                rstd_RAssert(NewBase, "OS Allocation call failed (probably your machine ran out of memory)");
+                
+                AlignmentPadding = GetAlignmentPadding(NewBase, Alignment);
+                size NewMemBlockSize = AllocationSize - sizeof(memory_block);
+                NewMemBlock = (memory_block*)(NewBase + NewMemBlockSize);
+                NewMemBlock->Base = NewBase;
+                NewMemBlock->MaxHistoricalUsed = AlignmentPadding + Size;
+                NewMemBlock->Size = NewMemBlockSize;
+                NewMemBlock->Committed = NewMemBlockSize;
+                NewMemBlock->Opposite = nullptr;
+                NewMemBlock->HugePages = HugePages;
+                NewMemBlock->GrowsDown = false;
+            }
+            NewMemBlock->Prev = MemBlock;
+            NewMemBlock->Used = AlignmentPadding + Size;
+            Arena.MemoryBlock = NewMemBlock;
+            
+            Res.Memory = NewMemBlock->Base + AlignmentPadding;
+            
+            MemoryDebug::RegisterArenaAllocateNextMemoryBlock(Arena);
+        }
+        else
+        {
+            size UsedBeforePush = UsedBeforeAllocation + AlignmentPadding;
+            Res.Memory = MemBlock->Base + UsedBeforePush;
+            
+            if(UsedBeforePush < MemBlock->MaxHistoricalUsed)
+            {
+                size GarbageBytes = MemBlock->MaxHistoricalUsed - UsedBeforePush;
+                Res.GarbageBytes = GarbageBytes < Size ? GarbageBytes : Size;
+            }
+            
+            if(UsedAfterAllocation > MemBlock->MaxHistoricalUsed)
+                MemBlock->MaxHistoricalUsed = UsedAfterAllocation;
+            
+            MemBlock->Used = UsedAfterAllocation;
+        }
+        
+        Res.AlignmentPadding = AlignmentPadding;
+        return Res;
+    }
+    
+    static push_size_uninitialized_ex_res PushSizeUninitializedEx(arena& Arena, size Size)
+    { return PushSizeUninitializedEx(Arena, Size, Arena.DefaultAlignment); }
+    
+    static u8* InternalPushSizeUninitializedAligned
+ (arena& Arena, size Size, size Alignment, calling_info CallingInfo)
+    { 
+        rstd_MemoryProfileFunction;
+        
+        auto Res = PushSizeUninitializedEx(Arena, Size, Alignment);
+        MemoryDebug::RegisterArenaPush(Arena, Res, Size,
+                                       MemoryDebug::allocation_type::ArenaPushUninitialized,
+                                       CallingInfo);
+        return Res.Memory;
+    }
+    
+    static u8* InternalPushSizeUninitialized(arena& Arena, size Size, calling_info CallingInfo)
+    { return InternalPushSizeUninitializedAligned(Arena, Size, Arena.DefaultAlignment, CallingInfo); }
+    
+    static void ZeroGarbage
+ (arena& Arena, u8* Memory, size GarbageBytes)
+    {
+        if((Arena.Flags & ArenaFlag_ZeroByPageReset) && GarbageBytes >= 16*MemoryPageSize)
+            ZeroPages(Memory, GarbageBytes);
+        else
+            Zero(Memory, GarbageBytes);
+    }
+    
+    static u8* InternalPushSizeZeroAligned
+ (arena& Arena, size Size, size Alignment, calling_info CallingInfo)
+    {
+        rstd_MemoryProfileFunction;
+        
+        auto Res = PushSizeUninitializedEx(Arena, Size, Alignment);
+        if(Res.GarbageBytes)
+            ZeroGarbage(Arena, Res.Memory, Res.GarbageBytes);
+        
+        MemoryDebug::RegisterArenaPush(Arena, Res, Size,
+                                       MemoryDebug::allocation_type::ArenaPushZero, CallingInfo);
+        
+        return Res.Memory;
+    }
+    
+    static u8* InternalPushSizeZero(arena& Arena, size Size, calling_info CallingInfo)
+    { return InternalPushSizeZeroAligned(Arena, Size, Arena.DefaultAlignment, CallingInfo); }
+    
+    struct resize_last_push_res
+    {
+        u8* Memory;
+        rstd_bool ResizedInPlace; // false means memory was pushed again and old content was copied
+    };
+    
+    // NOTE: Grows or shrinks in place if Memory is the end of current memory block (never in GrowsDown arenas),
+    //       otherwise (or if block is too small) pushes NewSize bytes with Alignment (0 means arena's default)
+    //       and copies old content
+    static resize_last_push_res InternalResizeLastPush
+ (arena& Arena, void* Memory, size OldSize, size NewSize, rstd_bool ZeroNewBytes, calling_info CallingInfo,
+  size Alignment = 0)
+    {
+        rstd_MemoryProfileFunction;
+        
+        resize_last_push_res Res = {(u8*)Memory, true};
+        auto& MemBlock = *Arena.MemoryBlock;
+        WaitForBackgroundZeroing(MemBlock);
+        
+        if(!MemBlock.GrowsDown && (u8*)Memory + OldSize == MemBlock.Base + MemBlock.Used)
+        {
+            size UsedAfterResize = MemBlock.Used - OldSize + NewSize;
+            if(NewSize <= OldSize)
+            {
+                MemBlock.Used = UsedAfterResize;
+                if(NewSize < OldSize)
+                    MemoryDebug::RegisterArenaShrinkLastPush(Arena, OldSize - NewSize, CallingInfo);
+                return Res;
+            }
+            
+            if(UsedAfterResize <= MemBlock.Committed ||
+               TryExtendMemoryBlock(MemBlock, UsedAfterResize, Arena.MinimalAllocationSize))
+            {
+                push_size_uninitialized_ex_res PushRes = {};
+                PushRes.Memory = MemBlock.Base + MemBlock.Used;
+                if(MemBlock.Used < MemBlock.MaxHistoricalUsed)
+                    PushRes.GarbageBytes = MemBlock.MaxHistoricalUsed - MemBlock.Used;
+                
+                if(UsedAfterResize > MemBlock.MaxHistoricalUsed)
+                    MemBlock.MaxHistoricalUsed = UsedAfterResize;
+                MemBlock.Used = UsedAfterResize;
+                
+                size NewBytes = NewSize - OldSize;
+                if(ZeroNewBytes && PushRes.GarbageBytes)
+                    ZeroGarbage(Arena, PushRes.Memory, PushRes.GarbageBytes < NewBytes ? PushRes.GarbageBytes : NewBytes);
+                
+                MemoryDebug::RegisterArenaPush(Arena, PushRes, NewBytes, ZeroNewBytes ? MemoryDebug::allocation_type::ArenaPushZero :
+                                               MemoryDebug::allocation_type::ArenaPushUninitialized, CallingInfo);
+                return Res;
+            }
+        }
+        else if(NewSize <= OldSize)
+        {
+            return Res;
+        }
+        
+        auto PushRes = PushSizeUninitializedEx(Arena, NewSize, Alignment ? Alignment : Arena.DefaultAlignment);
+        memcpy(PushRes.Memory, Memory, OldSize);
+        if(ZeroNewBytes && PushRes.GarbageBytes > OldSize)
+            ZeroGarbage(Arena, PushRes.Memory + OldSize, PushRes.GarbageBytes - OldSize);
+        
+        MemoryDebug::RegisterArenaPush(Arena, PushRes, NewSize, ZeroNewBytes ? MemoryDebug::allocation_type::ArenaPushZero :
+                                       MemoryDebug::allocation_type::ArenaPushUninitialized, CallingInfo);
+        
+        Res.Memory = PushRes.Memory;
+        Res.ResizedInPlace = false;
+        return Res;
+    }
+    
+    static char* InternalPushStringCopy
+ (arena& Arena, const char* InitString, calling_info CallingInfo)
+    {
+        rstd_MemoryProfileFunction;
         
         u32 LengthWithNullChar = (u32)strlen(InitString) + 1;
         auto Res = PushSizeUninitializedEx(Arena, LengthWithNullChar);
@@ -2059,31 +2900,112 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
         return String;
     }
     
+    static void SetGrowthPolicy
+ (arena& Arena, arena_growth_policy GrowthPolicy, size MaxAllocationSize = MegabytesToBytes((size)256))
+    {
+        rstd_Assert(MaxAllocationSize >= Arena.MinimalAllocationSize);
+        Arena.GrowthPolicy = GrowthPolicy;
+        Arena.MaxAllocationSize = MaxAllocationSize;
+    }
+    
+    static const char* GetGrowthPolicyName
+ (arena_growth_policy GrowthPolicy)
+    {
+        switch(GrowthPolicy)
+        {
+            case arena_growth_policy::Fixed: return "fixed";
+            case arena_growth_policy::Geometric: return "geometric";
+            case arena_growth_policy::FitNextPush: return "fit next push";
+        }
+        return "";
+    }
+    
+    static u32 GetMemoryBlockCount
+ (arena& Arena)
+    {
+        u32 Count = 0;
+        for(auto* MemBlock = Arena.MemoryBlock; MemBlock; MemBlock = MemBlock->Prev)
+            ++Count;
+        return Count;
+    }
+    
+    static void SetDefaultAlignment
+ (arena& Arena, u32 Alignment)
+    {
+        rstd_Assert(IsPowerOfTwo(Alignment));
+        Arena.DefaultAlignment = Alignment;
+    }
+    
     template<class type> static type& PushStruct
  (arena& Arena, const type& Init)
     {
-        auto& A = rstd_PushStructUninitialized(Arena, type);
+        size Alignment = alignof(type) > Arena.DefaultAlignment ? alignof(type) : Arena.DefaultAlignment;
+        auto& A = *(type*)rstd_PushSizeUninitializedAligned(Arena, sizeof(type), Alignment);
         A = Init;
         return A;
     }
     
     static arena InternalAllocateArenaZero
- (size Size, calling_info CallingInfo, const char* DebugName = nullptr)
+ (size Size, calling_info CallingInfo, const char* DebugName = nullptr, u32 Flags = 0)
     {
         arena Arena;
         
+        rstd_bool HugePages = Flags & ArenaFlag_HugePages;
         Size += sizeof(memory_block);
-        Size = Align(Size, MemoryPageSize);
-        u8* Base = (u8*)PageAlloc(Size);
+        Size = HugePages ? AlignToHugePages(Size) : Align(Size, MemoryPageSize);
+        u8* Base = (u8*)(HugePages ? HugePageAlloc(Size) : PageAlloc(Size));
+        rstd_RAssert(Base, "OS Allocation call failed (probably your machine ran out of memory)");
         Size -= sizeof(memory_block);
         
         auto* MemBlock = (memory_block*)(Base + Size);
         MemBlock->Base = Base;
         MemBlock->Size = Size;
+        MemBlock->Committed = Size;
+        MemBlock->HugePages = HugePages;
+        Arena.MemoryBlock = MemBlock;
+        
+        Arena.MinimalAllocationSize = MegabytesToBytes(1);
+        Arena.MaxAllocationSize = MegabytesToBytes((size)256);
+        Arena.GrowthPolicy = arena_growth_policy::Fixed;
+        Arena.TempMemCount = 0;
+        Arena.Flags = Flags;
+        Arena.DefaultAlignment = rstd_ArenaDefaultAlignment;
+        Arena.PurgeDecayMilliseconds = 0;
+        
+        MemoryDebug::RegisterCreateArena(Arena, DebugName, nullptr, CallingInfo);
+        
+        return Arena;
+    }
+    
+    // NOTE: Reserves address space once and commits pages as Used grows,
+    //       so pushes stay contiguous and arena never chains memory blocks (unless reservation runs out)
+    static arena InternalReserveArena
+ (size ReserveSize, calling_info CallingInfo, const char* DebugName = nullptr, u32 Flags = 0)
+    {
+        rstd_AssertM(!(Flags & ArenaFlag_HugePages), "Huge pages can't be committed gradually, use AllocateArenaZero() instead");
+        arena Arena;
+        
+        ReserveSize = Align(ReserveSize + sizeof(memory_block), MemoryPageSize);
+        u8* Base = (u8*)PageReserve(ReserveSize);
+        rstd_RAssert(Base, "OS Reserve call failed (probably you reserved more than address space allows)");
+        
+        u8* HeaderPage = Base + ReserveSize - MemoryPageSize;
+        rstd_RAssert(PageCommit(HeaderPage, MemoryPageSize), "OS Commit call failed (probably your machine ran out of memory)");
+        
+        size Size = ReserveSize - sizeof(memory_block);
+        auto* MemBlock = (memory_block*)(Base + Size);
+        MemBlock->Base = Base;
+        MemBlock->Size = Size;
+        MemBlock->Committed = 0;
         Arena.MemoryBlock = MemBlock;
         
         Arena.MinimalAllocationSize = MegabytesToBytes(1);
+        Arena.MaxAllocationSize = MegabytesToBytes((size)256);
+        Arena.GrowthPolicy = arena_growth_policy::Fixed;
         Arena.TempMemCount = 0;
+        Arena.Flags = Flags;
+        Arena.DefaultAlignment = rstd_ArenaDefaultAlignment;
+        Arena.PurgeDecayMilliseconds = 0;
         
         MemoryDebug::RegisterCreateArena(Arena, DebugName, nullptr, CallingInfo);
         
@@ -2104,12 +3026,18 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
         ZeroStruct(*MemBlock);
         MemBlock->Base = Base;
         MemBlock->Size = Size;
+        MemBlock->Committed = Size;
         SubArena.MemoryBlock = MemBlock;
         
         SubArena.MinimalAllocationSize = MasterArena.MinimalAllocationSize;
+        SubArena.MaxAllocationSize = MasterArena.MaxAllocationSize;
+        SubArena.GrowthPolicy = MasterArena.GrowthPolicy;
         SubArena.TempMemCount = 0;
+        SubArena.Flags = ArenaFlag_SubArena;
+        SubArena.DefaultAlignment = MasterArena.DefaultAlignment;
+        SubArena.PurgeDecayMilliseconds = 0;
         
-        MemoryDebug::RegisterCreateArena(SubArena, DebugName, MasterArena.DebugName, CallingInfo);
+        MemoryDebug::RegisterCreateArena(SubArena, DebugName, rstd_DebugOnly(MasterArena.DebugName) rstd_ReleaseOnly(nullptr), CallingInfo);
         
         return SubArena;
     }
@@ -2119,28 +3047,38 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
     {
         rstd_AssertM(Arena.TempMemCount == 0, "You forgot to call EndTemporaryMemory()");
         
+        MemoryDebug::RegisterClearArena(Arena);
+        
+        WaitForBackgroundZeroing(*Arena.MemoryBlock);
         while(Arena.MemoryBlock->Prev)
         {
             auto* PrevMemBlock = Arena.MemoryBlock->Prev;
             MemoryDebug::RegisterArenaDeallocateMemoryBlock(Arena);
-            PageFree(Arena.MemoryBlock->Base);
+            ReleaseMemoryBlock(Arena.MemoryBlock);
             Arena.MemoryBlock = PrevMemBlock;
         }
+        size UsedBeforeRevert = Arena.MemoryBlock->Used;
         Arena.MemoryBlock->Used = 0;
+        DecommitAfterRevert(Arena, UsedBeforeRevert);
     }
     
-    // TODO: Can't we just store arena copy on stack?
     static void DeallocateArenaStoredInItself
  (arena& Arena)
     {
-        auto* MemBlock = Arena.MemoryBlock;
-        while(MemBlock)
+        // NOTE: Arena may live in one of its blocks, so only the copy is touched once freeing starts
+        arena ArenaCopy = Arena;
+        if(ArenaCopy.MemoryBlock)
         {
-            auto* PrevMemBlock = MemBlock->Prev;
-            MemoryDebug::RegisterArenaDeallocateMemoryBlock(Arena);
-            // TODO: Don't try to deallocate first block if it comes from SubArena()
-            PageFree(MemBlock);
-            MemBlock = PrevMemBlock;
+            MemoryDebug::RegisterDeallocateArena(ArenaCopy, rstd_GetCallingInfo());
+            WaitForBackgroundZeroing(*ArenaCopy.MemoryBlock);
+        }
+        while(ArenaCopy.MemoryBlock)
+        {
+            auto* PrevMemBlock = ArenaCopy.MemoryBlock->Prev;
+            MemoryDebug::RegisterArenaDeallocateMemoryBlock(ArenaCopy);
+            if(OwnsMemoryBlock(ArenaCopy, ArenaCopy.MemoryBlock))
+                FreeMemoryBlock(ArenaCopy.MemoryBlock);
+            ArenaCopy.MemoryBlock = PrevMemBlock;
         }
     }
     
@@ -2191,7 +3129,7 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
         auto* MemBlock = Arena.MemoryBlock;
         while(MemBlock)
         {
-            Bytes += MemBlock->Size;
+            Bytes += MemBlock->Committed;
             MemBlock = MemBlock->Prev;
         }
         return Bytes;
@@ -2219,15 +3157,19 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
         rstd_AssertM(TempMem.DebugId == TempMem.Arena->TempMemCount, "Temporary memory that was created most recently has to be ended first");
         
         auto* Arena = TempMem.Arena;
+        WaitForBackgroundZeroing(*Arena->MemoryBlock);
         while(Arena->MemoryBlock != TempMem.MemBlockOnBeginTemporaryMemory)
         {
             auto* PrevMemBlock = Arena->MemoryBlock->Prev;
-            PageFree(Arena->MemoryBlock->Base);
+            MemoryDebug::RegisterArenaDeallocateMemoryBlock(*Arena);
+            ReleaseMemoryBlock(Arena->MemoryBlock);
             Arena->MemoryBlock = PrevMemBlock;
         }
         
-        TempMem.Arena->MemoryBlock->Used = TempMem.ArenaUsedOnBeginTemporaryMemory;
-        --TempMem.Arena->TempMemCount;
+        size UsedBeforeRevert = Arena->MemoryBlock->Used;
+        Arena->MemoryBlock->Used = TempMem.ArenaUsedOnBeginTemporaryMemory;
+        --Arena->TempMemCount;
+        DecommitAfterRevert(*Arena, UsedBeforeRevert);
         
         MemoryDebug::RegisterEndTemporaryMemory(TempMem);
     }
@@ -2239,12 +3181,33 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
         scope_temporary_memory(arena& Arena)
         { TempMem = BeginTemporaryMemory(Arena); }
         
+        scope_temporary_memory(temporary_memory TempMem)
+            :TempMem(TempMem)
+        {}
+        
         ~scope_temporary_memory()
         { EndTemporaryMemory(TempMem); }
     };
     
 #define ScopeTemporaryMemory(Arena) scope_temporary_memory ScopeTempMem##__LINE__(Arena)
     
+    // NOTE: Every thread (thread_pool workers too) lazily gets its own rstd_ScratchArenaCount scratch arenas.
+    // Pass arenas you are going to push into while using the scratch (e.g. the one you return results in)
+    // and you'll get a scratch arena that is none of them.
+    temporary_memory GetScratch(arena* const* Conflicts, u32 ConflictCount);
+    
+    static temporary_memory GetScratch()
+    { return GetScratch(nullptr, 0); }
+    
+    template<class... arenas> static temporary_memory GetScratch
+ (arena& Conflict, arenas&... Conflicts)
+    {
+        arena* ConflictArray[] = {&Conflict, &Conflicts...};
+        return GetScratch(ConflictArray, sizeof...(Conflicts) + 1);
+    }
+    
+    void AssertNoScratchIsInUse();
+    
     
     struct arena_revert_point
     {
@@ -2258,14 +3221,18 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
     static void RevertArena
  (arena& Arena, arena_revert_point RevertPoint)
     {
+        WaitForBackgroundZeroing(*Arena.MemoryBlock);
         while(Arena.MemoryBlock != RevertPoint.MemBlock)
         {
             auto* PrevArenaMemBlock = Arena.MemoryBlock->Prev;
-            PageFree(Arena.MemoryBlock->Base);
+            MemoryDebug::RegisterArenaDeallocateMemoryBlock(Arena);
+            ReleaseMemoryBlock(Arena.MemoryBlock);
             Arena.MemoryBlock = PrevArenaMemBlock;
         }
         rstd_Assert(Arena.MemoryBlock);
+        size UsedBeforeRevert = Arena.MemoryBlock->Used;
         Arena.MemoryBlock->Used = RevertPoint.Used;
+        DecommitAfterRevert(Arena, UsedBeforeRevert);
     }
     
     struct arena_ref
@@ -2313,6 +3280,299 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
         return Ref;
     }
     
+    /////////////////
+    // FRAME ARENA //
+    /////////////////
+    // NOTE: FrameCount sub-arenas carved out of one allocation. Memory pushed during a frame stays valid
+    // for the next FrameCount - 1 frames, AdvanceFrame() then clears the oldest sub-arena and makes it current.
+    // Clearing is O(1) and touches no pages unless the frame overflowed its range into chained blocks
+    // (those go to the memory block cache). Watch OverflowedFrameCount to pick a big enough FrameSize.
+    struct frame_arena_stats
+    {
+        size LastFrameUsed; // bytes held by the most recently finished frame
+        size PeakFrameUsed; // max bytes held by a single frame so far
+        u64 FrameNumber;
+        u32 OverflowedFrameCount; // frames that didn't fit into FrameSize
+    };
+    
+    template<u32 FrameCount>
+        struct frame_arena
+    {
+        static_assert(FrameCount >= 1, "frame_arena needs at least one frame");
+        
+        arena MasterArena;
+        arena Frames[FrameCount];
+        size FrameUsed[FrameCount]; // what each frame held when it finished
+        frame_arena_stats Stats;
+        u32 CurrentFrame;
+    };
+    
+#define rstd_AllocateFrameArena(_FrameCount, _FrameSize, ...) \
+InternalAllocateFrameArena<_FrameCount>(_FrameSize, rstd_GetCallingInfo(), ##__VA_ARGS__)
+    
+    template<u32 FrameCount> static frame_arena<FrameCount> InternalAllocateFrameArena
+ (size FrameSize, calling_info CallingInfo, const char* DebugName = nullptr)
+    {
+        frame_arena<FrameCount> FrameArena;
+        
+        // every frame range begins on its own page
+        size FrameRangeSize = Align(FrameSize + sizeof(memory_block), MemoryPageSize);
+        FrameArena.MasterArena = InternalAllocateArenaZero(FrameRangeSize * FrameCount, CallingInfo, DebugName);
+        for(u32 FrameIndex = 0; FrameIndex < FrameCount; ++FrameIndex)
+        {
+            FrameArena.Frames[FrameIndex] = InternalSubArena(FrameArena.MasterArena, FrameRangeSize - sizeof(memory_block),
+                                                             CallingInfo, DebugName);
+            FrameArena.FrameUsed[FrameIndex] = 0;
+        }
+        
+        ZeroStruct(FrameArena.Stats);
+        FrameArena.CurrentFrame = 0;
+        return FrameArena;
+    }
+    
+    template<u32 FrameCount> static arena& GetCurrentFrame(frame_arena<FrameCount>& FrameArena)
+    { return FrameArena.Frames[FrameArena.CurrentFrame]; }
+    
+    template<u32 FrameCount> static void AdvanceFrame
+ (frame_arena<FrameCount>& FrameArena)
+    {
+        auto& Stats = FrameArena.Stats;
+        arena& Finished = GetCurrentFrame(FrameArena);
+        size Used = GetUsed(Finished);
+        FrameArena.FrameUsed[FrameArena.CurrentFrame] = Used;
+        Stats.LastFrameUsed = Used;
+        if(Used > Stats.PeakFrameUsed)
+            Stats.PeakFrameUsed = Used;
+        if(Finished.MemoryBlock->Prev)
+            ++Stats.OverflowedFrameCount;
+        ++Stats.FrameNumber;
+        
+        FrameArena.CurrentFrame = (FrameArena.CurrentFrame + 1) % FrameCount;
+        Clear(GetCurrentFrame(FrameArena));
+    }
+    
+    template<u32 FrameCount> static frame_arena_stats GetStats(frame_arena<FrameCount>& FrameArena)
+    { return FrameArena.Stats; }
+    
+    template<u32 FrameCount> static void DeallocateFrameArena
+ (frame_arena<FrameCount>& FrameArena)
+    {
+        for(arena& Frame : FrameArena.Frames)
+            DeallocateArena(Frame);
+        DeallocateArena(FrameArena.MasterArena);
+    }
+    
+    ////////////////////////
+    // DOUBLE ENDED ARENA //
+    ////////////////////////
+    // NOTE: Low and High are ordinary arenas (so arena_ref, lists and temporary memory work with either of them)
+    // that share one memory block. Low pushes from its beginning, High from its end and each takes
+    // whatever the other one doesn't use. When the ends meet, the end that pushes chains a new block like any arena.
+    struct double_ended_arena
+    {
+        arena MasterArena;
+        arena Low;
+        arena High;
+    };
+    
+#define rstd_AllocateDoubleEndedArena(_Size, ...) \
+InternalAllocateDoubleEndedArena(_Size, rstd_GetCallingInfo(), ##__VA_ARGS__)
+    
+#define rstd_PushLow(_DoubleEndedArena, _Size) \
+rstd_PushSizeZero((_DoubleEndedArena).Low, _Size)
+    
+#define rstd_PushHigh(_DoubleEndedArena, _Size) \
+rstd_PushSizeZero((_DoubleEndedArena).High, _Size)
+    
+    static double_ended_arena InternalAllocateDoubleEndedArena
+ (size Size, calling_info CallingInfo, const char* DebugName = nullptr)
+    {
+        double_ended_arena Arena;
+        Arena.MasterArena = InternalAllocateArenaZero(Size + 2 * sizeof(memory_block), CallingInfo, DebugName);
+        
+        auto* LowBlock = (memory_block*)InternalPushSizeZero(Arena.MasterArena, sizeof(memory_block), CallingInfo);
+        auto* HighBlock = (memory_block*)InternalPushSizeZero(Arena.MasterArena, sizeof(memory_block), CallingInfo);
+        u8* Base = InternalPushSizeZero(Arena.MasterArena, Size, CallingInfo);
+        
+        // NOTE: Committed is 0, first push of each end claims the free part of block
+        LowBlock->Base = HighBlock->Base = Base;
+        LowBlock->Size = HighBlock->Size = Size;
+        LowBlock->Opposite = HighBlock;
+        HighBlock->Opposite = LowBlock;
+        HighBlock->GrowsDown = true;
+        
+        Arena.Low = Arena.MasterArena;
+        Arena.Low.MemoryBlock = LowBlock;
+        Arena.Low.Flags = ArenaFlag_SubArena;
+        
+        Arena.High = Arena.MasterArena;
+        Arena.High.MemoryBlock = HighBlock;
+        Arena.High.Flags = ArenaFlag_SubArena|ArenaFlag_GrowsDown;
+        
+        const char* MasterName = rstd_DebugOnly(Arena.MasterArena.DebugName) rstd_ReleaseOnly(nullptr);
+        MemoryDebug::RegisterCreateArena(Arena.Low, "Low", MasterName, CallingInfo);
+        MemoryDebug::RegisterCreateArena(Arena.High, "High", MasterName, CallingInfo);
+        
+        return Arena;
+    }
+    
+    static arena_revert_point GetLowRevertPoint(double_ended_arena& Arena)
+    { return GetArenaRevertPoint(Arena.Low); }
+    
+    static arena_revert_point GetHighRevertPoint(double_ended_arena& Arena)
+    { return GetArenaRevertPoint(Arena.High); }
+    
+    static void RevertLow(double_ended_arena& Arena, arena_revert_point RevertPoint)
+    { RevertArena(Arena.Low, RevertPoint); }
+    
+    static void RevertHigh(double_ended_arena& Arena, arena_revert_point RevertPoint)
+    { RevertArena(Arena.High, RevertPoint); }
+    
+    // NOTE: Bytes between the ends of shared block, chained blocks are not counted
+    static size GetFreeBytes
+ (double_ended_arena& Arena)
+    {
+        memory_block* LowBlock = Arena.Low.MemoryBlock;
+        while(LowBlock->Prev)
+            LowBlock = LowBlock->Prev;
+        memory_block* HighBlock = LowBlock->Opposite;
+        return LowBlock->Size - LowBlock->Used - HighBlock->Used;
+    }
+    
+    static void DeallocateDoubleEndedArena
+ (double_ended_arena& Arena)
+    {
+        DeallocateArena(Arena.Low);
+        DeallocateArena(Arena.High);
+        DeallocateArena(Arena.MasterArena);
+    }
+    
+    ////////////////////
+    // SLAB ALLOCATOR //
+    ////////////////////
+    // NOTE: Hands out fixed-size slots. Arena is asked for SlotsPerSlab slots at once,
+    // freed slots go to a free list (linked through first bytes of the slot) and are reused before arena is touched again.
+    // It keeps no arena itself, so containers that already have an arena_ref can embed it.
+    struct slab_allocator
+    {
+        void* FreeSlots;
+        u32 SlotSize;
+        u32 SlotAlignment;
+        u32 SlotsPerSlab;
+        u32 FreeSlotCount;
+    };
+    
+    static slab_allocator MakeSlabAllocator
+ (u32 SlotSize, u32 SlotAlignment, u32 SlotsPerSlab = 64)
+    {
+        rstd_Assert(IsPowerOfTwo(SlotAlignment));
+        rstd_Assert(SlotsPerSlab);
+        
+        if(SlotSize < sizeof(void*))
+            SlotSize = sizeof(void*);
+        if(SlotAlignment < alignof(void*))
+            SlotAlignment = alignof(void*);
+        
+        slab_allocator Slab;
+        Slab.FreeSlots = nullptr;
+        Slab.SlotSize = (u32)Align(SlotSize, SlotAlignment);
+        Slab.SlotAlignment = SlotAlignment;
+        Slab.SlotsPerSlab = SlotsPerSlab;
+        Slab.FreeSlotCount = 0;
+        return Slab;
+    }
+    
+    static void Free
+ (slab_allocator& Slab, void* Slot)
+    {
+        *(void**)Slot = Slab.FreeSlots;
+        Slab.FreeSlots = Slot;
+        ++Slab.FreeSlotCount;
+    }
+    
+    static void* AllocateUninitialized
+ (slab_allocator& Slab, arena& Arena)
+    {
+        if(!Slab.FreeSlots)
+        {
+            u8* Slots = rstd_PushSizeUninitializedAligned(Arena, (size)Slab.SlotSize * Slab.SlotsPerSlab, Slab.SlotAlignment);
+            for(u32 SlotIndex = Slab.SlotsPerSlab; SlotIndex--;)
+                Free(Slab, Slots + (size)SlotIndex * Slab.SlotSize);
+        }
+        
+        void* Slot = Slab.FreeSlots;
+        Slab.FreeSlots = *(void**)Slot;
+        --Slab.FreeSlotCount;
+        return Slot;
+    }
+    
+    static void* AllocateZero
+ (slab_allocator& Slab, arena& Arena)
+    {
+        void* Slot = AllocateUninitialized(Slab, Arena);
+        Zero(Slot, Slab.SlotSize);
+        return Slot;
+    }
+    
+    // NOTE: Call it after the arena that slots came from was cleared or reverted
+    static void Reset
+ (slab_allocator& Slab)
+    {
+        Slab.FreeSlots = nullptr;
+        Slab.FreeSlotCount = 0;
+    }
+    
+    //////////
+    // POOL //
+    //////////
+    template<class type>
+        struct pool
+    {
+        arena_ref ArenaRef;
+        slab_allocator Slab;
+        
+        pool()
+            :ArenaRef() {}
+        
+        pool
+ (arena_ref ArenaRef, u32 SlotsPerSlab = 64)
+            :ArenaRef(ArenaRef)
+        { Slab = MakeSlabAllocator(sizeof(type), alignof(type), SlotsPerSlab); }
+        
+        rstd_bool Initialized()
+        { return ArenaRef; }
+        
+        type* AllocateUninitialized()
+        {
+            rstd_Assert(ArenaRef);
+            return (type*)rstd::AllocateUninitialized(Slab, *ArenaRef);
+        }
+        
+        type* AllocateZero()
+        {
+            rstd_Assert(ArenaRef);
+            return (type*)rstd::AllocateZero(Slab, *ArenaRef);
+        }
+        
+        type& Allocate
+ (const type& InitialData)
+        {
+            type* E = AllocateUninitialized();
+            *E = InitialData;
+            return *E;
+        }
+        
+        void Free
+ (type* E)
+        { rstd::Free(Slab, E); }
+        
+        u32 GetFreeCount()
+        { return Slab.FreeSlotCount; }
+        
+        void Reset()
+        { rstd::Reset(Slab); }
+    };
+    
     template<class dest_container, class source_container> void CopyElements
  (dest_container* Dest, source_container& Source)
     {
@@ -2902,8 +4162,9 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
         { 
             if(auto* Found = Find(Comparison)) 
             { 
+                optional<type> Res = {*Found}; 
                 Remove(*Found); 
-                return {*Found}; 
+                return Res; 
             } 
             return {}; 
         } 
@@ -2917,7 +4178,7 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
             { 
                 if(Comparison(*It)) 
                 { 
-                    Remove(It); 
+                    It = Remove(It); 
                     ++RemovedCount; 
                 } 
             } 
@@ -3007,352 +4268,198 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
         
     };
     
+    ///////////////////
+    // DYNAMIC ARRAY //
+    ///////////////////
+    // NOTE: Elements live in one push that doubles when it runs out of capacity. While that push is the last one
+    // in the arena it grows in place, otherwise it is pushed again and copied (old copy stays in arena until it's cleared).
+    // Growing invalidates pointers to elements, use doubly_linked_list if you need them to be stable.
     template<class type>
-        struct doubly_linked_list
+        struct dynamic_array
     {
-        // NOTE: to be more precise, it's a doubly linked list with sentinel node
-        
-        struct node
-        {
-            type Data;
-            node* Next;
-            node* Prev;
-        };
-        
-        static_assert(offsetof(node, Data) == 0, "we need Data to be first in node for Remove(type*)");
+        using iterator = type*;
         
         arena_ref ArenaRef;
-        node* Sentinel;
-        node* Nodes;
-        node* FreeNodes;
+        type* Elements;
+        u32 Count;
+        u32 Capacity;
         
         rstd_bool Initialized()
-        { return Nodes; }
-        
-        doubly_linked_list()
-        { Nodes = nullptr; }
+        { return ArenaRef; }
         
-        doubly_linked_list
- (arena_ref ArenaRef)
+        dynamic_array()
         {
-            this->ArenaRef = ArenaRef;
-            Sentinel = &rstd_PushStructUninitialized(*ArenaRef, doubly_linked_list<type>::node);
-            Nodes = Sentinel;
-            Sentinel->Next = Sentinel;
-            Sentinel->Prev = Sentinel;
-            FreeNodes = nullptr;
+            Elements = nullptr;
+            Count = 0;
+            Capacity = 0;
         }
         
-        struct iterator
+        dynamic_array
+ (arena_ref ArenaRef, u32 InitialCapacity = 0)
         {
-            node* Node;
-            rstd_DebugOnly(node* DebugSentinel;)
-                
-                iterator& operator++() 
-            {
-                Node = Node->Next;
-                return *this;
-            }
-            
-            iterator operator++(int)
-            {
-                auto Res = *this;
-                Node = Node->Next;
-                return Res;
-            }
-            
-            iterator& operator--() 
-            { 
-                Node = Node->Prev;
-                return *this;
-            }
-            
-            iterator operator--(int)
-            {
-                auto Res = *this;
-                Node = Node->Prev;
-                return Res;
-            }
-            
-            iterator& operator+=
- (u32 Offset) 
-            {
-                while(Offset--)
-                    Node = Node->Next;
-                return *this;
-            }
-            
-            iterator& operator-=
- (u32 Offset)
-            {
-                while(Offset--)
-                    Node = Node->Prev;
-                return *this;
-            }
-            
-            iterator operator+
- (u32 Offset)
-            {
-                auto Res = *this;
-                return Res += Offset;
-            }
-            
-            iterator operator-
- (u32 Offset)
-            {
-                auto Res = *this;
-                return Res -= Offset;
-            }
-            
-            u32 operator-
- (iterator Rhs)
-            {
-                u32 Diff = 0;
-                while(Node != Rhs.Node)	
-                {
-                    Rhs = Rhs.Prev;
-                    ++Diff;
-                    rstd_Assert(Rhs.Node != DebugSentinel);
-                }
-                return Diff;
-            }
-            
-            // TODO: Should I remove Ptr() and leave just conversion operator?
-            type* Ptr()
-            { 
-                rstd_Assert(Node != DebugSentinel);
-                return &Node->Data;
-            }
-            
-            operator type*()
-            { return Ptr(); }
-            
-            type* operator->()
-            { return Ptr(); }
-            
-            type& operator*()
-            { return *Ptr(); }
-            
-            rstd_bool operator==(iterator Rhs)
-            { return Node == Rhs.Node; }
-            
-            rstd_bool operator!=(iterator Rhs)
-            { return Node != Rhs.Node; }
-        };
+            this->ArenaRef = ArenaRef;
+            Elements = nullptr;
+            Count = 0;
+            Capacity = 0;
+            Reserve(InitialCapacity);
+        }
         
         iterator Begin()
-        {
-            iterator It = {Sentinel->Next};
-            rstd_DebugOnly(It.DebugSentinel = Sentinel);
-            return It;
-        }
+        { return Elements; }
         
         iterator End()
+        { return Elements + Count; }
+        
+        internal_rstd_RestOfIteratorFunctions;
+        
+        type& operator[]
+ (u32 Index)
         {
-            iterator It = {Sentinel};
-            rstd_DebugOnly(It.DebugSentinel = Sentinel);
-            return It;
+            rstd_AssertM(Index < Count,
+                         "You tried to get element [%], but this dynamic_array has only % elements", Index, Count);
+            return Elements[Index];
         }
         
-        internal_rstd_RestOfIteratorFunctions;
+        u32 GetCount()
+        { return Count; }
         
-        rstd_bool Empty()
-        { return Sentinel->Next == Sentinel; }
+        u32 GetCapacity()
+        { return Capacity; }
         
-        type& operator[]
- (u32 DesiredIndex)
+        void Clear()
+        { Count = 0; }
+        
+        void Zero()
         {
-            rstd_Assert(!Empty());
-            
-            u32 Index = 0;
-            for(auto& E : *this)
-            {
-                if(Index == DesiredIndex)
-                    return E;
-                ++Index;
-            }
-            
-            rstd_InvalidCodePathM(Format<string<>>("You tried to get element [%], but doubly_linked_list has only % elements", DesiredIndex, Index));
-            return *(type*)(nullptr);
+            rstd::Zero(Elements, Count * sizeof(type));
+            Count = 0;
         }
         
+        rstd_bool Empty()
+        { return Count == 0; }
+        
         type& GetFirst()
         {
             rstd_Assert(!Empty());
-            return Sentinel->Next->Data;
+            return *Elements; 
         }
         
         type& GetLast()
-        {
+        { 
             rstd_Assert(!Empty());
-            return Sentinel->Prev->Data;
+            return Elements[Count - 1]; 
         }
         
-        void SanityCheck()
+        void Reserve
+ (u32 NewCapacity)
         {
-#if rstd_Debug
-            rstd_AssertM(Nodes, "You have to initialize list before using it!");
-            rstd_Assert(Nodes == Sentinel);
-            rstd_Assert(FreeNodes != Sentinel);
-            rstd_Assert(Sentinel->Next && Sentinel->Prev);
+            rstd_AssertM(ArenaRef, "You have to initialize dynamic_array before using it!");
+            if(NewCapacity <= Capacity)
+                return;
             
-#ifdef rstd_EnableDoublyLinkedListAdvancedSanityCheck	
-            auto* Prev = Sentinel;
-            auto* Current = Sentinel->Next;
-            while(Current != Sentinel)
+            if(Elements)
             {
-                rstd_Assert(Current->Next);
-                rstd_Assert(Current->Prev);
-                rstd_Assert(Prev->Next == Current);
-                rstd_Assert(Current->Prev == Prev);
-                Prev = Current;
-                Current = Current->Next;
+                Elements = (type*)InternalResizeLastPush(*ArenaRef, Elements, Capacity * sizeof(type), NewCapacity * sizeof(type),
+                                                         false, rstd_GetCallingInfo(), alignof(type)).Memory;
             }
-#endif
-#endif
+            else
+            {
+                Elements = rstd_PushArrayUninitializedAligned(*ArenaRef, type, NewCapacity);
+            }
+            Capacity = NewCapacity;
         }
         
-#ifndef rstd_DisableWarningForUsingGetCountInListsWithoutCounter
- [[deprecated("\nConsider using doubly_linked_list_with_counter instead of doubly_linked_list\n"
-              "if you want to call GetCount(); in most cases that will result in better performance.\n"
-              "If you want to get rid of this warning you can #define rstd_DisableWarningForUsingGetCountInListsWithoutCounter.")]]
-#endif
-        u32 GetCount()
+        void Grow()
         {
-            SanityCheck();
-            u32 Count = 0;
-            for(auto& E : *this)
-                ++Count;
-            return Count;
+            rstd_AssertM(Capacity < MaxU32, "dynamic_array can't have more than MaxU32 elements");
+            u32 NewCapacity = Capacity > MaxU32 / 2 ? MaxU32 : Capacity * 2;
+            if(NewCapacity < 8)
+                NewCapacity = 8;
+            Reserve(NewCapacity);
         }
         
-        void PushNode
- (node* Node)
+        // NOTE: New elements are uninitialized
+        void Resize
+ (u32 NewCount)
         {
-            auto* LastNode = Sentinel->Prev;
-            Sentinel->Prev = Node;
-            LastNode->Next = Node;
-            Node->Prev = LastNode;
-            Node->Next = Sentinel;
-            
-            SanityCheck();
+            Reserve(NewCount);
+            Count = NewCount;
         }
         
-        void PushNodeFront
- (node* Node)
+        type& PushUninitialized()
         {
-            auto* FirstNode = Sentinel->Next;
-            Sentinel->Next = Node;
-            FirstNode->Prev = Node;
-            Node->Next = FirstNode;
-            Node->Prev = Sentinel;
-            
-            SanityCheck();
+            if(Count == Capacity)
+                Grow();
+            ++Count;
+            return Elements[Count - 1];
         }
         
-        node* PopFreeNode()
+        type& PushZero()
         {
-            rstd_Assert(FreeNodes);
-            node* Node = FreeNodes;
-            FreeNodes = FreeNodes->Next;
-            return Node;
+            auto& Data = PushUninitialized();
+            ZeroStruct(Data);
+            return Data;
         }
         
-        node* AllocateZeroNode()
+        void Pop()
         {
-            node* Node;
-            if(FreeNodes)
-            {
-                Node = PopFreeNode();
-                ZeroStruct(Node->Data);
-            }
-            else
-            {
-                Node = &rstd_PushStructZero(*ArenaRef, node);
-            }
-            return Node;
+            rstd_Assert(!Empty());
+            --Count;
         }
         
-        node* AllocateUninitializedNode()
-        { return FreeNodes ? PopFreeNode() : &rstd_PushStructUninitialized(*ArenaRef, node); }
-        
-        type& PushZero()
-        {
-            node* Node = AllocateZeroNode();
-            PushNode(Node);
-            return Node->Data;
-        }
-        
-        type& PushUninitialized()
+        void RemovePointerAsserts
+ (type* E) 
         {
-            node* Node = AllocateUninitializedNode();
-            PushNode(Node);
-            return Node->Data;
+            rstd_Assert(!Empty());
+            rstd_Assert(E >= Elements);
+            rstd_Assert(E < Elements + Count);
         }
         
-        type& PushFrontZero()
+        type* Remove
+ (type* E)
         {
-            node* Node = AllocateZeroNode();
-            PushNodeFront(Node);
-            return Node->Data;
+            RemovePointerAsserts(E);
+            if(E < Elements + Count - 1)
+                *E = Elements[Count - 1];
+            --Count;
+            return E - 1;
         }
         
-        type& PushFrontUninitialized()
-        {
-            node* Node = AllocateUninitializedNode();
-            PushNodeFront(Node);
-            return Node->Data;
-        }
+        void Remove(type& E)
+        { Remove(&E); }
         
-        void AddFreeNode
- (node* Node)
+        type* RemoveAndPersistOrder
+ (type* E)
         {
-            Node->Next = FreeNodes;
-            FreeNodes = Node;
+            RemovePointerAsserts(E);
+            if(E < Elements + Count - 1)
+                memmove(E, E + 1, (size_t)((char*)(Elements + Count) - (char*)(E + 1)));
+            --Count;
+            return E - 1;
         }
         
-        void Clear()
-        {
-            SanityCheck();
-            
-            iterator Next;
-            for(auto It = Begin(); It != End(); It = Next)
-            {
-                Next = It + 1;
-                AddFreeNode(It.Node);
-            }
-            
-            Sentinel->Next = Sentinel;
-            Sentinel->Prev = Sentinel;
-        }
+        void RemoveAndPersistOrder(type& E)
+        { RemoveAndPersistOrder(&E); }
         
-        void Remove
- (node* Node)
-        {
-            rstd_Assert(!Empty());
-            
-            Node->Prev->Next = Node->Next;
-            Node->Next->Prev = Node->Prev;
-            AddFreeNode(Node);
-            
-            SanityCheck();
-        }
+        void PopFirst()
+        { Remove(Elements); }
         
-        iterator Remove
- (iterator It)
+        void PopLast()
         {
-            Remove(It.Node);
-            return --It;
+            rstd_Assert(!Empty());
+            --Count;
         }
         
-        void Remove(type& E)
-        { Remove((node*)&E); }
+        void PopFrontAndPersistOrder()
+        { RemoveAndPersistOrder(Elements); }
         
-        void PopFirst()
-        { Remove(GetFirst()); }
+        template<class comparison_fn>
+            void Sort(comparison_fn Comparison)
+        { std::sort(Elements, Elements + Count, Comparison); }
         
-        void PopLast()
-        { Remove(GetLast()); }
+        template<class comparison_fn>
+            void StableSort(comparison_fn Comparison)
+        { std::stable_sort(Elements, Elements + Count, Comparison); }
         
         template<class compare_type>               
             type* FindEqual                            
@@ -3537,23 +4644,6 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
             Push(NextPushElements...); 
         }
         
-        type& PushFront 
- (const type& InitialData) 
-        { 
-            auto& Data = PushFrontUninitialized(); 
-            Data = InitialData; 
-            return Data; 
-        }
-        
-        template<class comparison_fn> 
-            type* PushFrontIfUnique 
- (const type& InitialData, comparison_fn Comparison) 
-        { 
-            if(!Has(Comparison)) 
-                return &PushFront(InitialData); 
-            return nullptr; 
-        } 
-        
         template<class compare_type> 
             rstd_bool RemoveFirstEqualTo 
  (const compare_type& ThingToCompare) 
@@ -3600,8 +4690,9 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
         { 
             if(auto* Found = Find(Comparison)) 
             { 
+                optional<type> Res = {*Found}; 
                 Remove(*Found); 
-                return {*Found}; 
+                return Res; 
             } 
             return {}; 
         } 
@@ -3615,7 +4706,7 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
             { 
                 if(Comparison(*It)) 
                 { 
-                    Remove(It); 
+                    It = Remove(It); 
                     ++RemovedCount; 
                 } 
             } 
@@ -3692,364 +4783,849 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
             } 
         }
         
+        rstd_bool HasPtr(const type* Ptr) 
+        { return Ptr >= Elements && Ptr < Elements + Count; } 
+        
+        u32 GetIndexFromPtr 
+ (const type* Ptr) 
+        { 
+            /* TODO: rstd_Assert(Is aligned to array elements) */ 
+            rstd_Assert(HasPtr(Ptr)); 
+            return (u32)((umm)(Ptr - Elements)); 
+        }
+        
     };
     
-    // TODO: Add memory debugging for singly_linked_list
-    template<class type>
-        struct singly_linked_list
+    //////////////
+    // HASH MAP //
+    //////////////
+    // NOTE: Keys up to 8 bytes are hashed by their bits (so don't use structs with padding), strings by contents.
+    // Write your own hasher with the same two functions for anything else.
+    struct default_hasher
     {
-        struct node
+        template<class key>
+            static u64 Hash
+ (const key& Key)
         {
-            type Data;
-            node* Next;
+            static_assert(sizeof(key) <= sizeof(u64), "default_hasher hashes only keys up to 8 bytes, pass your own hasher");
+            u64 Bits = 0;
+            memcpy(&Bits, &Key, sizeof(key));
+            return HashU64(Bits);
+        }
+        
+        static u64 Hash
+ (const char* Key)
+        { return HashString(Key); }
+        
+        template<size Size, class character>
+            static u64 Hash
+ (const string<Size, character>& Key)
+        { return HashString(Key); }
+        
+        template<class key>
+            static rstd_bool Equal
+ (const key& A, const key& B)
+        { return A == B; }
+        
+        static rstd_bool Equal
+ (const char* A, const char* B)
+        { return strcmp(A, B) == 0; }
+        
+        template<size Size, class character>
+            static rstd_bool Equal
+ (const string<Size, character>& A, const string<Size, character>& B)
+        { return A.Count == B.Count && memcmp(A.Characters, B.Characters, A.Count * sizeof(character)) == 0; }
+    };
+    
+    // NOTE: Open addressing with linear probing. Every slot has a control byte which is either EmptyControl
+    // or low 7 bits of the key hash. Lookup compares 16 control bytes at once and looks only at keys whose bits matched.
+    // Remove shifts following keys back into the hole instead of leaving tombstones, so lookups don't get slower
+    // after many removes and the table never has to be rehashed just to clean up.
+    // Slots and control bytes are one allocation, pushed to arena if you pass one (old table stays in arena when
+    // the map grows), otherwise taken from GenAlloc and given back in Free(). Growing invalidates pointers to keys and values.
+    template<class key, class value, class hasher = default_hasher>
+        struct hash_map
+    {
+        struct slot
+        {
+            key Key;
+            value Value;
         };
         
+        static constexpr u32 GroupWidth = 16;
+        static constexpr u32 MinCapacity = GroupWidth;
+        static constexpr u8 EmptyControl = 0x80;
+        
+        static_assert(alignof(slot) <= 16, "GenAlloc gives only 16 byte aligned memory");
+        
+        arena_ref ArenaRef;
+        slot* Slots;
+        u8* Controls; // Capacity + GroupWidth - 1 bytes, first GroupWidth - 1 are repeated at the end so groups never wrap
+        u32 Count;
+        u32 Capacity;
+        
+        hash_map()
+        {
+            Slots = nullptr;
+            Controls = nullptr;
+            Count = 0;
+            Capacity = 0;
+        }
+        
+        hash_map
+ (arena_ref ArenaRef, u32 InitialCount = 0)
+        {
+            this->ArenaRef = ArenaRef;
+            Slots = nullptr;
+            Controls = nullptr;
+            Count = 0;
+            Capacity = 0;
+            Reserve(InitialCount);
+        }
+        
         struct iterator
         {
-            node* Node;
+            hash_map* Map;
+            u32 Index;
             
-            iterator& operator++() 
-            { 
-                Node = Node->Next;
+            iterator& operator++()
+            {
+                Index = Map->GetNextFullIndex(Index + 1);
                 return *this;
             }
             
             iterator operator++(int)
             {
                 auto Res = *this;
-                Node = Node->Next;
+                ++*this;
                 return Res;
             }
             
-            type& operator*() 
-            { return Node->Data; }
-            
-            type* Ptr()
-            { return &Node->Data; }
+            slot& operator*()
+            { return Map->Slots[Index]; }
             
-            type* operator->() 
-            { return Ptr(); }
+            slot* operator->()
+            { return Map->Slots + Index; }
             
-            rstd_bool operator==(iterator Rhs)
-            { return Node == Rhs.Node; }
+            rstd_bool operator==(const iterator& B) const
+            { return Index == B.Index; }
             
-            rstd_bool operator!=(iterator Rhs)
-            { return Node != Rhs.Node; }
+            rstd_bool operator!=(const iterator& B) const
+            { return Index != B.Index; }
         };
         
-        node* FirstNode;
-        node* LastNode;
-        arena_ref ArenaRef;
-        
-        void Clear()
-        { FirstNode = LastNode = nullptr; }
-        
-        void Init
- (arena_ref ArenaRef)
-        {	
-            rstd_AssertM(!this->ArenaRef, "It's already initialized!");
-            this->ArenaRef = ArenaRef;
-            Clear();
-        }
-        
-        singly_linked_list(arena_ref ArenaRef) 
-        { Init(ArenaRef); }
-        
-        singly_linked_list()
-            :ArenaRef() { Clear(); }
-        
         iterator Begin()
-        { return {FirstNode}; }
+        { return {this, GetNextFullIndex(0)}; }
         
         iterator End()
-        { return {nullptr}; }
+        { return {this, Capacity}; }
         
         internal_rstd_RestOfIteratorFunctions;
         
-        rstd_bool Initialized()
-        { return ArenaRef; }
+        u32 GetCount()
+        { return Count; }
+        
+        u32 GetCapacity()
+        { return Capacity; }
         
         rstd_bool Empty()
-        { return !FirstNode; }
+        { return Count == 0; }
         
-        type& GetFirst()
+        // NOTE: Max load factor is 7/8
+        static u32 GetMaxCount
+ (u32 Capacity)
+        { return Capacity - Capacity / 8; }
+        
+        static u32 GetCapacityFor
+ (u32 ElementCount)
         {
-            rstd_Assert(!Empty());
-            return FirstNode->Data;
+            u32 Res = MinCapacity;
+            while(GetMaxCount(Res) < ElementCount)
+            {
+                rstd_AssertM(Res <= MaxU32 / 4, "hash_map can't have more than 2^31 slots");
+                Res *= 2;
+            }
+            return Res;
         }
         
-        type& GetLast()
+        static u32 MatchControl
+ (const u8* Group, u8 Control)
         {
-            rstd_Assert(!Empty());
-            return LastNode->Data;
+#if rstd_SSE2
+            __m128i Bytes = _mm_loadu_si128((const __m128i*)Group);
+            return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(Bytes, _mm_set1_epi8((char)Control)));
+#else
+            u32 Res = 0;
+            for(u32 ByteIndex = 0; ByteIndex < GroupWidth; ++ByteIndex)
+                Res |= (u32)(Group[ByteIndex] == Control) << ByteIndex;
+            return Res;
+#endif
         }
         
-#ifndef rstd_DisableWarningForUsingGetCountInListsWithoutCounter
- [[deprecated("\nConsider using singly_linked_list_with_counter instead of singly_linked_list\n"
-              "if you want to call GetCount(); in most cases that will result in better performance.\n"
-              "If you want to get rid of this warning you can #define rstd_DisableWarningForUsingGetCountInListsWithoutCounter.")]]
+        // NOTE: Only EmptyControl has the high bit set
+        static u32 MatchEmpty
+ (const u8* Group)
+        {
+#if rstd_SSE2
+            return (u32)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)Group));
+#else
+            u32 Res = 0;
+            for(u32 ByteIndex = 0; ByteIndex < GroupWidth; ++ByteIndex)
+                Res |= (u32)(Group[ByteIndex] >> 7) << ByteIndex;
+            return Res;
 #endif
-        u32 GetCount()
-        { 
-            u32 Count = 0;
-            for(auto& E : *this)
-                ++Count;
-            return Count;
         }
         
-        void PushNode
- (node& Node)
+        static u8 GetControl
+ (u64 Hash)
+        { return (u8)(Hash & 0x7f); }
+        
+        u32 GetHomeIndex
+ (u64 Hash)
+        { return (u32)(Hash >> 7) & (Capacity - 1); }
+        
+        void SetControl
+ (u32 Index, u8 Control)
         {
-            if(LastNode)
-                LastNode->Next = &Node;
-            LastNode = &Node;
-            if(!FirstNode)
-                FirstNode = &Node;
+            // NOTE: For Index < GroupWidth - 1 second write goes to the copy at the end, otherwise it writes the same byte again
+            u32 Mask = Capacity - 1;
+            Controls[Index] = Control;
+            Controls[((Index - (GroupWidth - 1)) & Mask) + (GroupWidth - 1)] = Control;
         }
         
-        void PushNodeFront
- (node& Node)
+        u32 GetNextFullIndex
+ (u32 Index)
         {
-            Node.Next = FirstNode;
-            FirstNode = Node;
-            if(!LastNode)
-                LastNode = FirstNode;
+            for(; Index < Capacity; Index += GroupWidth)
+            {
+                u32 Full = ~MatchEmpty(Controls + Index) & 0xffff;
+                if(Full)
+                {
+                    Index += CountTrailingZeros(Full);
+                    return Index < Capacity ? Index : Capacity;
+                }
+            }
+            return Capacity;
         }
         
-        type& PushZero()
+        slot* FindSlot
+ (const key& Key, u64 Hash)
         {
-            rstd_Assert(ArenaRef);
-            auto* Node = PushStructZero(ArenaRef.Ptr(), node);
-            PushNode(Node);
-            return Node->Data;
+            if(!Count)
+                return nullptr;
+            
+            u8 Control = GetControl(Hash);
+            u32 Mask = Capacity - 1;
+            for(u32 GroupIndex = GetHomeIndex(Hash);; GroupIndex = (GroupIndex + GroupWidth) & Mask)
+            {
+                u8* Group = Controls + GroupIndex;
+                for(u32 Matches = MatchControl(Group, Control); Matches; Matches &= Matches - 1)
+                {
+                    u32 Index = (GroupIndex + CountTrailingZeros(Matches)) & Mask;
+                    if(hasher::Equal(Slots[Index].Key, Key))
+                        return Slots + Index;
+                }
+                if(MatchEmpty(Group))
+                    return nullptr;
+            }
         }
         
-        type& PushUninitialized()
+        u32 FindEmptyIndex
+ (u64 Hash)
         {
-            rstd_Assert(ArenaRef);
-            auto& Node = rstd_PushStructUninitialized(*ArenaRef, node);
-            Node.Next = nullptr;
-            PushNode(Node);
-            return Node.Data;
+            u32 Mask = Capacity - 1;
+            for(u32 GroupIndex = GetHomeIndex(Hash);; GroupIndex = (GroupIndex + GroupWidth) & Mask)
+            {
+                if(u32 Empties = MatchEmpty(Controls + GroupIndex))
+                    return (GroupIndex + CountTrailingZeros(Empties)) & Mask;
+            }
         }
         
-        type& PushFrontZero()
+        value& InsertUniqueWithoutRehash
+ (const key& Key, u64 Hash)
         {
-            rstd_Assert(ArenaRef);
-            auto* Node = PushStructZero(ArenaRef.Ptr(), node);
-            PushNodeFront(Node);
-            return Node->Data;
+            u32 Index = FindEmptyIndex(Hash);
+            SetControl(Index, GetControl(Hash));
+            Slots[Index].Key = Key;
+            ++Count;
+            return Slots[Index].Value;
         }
         
-        type& PushFrontUninitialized()
+        value* Find
+ (const key& Key)
         {
-            rstd_Assert(ArenaRef);
-            auto* Node = PushStructUninitialized(ArenaRef.Ptr(), node);
-            PushNodeFront(Node);
-            return Node->Data;
+            slot* Slot = FindSlot(Key, hasher::Hash(Key));
+            return Slot ? &Slot->Value : nullptr;
         }
         
-        type& PushAfter
- (node* NodeWhichWillBeBeforeThePushedOne)
+        value& FindWithAssert
+ (const key& Key)
         {
-            rstd_Assert(ArenaRef);
-            auto* PushedNode = PushStructUninitialized(ArenaRef.Ptr(), node);
-            PushedNode->Next = NodeWhichWillBeBeforeThePushedOne->Next;
-            if(!PushedNode->Next)
-                LastNode = PushedNode;
-            NodeWhichWillBeBeforeThePushedOne->Next = PushedNode;
-            return PushedNode->Data;
+            value* Found = Find(Key);
+            rstd_Assert(Found);
+            return *Found;
         }
         
-        type& PushAfter
- (node* NodeWhichWillBeBeforeThePushedOne, const type& InitialData)
-        {
-            auto& Data = PushAfter(NodeWhichWillBeBeforeThePushedOne);
-            Data = InitialData;
-            return Data;
-        }
+        rstd_bool Has
+ (const key& Key)
+        { return (rstd_bool)FindSlot(Key, hasher::Hash(Key)); }
         
-        void PopFront()
+        rstd_bool InsertNeedsRehash()
+        { return Count + 1 > GetMaxCount(Capacity); }
+        
+        // NOTE: Key must not be in the map already, value is uninitialized.
+        // Key may be an element of this map, so it's copied before rehash frees the old slots
+        value& InsertUnique
+ (const key& Key, u64 Hash)
         {
-            rstd_Assert(!Empty());
-            FirstNode = FirstNode->Next;
+            if(InsertNeedsRehash())
+            {
+                key KeyCopy = Key;
+                Rehash(Capacity ? Capacity * 2 : MinCapacity);
+                return InsertUniqueWithoutRehash(KeyCopy, Hash);
+            }
+            return InsertUniqueWithoutRehash(Key, Hash);
         }
         
-        void Pop()
+        // NOTE: Overwrites value if key is already in the map. Value may be an element of this map too
+        value& Insert
+ (const key& Key, const value& Value)
         {
-            rstd_Assert(!Empty());
-            if(FirstNode->Next)
+            u64 Hash = hasher::Hash(Key);
+            if(slot* Slot = FindSlot(Key, Hash))
             {
-                auto* Node = FirstNode;
-                while(Node->Next != LastNode)
-                    ++Node;
-                Node->Next = nullptr;	
-                LastNode = Node;
+                Slot->Value = Value;
+                return Slot->Value;
             }
-            else
+            
+            if(InsertNeedsRehash())
             {
-                FirstNode = nullptr;
+                value ValueCopy = Value;
+                value& Res = InsertUnique(Key, Hash);
+                Res = ValueCopy;
+                return Res;
             }
+            
+            value& Res = InsertUnique(Key, Hash);
+            Res = Value;
+            return Res;
         }
         
-        void Remove
- (type* ElementToRemove)
+        value& FindOrInsertZero
+ (const key& Key)
         {
-            node* NodeToRemove = (node*)ElementToRemove;	
+            u64 Hash = hasher::Hash(Key);
+            if(slot* Slot = FindSlot(Key, Hash))
+                return Slot->Value;
             
-            if(NodeToRemove == FirstNode)
-            {
-                FirstNode = FirstNode->Next;
-            }
-            else
+            value& Res = InsertUnique(Key, Hash);
+            ZeroStruct(Res);
+            return Res;
+        }
+        
+        void RemoveSlot
+ (u32 Hole)
+        {
+            // NOTE: Keys after the hole move back into it if the hole is between their home slot and them,
+            // so every key stays reachable from its home slot without crossing an empty slot
+            u32 Mask = Capacity - 1;
+            for(u32 Index = (Hole + 1) & Mask; Controls[Index] != EmptyControl; Index = (Index + 1) & Mask)
             {
-                node* PrevNode = FirstNode;
-                for(auto* Node = FirstNode->Next;; Node = Node->Next)
+                u32 Home = GetHomeIndex(hasher::Hash(Slots[Index].Key));
+                if(((Index - Home) & Mask) >= ((Index - Hole) & Mask))
                 {
-                    rstd_AssertM(Node, "You're trying to remove thing that is not in this container");
-                    if(Node == NodeToRemove)
-                    {
-                        PrevNode->Next = Node->Next;
-                        break;
-                    }
-                    PrevNode = Node;
+                    Slots[Hole] = Slots[Index];
+                    SetControl(Hole, Controls[Index]);
+                    Hole = Index;
                 }
             }
+            SetControl(Hole, EmptyControl);
+            --Count;
+        }
+        
+        rstd_bool Remove
+ (const key& Key)
+        {
+            slot* Slot = FindSlot(Key, hasher::Hash(Key));
+            if(!Slot)
+                return false;
+            RemoveSlot((u32)(Slot - Slots));
+            return true;
+        }
+        
+        void RemoveWithAssert
+ (const key& Key)
+        {
+            rstd_bool ManagedToRemove = Remove(Key);
+            rstd_Assert(ManagedToRemove);
         }
         
-        // NOTE: returns true if found element to remove
         template<class comparison_fn>
-            rstd_bool RemoveFirstIf
+            u32 RemoveIf
  (comparison_fn Comparison)
         {
-            node* PrevNode = nullptr;
-            for(auto* Node = FirstNode; Node; Node = Node->Next)
+            if(!Count)
+                return 0;
+            
+            // NOTE: Start right after an empty slot, so keys shifted back by RemoveSlot never land on slots we already visited
+            u32 Mask = Capacity - 1;
+            u32 Start = 0;
+            while(Controls[Start] != EmptyControl)
+                ++Start;
+            
+            u32 RemovedCount = 0;
+            for(u32 Index = (Start + 1) & Mask; Index != Start;)
             {
-                if(Comparison(Node->Data))
+                if(Controls[Index] != EmptyControl && Comparison(Slots[Index]))
                 {
-                    if(PrevNode)
-                    {
-                        PrevNode->Next = Node->Next;	
-                        if(Node == LastNode)
-                            LastNode = PrevNode;
-                    }
-                    else
-                    {
-                        FirstNode = Node->Next;
-                    }
-                    return true;
+                    RemoveSlot(Index);
+                    ++RemovedCount;
                 }
                 else
                 {
-                    PrevNode = Node;
+                    Index = (Index + 1) & Mask;
                 }
             }
-            return false;
+            return RemovedCount;
         }
         
-        template<class comparison_fn>
-            optional<type> RemoveFirstIfReturnCopy
- (comparison_fn Comparison)
+        void Rehash
+ (u32 NewCapacity)
         {
-            node* PrevNode = nullptr;
-            for(auto* Node = FirstNode; Node; Node = Node->Next)
+            rstd_AssertM(IsPowerOfTwo(NewCapacity) && NewCapacity >= MinCapacity, "hash_map capacity has to be power of two and at least %", MinCapacity);
+            rstd_Assert(GetMaxCount(NewCapacity) >= Count);
+            
+            slot* OldSlots = Slots;
+            u8* OldControls = Controls;
+            u32 OldCapacity = Capacity;
+            
+            size SlotsSize = (size)NewCapacity * sizeof(slot);
+            size ControlsSize = (size)NewCapacity + GroupWidth - 1;
+            u8* Memory = ArenaRef ?
+                rstd_PushSizeUninitializedAligned(*ArenaRef, SlotsSize + ControlsSize, alignof(slot)) :
+            (u8*)GenAllocSize(SlotsSize + ControlsSize);
+            Slots = (slot*)Memory;
+            Controls = Memory + SlotsSize;
+            Capacity = NewCapacity;
+            memset(Controls, EmptyControl, ControlsSize);
+            
+            for(u32 OldIndex = 0; OldIndex < OldCapacity; ++OldIndex)
             {
-                if(Comparison(Node->Data))
+                if(OldControls[OldIndex] == EmptyControl)
+                    continue;
+                
+                u64 Hash = hasher::Hash(OldSlots[OldIndex].Key);
+                u32 Index = FindEmptyIndex(Hash);
+                SetControl(Index, GetControl(Hash));
+                Slots[Index] = OldSlots[OldIndex];
+            }
+            
+            if(OldSlots && !ArenaRef)
+                GenFree(OldSlots);
+        }
+        
+        void Reserve
+ (u32 ElementCount)
+        {
+            if(ElementCount > GetMaxCount(Capacity))
+                Rehash(GetCapacityFor(ElementCount));
+        }
+        
+        void Clear()
+        {
+            if(Controls)
+                memset(Controls, EmptyControl, (size)Capacity + GroupWidth - 1);
+            Count = 0;
+        }
+        
+        // NOTE: Gives the table back to GenAlloc, map stays usable. Arena backed tables are freed with the arena
+        void Free()
+        {
+            if(Slots && !ArenaRef)
+                GenFree(Slots);
+            Slots = nullptr;
+            Controls = nullptr;
+            Count = 0;
+            Capacity = 0;
+        }
+    };
+    
+    //////////////////
+    // BUCKET ARRAY //
+    //////////////////
+    // NOTE: Bucket of 16 KB minus its header (bitmap, two pointers and two counters)
+    template<class type>
+        constexpr u32 GetDefaultBucketSize()
+    {
+        size BucketBytes = 16*1024;
+        u32 Res = BucketBytes / sizeof(type) > 1 ? (u32)(BucketBytes / sizeof(type)) : 1;
+        while(Res > 1 && ConstAlign(ConstAlign((Res + 63) / 64 * sizeof(u64) + 2*sizeof(void*) + 2*sizeof(u32), alignof(type)) +
+                                    Res * sizeof(type), alignof(type) > 8 ? alignof(type) : 8) > BucketBytes)
+            --Res;
+        return Res;
+    }
+    
+    // NOTE: Elements live in buckets that never move, so pointers to them stay valid like in lists,
+    // but iteration goes through contiguous memory. Every bucket has a bitmap of occupied slots,
+    // iteration jumps over free slots with CountTrailingZeros() and Push() takes first free slot of first bucket that has one.
+    // Buckets are aligned to power of two of their size, so Remove() finds the bucket by masking element address.
+    // If you pick your own bucket_size, keep its bucket just under power of two, rest of it is padding.
+    // Order of elements is not kept, slots of removed elements get reused and buckets are freed only with the arena.
+    template<class type, u32 bucket_size = GetDefaultBucketSize<type>()>
+        struct bucket_array
+    {
+        static constexpr u32 OccupancyWordCount = (bucket_size + 63) / 64;
+        
+        struct bucket
+        {
+            u64 Occupied[OccupancyWordCount];
+            bucket* Next;
+            bucket* NextWithFreeSlots;
+            u32 Count;
+            u32 FirstFreeWordIndex; // words before it are full
+            type Elements[bucket_size];
+        };
+        
+        static constexpr size GetBucketAlignment()
+        {
+            size Res = 64;
+            while(Res < sizeof(bucket))
+                Res *= 2;
+            return Res;
+        }
+        
+        static constexpr size BucketAlignment = GetBucketAlignment();
+        
+        arena_ref ArenaRef;
+        bucket* FirstBucket;
+        bucket* LastBucket;
+        bucket* BucketsWithFreeSlots;
+        u32 Count;
+        
+        rstd_bool Initialized()
+        { return ArenaRef; }
+        
+        bucket_array()
+        {
+            FirstBucket = nullptr;
+            LastBucket = nullptr;
+            BucketsWithFreeSlots = nullptr;
+            Count = 0;
+        }
+        
+        bucket_array
+ (arena_ref ArenaRef)
+        {
+            this->ArenaRef = ArenaRef;
+            FirstBucket = nullptr;
+            LastBucket = nullptr;
+            BucketsWithFreeSlots = nullptr;
+            Count = 0;
+        }
+        
+        struct iterator
+        {
+            bucket* Bucket;
+            u32 Index;
+            u64 Bits; // occupied bits of current word from Index up, so most increments don't touch the bitmap
+            
+            void MoveToNextWord()
+            {
+                u32 WordIndex = Index / 64 + 1;
+                for(;;)
                 {
-                    if(PrevNode)
+                    for(; WordIndex < OccupancyWordCount; ++WordIndex)
                     {
-                        PrevNode->Next = Node->Next;	
-                        if(Node == LastNode)
-                            LastNode = PrevNode;
+                        Bits = Bucket->Occupied[WordIndex];
+                        if(Bits)
+                        {
+                            Index = WordIndex * 64 + CountTrailingZeros(Bits);
+                            return;
+                        }
                     }
-                    else
+                    
+                    Bucket = Bucket->Next;
+                    if(!Bucket)
                     {
-                        FirstNode = Node->Next;
+                        Index = 0;
+                        Bits = 0;
+                        return;
                     }
-                    return {Node->Data};
+                    WordIndex = 0;
                 }
+            }
+            
+            iterator& operator++()
+            {
+                Bits &= Bits - 1;
+                if(Bits)
+                    Index = (Index & ~63u) + CountTrailingZeros(Bits);
                 else
-                {
-                    PrevNode = Node;
-                }
+                    MoveToNextWord();
+                return *this;
             }
-            return {};
-        }
-        
-        rstd_bool RemoveFirstEqualTo
- (type& E)
-        {
-            node* PrevNode = nullptr;
-            for(auto* Node = FirstNode; Node; Node = Node->Next)
+            
+            iterator operator++(int)
             {
-                if(Node->Data == E)
+                auto Res = *this;
+                ++*this;
+                return Res;
+            }
+            
+            iterator& operator+=
+ (u32 Offset)
+            {
+                // NOTE: Whole bitmap words are skipped by their popcount and whole buckets by their Count
+                while(Offset)
                 {
-                    if(PrevNode)
+                    rstd_AssertM(Bucket, "You tried to move bucket_array iterator past the end");
+                    u32 WordIndex = Index / 64;
+                    Bits &= Bits - 1;
+                    for(;;)
+                    {
+                        u32 BitCount = CountSetBits(Bits);
+                        if(Offset <= BitCount)
+                        {
+                            while(--Offset)
+                                Bits &= Bits - 1;
+                            Index = WordIndex * 64 + CountTrailingZeros(Bits);
+                            return *this;
+                        }
+                        Offset -= BitCount;
+                        if(++WordIndex == OccupancyWordCount)
+                            break;
+                        Bits = Bucket->Occupied[WordIndex];
+                    }
+                    
+                    for(Bucket = Bucket->Next; Bucket && Bucket->Count < Offset; Bucket = Bucket->Next)
+                        Offset -= Bucket->Count;
+                    
+                    if(Bucket)
                     {
-                        PrevNode->Next = Node->Next;	
-                        if(Node == LastNode)
-                            LastNode = PrevNode;
+                        // NOTE: Bucket has at least Offset elements, so it has the first one
+                        Index = 0;
+                        Bits = Bucket->Occupied[0];
+                        if(Bits)
+                            Index = CountTrailingZeros(Bits);
+                        else
+                            MoveToNextWord();
+                        --Offset;
                     }
                     else
                     {
-                        FirstNode = Node->Next;
+                        // NOTE: One past the last element is End()
+                        rstd_AssertM(Offset == 1, "You tried to move bucket_array iterator past the end");
+                        Index = 0;
+                        Bits = 0;
+                        Offset = 0;
                     }
-                    return true;
-                }
-                else
-                {
-                    PrevNode = Node;
                 }
+                return *this;
             }
-            return false;
+            
+            iterator operator+
+ (u32 Offset)
+            {
+                auto Res = *this;
+                return Res += Offset;
+            }
+            
+            type& operator*()
+            { return Bucket->Elements[Index]; }
+            
+            type* operator->()
+            { return Bucket->Elements + Index; }
+            
+            rstd_bool operator==(const iterator& B) const
+            { return Bucket == B.Bucket && Index == B.Index; }
+            
+            rstd_bool operator!=(const iterator& B) const
+            { return !(*this == B); }
+        };
+        
+        iterator Begin()
+        {
+            if(!FirstBucket)
+                return End();
+            
+            iterator Res = {FirstBucket, 0, FirstBucket->Occupied[0]};
+            if(Res.Bits)
+                Res.Index = CountTrailingZeros(Res.Bits);
+            else
+                Res.MoveToNextWord();
+            return Res;
         }
         
-        template<class compare_type>               
-            type* FindEqual                            
- (const compare_type& ThingToComare)        
-        {                                          
-            for(auto& Element : *this)         
-            {                                      
-                if(Element == ThingToComare)               
-                    return &Element;               
-            }                                      
-            return nullptr;                        
-        }                                          
+        iterator End()
+        { return {nullptr, 0, 0}; }
         
-        template<class comparison_fn>        
-            type* Find                           
- (comparison_fn Comparison)           
-        {                                    
-            for(auto& Element : *this)       
-            {                                
-                if(Comparison(Element))      
-                    return &Element;         
-            }                                
-            return nullptr;                  
-        }                                    
+        internal_rstd_RestOfIteratorFunctions;
         
-        template<class comparison_fn> 
-            auto& FindWithAssert 
- (comparison_fn Comparison) 
-        { 
-            auto* Found = Find(Comparison); 
-            rstd_Assert(Found); 
-            return *Found; 
-        } 
+        u32 GetCount()
+        { return Count; }
         
-        template<class compare_type> 
-            rstd_bool HasEqual 
- (const compare_type& ThingToCompare) 
-        { return (rstd_bool)FindEqual(ThingToCompare); } 
+        rstd_bool Empty()
+        { return Count == 0; }
         
-        template<class comparison_fn> 
-            rstd_bool Has 
- (comparison_fn Comparison) 
-        { return (rstd_bool)Find(Comparison); } 
+        u32 GetBucketCount()
+        {
+            u32 Res = 0;
+            for(bucket* Bucket = FirstBucket; Bucket; Bucket = Bucket->Next)
+                ++Res;
+            return Res;
+        }
         
-        template<class compare_type> 
-            u32 FindIndexOfFirstEqual 
- (const compare_type& ThingToCompare) 
+        void AddBucket()
+        {
+            rstd_AssertM(ArenaRef, "You have to initialize bucket_array before using it!");
+            
+            auto* Bucket = (bucket*)rstd_PushSizeUninitializedAligned(*ArenaRef, sizeof(bucket), BucketAlignment);
+            Zero(Bucket->Occupied, sizeof(Bucket->Occupied));
+            Bucket->Next = nullptr;
+            Bucket->NextWithFreeSlots = BucketsWithFreeSlots;
+            Bucket->Count = 0;
+            Bucket->FirstFreeWordIndex = 0;
+            
+            if(LastBucket)
+                LastBucket->Next = Bucket;
+            else
+                FirstBucket = Bucket;
+            LastBucket = Bucket;
+            BucketsWithFreeSlots = Bucket;
+        }
+        
+        type& PushUninitialized()
+        {
+            if(!BucketsWithFreeSlots)
+                AddBucket();
+            
+            // NOTE: Bits past bucket_size in the last word are never set, so first clear bit is always a real slot
+            bucket* Bucket = BucketsWithFreeSlots;
+            u32 WordIndex = Bucket->FirstFreeWordIndex;
+            while(Bucket->Occupied[WordIndex] == ~0ull)
+                ++WordIndex;
+            u32 Bit = CountTrailingZeros(~Bucket->Occupied[WordIndex]);
+            Bucket->Occupied[WordIndex] |= 1ull << Bit;
+            Bucket->FirstFreeWordIndex = WordIndex;
+            
+            if(++Bucket->Count == bucket_size)
+                BucketsWithFreeSlots = Bucket->NextWithFreeSlots;
+            ++Count;
+            return Bucket->Elements[WordIndex * 64 + Bit];
+        }
+        
+        type& PushZero()
+        {
+            auto& Data = PushUninitialized();
+            ZeroStruct(Data);
+            return Data;
+        }
+        
+        static bucket* GetBucket
+ (const type* E)
+        { return (bucket*)((umm)E & ~(umm)(BucketAlignment - 1)); }
+        
+        void Remove
+ (type* E)
+        {
+            bucket* Bucket = GetBucket(E);
+            u32 Index = (u32)(E - Bucket->Elements);
+            u64 Bit = 1ull << (Index % 64);
+            rstd_AssertM(Index < bucket_size && (Bucket->Occupied[Index / 64] & Bit), 
+                         "You tried to remove element that is not in this bucket_array");
+            
+            Bucket->Occupied[Index / 64] &= ~Bit;
+            if(Index / 64 < Bucket->FirstFreeWordIndex)
+                Bucket->FirstFreeWordIndex = Index / 64;
+            if(Bucket->Count-- == bucket_size)
+            {
+                Bucket->NextWithFreeSlots = BucketsWithFreeSlots;
+                BucketsWithFreeSlots = Bucket;
+            }
+            --Count;
+        }
+        
+        void Remove(type& E)
+        { Remove(&E); }
+        
+        void Remove(iterator It)
+        { Remove(&*It); }
+        
+        // NOTE: Keeps buckets for next pushes
+        void Clear()
+        {
+            BucketsWithFreeSlots = nullptr;
+            for(bucket* Bucket = FirstBucket; Bucket; Bucket = Bucket->Next)
+            {
+                Zero(Bucket->Occupied, sizeof(Bucket->Occupied));
+                Bucket->Count = 0;
+                Bucket->FirstFreeWordIndex = 0;
+                Bucket->NextWithFreeSlots = BucketsWithFreeSlots;
+                BucketsWithFreeSlots = Bucket;
+            }
+            Count = 0;
+        }
+        
+        rstd_bool HasPtr
+ (const type* Ptr)
+        {
+            for(bucket* Bucket = FirstBucket; Bucket; Bucket = Bucket->Next)
+            {
+                if(Ptr >= Bucket->Elements && Ptr < Bucket->Elements + bucket_size)
+                {
+                    u32 Index = (u32)(Ptr - Bucket->Elements);
+                    return (Bucket->Occupied[Index / 64] >> (Index % 64)) & 1;
+                }
+            }
+            return false;
+        }
+        
+        template<class compare_type>               
+            type* FindEqual                            
+ (const compare_type& ThingToComare)        
+        {                                          
+            for(auto& Element : *this)         
+            {                                      
+                if(Element == ThingToComare)               
+                    return &Element;               
+            }                                      
+            return nullptr;                        
+        }                                          
+        
+        template<class comparison_fn>        
+            type* Find                           
+ (comparison_fn Comparison)           
+        {                                    
+            for(auto& Element : *this)       
+            {                                
+                if(Comparison(Element))      
+                    return &Element;         
+            }                                
+            return nullptr;                  
+        }                                    
+        
+        template<class comparison_fn> 
+            auto& FindWithAssert 
+ (comparison_fn Comparison) 
+        { 
+            auto* Found = Find(Comparison); 
+            rstd_Assert(Found); 
+            return *Found; 
+        } 
+        
+        template<class compare_type> 
+            rstd_bool HasEqual 
+ (const compare_type& ThingToCompare) 
+        { return (rstd_bool)FindEqual(ThingToCompare); } 
+        
+        template<class comparison_fn> 
+            rstd_bool Has 
+ (comparison_fn Comparison) 
+        { return (rstd_bool)Find(Comparison); } 
+        
+        template<class compare_type> 
+            u32 FindIndexOfFirstEqual 
+ (const compare_type& ThingToCompare) 
         { 
             u32 ElementIndex = 0; 
             for(auto& Element : *this) 
@@ -4134,7 +5710,7 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
         }
         
         type& Push 
- (const type& InitialData)
+ (const type& InitialData) 
         { 
             auto& Data = PushUninitialized(); 
             Data = InitialData; 
@@ -4187,41 +5763,118 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
             Push(NextPushElements...); 
         }
         
-        type& PushFront 
- (const type& InitialData) 
+        template<class compare_type> 
+            rstd_bool RemoveFirstEqualTo 
+ (const compare_type& ThingToCompare) 
         { 
-            auto& Data = PushFrontUninitialized(); 
-            Data = InitialData; 
-            return Data; 
-        }
+            if(auto* Found = FindEqual(ThingToCompare)) 
+            { 
+                Remove(*Found); 
+                return true; 
+            } 
+            return false; 
+        } 
+        
+        template<class compare_type> 
+            void RemoveFirstEqualToWithAssert 
+ (const compare_type& ThingToCompare) 
+        { 
+            bool ManagedToRemove = RemoveFirstEqualTo(ThingToCompare); 
+            rstd_Assert(ManagedToRemove); 
+        } 
         
         template<class comparison_fn> 
-            type* PushFrontIfUnique 
- (const type& InitialData, comparison_fn Comparison) 
+            rstd_bool RemoveFirstIf 
+ (comparison_fn Comparison) 
         { 
-            if(!Has(Comparison)) 
-                return &PushFront(InitialData); 
-            return nullptr; 
+            if(auto* Found = Find(Comparison)) 
+            { 
+                Remove(*Found); 
+                return true; 
+            } 
+            return false; 
+        } 
+        
+        template<class comparison_fn> 
+            void RemoveFirstIfWithAssert 
+ (comparison_fn Comparison) 
+        { 
+            bool ManagedToRemove = RemoveFirstIf(Comparison); 
+            rstd_Assert(ManagedToRemove); 
+        } 
+        
+        template<class comparison_fn> 
+            optional<type> RemoveFirstIfReturnCopy 
+ (comparison_fn Comparison) 
+        { 
+            if(auto* Found = Find(Comparison)) 
+            { 
+                Remove(*Found); 
+                return {*Found}; 
+            } 
+            return {}; 
         } 
         
+        template<class comparison_fn> 
+            u32 RemoveIf 
+ (comparison_fn Comparison) 
+        { 
+            u32 RemovedCount = 0; 
+            for(auto It = Begin(); It != End(); ++It) 
+            { 
+                if(Comparison(*It)) 
+                { 
+                    Remove(It); 
+                    ++RemovedCount; 
+                } 
+            } 
+            return RemovedCount; 
+        }
     };
     
-    // TODO: Add memory debugging for backward_singly_linked_list
     template<class type>
-        struct backward_singly_linked_list
+        struct doubly_linked_list
     {
+        // NOTE: to be more precise, it's a doubly linked list with sentinel node
+        
         struct node
         {
             type Data;
             node* Next;
+            node* Prev;
         };
         
+        static_assert(offsetof(node, Data) == 0, "we need Data to be first in node for Remove(type*)");
+        
+        arena_ref ArenaRef;
+        node* Sentinel;
+        node* Nodes;
+        node* FreeNodes;
+        
+        rstd_bool Initialized()
+        { return Nodes; }
+        
+        doubly_linked_list()
+        { Nodes = nullptr; }
+        
+        doubly_linked_list
+ (arena_ref ArenaRef)
+        {
+            this->ArenaRef = ArenaRef;
+            Sentinel = &rstd_PushStructUninitialized(*ArenaRef, doubly_linked_list<type>::node);
+            Nodes = Sentinel;
+            Sentinel->Next = Sentinel;
+            Sentinel->Prev = Sentinel;
+            FreeNodes = nullptr;
+        }
+        
         struct iterator
         {
             node* Node;
-            
-            iterator& operator++() 
-            { 
+            rstd_DebugOnly(node* DebugSentinel;)
+                
+                iterator& operator++() 
+            {
                 Node = Node->Next;
                 return *this;
             }
@@ -4233,57 +5886,104 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
                 return Res;
             }
             
-            type& operator*() 
-            { return Node->Data; }
+            iterator& operator--() 
+            { 
+                Node = Node->Prev;
+                return *this;
+            }
             
-            type* Ptr()
-            { return &Node->Data; }
+            iterator operator--(int)
+            {
+                auto Res = *this;
+                Node = Node->Prev;
+                return Res;
+            }
             
-            type* operator->() 
-            { return Ptr(); }
+            iterator& operator+=
+ (u32 Offset) 
+            {
+                while(Offset--)
+                    Node = Node->Next;
+                return *this;
+            }
             
-            rstd_bool operator==(iterator Rhs)
-            { return Node == Rhs.Node; }
+            iterator& operator-=
+ (u32 Offset)
+            {
+                while(Offset--)
+                    Node = Node->Prev;
+                return *this;
+            }
             
-            rstd_bool operator!=(iterator Rhs)
-            { return Node != Rhs.Node; }
-        };
-        
-        node* Nodes;
-        arena_ref ArenaRef;
-        
-        backward_singly_linked_list(arena_ref ArenaRef) 
-            :ArenaRef(ArenaRef), Nodes(nullptr) {}
-        
-        backward_singly_linked_list()
-            :ArenaRef(), Nodes(nullptr) {}
-        
-        iterator Begin()
-        { return {Nodes}; }
-        
-        iterator End()
-        { return {nullptr}; }
-        
-        internal_rstd_RestOfIteratorFunctions;
-        
-        rstd_bool Initialized()
-        { return ArenaRef; }
+            iterator operator+
+ (u32 Offset)
+            {
+                auto Res = *this;
+                return Res += Offset;
+            }
+            
+            iterator operator-
+ (u32 Offset)
+            {
+                auto Res = *this;
+                return Res -= Offset;
+            }
+            
+            u32 operator-
+ (iterator Rhs)
+            {
+                u32 Diff = 0;
+                while(Node != Rhs.Node)	
+                {
+                    Rhs = Rhs.Prev;
+                    ++Diff;
+                    rstd_Assert(Rhs.Node != DebugSentinel);
+                }
+                return Diff;
+            }
+            
+            // TODO: Should I remove Ptr() and leave just conversion operator?
+            type* Ptr()
+            { 
+                rstd_Assert(Node != DebugSentinel);
+                return &Node->Data;
+            }
+            
+            operator type*()
+            { return Ptr(); }
+            
+            type* operator->()
+            { return Ptr(); }
+            
+            type& operator*()
+            { return *Ptr(); }
+            
+            rstd_bool operator==(iterator Rhs)
+            { return Node == Rhs.Node; }
+            
+            rstd_bool operator!=(iterator Rhs)
+            { return Node != Rhs.Node; }
+        };
         
-        type& GetFirst()
+        iterator Begin()
         {
-            rstd_Assert(!Empty());
-            return Nodes->Data;
+            iterator It = {Sentinel->Next};
+            rstd_DebugOnly(It.DebugSentinel = Sentinel);
+            return It;
         }
         
-        type& GetLast()
+        iterator End()
         {
-            rstd_Assert(!Empty());
-            node* Node = Nodes;
-            while(Node && Node->Next)
-                Node = Node->Next;
-            return Node->Data;
+            iterator It = {Sentinel};
+            rstd_DebugOnly(It.DebugSentinel = Sentinel);
+            return It;
         }
         
+        internal_rstd_RestOfIteratorFunctions;
+        
+        rstd_bool Empty()
+        { return Sentinel->Next == Sentinel; }
+        
         type& operator[]
  (u32 DesiredIndex)
         {
@@ -4297,23 +5997,54 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
                 ++Index;
             }
             
-            rstd_InvalidCodePathM(Format<string<>>("You tried to get element [%], but this backward_singly_linked_list has only % elements", DesiredIndex, Index));
+            rstd_InvalidCodePathM(Format<string<>>("You tried to get element [%], but doubly_linked_list has only % elements", DesiredIndex, Index));
             return *(type*)(nullptr);
         }
         
-        void Clear()
-        { Nodes = nullptr; }
+        type& GetFirst()
+        {
+            rstd_Assert(!Empty());
+            return Sentinel->Next->Data;
+        }
         
-        rstd_bool Empty()
-        { return !Nodes; }
+        type& GetLast()
+        {
+            rstd_Assert(!Empty());
+            return Sentinel->Prev->Data;
+        }
+        
+        void SanityCheck()
+        {
+#if rstd_Debug
+            rstd_AssertM(Nodes, "You have to initialize list before using it!");
+            rstd_Assert(Nodes == Sentinel);
+            rstd_Assert(FreeNodes != Sentinel);
+            rstd_Assert(Sentinel->Next && Sentinel->Prev);
+            
+#ifdef rstd_EnableDoublyLinkedListAdvancedSanityCheck	
+            auto* Prev = Sentinel;
+            auto* Current = Sentinel->Next;
+            while(Current != Sentinel)
+            {
+                rstd_Assert(Current->Next);
+                rstd_Assert(Current->Prev);
+                rstd_Assert(Prev->Next == Current);
+                rstd_Assert(Current->Prev == Prev);
+                Prev = Current;
+                Current = Current->Next;
+            }
+#endif
+#endif
+        }
         
 #ifndef rstd_DisableWarningForUsingGetCountInListsWithoutCounter
- [[deprecated("\nConsider using backward_singly_linked_list_with_counter instead of backward_singly_linked_list\n"
+ [[deprecated("\nConsider using doubly_linked_list_with_counter instead of doubly_linked_list\n"
               "if you want to call GetCount(); in most cases that will result in better performance.\n"
               "If you want to get rid of this warning you can #define rstd_DisableWarningForUsingGetCountInListsWithoutCounter.")]]
 #endif
         u32 GetCount()
-        { 
+        {
+            SanityCheck();
             u32 Count = 0;
             for(auto& E : *this)
                 ++Count;
@@ -4321,187 +6052,132 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
         }
         
         void PushNode
- (node& Node)
+ (node* Node)
         {
-            Node.Next = Nodes;
-            Nodes = &Node;
+            auto* LastNode = Sentinel->Prev;
+            Sentinel->Prev = Node;
+            LastNode->Next = Node;
+            Node->Prev = LastNode;
+            Node->Next = Sentinel;
+            
+            SanityCheck();
+        }
+        
+        void PushNodeFront
+ (node* Node)
+        {
+            auto* FirstNode = Sentinel->Next;
+            Sentinel->Next = Node;
+            FirstNode->Prev = Node;
+            Node->Next = FirstNode;
+            Node->Prev = Sentinel;
+            
+            SanityCheck();
+        }
+        
+        node* PopFreeNode()
+        {
+            rstd_Assert(FreeNodes);
+            node* Node = FreeNodes;
+            FreeNodes = FreeNodes->Next;
+            return Node;
+        }
+        
+        node* AllocateZeroNode()
+        {
+            node* Node;
+            if(FreeNodes)
+            {
+                Node = PopFreeNode();
+                ZeroStruct(Node->Data);
+            }
+            else
+            {
+                Node = &rstd_PushStructZero(*ArenaRef, node);
+            }
+            return Node;
         }
         
+        node* AllocateUninitializedNode()
+        { return FreeNodes ? PopFreeNode() : &rstd_PushStructUninitialized(*ArenaRef, node); }
+        
         type& PushZero()
         {
-            rstd_Assert(ArenaRef);
-            auto& Node = rstd_PushStructZero(*ArenaRef, node);
+            node* Node = AllocateZeroNode();
             PushNode(Node);
-            return Node.Data;
+            return Node->Data;
         }
         
         type& PushUninitialized()
         {
-            rstd_Assert(ArenaRef);
-            auto& Node = rstd_PushStructUninitialized(*ArenaRef, node);
+            node* Node = AllocateUninitializedNode();
             PushNode(Node);
-            return Node.Data;
+            return Node->Data;
         }
         
-        type& PushAfter
- (node& NodeWhichWillBeBeforeThePushedOne, const type& InitialData)
+        type& PushFrontZero()
         {
-            rstd_Assert(ArenaRef);
-            auto& PushedNode = rstd_PushStructUninitialized(*ArenaRef, node);
-            PushedNode.Next = NodeWhichWillBeBeforeThePushedOne.Next;
-            NodeWhichWillBeBeforeThePushedOne.Next = &PushedNode;
-            PushedNode.Data = InitialData;
-            return PushedNode.Data;
+            node* Node = AllocateZeroNode();
+            PushNodeFront(Node);
+            return Node->Data;
         }
         
-        void Pop()
+        type& PushFrontUninitialized()
         {
-            rstd_Assert(!Empty());
-            Nodes = Nodes->Next; 
+            node* Node = AllocateUninitializedNode();
+            PushNodeFront(Node);
+            return Node->Data;
         }
         
-        node* PopLastNode()
+        void AddFreeNode
+ (node* Node)
         {
-            rstd_Assert(!Empty());
-            node* Node = Nodes;
-            while(Node && Node->Next->Next)
-                Node = Node->Next;
-            auto* NodeBeingPopped = Node->Next;
-            Node->Next = nullptr;
-            return NodeBeingPopped;
+            Node->Next = FreeNodes;
+            FreeNodes = Node;
         }
         
-        void PopLast()
-        { PopLastNode(); }
-        
-        type* PopLastReturnPtr()
-        { return &PopLastNode()->Data; }
-        
-        void Remove
- (type* ElementToRemove)
+        void Clear()
         {
-            node* NodeToRemove = (node*)ElementToRemove;	
+            SanityCheck();
             
-            if(NodeToRemove == Nodes)
-            {
-                Nodes = NodeToRemove->Next;
-            }
-            else
+            iterator Next;
+            for(auto It = Begin(); It != End(); It = Next)
             {
-                node* PrevNode = Nodes;
-                for(auto* Node = Nodes->Next;; Node = Node->Next)
-                {
-                    rstd_AssertM(Node, "You're trying to remove thing that is not in this container");
-                    if(Node == NodeToRemove)
-                    {
-                        PrevNode->Next = Node->Next;
-                        break;
-                    }
-                    PrevNode = Node;
-                }
+                Next = It + 1;
+                AddFreeNode(It.Node);
             }
+            
+            Sentinel->Next = Sentinel;
+            Sentinel->Prev = Sentinel;
         }
         
-        // NOTE: returns true if found element to remove
-        template<class comparison_fn>
-            rstd_bool RemoveFirstIf
- (comparison_fn Comparison)
+        void Remove
+ (node* Node)
         {
-            node* PrevNode = nullptr;
-            for(auto* Node = Nodes; Node; Node = Node->Next)
-            {
-                if(Comparison(Node->Data))
-                {
-                    if(PrevNode)
-                        PrevNode->Next = Node->Next;	
-                    else
-                        Nodes = Node->Next;
-                    return true;
-                }
-                else
-                {
-                    PrevNode = Node;
-                }
-            }
-            return false;
-        }
-        
-        template<class comparison_fn>
-            void RemoveFirstIfWithAssert
- (comparison_fn Comparison)
-        {
-            rstd_bool ManagedToRemove = RemoveFirstIf(Comparison);	
-            rstd_AssertM(ManagedToRemove, "Element which meets the condition of removal wasn't found!");
+            rstd_Assert(!Empty());
+            
+            Node->Prev->Next = Node->Next;
+            Node->Next->Prev = Node->Prev;
+            AddFreeNode(Node);
+            
+            SanityCheck();
         }
         
-        template<class comparison_fn>
-            optional<type> RemoveFirstIfReturnCopy
- (comparison_fn Comparison)
+        iterator Remove
+ (iterator It)
         {
-            node* PrevNode = nullptr;
-            for(auto* Node = Nodes; Node; Node = Node->Next)
-            {
-                if(Comparison(Node->Data))
-                {
-                    if(PrevNode)
-                        PrevNode->Next = Node->Next;	
-                    else
-                        Nodes = Node->Next;
-                    return {Node->Data};
-                }
-                else
-                {
-                    PrevNode = Node;
-                }
-            }
-            return {};
+            Remove(It.Node);
+            return --It;
         }
         
-        template<class comparison_fn>
-            type RemoveFirstIfWithAssertReturnCopy
- (comparison_fn Comparison)
-        {
-            node* PrevNode = nullptr;
-            for(auto* Node = Nodes; Node; Node = Node->Next)
-            {
-                if(Comparison(Node->Data))
-                {
-                    if(PrevNode)
-                        PrevNode->Next = Node->Next;	
-                    else
-                        Nodes = Node->Next;
-                    return Node->Data;
-                }
-                else
-                {
-                    PrevNode = Node;
-                }
-            }
-            rstd_InvalidCodePathM("Element which meets the condition of removal wasn't found!");
-            return {};
-        }
+        void Remove(type& E)
+        { Remove((node*)&E); }
         
-        rstd_bool RemoveFirstEqualTo
- (type& E)
-        {
-            node* PrevNode = nullptr;
-            for(auto* Node = Nodes; Node; Node = Node->Next)
-            {
-                if(Node->Data == E)
-                {
-                    if(PrevNode)
-                        PrevNode->Next = Node->Next;	
-                    else
-                        Nodes = Node->Next;
-                    return true;
-                }
-                else
-                {
-                    PrevNode = Node;
-                }
-            }
-            return false;
-        }
+        void PopFirst()
+        { Remove(GetFirst()); }
+        
+        void PopLast()
+        { Remove(GetLast()); }
         
         template<class compare_type>               
             type* FindEqual                            
@@ -4677,7 +6353,7 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
             return Push(ThingToCompareOrInitialData); 
         } 
         
-        // TODO: Do args need to be templated?
+        /* TODO(now): Do args need to be templated? */ 
         template<class... args> 
             void Push 
  (const type& CurrentPushElement, const args&&... NextPushElements) 
@@ -4685,1890 +6361,7377 @@ InternalPushStringCopy(_Arena, _InitString, rstd_GetCallingInfo())
             Push(CurrentPushElement); 
             Push(NextPushElements...); 
         }
-    };
-    
-    template<class type>
-        struct doubly_linked_list_with_counter : doubly_linked_list<type>
-    {
-        using typename doubly_linked_list<type>::node;
-        using typename doubly_linked_list<type>::iterator;
         
-        doubly_linked_list_with_counter(arena_ref ArenaRef)
-            :doubly_linked_list<type>(ArenaRef), Count(0) {}
+        type& PushFront 
+ (const type& InitialData) 
+        { 
+            auto& Data = PushFrontUninitialized(); 
+            Data = InitialData; 
+            return Data; 
+        }
         
-        doubly_linked_list_with_counter()
-            :doubly_linked_list<type>(), Count(0) {}
+        template<class comparison_fn> 
+            type* PushFrontIfUnique 
+ (const type& InitialData, comparison_fn Comparison) 
+        { 
+            if(!Has(Comparison)) 
+                return &PushFront(InitialData); 
+            return nullptr; 
+        } 
         
-        u32 Count;
+        template<class compare_type> 
+            rstd_bool RemoveFirstEqualTo 
+ (const compare_type& ThingToCompare) 
+        { 
+            if(auto* Found = FindEqual(ThingToCompare)) 
+            { 
+                Remove(*Found); 
+                return true; 
+            } 
+            return false; 
+        } 
         
-        u32 GetCount()
-        { return Count; }
+        template<class compare_type> 
+            void RemoveFirstEqualToWithAssert 
+ (const compare_type& ThingToCompare) 
+        { 
+            bool ManagedToRemove = RemoveFirstEqualTo(ThingToCompare); 
+            rstd_Assert(ManagedToRemove); 
+        } 
         
-        using doubly_linked_list<type>::Find;
+        template<class comparison_fn> 
+            rstd_bool RemoveFirstIf 
+ (comparison_fn Comparison) 
+        { 
+            if(auto* Found = Find(Comparison)) 
+            { 
+                Remove(*Found); 
+                return true; 
+            } 
+            return false; 
+        } 
         
-        void Clear()
-        {
-            doubly_linked_list<type>::Clear();
-            Count = 0;
-        }
+        template<class comparison_fn> 
+            void RemoveFirstIfWithAssert 
+ (comparison_fn Comparison) 
+        { 
+            bool ManagedToRemove = RemoveFirstIf(Comparison); 
+            rstd_Assert(ManagedToRemove); 
+        } 
         
-        void PushNode
- (node* Node)
-        {
-            ++Count;
-            doubly_linked_list<type>::PushNode(Node);
-        }
+        template<class comparison_fn> 
+            optional<type> RemoveFirstIfReturnCopy 
+ (comparison_fn Comparison) 
+        { 
+            if(auto* Found = Find(Comparison)) 
+            { 
+                Remove(*Found); 
+                return {*Found}; 
+            } 
+            return {}; 
+        } 
         
-        void PushNodeFront
- (node* Node)
-        {
-            ++Count;
-            doubly_linked_list<type>::PushNodeFront(Node);
-        }
+        template<class comparison_fn> 
+            u32 RemoveIf 
+ (comparison_fn Comparison) 
+        { 
+            u32 RemovedCount = 0; 
+            for(auto It = Begin(); It != End(); ++It) 
+            { 
+                if(Comparison(*It)) 
+                { 
+                    Remove(It); 
+                    ++RemovedCount; 
+                } 
+            } 
+            return RemovedCount; 
+        } 
         
-        void PopFreeNode
- (node* Node)
-        {
-            --Count;
-            doubly_linked_list<type>::PopFreeNode(Node);
-        }
+        type GetAndPopFirst() 
+        { 
+            auto FirstCopy = GetFirst(); 
+            PopFirst(); 
+            return FirstCopy; 
+        } 
         
-        type& PushZero()
-        {
-            ++Count;
-            return doubly_linked_list<type>::PushZero();
-        }
+        rstd_bool PopFirstIfNotEmpty() 
+        { 
+            if(Empty()) 
+            { 
+                return false; 
+            } 
+            else 
+            { 
+                PopFirst(); 
+                return true; 
+            } 
+        } 
         
-        type& PushUninitialized()
-        {
-            ++Count;
-            return doubly_linked_list<type>::PushUninitialized();
-        }
+        optional<type> GetAndPopFirstIfNotEmpty() 
+        { 
+            if(Empty()) 
+            { 
+                return {}; 
+            } 
+            else 
+            { 
+                auto* First = &GetFirst(); 
+                type FirstCopy = *First; 
+                Remove(First); 
+                return FirstCopy; 
+            } 
+        } 
         
-        type& Push
- (const type& InitialData)
-        {
-            ++Count;
-            return doubly_linked_list<type>::Push(InitialData);
-        }
+        rstd_bool PopLastIfNotEmpty() 
+        { 
+            if(Empty()) 
+            { 
+                return false; 
+            } 
+            else 
+            { 
+                PopLast(); 
+                return true; 
+            } 
+        } 
         
-        type& PushFrontZero()
-        {
-            ++Count;
-            return doubly_linked_list<type>::PushFrontZero();
-        }
+        type GetAndPopLast() 
+        { 
+            type LastCopy = GetLast(); 
+            PopLast(); 
+            return LastCopy; 
+        } 
         
-        type& PushFrontUninitialized()
-        {
-            ++Count;
-            return doubly_linked_list<type>::PushFrontUninitialized();
+        optional<type> GetAndPopLastIfNotEmpty() 
+        { 
+            if(Empty()) 
+            { 
+                return {}; 
+            } 
+            else 
+            { 
+                auto* Last = &GetLast(); 
+                type LastCopy = *Last; 
+                Remove(Last); 
+                return LastCopy; 
+            } 
         }
         
-        type& PushFront
- (const type& InitialData)
-        {
-            ++Count;
-            return doubly_linked_list<type>::PushFront(InitialData);
-        }
+    };
+    
+    ///////////////////
+    // UNROLLED LIST //
+    ///////////////////
+    // NOTE: Node of about 256 bytes, but at least 4 elements
+    template<class type>
+        constexpr u32 GetDefaultUnrolledListNodeSize()
+    {
+        size Res = (256 - 2*sizeof(void*) - sizeof(u32)) / sizeof(type);
+        return Res > 4 ? (u32)Res : 4;
+    }
+    
+    // NOTE: doubly_linked_list that keeps up to elements_per_node elements packed in every node,
+    // so small types don't pay for two pointers each and iteration takes one cache miss per node instead of per element.
+    // Full node is split in half when you insert into it, node that drops under half full is merged with its neighbour.
+    // Elements move when others are inserted or removed around them, so unlike doubly_linked_list pointers to them
+    // are not stable and Remove(type&) has to look for the node, prefer Remove(iterator).
+    template<class type, u32 elements_per_node = GetDefaultUnrolledListNodeSize<type>()>
+        struct unrolled_list
+    {
+        static_assert(elements_per_node >= 2, "unrolled_list node has to hold at least 2 elements");
         
-        type* PushIfUnique
- (const type& InitialData)
+        struct node
         {
-            ++Count;
-            return doubly_linked_list<type>::PushIfUnique(InitialData);
-        }
+            node* Next;
+            node* Prev;
+            u32 Count;
+            type Elements[elements_per_node];
+        };
         
-        type& GetIfExistsOrPushIfUnique
- (const type& E)
+        arena_ref ArenaRef;
+        node* Sentinel;
+        node* FreeNodes;
+        u32 Count;
+        
+        rstd_bool Initialized()
+        { return Sentinel; }
+        
+        unrolled_list()
+        { Sentinel = nullptr; }
+        
+        unrolled_list
+ (arena_ref ArenaRef)
         {
-            auto* Found = Find(*this, E);
-            if(Found)
-                return *Found;
-            return Push(E);
+            this->ArenaRef = ArenaRef;
+            Sentinel = &rstd_PushStructUninitializedAligned(*ArenaRef, node);
+            Sentinel->Next = Sentinel;
+            Sentinel->Prev = Sentinel;
+            Sentinel->Count = 0;
+            FreeNodes = nullptr;
+            Count = 0;
         }
         
-        void Remove
- (node* Node)
+        struct iterator
         {
-            doubly_linked_list<type>::Remove(Node);
-            --Count;
-        }
+            node* Node;
+            u32 Index;
+            rstd_DebugOnly(node* DebugSentinel;)
+                
+                iterator& operator++() 
+            {
+                // NOTE: >= because iterator before the first element is Sentinel with Index MaxU32
+                if(++Index >= Node->Count)
+                {
+                    Node = Node->Next;
+                    Index = 0;
+                }
+                return *this;
+            }
+            
+            iterator operator++(int)
+            {
+                auto Res = *this;
+                ++*this;
+                return Res;
+            }
+            
+            iterator& operator--() 
+            { 
+                if(Index == 0)
+                {
+                    Node = Node->Prev;
+                    Index = Node->Count;
+                }
+                --Index;
+                return *this;
+            }
+            
+            iterator operator--(int)
+            {
+                auto Res = *this;
+                --*this;
+                return Res;
+            }
+            
+            iterator& operator+=
+ (u32 Offset) 
+            {
+                // NOTE: Whole nodes are skipped by their Count
+                while(Offset >= Node->Count - Index && Node->Count)
+                {
+                    Offset -= Node->Count - Index;
+                    Node = Node->Next;
+                    Index = 0;
+                }
+                Index += Offset;
+                return *this;
+            }
+            
+            iterator& operator-=
+ (u32 Offset)
+            {
+                while(Offset > Index)
+                {
+                    Offset -= Index + 1;
+                    Node = Node->Prev;
+                    Index = Node->Count - 1;
+                }
+                Index -= Offset;
+                return *this;
+            }
+            
+            iterator operator+
+ (u32 Offset)
+            {
+                auto Res = *this;
+                return Res += Offset;
+            }
+            
+            iterator operator-
+ (u32 Offset)
+            {
+                auto Res = *this;
+                return Res -= Offset;
+            }
+            
+            type* Ptr()
+            { 
+                rstd_Assert(Node != DebugSentinel);
+                return Node->Elements + Index;
+            }
+            
+            operator type*()
+            { return Ptr(); }
+            
+            type* operator->()
+            { return Ptr(); }
+            
+            type& operator*()
+            { return *Ptr(); }
+            
+            rstd_bool operator==(iterator Rhs)
+            { return Node == Rhs.Node && Index == Rhs.Index; }
+            
+            rstd_bool operator!=(iterator Rhs)
+            { return !(*this == Rhs); }
+        };
         
-        iterator Remove
- (iterator It)
+        iterator MakeIterator
+ (node* Node, u32 Index)
         {
-            iterator Res = doubly_linked_list<type>::Remove(It);
-            --Count;
-            return Res;
+            iterator It = {Node, Index};
+            rstd_DebugOnly(It.DebugSentinel = Sentinel);
+            return It;
         }
         
-        void Remove
- (type& ElementToRemove)
+        iterator Begin()
+        { return MakeIterator(Sentinel->Next, 0); }
+        
+        iterator End()
+        { return MakeIterator(Sentinel, 0); }
+        
+        internal_rstd_RestOfIteratorFunctions;
+        
+        rstd_bool Empty()
+        { return Count == 0; }
+        
+        u32 GetCount()
+        { return Count; }
+        
+        u32 GetNodeCount()
         {
-            --Count;
-            doubly_linked_list<type>::Remove(ElementToRemove);
+            u32 Res = 0;
+            for(node* Node = Sentinel->Next; Node != Sentinel; Node = Node->Next)
+                ++Res;
+            return Res;
         }
         
-        void PopFirst()
+        type& operator[]
+ (u32 Index)
         {
-            doubly_linked_list<type>::PopFirst();
-            --Count;
+            rstd_AssertM(Index < Count,
+                         "You tried to get element [%], but unrolled_list has only % elements", Index, Count);
+            return *(Begin() + Index);
         }
         
-        rstd_bool PopFirstIfNotEmpty()
+        type& GetFirst()
         {
-            rstd_bool Res = doubly_linked_list<type>::Empty();
-            if(Res)
-            {
-                PopFirst();
-                --Count;
-            }
-            return Res;
+            rstd_Assert(!Empty());
+            return Sentinel->Next->Elements[0];
         }
         
-        type GetAndPopFirst()
+        type& GetLast()
         {
-            --Count;
-            return doubly_linked_list<type>::GetAndPopFirst();
+            rstd_Assert(!Empty());
+            return Sentinel->Prev->Elements[Sentinel->Prev->Count - 1];
         }
         
-        optional<type> GetAndPopFirstIfNotEmpty()
+        node* AllocateNode()
         {
-            if(doubly_linked_list<type>::Empty())
+            rstd_AssertM(Sentinel, "You have to initialize list before using it!");
+            node* Node;
+            if(FreeNodes)
             {
-                return {};
+                Node = FreeNodes;
+                FreeNodes = FreeNodes->Next;
             }
             else
             {
-                auto* First = &doubly_linked_list<type>::GetFirst();
-                type FirstCopy = *First;
-                Remove(First);
-                return FirstCopy;
+                Node = &rstd_PushStructUninitializedAligned(*ArenaRef, node);
             }
+            Node->Count = 0;
+            return Node;
         }
         
-        void PopLast()
+        node* InsertNodeAfter
+ (node* Prev)
         {
-            doubly_linked_list<type>::PopLast();
-            --Count;
+            node* Node = AllocateNode();
+            Node->Prev = Prev;
+            Node->Next = Prev->Next;
+            Prev->Next->Prev = Node;
+            Prev->Next = Node;
+            return Node;
         }
         
-        rstd_bool PopLastIfNotEmpty()
+        void RemoveNode
+ (node* Node)
         {
-            rstd_bool Res = doubly_linked_list<type>::Empty();
-            if(Res)
-            {
-                PopLast();
-                --Count;
-            }
-            return Res;
+            Node->Prev->Next = Node->Next;
+            Node->Next->Prev = Node->Prev;
+            Node->Next = FreeNodes;
+            FreeNodes = Node;
         }
         
-        type GetAndPopLast()
+        type& PushUninitialized()
         {
-            --Count;
-            return doubly_linked_list<type>::GetAndPopLast();
+            node* Last = Sentinel->Prev;
+            if(Last == Sentinel || Last->Count == elements_per_node)
+                Last = InsertNodeAfter(Last);
+            ++Count;
+            return Last->Elements[Last->Count++];
         }
         
-        optional<type> GetAndPopLastIfNotEmpty()
+        type& PushZero()
         {
-            if(doubly_linked_list<type>::Empty())
-            {
-                return {};
-            }
-            else
-            {
-                auto* Last = &doubly_linked_list<type>::GetLast();
-                type LastCopy = *Last;
-                Remove(Last);
-                return LastCopy;
-            }
+            auto& Data = PushUninitialized();
+            ZeroStruct(Data);
+            return Data;
         }
         
-        // NOTE: returns true if found element to remove
-        template<class comparison_fn>
-            rstd_bool RemoveFirstIf
- (comparison_fn Comparison)
+        type& PushFrontUninitialized()
         {
-            if(auto* Found = Find(Comparison))
-            {
-                Remove(*Found);
-                return true;
-            }
-            return false;
+            node* First = Sentinel->Next;
+            if(First == Sentinel || First->Count == elements_per_node)
+                First = InsertNodeAfter(Sentinel);
+            memmove(First->Elements + 1, First->Elements, First->Count * sizeof(type));
+            ++First->Count;
+            ++Count;
+            return First->Elements[0];
         }
         
-        template<class comparison_fn>
-            optional<type> RemoveFirstIfReturnCopy
- (comparison_fn Comparison)
+        type& PushFrontZero()
         {
-            if(auto* Found = Find(Comparison))
-            {
-                Remove(*Found);
-                return {*Found};
-            }
-            return {};
+            auto& Data = PushFrontUninitialized();
+            ZeroStruct(Data);
+            return Data;
         }
         
-        rstd_bool RemoveFirstEqualTo
- (type& E)
+        // NOTE: Inserts before Position
+        type& InsertUninitialized
+ (iterator Position)
         {
-            if(auto* Found = FindEqual(E))
+            node* Node = Position.Node;
+            u32 Index = Position.Index;
+            if(Node == Sentinel)
+                return PushUninitialized();
+            
+            if(Node->Count == elements_per_node)
             {
-                Remove(*Found);
-                return true;
+                node* NewNode = InsertNodeAfter(Node);
+                u32 Half = elements_per_node / 2;
+                NewNode->Count = elements_per_node - Half;
+                memcpy(NewNode->Elements, Node->Elements + Half, NewNode->Count * sizeof(type));
+                Node->Count = Half;
+                if(Index > Half)
+                {
+                    Node = NewNode;
+                    Index -= Half;
+                }
             }
-            return false;
+            
+            memmove(Node->Elements + Index + 1, Node->Elements + Index, (Node->Count - Index) * sizeof(type));
+            ++Node->Count;
+            ++Count;
+            return Node->Elements[Index];
         }
-    };
-    
-    template<class type>
-        struct singly_linked_list_with_counter : singly_linked_list<type>
-    {
-        using typename singly_linked_list<type>::node;
-        
-        singly_linked_list_with_counter(arena_ref ArenaRef)
-            :singly_linked_list<type>(ArenaRef), Count(0) {}
-        
-        singly_linked_list_with_counter()
-            :singly_linked_list<type>(), Count(0) {}
         
-        u32 Count;
-        
-        u32 GetCount()
-        { return Count; }
+        type& Insert
+ (iterator Position, const type& InitialData)
+        {
+            auto& Data = InsertUninitialized(Position);
+            Data = InitialData;
+            return Data;
+        }
         
         void Clear()
         {
-            singly_linked_list<type>::Clear();
+            while(Sentinel->Next != Sentinel)
+                RemoveNode(Sentinel->Next);
             Count = 0;
         }
         
-        void PushNodeFront(node* Node)
+        // NOTE: Returns iterator before the removed element, like doubly_linked_list does
+        iterator Remove
+ (iterator It)
         {
-            ++Count;
-            singly_linked_list<type>::PushNodeFront(Node);
+            rstd_Assert(!Empty());
+            node* Node = It.Node;
+            u32 Index = It.Index;
+            rstd_Assert(Node != Sentinel && Index < Node->Count);
+            
+            memmove(Node->Elements + Index, Node->Elements + Index + 1, (Node->Count - Index - 1) * sizeof(type));
+            --Node->Count;
+            --Count;
+            
+            if(Node->Count < elements_per_node / 2)
+            {
+                node* Next = Node->Next;
+                node* Prev = Node->Prev;
+                if(Next != Sentinel && Node->Count + Next->Count <= elements_per_node)
+                {
+                    memcpy(Node->Elements + Node->Count, Next->Elements, Next->Count * sizeof(type));
+                    Node->Count += Next->Count;
+                    RemoveNode(Next);
+                }
+                else if(Prev != Sentinel && Prev->Count + Node->Count <= elements_per_node)
+                {
+                    memcpy(Prev->Elements + Prev->Count, Node->Elements, Node->Count * sizeof(type));
+                    Index += Prev->Count;
+                    Prev->Count += Node->Count;
+                    RemoveNode(Node);
+                    Node = Prev;
+                }
+                else if(Node->Count == 0)
+                {
+                    RemoveNode(Node);
+                    return MakeIterator(Prev, Prev->Count ? Prev->Count - 1 : MaxU32);
+                }
+            }
+            
+            if(Index)
+                return MakeIterator(Node, Index - 1);
+            node* Prev = Node->Prev;
+            return MakeIterator(Prev, Prev->Count ? Prev->Count - 1 : MaxU32);
         }
         
-        type& PushFrontZero()
+        void Remove
+ (type* E)
         {
-            ++Count;
-            return singly_linked_list<type>::PushFrontZero();
+            for(node* Node = Sentinel->Next; Node != Sentinel; Node = Node->Next)
+            {
+                if(E >= Node->Elements && E < Node->Elements + Node->Count)
+                {
+                    Remove(MakeIterator(Node, (u32)(E - Node->Elements)));
+                    return;
+                }
+            }
+            rstd_InvalidCodePathM("You tried to remove element that is not in this unrolled_list");
         }
         
-        type& PushFrontUninitialized()
-        {
-            ++Count;
-            return singly_linked_list<type>::PushFrontUninitialized();
-        }
+        void Remove(type& E)
+        { Remove(&E); }
         
-        type& PushFront
- (const type& InitialData)
-        {
-            ++Count;
-            return singly_linked_list<type>::PushFront(InitialData);
-        }
+        void PopFirst()
+        { Remove(Begin()); }
         
-        void PushNode(node* Node)
-        {
-            ++Count;
-            singly_linked_list<type>::PushNode(Node);
-        }
+        void PopLast()
+        { Remove(MakeIterator(Sentinel->Prev, Sentinel->Prev->Count - 1)); }
         
-        type& PushZero()
-        {
-            ++Count;
-            return singly_linked_list<type>::PushZero();
-        }
+        template<class compare_type>               
+            type* FindEqual                            
+ (const compare_type& ThingToComare)        
+        {                                          
+            for(auto& Element : *this)         
+            {                                      
+                if(Element == ThingToComare)               
+                    return &Element;               
+            }                                      
+            return nullptr;                        
+        }                                          
         
-        type& PushUninitialized()
-        {
-            ++Count;
-            return singly_linked_list<type>::PushUninitialized();
-        }
+        template<class comparison_fn>        
+            type* Find                           
+ (comparison_fn Comparison)           
+        {                                    
+            for(auto& Element : *this)       
+            {                                
+                if(Comparison(Element))      
+                    return &Element;         
+            }                                
+            return nullptr;                  
+        }                                    
         
-        type& Push
- (const type& InitialData)
-        {
-            ++Count;
-            return singly_linked_list<type>::Push(InitialData);
-        }
+        template<class comparison_fn> 
+            auto& FindWithAssert 
+ (comparison_fn Comparison) 
+        { 
+            auto* Found = Find(Comparison); 
+            rstd_Assert(Found); 
+            return *Found; 
+        } 
         
-        type& PushAfter
- (node* NodeWhichWillBeBeforeThePushedOne, const type& InitialData)
-        {
-            ++Count;
-            return singly_linked_list<type>::PushAfter(NodeWhichWillBeBeforeThePushedOne, InitialData);
-        }
+        template<class compare_type> 
+            rstd_bool HasEqual 
+ (const compare_type& ThingToCompare) 
+        { return (rstd_bool)FindEqual(ThingToCompare); } 
         
-        type* PushIfUnique
- (const type& InitialData)
-        {
-            ++Count;
-            return singly_linked_list<type>::PushIfUnique(InitialData);
-        }
+        template<class comparison_fn> 
+            rstd_bool Has 
+ (comparison_fn Comparison) 
+        { return (rstd_bool)Find(Comparison); } 
         
-        type& GetIfExistsOrPushIfUnique
- (const type& E)
-        {
-            auto* Found = Find(this, E);
-            if(Found)
-                return *Found;
-            return Push(E);
-        }
+        template<class compare_type> 
+            u32 FindIndexOfFirstEqual 
+ (const compare_type& ThingToCompare) 
+        { 
+            u32 ElementIndex = 0; 
+            for(auto& Element : *this) 
+            { 
+                if(Element == ThingToCompare) 
+                    return ElementIndex; 
+                ++ElementIndex; 
+            } 
+            return InvalidU32; 
+        } 
         
-        void PopFront()
-        {
-            --Count;
-            singly_linked_list<type>::PopFront();
-        }
+        template<class comparison_fn> 
+            u32 FindIndexOfFirst 
+ (comparison_fn Comparison) 
+        { 
+            u32 ElementIndex = 0; 
+            for(auto& Element : *this) 
+            { 
+                if(Comparison(Element)) 
+                    return ElementIndex; 
+                ++ElementIndex; 
+            } 
+            return InvalidU32; 
+        } 
         
-        void Pop()
-        {
-            --Count;
-            singly_linked_list<type>::Pop();
-        }
+        template<class compare_type> 
+            u32 HowManyEqualHas 
+ (const compare_type& ThingToCompare) 
+        { 
+            u32 Res = 0; 
+            for(auto& Element : *this) 
+            { 
+                if(Element == ThingToCompare) 
+                    ++Res; 
+            } 
+            return Res; 
+        } 
         
-        void Remove
- (type& ElementToRemove)
-        {
-            --Count;
-            singly_linked_list<type>::Remove(ElementToRemove);
-        }
+        template<class comparison_fn> 
+            u32 HowManyHas 
+ (comparison_fn Comparison) 
+        { 
+            u32 Res = 0; 
+            for(auto& Element : *this) 
+            { 
+                if(Comparison(Element)) 
+                    ++Res; 
+            } 
+            return Res; 
+        } 
         
-        template<class comparison_fn>
-            rstd_bool RemoveFirstIf
- (comparison_fn Comparison)
-        {
-            rstd_bool ManagedToRemove = singly_linked_list<type>::RemoveFirstIf(Comparison);
-            if(ManagedToRemove)
-                --Count;
-            return ManagedToRemove;
-        }
+        struct get_value_and_index_result 
+        { 
+            type* Value; 
+            u32 Index; 
+            
+            operator rstd_bool() 
+            { return Value; } 
+            
+            type* operator->() 
+            { 	 
+                rstd_Assert(Value); 
+                return Value; 
+            } 
+        }; 
         
-        template<class comparison_fn>
-            optional<type> RemoveFirstIfReturnCopy
- (comparison_fn Comparison)
-        {
-            auto Res = singly_linked_list<type>::RemoveFirstIfReturnCopy(Comparison);
-            if(Res)
-                --Count;
-            return Res;
-        }
-        
-        rstd_bool RemoveFirstEqualTo
- (type& E)
-        {
-            rstd_bool ManagedToRemove = singly_linked_list<type>::RemoveFirstEqualTo(E);
-            if(ManagedToRemove)
-                --Count;
-            return ManagedToRemove;
+        template<class comparison_fn> 
+            get_value_and_index_result FindValueAndIndex 
+ (comparison_fn Comparison) 
+        { 
+            get_value_and_index_result Res = {}; 
+            for(auto& E : *this) 
+            { 
+                if(Comparison(E)) 
+                { 
+                    Res.Value = &E; 
+                    break; 
+                } 
+                ++Res.Index; 
+            } 
+            return Res; 
         }
-    };
-    
-    template<class type>
-        struct backward_singly_linked_list_with_counter : backward_singly_linked_list<type>
-    {
-        using typename backward_singly_linked_list<type>::node;
         
-        backward_singly_linked_list_with_counter(arena_ref ArenaRef)
-            :backward_singly_linked_list<type>(ArenaRef), Count(0) {}
+        type& Push 
+ (const type& InitialData) 
+        { 
+            auto& Data = PushUninitialized(); 
+            Data = InitialData; 
+            return Data; 
+        } 
         
-        backward_singly_linked_list_with_counter()
-            :backward_singly_linked_list<type>(), Count(0) {}
+        type& PushDefault() 
+        { 
+            type E; 
+            return Push(E); 
+        } 
         
-        u32 Count;
+        type* PushIfNotFull 
+ (const type& InitialData) 
+        { 
+            return &Push(InitialData); 
+        } 
         
-        u32 GetCount()
-        { return Count; }
+        type* PushIfUnique 
+ (const type& InitialData) 
+        { 
+            if(!HasEqual(InitialData)) 
+                return &Push(InitialData); 
+            return nullptr; 
+        } 
         
-        void Clear()
-        {
-            backward_singly_linked_list<type>::Clear();
-            Count = 0;
-        }
+        template<class comparison_fn> 
+            type* PushIfUnique
+ (const type& InitialData, comparison_fn Comparison) 
+        { 
+            if(!Has(Comparison)) 
+                return &Push(InitialData); 
+            return nullptr; 
+        } 
         
-        void PushNode
- (node& Node)
-        {
-            ++Count;
-            backward_singly_linked_list<type>::PushNode(Node);
-        }
+        type& GetIfExistsOrPushIfUnique 
+ (const type& ThingToCompareOrInitialData) 
+        { 
+            if(auto* Found = Find(ThingToCompareOrInitialData)) 
+                return *Found; 
+            return Push(ThingToCompareOrInitialData); 
+        } 
         
-        type& PushZero()
-        {
-            ++Count;
-            return backward_singly_linked_list<type>::PushZero();
+        /* TODO(now): Do args need to be templated? */ 
+        template<class... args> 
+            void Push 
+ (const type& CurrentPushElement, const args&&... NextPushElements) 
+        { 
+            Push(CurrentPushElement); 
+            Push(NextPushElements...); 
         }
         
-        type& PushUninitialized()
-        {
-            ++Count;
-            return backward_singly_linked_list<type>::PushUninitialized();
+        type& PushFront 
+ (const type& InitialData) 
+        { 
+            auto& Data = PushFrontUninitialized(); 
+            Data = InitialData; 
+            return Data; 
         }
         
-        type& Push
- (const type& InitialData)
-        {
-            ++Count;
-            return backward_singly_linked_list<type>::Push(InitialData);
-        }
+        template<class comparison_fn> 
+            type* PushFrontIfUnique 
+ (const type& InitialData, comparison_fn Comparison) 
+        { 
+            if(!Has(Comparison)) 
+                return &PushFront(InitialData); 
+            return nullptr; 
+        } 
         
-        type& PushAfter
- (node& NodeWhichWillBeBeforeThePushedOne, const type& InitialData)
-        {
-            ++Count;
-            return backward_singly_linked_list<type>::PushAfter(NodeWhichWillBeBeforeThePushedOne, InitialData);
-        }
+        template<class compare_type> 
+            rstd_bool RemoveFirstEqualTo 
+ (const compare_type& ThingToCompare) 
+        { 
+            if(auto* Found = FindEqual(ThingToCompare)) 
+            { 
+                Remove(*Found); 
+                return true; 
+            } 
+            return false; 
+        } 
         
-        type* PushIfUnique
- (const type& InitialData)
-        {
-            ++Count;
-            return backward_singly_linked_list<type>::PushIfUnique(InitialData);
-        }
+        template<class compare_type> 
+            void RemoveFirstEqualToWithAssert 
+ (const compare_type& ThingToCompare) 
+        { 
+            bool ManagedToRemove = RemoveFirstEqualTo(ThingToCompare); 
+            rstd_Assert(ManagedToRemove); 
+        } 
         
-        type& GetIfExistsOrPushIfUnique
- (const type& E)
-        {
-            auto* Found = Find(*this, E);
-            if(Found)
-                return *Found;
-            return Push(E);
-        }
+        template<class comparison_fn> 
+            rstd_bool RemoveFirstIf 
+ (comparison_fn Comparison) 
+        { 
+            if(auto* Found = Find(Comparison)) 
+            { 
+                Remove(*Found); 
+                return true; 
+            } 
+            return false; 
+        } 
         
-        void Pop()
-        {
-            --Count;
-            backward_singly_linked_list<type>::Pop();
-        }
+        template<class comparison_fn> 
+            void RemoveFirstIfWithAssert 
+ (comparison_fn Comparison) 
+        { 
+            bool ManagedToRemove = RemoveFirstIf(Comparison); 
+            rstd_Assert(ManagedToRemove); 
+        } 
         
-        void PopLast()
-        {
-            --Count;
-            backward_singly_linked_list<type>::PopLast();
-        }
+        template<class comparison_fn> 
+            optional<type> RemoveFirstIfReturnCopy 
+ (comparison_fn Comparison) 
+        { 
+            if(auto* Found = Find(Comparison)) 
+            { 
+                optional<type> Res = {*Found}; 
+                Remove(*Found); 
+                return Res; 
+            } 
+            return {}; 
+        } 
         
-        node* PopLastNode()
-        {
-            --Count;
-            return backward_singly_linked_list<type>::PopLastNode();
-        }
+        template<class comparison_fn> 
+            u32 RemoveIf 
+ (comparison_fn Comparison) 
+        { 
+            u32 RemovedCount = 0; 
+            for(auto It = Begin(); It != End(); ++It) 
+            { 
+                if(Comparison(*It)) 
+                { 
+                    It = Remove(It); 
+                    ++RemovedCount; 
+                } 
+            } 
+            return RemovedCount; 
+        } 
         
-        type* PopLastReturnPtr()
-        {
-            --Count;
-            return backward_singly_linked_list<type>::PopLastReturnPtr();
-        }
+        type GetAndPopFirst() 
+        { 
+            auto FirstCopy = GetFirst(); 
+            PopFirst(); 
+            return FirstCopy; 
+        } 
         
-        void Remove
- (type* ElementToRemove)
-        {
-            --Count;
-            backward_singly_linked_list<type>::Remove(ElementToRemove);
-        }
+        rstd_bool PopFirstIfNotEmpty() 
+        { 
+            if(Empty()) 
+            { 
+                return false; 
+            } 
+            else 
+            { 
+                PopFirst(); 
+                return true; 
+            } 
+        } 
         
-        template<class comparison_fn>
-            rstd_bool RemoveFirstIf
+        optional<type> GetAndPopFirstIfNotEmpty() 
+        { 
+            if(Empty()) 
+            { 
+                return {}; 
+            } 
+            else 
+            { 
+                auto* First = &GetFirst(); 
+                type FirstCopy = *First; 
+                Remove(First); 
+                return FirstCopy; 
+            } 
+        } 
+        
+        rstd_bool PopLastIfNotEmpty() 
+        { 
+            if(Empty()) 
+            { 
+                return false; 
+            } 
+            else 
+            { 
+                PopLast(); 
+                return true; 
+            } 
+        } 
+        
+        type GetAndPopLast() 
+        { 
+            type LastCopy = GetLast(); 
+            PopLast(); 
+            return LastCopy; 
+        } 
+        
+        optional<type> GetAndPopLastIfNotEmpty() 
+        { 
+            if(Empty()) 
+            { 
+                return {}; 
+            } 
+            else 
+            { 
+                auto* Last = &GetLast(); 
+                type LastCopy = *Last; 
+                Remove(Last); 
+                return LastCopy; 
+            } 
+        }
+        
+    };
+    
+    // TODO: Add memory debugging for singly_linked_list
+    template<class type>
+        struct singly_linked_list
+    {
+        struct node
+        {
+            type Data;
+            node* Next;
+        };
+        
+        struct iterator
+        {
+            node* Node;
+            
+            iterator& operator++() 
+            { 
+                Node = Node->Next;
+                return *this;
+            }
+            
+            iterator operator++(int)
+            {
+                auto Res = *this;
+                Node = Node->Next;
+                return Res;
+            }
+            
+            type& operator*() 
+            { return Node->Data; }
+            
+            type* Ptr()
+            { return &Node->Data; }
+            
+            type* operator->() 
+            { return Ptr(); }
+            
+            rstd_bool operator==(iterator Rhs)
+            { return Node == Rhs.Node; }
+            
+            rstd_bool operator!=(iterator Rhs)
+            { return Node != Rhs.Node; }
+        };
+        
+        node* FirstNode;
+        node* LastNode;
+        node* FreeNodes;
+        arena_ref ArenaRef;
+        
+        void AddFreeNode
+ (node* Node)
+        {
+            Node->Next = FreeNodes;
+            FreeNodes = Node;
+        }
+        
+        node* AllocateUninitializedNode()
+        {
+            rstd_Assert(ArenaRef);
+            if(!FreeNodes)
+                return &rstd_PushStructUninitialized(*ArenaRef, node);
+            node* Node = FreeNodes;
+            FreeNodes = FreeNodes->Next;
+            return Node;
+        }
+        
+        node* AllocateZeroNode()
+        {
+            rstd_Assert(ArenaRef);
+            if(!FreeNodes)
+                return &rstd_PushStructZero(*ArenaRef, node);
+            node* Node = AllocateUninitializedNode();
+            ZeroStruct(*Node);
+            return Node;
+        }
+        
+        void Clear()
+        {
+            if(LastNode)
+            {
+                LastNode->Next = FreeNodes;
+                FreeNodes = FirstNode;
+            }
+            FirstNode = LastNode = nullptr;
+        }
+        
+        void Init
+ (arena_ref ArenaRef)
+        {	
+            rstd_AssertM(!this->ArenaRef, "It's already initialized!");
+            this->ArenaRef = ArenaRef;
+            FirstNode = LastNode = FreeNodes = nullptr;
+        }
+        
+        singly_linked_list(arena_ref ArenaRef) 
+        { Init(ArenaRef); }
+        
+        singly_linked_list()
+            :FirstNode(nullptr), LastNode(nullptr), FreeNodes(nullptr), ArenaRef() {}
+        
+        iterator Begin()
+        { return {FirstNode}; }
+        
+        iterator End()
+        { return {nullptr}; }
+        
+        internal_rstd_RestOfIteratorFunctions;
+        
+        rstd_bool Initialized()
+        { return ArenaRef; }
+        
+        rstd_bool Empty()
+        { return !FirstNode; }
+        
+        type& GetFirst()
+        {
+            rstd_Assert(!Empty());
+            return FirstNode->Data;
+        }
+        
+        type& GetLast()
+        {
+            rstd_Assert(!Empty());
+            return LastNode->Data;
+        }
+        
+#ifndef rstd_DisableWarningForUsingGetCountInListsWithoutCounter
+ [[deprecated("\nConsider using singly_linked_list_with_counter instead of singly_linked_list\n"
+              "if you want to call GetCount(); in most cases that will result in better performance.\n"
+              "If you want to get rid of this warning you can #define rstd_DisableWarningForUsingGetCountInListsWithoutCounter.")]]
+#endif
+        u32 GetCount()
+        { 
+            u32 Count = 0;
+            for(auto& E : *this)
+                ++Count;
+            return Count;
+        }
+        
+        void PushNode
+ (node& Node)
+        {
+            if(LastNode)
+                LastNode->Next = &Node;
+            LastNode = &Node;
+            if(!FirstNode)
+                FirstNode = &Node;
+        }
+        
+        void PushNodeFront
+ (node& Node)
+        {
+            Node.Next = FirstNode;
+            FirstNode = &Node;
+            if(!LastNode)
+                LastNode = FirstNode;
+        }
+        
+        type& PushZero()
+        {
+            auto& Node = *AllocateZeroNode();
+            PushNode(Node);
+            return Node.Data;
+        }
+        
+        type& PushUninitialized()
+        {
+            auto& Node = *AllocateUninitializedNode();
+            Node.Next = nullptr;
+            PushNode(Node);
+            return Node.Data;
+        }
+        
+        type& PushFrontZero()
+        {
+            auto& Node = *AllocateZeroNode();
+            PushNodeFront(Node);
+            return Node.Data;
+        }
+        
+        type& PushFrontUninitialized()
+        {
+            auto& Node = *AllocateUninitializedNode();
+            PushNodeFront(Node);
+            return Node.Data;
+        }
+        
+        type& PushAfter
+ (node* NodeWhichWillBeBeforeThePushedOne)
+        {
+            auto* PushedNode = AllocateUninitializedNode();
+            PushedNode->Next = NodeWhichWillBeBeforeThePushedOne->Next;
+            if(!PushedNode->Next)
+                LastNode = PushedNode;
+            NodeWhichWillBeBeforeThePushedOne->Next = PushedNode;
+            return PushedNode->Data;
+        }
+        
+        type& PushAfter
+ (node* NodeWhichWillBeBeforeThePushedOne, const type& InitialData)
+        {
+            auto& Data = PushAfter(NodeWhichWillBeBeforeThePushedOne);
+            Data = InitialData;
+            return Data;
+        }
+        
+        void PopFront()
+        {
+            rstd_Assert(!Empty());
+            auto* PoppedNode = FirstNode;
+            FirstNode = FirstNode->Next;
+            if(!FirstNode)
+                LastNode = nullptr;
+            AddFreeNode(PoppedNode);
+        }
+        
+        void Pop()
+        {
+            rstd_Assert(!Empty());
+            auto* PoppedNode = LastNode;
+            if(FirstNode->Next)
+            {
+                auto* Node = FirstNode;
+                while(Node->Next != LastNode)
+                    Node = Node->Next;
+                Node->Next = nullptr;	
+                LastNode = Node;
+            }
+            else
+            {
+                FirstNode = LastNode = nullptr;
+            }
+            AddFreeNode(PoppedNode);
+        }
+        
+        // NOTE: Node goes to free list, so data is valid only until the next push
+        void RemoveNode
+ (node* PrevNode, node* Node)
+        {
+            if(PrevNode)
+                PrevNode->Next = Node->Next;
+            else
+                FirstNode = Node->Next;
+            if(Node == LastNode)
+                LastNode = PrevNode;
+            AddFreeNode(Node);
+        }
+        
+        void Remove
+ (type* ElementToRemove)
+        {
+            node* NodeToRemove = (node*)ElementToRemove;	
+            
+            node* PrevNode = nullptr;
+            for(auto* Node = FirstNode;; Node = Node->Next)
+            {
+                rstd_AssertM(Node, "You're trying to remove thing that is not in this container");
+                if(Node == NodeToRemove)
+                {
+                    RemoveNode(PrevNode, Node);
+                    break;
+                }
+                PrevNode = Node;
+            }
+        }
+        
+        // NOTE: returns true if found element to remove
+        template<class comparison_fn>
+            rstd_bool RemoveFirstIf
+ (comparison_fn Comparison)
+        {
+            node* PrevNode = nullptr;
+            for(auto* Node = FirstNode; Node; Node = Node->Next)
+            {
+                if(Comparison(Node->Data))
+                {
+                    RemoveNode(PrevNode, Node);
+                    return true;
+                }
+                else
+                {
+                    PrevNode = Node;
+                }
+            }
+            return false;
+        }
+        
+        template<class comparison_fn>
+            optional<type> RemoveFirstIfReturnCopy
+ (comparison_fn Comparison)
+        {
+            node* PrevNode = nullptr;
+            for(auto* Node = FirstNode; Node; Node = Node->Next)
+            {
+                if(Comparison(Node->Data))
+                {
+                    optional<type> Res = {Node->Data};
+                    RemoveNode(PrevNode, Node);
+                    return Res;
+                }
+                else
+                {
+                    PrevNode = Node;
+                }
+            }
+            return {};
+        }
+        
+        rstd_bool RemoveFirstEqualTo
+ (type& E)
+        {
+            node* PrevNode = nullptr;
+            for(auto* Node = FirstNode; Node; Node = Node->Next)
+            {
+                if(Node->Data == E)
+                {
+                    RemoveNode(PrevNode, Node);
+                    return true;
+                }
+                else
+                {
+                    PrevNode = Node;
+                }
+            }
+            return false;
+        }
+        
+        template<class compare_type>               
+            type* FindEqual                            
+ (const compare_type& ThingToComare)        
+        {                                          
+            for(auto& Element : *this)         
+            {                                      
+                if(Element == ThingToComare)               
+                    return &Element;               
+            }                                      
+            return nullptr;                        
+        }                                          
+        
+        template<class comparison_fn>        
+            type* Find                           
+ (comparison_fn Comparison)           
+        {                                    
+            for(auto& Element : *this)       
+            {                                
+                if(Comparison(Element))      
+                    return &Element;         
+            }                                
+            return nullptr;                  
+        }                                    
+        
+        template<class comparison_fn> 
+            auto& FindWithAssert 
+ (comparison_fn Comparison) 
+        { 
+            auto* Found = Find(Comparison); 
+            rstd_Assert(Found); 
+            return *Found; 
+        } 
+        
+        template<class compare_type> 
+            rstd_bool HasEqual 
+ (const compare_type& ThingToCompare) 
+        { return (rstd_bool)FindEqual(ThingToCompare); } 
+        
+        template<class comparison_fn> 
+            rstd_bool Has 
+ (comparison_fn Comparison) 
+        { return (rstd_bool)Find(Comparison); } 
+        
+        template<class compare_type> 
+            u32 FindIndexOfFirstEqual 
+ (const compare_type& ThingToCompare) 
+        { 
+            u32 ElementIndex = 0; 
+            for(auto& Element : *this) 
+            { 
+                if(Element == ThingToCompare) 
+                    return ElementIndex; 
+                ++ElementIndex; 
+            } 
+            return InvalidU32; 
+        } 
+        
+        template<class comparison_fn> 
+            u32 FindIndexOfFirst 
+ (comparison_fn Comparison) 
+        { 
+            u32 ElementIndex = 0; 
+            for(auto& Element : *this) 
+            { 
+                if(Comparison(Element)) 
+                    return ElementIndex; 
+                ++ElementIndex; 
+            } 
+            return InvalidU32; 
+        } 
+        
+        template<class compare_type> 
+            u32 HowManyEqualHas 
+ (const compare_type& ThingToCompare) 
+        { 
+            u32 Res = 0; 
+            for(auto& Element : *this) 
+            { 
+                if(Element == ThingToCompare) 
+                    ++Res; 
+            } 
+            return Res; 
+        } 
+        
+        template<class comparison_fn> 
+            u32 HowManyHas 
+ (comparison_fn Comparison) 
+        { 
+            u32 Res = 0; 
+            for(auto& Element : *this) 
+            { 
+                if(Comparison(Element)) 
+                    ++Res; 
+            } 
+            return Res; 
+        } 
+        
+        struct get_value_and_index_result 
+        { 
+            type* Value; 
+            u32 Index; 
+            
+            operator rstd_bool() 
+            { return Value; } 
+            
+            type* operator->() 
+            { 	 
+                rstd_Assert(Value); 
+                return Value; 
+            } 
+        }; 
+        
+        template<class comparison_fn> 
+            get_value_and_index_result FindValueAndIndex 
+ (comparison_fn Comparison) 
+        { 
+            get_value_and_index_result Res = {}; 
+            for(auto& E : *this) 
+            { 
+                if(Comparison(E)) 
+                { 
+                    Res.Value = &E; 
+                    break; 
+                } 
+                ++Res.Index; 
+            } 
+            return Res; 
+        }
+        
+        type& Push 
+ (const type& InitialData)
+        { 
+            auto& Data = PushUninitialized(); 
+            Data = InitialData; 
+            return Data; 
+        } 
+        
+        type& PushDefault() 
+        { 
+            type E; 
+            return Push(E); 
+        } 
+        
+        type* PushIfNotFull 
+ (const type& InitialData) 
+        { 
+            return &Push(InitialData); 
+        } 
+        
+        type* PushIfUnique 
+ (const type& InitialData) 
+        { 
+            if(!HasEqual(InitialData)) 
+                return &Push(InitialData); 
+            return nullptr; 
+        } 
+        
+        template<class comparison_fn> 
+            type* PushIfUnique
+ (const type& InitialData, comparison_fn Comparison) 
+        { 
+            if(!Has(Comparison)) 
+                return &Push(InitialData); 
+            return nullptr; 
+        } 
+        
+        type& GetIfExistsOrPushIfUnique 
+ (const type& ThingToCompareOrInitialData) 
+        { 
+            if(auto* Found = Find(ThingToCompareOrInitialData)) 
+                return *Found; 
+            return Push(ThingToCompareOrInitialData); 
+        } 
+        
+        /* TODO(now): Do args need to be templated? */ 
+        template<class... args> 
+            void Push 
+ (const type& CurrentPushElement, const args&&... NextPushElements) 
+        { 
+            Push(CurrentPushElement); 
+            Push(NextPushElements...); 
+        }
+        
+        type& PushFront 
+ (const type& InitialData) 
+        { 
+            auto& Data = PushFrontUninitialized(); 
+            Data = InitialData; 
+            return Data; 
+        }
+        
+        template<class comparison_fn> 
+            type* PushFrontIfUnique 
+ (const type& InitialData, comparison_fn Comparison) 
+        { 
+            if(!Has(Comparison)) 
+                return &PushFront(InitialData); 
+            return nullptr; 
+        } 
+        
+    };
+    
+    // TODO: Add memory debugging for backward_singly_linked_list
+    template<class type>
+        struct backward_singly_linked_list
+    {
+        struct node
+        {
+            type Data;
+            node* Next;
+        };
+        
+        struct iterator
+        {
+            node* Node;
+            
+            iterator& operator++() 
+            { 
+                Node = Node->Next;
+                return *this;
+            }
+            
+            iterator operator++(int)
+            {
+                auto Res = *this;
+                Node = Node->Next;
+                return Res;
+            }
+            
+            type& operator*() 
+            { return Node->Data; }
+            
+            type* Ptr()
+            { return &Node->Data; }
+            
+            type* operator->() 
+            { return Ptr(); }
+            
+            rstd_bool operator==(iterator Rhs)
+            { return Node == Rhs.Node; }
+            
+            rstd_bool operator!=(iterator Rhs)
+            { return Node != Rhs.Node; }
+        };
+        
+        node* Nodes;
+        node* FreeNodes;
+        arena_ref ArenaRef;
+        
+        backward_singly_linked_list(arena_ref ArenaRef) 
+            :Nodes(nullptr), FreeNodes(nullptr), ArenaRef(ArenaRef) {}
+        
+        backward_singly_linked_list()
+            :Nodes(nullptr), FreeNodes(nullptr), ArenaRef() {}
+        
+        void AddFreeNode
+ (node* Node)
+        {
+            Node->Next = FreeNodes;
+            FreeNodes = Node;
+        }
+        
+        node* AllocateUninitializedNode()
+        {
+            rstd_Assert(ArenaRef);
+            if(!FreeNodes)
+                return &rstd_PushStructUninitialized(*ArenaRef, node);
+            node* Node = FreeNodes;
+            FreeNodes = FreeNodes->Next;
+            return Node;
+        }
+        
+        node* AllocateZeroNode()
+        {
+            rstd_Assert(ArenaRef);
+            if(!FreeNodes)
+                return &rstd_PushStructZero(*ArenaRef, node);
+            node* Node = AllocateUninitializedNode();
+            ZeroStruct(*Node);
+            return Node;
+        }
+        
+        iterator Begin()
+        { return {Nodes}; }
+        
+        iterator End()
+        { return {nullptr}; }
+        
+        internal_rstd_RestOfIteratorFunctions;
+        
+        rstd_bool Initialized()
+        { return ArenaRef; }
+        
+        type& GetFirst()
+        {
+            rstd_Assert(!Empty());
+            return Nodes->Data;
+        }
+        
+        type& GetLast()
+        {
+            rstd_Assert(!Empty());
+            node* Node = Nodes;
+            while(Node && Node->Next)
+                Node = Node->Next;
+            return Node->Data;
+        }
+        
+        type& operator[]
+ (u32 DesiredIndex)
+        {
+            rstd_Assert(!Empty());
+            
+            u32 Index = 0;
+            for(auto& E : *this)
+            {
+                if(Index == DesiredIndex)
+                    return E;
+                ++Index;
+            }
+            
+            rstd_InvalidCodePathM(Format<string<>>("You tried to get element [%], but this backward_singly_linked_list has only % elements", DesiredIndex, Index));
+            return *(type*)(nullptr);
+        }
+        
+        void Clear()
+        {
+            while(Nodes)
+            {
+                auto* Next = Nodes->Next;
+                AddFreeNode(Nodes);
+                Nodes = Next;
+            }
+        }
+        
+        rstd_bool Empty()
+        { return !Nodes; }
+        
+#ifndef rstd_DisableWarningForUsingGetCountInListsWithoutCounter
+ [[deprecated("\nConsider using backward_singly_linked_list_with_counter instead of backward_singly_linked_list\n"
+              "if you want to call GetCount(); in most cases that will result in better performance.\n"
+              "If you want to get rid of this warning you can #define rstd_DisableWarningForUsingGetCountInListsWithoutCounter.")]]
+#endif
+        u32 GetCount()
+        { 
+            u32 Count = 0;
+            for(auto& E : *this)
+                ++Count;
+            return Count;
+        }
+        
+        void PushNode
+ (node& Node)
+        {
+            Node.Next = Nodes;
+            Nodes = &Node;
+        }
+        
+        type& PushZero()
+        {
+            auto& Node = *AllocateZeroNode();
+            PushNode(Node);
+            return Node.Data;
+        }
+        
+        type& PushUninitialized()
+        {
+            auto& Node = *AllocateUninitializedNode();
+            PushNode(Node);
+            return Node.Data;
+        }
+        
+        type& PushAfter
+ (node& NodeWhichWillBeBeforeThePushedOne, const type& InitialData)
+        {
+            auto& PushedNode = *AllocateUninitializedNode();
+            PushedNode.Next = NodeWhichWillBeBeforeThePushedOne.Next;
+            NodeWhichWillBeBeforeThePushedOne.Next = &PushedNode;
+            PushedNode.Data = InitialData;
+            return PushedNode.Data;
+        }
+        
+        void Pop()
+        {
+            rstd_Assert(!Empty());
+            auto* PoppedNode = Nodes;
+            Nodes = Nodes->Next; 
+            AddFreeNode(PoppedNode);
+        }
+        
+        // NOTE: Popped node goes to free list, so its data is valid only until the next push
+        node* PopLastNode()
+        {
+            rstd_Assert(!Empty());
+            node* NodeBeingPopped = Nodes;
+            if(Nodes->Next)
+            {
+                node* Node = Nodes;
+                while(Node->Next->Next)
+                    Node = Node->Next;
+                NodeBeingPopped = Node->Next;
+                Node->Next = nullptr;
+            }
+            else
+            {
+                Nodes = nullptr;
+            }
+            AddFreeNode(NodeBeingPopped);
+            return NodeBeingPopped;
+        }
+        
+        void PopLast()
+        { PopLastNode(); }
+        
+        type* PopLastReturnPtr()
+        { return &PopLastNode()->Data; }
+        
+        void RemoveNode
+ (node* PrevNode, node* Node)
+        {
+            if(PrevNode)
+                PrevNode->Next = Node->Next;
+            else
+                Nodes = Node->Next;
+            AddFreeNode(Node);
+        }
+        
+        void Remove
+ (type* ElementToRemove)
+        {
+            node* NodeToRemove = (node*)ElementToRemove;	
+            
+            node* PrevNode = nullptr;
+            for(auto* Node = Nodes;; Node = Node->Next)
+            {
+                rstd_AssertM(Node, "You're trying to remove thing that is not in this container");
+                if(Node == NodeToRemove)
+                {
+                    RemoveNode(PrevNode, Node);
+                    break;
+                }
+                PrevNode = Node;
+            }
+        }
+        
+        // NOTE: returns true if found element to remove
+        template<class comparison_fn>
+            rstd_bool RemoveFirstIf
+ (comparison_fn Comparison)
+        {
+            node* PrevNode = nullptr;
+            for(auto* Node = Nodes; Node; Node = Node->Next)
+            {
+                if(Comparison(Node->Data))
+                {
+                    RemoveNode(PrevNode, Node);
+                    return true;
+                }
+                else
+                {
+                    PrevNode = Node;
+                }
+            }
+            return false;
+        }
+        
+        template<class comparison_fn>
+            void RemoveFirstIfWithAssert
+ (comparison_fn Comparison)
+        {
+            rstd_bool ManagedToRemove = RemoveFirstIf(Comparison);	
+            rstd_AssertM(ManagedToRemove, "Element which meets the condition of removal wasn't found!");
+        }
+        
+        template<class comparison_fn>
+            optional<type> RemoveFirstIfReturnCopy
+ (comparison_fn Comparison)
+        {
+            node* PrevNode = nullptr;
+            for(auto* Node = Nodes; Node; Node = Node->Next)
+            {
+                if(Comparison(Node->Data))
+                {
+                    optional<type> Res = {Node->Data};
+                    RemoveNode(PrevNode, Node);
+                    return Res;
+                }
+                else
+                {
+                    PrevNode = Node;
+                }
+            }
+            return {};
+        }
+        
+        template<class comparison_fn>
+            type RemoveFirstIfWithAssertReturnCopy
+ (comparison_fn Comparison)
+        {
+            node* PrevNode = nullptr;
+            for(auto* Node = Nodes; Node; Node = Node->Next)
+            {
+                if(Comparison(Node->Data))
+                {
+                    type Res = Node->Data;
+                    RemoveNode(PrevNode, Node);
+                    return Res;
+                }
+                else
+                {
+                    PrevNode = Node;
+                }
+            }
+            rstd_InvalidCodePathM("Element which meets the condition of removal wasn't found!");
+            return {};
+        }
+        
+        rstd_bool RemoveFirstEqualTo
+ (type& E)
+        {
+            node* PrevNode = nullptr;
+            for(auto* Node = Nodes; Node; Node = Node->Next)
+            {
+                if(Node->Data == E)
+                {
+                    RemoveNode(PrevNode, Node);
+                    return true;
+                }
+                else
+                {
+                    PrevNode = Node;
+                }
+            }
+            return false;
+        }
+        
+        template<class compare_type>               
+            type* FindEqual                            
+ (const compare_type& ThingToComare)        
+        {                                          
+            for(auto& Element : *this)         
+            {                                      
+                if(Element == ThingToComare)               
+                    return &Element;               
+            }                                      
+            return nullptr;                        
+        }                                          
+        
+        template<class comparison_fn>        
+            type* Find                           
+ (comparison_fn Comparison)           
+        {                                    
+            for(auto& Element : *this)       
+            {                                
+                if(Comparison(Element))      
+                    return &Element;         
+            }                                
+            return nullptr;                  
+        }                                    
+        
+        template<class comparison_fn> 
+            auto& FindWithAssert 
+ (comparison_fn Comparison) 
+        { 
+            auto* Found = Find(Comparison); 
+            rstd_Assert(Found); 
+            return *Found; 
+        } 
+        
+        template<class compare_type> 
+            rstd_bool HasEqual 
+ (const compare_type& ThingToCompare) 
+        { return (rstd_bool)FindEqual(ThingToCompare); } 
+        
+        template<class comparison_fn> 
+            rstd_bool Has 
+ (comparison_fn Comparison) 
+        { return (rstd_bool)Find(Comparison); } 
+        
+        template<class compare_type> 
+            u32 FindIndexOfFirstEqual 
+ (const compare_type& ThingToCompare) 
+        { 
+            u32 ElementIndex = 0; 
+            for(auto& Element : *this) 
+            { 
+                if(Element == ThingToCompare) 
+                    return ElementIndex; 
+                ++ElementIndex; 
+            } 
+            return InvalidU32; 
+        } 
+        
+        template<class comparison_fn> 
+            u32 FindIndexOfFirst 
+ (comparison_fn Comparison) 
+        { 
+            u32 ElementIndex = 0; 
+            for(auto& Element : *this) 
+            { 
+                if(Comparison(Element)) 
+                    return ElementIndex; 
+                ++ElementIndex; 
+            } 
+            return InvalidU32; 
+        } 
+        
+        template<class compare_type> 
+            u32 HowManyEqualHas 
+ (const compare_type& ThingToCompare) 
+        { 
+            u32 Res = 0; 
+            for(auto& Element : *this) 
+            { 
+                if(Element == ThingToCompare) 
+                    ++Res; 
+            } 
+            return Res; 
+        } 
+        
+        template<class comparison_fn> 
+            u32 HowManyHas 
+ (comparison_fn Comparison) 
+        { 
+            u32 Res = 0; 
+            for(auto& Element : *this) 
+            { 
+                if(Comparison(Element)) 
+                    ++Res; 
+            } 
+            return Res; 
+        } 
+        
+        struct get_value_and_index_result 
+        { 
+            type* Value; 
+            u32 Index; 
+            
+            operator rstd_bool() 
+            { return Value; } 
+            
+            type* operator->() 
+            { 	 
+                rstd_Assert(Value); 
+                return Value; 
+            } 
+        }; 
+        
+        template<class comparison_fn> 
+            get_value_and_index_result FindValueAndIndex 
+ (comparison_fn Comparison) 
+        { 
+            get_value_and_index_result Res = {}; 
+            for(auto& E : *this) 
+            { 
+                if(Comparison(E)) 
+                { 
+                    Res.Value = &E; 
+                    break; 
+                } 
+                ++Res.Index; 
+            } 
+            return Res; 
+        }
+        
+        type& Push 
+ (const type& InitialData) 
+        { 
+            auto& Data = PushUninitialized(); 
+            Data = InitialData; 
+            return Data; 
+        } 
+        
+        type& PushDefault() 
+        { 
+            type E; 
+            return Push(E); 
+        } 
+        
+        type* PushIfNotFull 
+ (const type& InitialData) 
+        { 
+            return &Push(InitialData); 
+        } 
+        
+        type* PushIfUnique 
+ (const type& InitialData) 
+        { 
+            if(!HasEqual(InitialData)) 
+                return &Push(InitialData); 
+            return nullptr; 
+        } 
+        
+        template<class comparison_fn> 
+            type* PushIfUnique
+ (const type& InitialData, comparison_fn Comparison) 
+        { 
+            if(!Has(Comparison)) 
+                return &Push(InitialData); 
+            return nullptr; 
+        } 
+        
+        type& GetIfExistsOrPushIfUnique 
+ (const type& ThingToCompareOrInitialData) 
+        { 
+            if(auto* Found = Find(ThingToCompareOrInitialData)) 
+                return *Found; 
+            return Push(ThingToCompareOrInitialData); 
+        } 
+        
+        // TODO: Do args need to be templated?
+        template<class... args> 
+            void Push 
+ (const type& CurrentPushElement, const args&&... NextPushElements) 
+        { 
+            Push(CurrentPushElement); 
+            Push(NextPushElements...); 
+        }
+    };
+    
+    template<class type>
+        struct doubly_linked_list_with_counter : doubly_linked_list<type>
+    {
+        using typename doubly_linked_list<type>::node;
+        using typename doubly_linked_list<type>::iterator;
+        
+        doubly_linked_list_with_counter(arena_ref ArenaRef)
+            :doubly_linked_list<type>(ArenaRef), Count(0) {}
+        
+        doubly_linked_list_with_counter()
+            :doubly_linked_list<type>(), Count(0) {}
+        
+        u32 Count;
+        
+        u32 GetCount()
+        { return Count; }
+        
+        using doubly_linked_list<type>::Find;
+        
+        void Clear()
+        {
+            doubly_linked_list<type>::Clear();
+            Count = 0;
+        }
+        
+        void PushNode
+ (node* Node)
+        {
+            ++Count;
+            doubly_linked_list<type>::PushNode(Node);
+        }
+        
+        void PushNodeFront
+ (node* Node)
+        {
+            ++Count;
+            doubly_linked_list<type>::PushNodeFront(Node);
+        }
+        
+        void PopFreeNode
+ (node* Node)
+        {
+            --Count;
+            doubly_linked_list<type>::PopFreeNode(Node);
+        }
+        
+        type& PushZero()
+        {
+            ++Count;
+            return doubly_linked_list<type>::PushZero();
+        }
+        
+        type& PushUninitialized()
+        {
+            ++Count;
+            return doubly_linked_list<type>::PushUninitialized();
+        }
+        
+        type& Push
+ (const type& InitialData)
+        {
+            ++Count;
+            return doubly_linked_list<type>::Push(InitialData);
+        }
+        
+        type& PushFrontZero()
+        {
+            ++Count;
+            return doubly_linked_list<type>::PushFrontZero();
+        }
+        
+        type& PushFrontUninitialized()
+        {
+            ++Count;
+            return doubly_linked_list<type>::PushFrontUninitialized();
+        }
+        
+        type& PushFront
+ (const type& InitialData)
+        {
+            ++Count;
+            return doubly_linked_list<type>::PushFront(InitialData);
+        }
+        
+        type* PushIfUnique
+ (const type& InitialData)
+        {
+            ++Count;
+            return doubly_linked_list<type>::PushIfUnique(InitialData);
+        }
+        
+        type& GetIfExistsOrPushIfUnique
+ (const type& E)
+        {
+            auto* Found = Find(*this, E);
+            if(Found)
+                return *Found;
+            return Push(E);
+        }
+        
+        void Remove
+ (node* Node)
+        {
+            doubly_linked_list<type>::Remove(Node);
+            --Count;
+        }
+        
+        iterator Remove
+ (iterator It)
+        {
+            iterator Res = doubly_linked_list<type>::Remove(It);
+            --Count;
+            return Res;
+        }
+        
+        void Remove
+ (type& ElementToRemove)
+        {
+            --Count;
+            doubly_linked_list<type>::Remove(ElementToRemove);
+        }
+        
+        void PopFirst()
+        {
+            doubly_linked_list<type>::PopFirst();
+            --Count;
+        }
+        
+        rstd_bool PopFirstIfNotEmpty()
+        {
+            rstd_bool Res = doubly_linked_list<type>::Empty();
+            if(Res)
+            {
+                PopFirst();
+                --Count;
+            }
+            return Res;
+        }
+        
+        type GetAndPopFirst()
+        {
+            --Count;
+            return doubly_linked_list<type>::GetAndPopFirst();
+        }
+        
+        optional<type> GetAndPopFirstIfNotEmpty()
+        {
+            if(doubly_linked_list<type>::Empty())
+            {
+                return {};
+            }
+            else
+            {
+                auto* First = &doubly_linked_list<type>::GetFirst();
+                type FirstCopy = *First;
+                Remove(First);
+                return FirstCopy;
+            }
+        }
+        
+        void PopLast()
+        {
+            doubly_linked_list<type>::PopLast();
+            --Count;
+        }
+        
+        rstd_bool PopLastIfNotEmpty()
+        {
+            rstd_bool Res = doubly_linked_list<type>::Empty();
+            if(Res)
+            {
+                PopLast();
+                --Count;
+            }
+            return Res;
+        }
+        
+        type GetAndPopLast()
+        {
+            --Count;
+            return doubly_linked_list<type>::GetAndPopLast();
+        }
+        
+        optional<type> GetAndPopLastIfNotEmpty()
+        {
+            if(doubly_linked_list<type>::Empty())
+            {
+                return {};
+            }
+            else
+            {
+                auto* Last = &doubly_linked_list<type>::GetLast();
+                type LastCopy = *Last;
+                Remove(Last);
+                return LastCopy;
+            }
+        }
+        
+        // NOTE: returns true if found element to remove
+        template<class comparison_fn>
+            rstd_bool RemoveFirstIf
+ (comparison_fn Comparison)
+        {
+            if(auto* Found = Find(Comparison))
+            {
+                Remove(*Found);
+                return true;
+            }
+            return false;
+        }
+        
+        template<class comparison_fn>
+            optional<type> RemoveFirstIfReturnCopy
+ (comparison_fn Comparison)
+        {
+            if(auto* Found = Find(Comparison))
+            {
+                Remove(*Found);
+                return {*Found};
+            }
+            return {};
+        }
+        
+        rstd_bool RemoveFirstEqualTo
+ (type& E)
+        {
+            if(auto* Found = FindEqual(E))
+            {
+                Remove(*Found);
+                return true;
+            }
+            return false;
+        }
+    };
+    
+    template<class type>
+        struct singly_linked_list_with_counter : singly_linked_list<type>
+    {
+        using typename singly_linked_list<type>::node;
+        
+        singly_linked_list_with_counter(arena_ref ArenaRef)
+            :singly_linked_list<type>(ArenaRef), Count(0) {}
+        
+        singly_linked_list_with_counter()
+            :singly_linked_list<type>(), Count(0) {}
+        
+        u32 Count;
+        
+        u32 GetCount()
+        { return Count; }
+        
+        void Clear()
+        {
+            singly_linked_list<type>::Clear();
+            Count = 0;
+        }
+        
+        void PushNodeFront(node* Node)
+        {
+            ++Count;
+            singly_linked_list<type>::PushNodeFront(Node);
+        }
+        
+        type& PushFrontZero()
+        {
+            ++Count;
+            return singly_linked_list<type>::PushFrontZero();
+        }
+        
+        type& PushFrontUninitialized()
+        {
+            ++Count;
+            return singly_linked_list<type>::PushFrontUninitialized();
+        }
+        
+        type& PushFront
+ (const type& InitialData)
+        {
+            ++Count;
+            return singly_linked_list<type>::PushFront(InitialData);
+        }
+        
+        void PushNode(node* Node)
+        {
+            ++Count;
+            singly_linked_list<type>::PushNode(Node);
+        }
+        
+        type& PushZero()
+        {
+            ++Count;
+            return singly_linked_list<type>::PushZero();
+        }
+        
+        type& PushUninitialized()
+        {
+            ++Count;
+            return singly_linked_list<type>::PushUninitialized();
+        }
+        
+        type& Push
+ (const type& InitialData)
+        {
+            ++Count;
+            return singly_linked_list<type>::Push(InitialData);
+        }
+        
+        type& PushAfter
+ (node* NodeWhichWillBeBeforeThePushedOne, const type& InitialData)
+        {
+            ++Count;
+            return singly_linked_list<type>::PushAfter(NodeWhichWillBeBeforeThePushedOne, InitialData);
+        }
+        
+        type* PushIfUnique
+ (const type& InitialData)
+        {
+            ++Count;
+            return singly_linked_list<type>::PushIfUnique(InitialData);
+        }
+        
+        type& GetIfExistsOrPushIfUnique
+ (const type& E)
+        {
+            auto* Found = Find(this, E);
+            if(Found)
+                return *Found;
+            return Push(E);
+        }
+        
+        void PopFront()
+        {
+            --Count;
+            singly_linked_list<type>::PopFront();
+        }
+        
+        void Pop()
+        {
+            --Count;
+            singly_linked_list<type>::Pop();
+        }
+        
+        void Remove
+ (type& ElementToRemove)
+        {
+            --Count;
+            singly_linked_list<type>::Remove(ElementToRemove);
+        }
+        
+        template<class comparison_fn>
+            rstd_bool RemoveFirstIf
+ (comparison_fn Comparison)
+        {
+            rstd_bool ManagedToRemove = singly_linked_list<type>::RemoveFirstIf(Comparison);
+            if(ManagedToRemove)
+                --Count;
+            return ManagedToRemove;
+        }
+        
+        template<class comparison_fn>
+            optional<type> RemoveFirstIfReturnCopy
+ (comparison_fn Comparison)
+        {
+            auto Res = singly_linked_list<type>::RemoveFirstIfReturnCopy(Comparison);
+            if(Res)
+                --Count;
+            return Res;
+        }
+        
+        rstd_bool RemoveFirstEqualTo
+ (type& E)
+        {
+            rstd_bool ManagedToRemove = singly_linked_list<type>::RemoveFirstEqualTo(E);
+            if(ManagedToRemove)
+                --Count;
+            return ManagedToRemove;
+        }
+    };
+    
+    template<class type>
+        struct backward_singly_linked_list_with_counter : backward_singly_linked_list<type>
+    {
+        using typename backward_singly_linked_list<type>::node;
+        
+        backward_singly_linked_list_with_counter(arena_ref ArenaRef)
+            :backward_singly_linked_list<type>(ArenaRef), Count(0) {}
+        
+        backward_singly_linked_list_with_counter()
+            :backward_singly_linked_list<type>(), Count(0) {}
+        
+        u32 Count;
+        
+        u32 GetCount()
+        { return Count; }
+        
+        void Clear()
+        {
+            backward_singly_linked_list<type>::Clear();
+            Count = 0;
+        }
+        
+        void PushNode
+ (node& Node)
+        {
+            ++Count;
+            backward_singly_linked_list<type>::PushNode(Node);
+        }
+        
+        type& PushZero()
+        {
+            ++Count;
+            return backward_singly_linked_list<type>::PushZero();
+        }
+        
+        type& PushUninitialized()
+        {
+            ++Count;
+            return backward_singly_linked_list<type>::PushUninitialized();
+        }
+        
+        type& Push
+ (const type& InitialData)
+        {
+            ++Count;
+            return backward_singly_linked_list<type>::Push(InitialData);
+        }
+        
+        type& PushAfter
+ (node& NodeWhichWillBeBeforeThePushedOne, const type& InitialData)
+        {
+            ++Count;
+            return backward_singly_linked_list<type>::PushAfter(NodeWhichWillBeBeforeThePushedOne, InitialData);
+        }
+        
+        type* PushIfUnique
+ (const type& InitialData)
+        {
+            ++Count;
+            return backward_singly_linked_list<type>::PushIfUnique(InitialData);
+        }
+        
+        type& GetIfExistsOrPushIfUnique
+ (const type& E)
+        {
+            auto* Found = Find(*this, E);
+            if(Found)
+                return *Found;
+            return Push(E);
+        }
+        
+        void Pop()
+        {
+            --Count;
+            backward_singly_linked_list<type>::Pop();
+        }
+        
+        void PopLast()
+        {
+            --Count;
+            backward_singly_linked_list<type>::PopLast();
+        }
+        
+        node* PopLastNode()
+        {
+            --Count;
+            return backward_singly_linked_list<type>::PopLastNode();
+        }
+        
+        type* PopLastReturnPtr()
+        {
+            --Count;
+            return backward_singly_linked_list<type>::PopLastReturnPtr();
+        }
+        
+        void Remove
+ (type* ElementToRemove)
+        {
+            --Count;
+            backward_singly_linked_list<type>::Remove(ElementToRemove);
+        }
+        
+        template<class comparison_fn>
+            rstd_bool RemoveFirstIf
+ (comparison_fn Comparison)
+        {
+            rstd_bool ManagedToRemove = backward_singly_linked_list<type>::RemoveFirstIf(Comparison);
+            if(ManagedToRemove)
+                --Count;
+            return ManagedToRemove;
+        }
+        
+        template<class comparison_fn>
+            void RemoveFirstIfWithAssert
+ (comparison_fn Comparison)
+        {
+            backward_singly_linked_list<type>::RemoveFirstIfWithAssert(Comparison);	
+            --Count;
+        }
+        
+        template<class comparison_fn>
+            optional<type> RemoveFirstIfReturnCopy
+ (comparison_fn Comparison)
+        {
+            auto Res = backward_singly_linked_list<type>::RemoveFirstIfReturnCopy(Comparison);
+            if(Res)
+                --Count;
+            return Res;
+        }
+        
+        template<class comparison_fn>
+            type RemoveFirstIfWithAssertReturnCopy
  (comparison_fn Comparison)
         {
-            rstd_bool ManagedToRemove = backward_singly_linked_list<type>::RemoveFirstIf(Comparison);
-            if(ManagedToRemove)
-                --Count;
-            return ManagedToRemove;
+            auto Res = backward_singly_linked_list<type>::RemoveFirstIfWithAssertReturnCopy(Comparison);
+            --Count;
+            return Res;
+        }
+        
+        rstd_bool RemoveFirstEqualTo
+ (type& E)
+        {
+            rstd_bool ManagedToRemove = backward_singly_linked_list<type>::RemoveFirstEqualTo(E);
+            if(ManagedToRemove)
+                --Count;
+            return ManagedToRemove;
+        }
+    };
+    
+    
+    /////////////////////
+    // MULTI-THREADING //
+    /////////////////////
+    
+#ifdef _WIN32
+    static void WriteFence()
+    {
+#if rstd_MultiThreadingEnabled
+        _WriteBarrier(); _mm_sfence();
+#endif
+    }
+    
+    static void ReadFence()
+    {
+#if rstd_MultiThreadingEnabled
+        _ReadBarrier();
+#endif
+    }
+    
+    static void ReadWriteFence()
+    {
+#if rstd_MultiThreadingEnabled
+        _ReadWriteBarrier();
+#endif
+    }
+    
+    u32 AtomicIncrement(volatile u32& A);
+    u32 AtomicDecrement(volatile u32& A);
+    size AtomicAdd(volatile size& A, size Addend);
+    
+    i32 AtomicSet(volatile i32& Destination, i32 NewValue);
+    
+    u32 AtomicSet(volatile u32& Destination, u32 NewValue)
+    { return AtomicSet((volatile i32&)Destination, (i32)NewValue);}
+    
+    i32 AtomicCompareAndSet
+ (volatile i32& Destination, i32 NewValue, i32 ValueThatShouldBeInDestination);
+    
+    i64 AtomicCompareAndSet
+ (volatile i64& Destination, i64 NewValue, i64 ValueThatShouldBeInDestination);
+    
+    static u32 AtomicCompareAndSet(volatile u32& Destination, u32 NewValue, u32 ValueThatShouldBeInDestination)
+    { return (u32)AtomicCompareAndSet((volatile i32&)Destination, (i32)NewValue, (i32)ValueThatShouldBeInDestination); }
+    
+    // TODO: Do cast with assetion or use different intrinsic
+    static u64 AtomicCompareAndSet(volatile u64& Destination, u64 NewValue, u64 ValueThatShouldBeInDestination)
+    { return (u64)AtomicCompareAndSet((volatile i64&)Destination, (i64)NewValue, (i64)ValueThatShouldBeInDestination); }
+    
+    void* AtomicCompareAndSet
+ (void* volatile& Destination, void* NewValue, void* ValueThatShouldBeInDestination);
+    
+    static u32 GetThreadID()
+    {
+        u8 *ThreadLocalStorage = (u8 *)__readgsqword(0x30);
+        return *(u32*)(ThreadLocalStorage + 0x48);
+    }
+    
+#else // POSIX
+    static void WriteFence()
+    {
+#if rstd_MultiThreadingEnabled
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+#endif
+    }
+    
+    static void ReadFence()
+    {
+#if rstd_MultiThreadingEnabled
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+#endif
+    }
+    
+    static void ReadWriteFence()
+    {
+#if rstd_MultiThreadingEnabled
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+    }
+    
+    // NOTE: On POSIX atomics are GCC/Clang builtins, so they are defined here to be inlined
+    static u32 AtomicIncrement
+ (volatile u32& A)
+    {
+#if rstd_MultiThreadingEnabled
+        return __atomic_add_fetch(&A, 1, __ATOMIC_SEQ_CST);
+#else
+        return ++A;
+#endif
+    }
+    
+    static u32 AtomicDecrement
+ (volatile u32& A)
+    {
+#if rstd_MultiThreadingEnabled
+        return __atomic_sub_fetch(&A, 1, __ATOMIC_SEQ_CST);
+#else
+        return --A;
+#endif
+    }
+    
+    static size AtomicAdd
+ (volatile size& A, size Addend)
+    {
+#if rstd_MultiThreadingEnabled
+        return __atomic_add_fetch(&A, Addend, __ATOMIC_SEQ_CST);
+#else
+        return A += Addend;
+#endif
+    }
+    
+    template<class type> static type AtomicSet
+ (volatile type& Destination, type NewValue)
+    {
+#if rstd_MultiThreadingEnabled
+        return __atomic_exchange_n(&Destination, NewValue, __ATOMIC_SEQ_CST);
+#else
+        type InitialValueInDestination = Destination;
+        Destination = NewValue;
+        return InitialValueInDestination;
+#endif
+    }
+    
+    template<class type> static type AtomicCompareAndSet
+ (volatile type& Destination, type NewValue, type ValueThatShouldBeInDestination)
+    {
+#if rstd_MultiThreadingEnabled
+        return __sync_val_compare_and_swap(&Destination, ValueThatShouldBeInDestination, NewValue);
+#else
+        type ValueThatReallyIsInDestination = Destination;
+        if(ValueThatReallyIsInDestination == ValueThatShouldBeInDestination)
+            Destination = NewValue;
+        return ValueThatReallyIsInDestination;
+#endif
+    }
+    
+    u32 GetThreadID();
+    
+#endif
+    
+    struct mutex
+    { volatile i32 Locked = 0; };
+    
+    static void Lock
+ (volatile i32& Locked)
+    {
+#if rstd_MultiThreadingEnabled
+        while(Locked || AtomicCompareAndSet(Locked, 1, 0) != 0);
+#endif
+    }
+    
+    static void Lock(mutex& Mutex)
+    { Lock(Mutex.Locked); }
+    
+    static rstd_bool TryLock
+ (volatile i32& Locked)
+    {
+#if rstd_MultiThreadingEnabled
+        return !Locked && AtomicCompareAndSet(Locked, 1, 0) == 0;
+#else
+        return true;
+#endif
+    }
+    
+    static rstd_bool TryLock(mutex& Mutex)
+    { return TryLock(Mutex.Locked); }
+    
+    static void Unlock
+ (volatile i32& Locked)
+    {
+#if rstd_MultiThreadingEnabled
+#ifdef _WIN32
+        Locked = 0;
+#else
+        __atomic_store_n(&Locked, 0, __ATOMIC_RELEASE);
+#endif
+#endif
+    }
+    
+    static void Unlock(mutex& Mutex)
+    { Unlock(Mutex.Locked); }
+    
+    // NOTE: Body of spin-wait loop, hyper-thread sharing the core gets it meanwhile
+    static void SpinWaitPause()
+    {
+#if rstd_SSE2
+        _mm_pause();
+#endif
+    }
+    
+#define rstd_ScopeLock(_Mutex) \
+rstd::Lock(_Mutex); \
+rstd_defer(rstd::Unlock(_Mutex)); \
+    
+    struct thread_pool;
+    
+    typedef void thread_pool_job_callback(void* Data);
+    
+    struct thread_pool_job
+    {
+        void* CallbackUserData;
+        thread_pool_job_callback* Callback;
+    };
+    
+    struct thread_pool_job_node : thread_pool_job
+    { thread_pool_job_node* Next; };
+    
+    struct thread_pool_job_list
+    {
+        thread_pool_job_node* NextJobToTake;
+        thread_pool_job_node* LastJobToTake;
+        thread_pool_job_node* JobFreeList;
+        arena Arena;
+        mutex Mutex;
+    };
+    
+    struct thread_pool
+    {
+        thread_pool_job_list JobList;
+        u32 RunningJobCount;
+#ifdef _WIN32
+        void* SemaphoreHandle;
+#else
+        volatile u32 SemaphoreCount; // futex word
+#endif
+        u32 ThreadCount;
+    };
+    
+    void Init(thread_pool& Pool, u32 ThreadCount, arena ArenaResponsibleOnlyForAllocatingJobs);
+    void PushJob(thread_pool&, void* JobUserData, thread_pool_job_callback* JobCallback);
+    template<class job_container> void PushJobs(thread_pool& Pool, job_container Jobs);
+    void CompleteAllJobs(thread_pool& Pool);
+    
+    // NOTE: Pool that zeroes reverted bytes of ArenaFlag_ZeroInBackground arenas, nullptr (default) turns it off
+    //       and such arenas zero on push like any other. Pool of its own keeps zeroing from queueing behind other jobs.
+    void SetBackgroundZeroingPool(thread_pool* Pool);
+    
+    //////////////////////
+    // CONCURRENT ARENA //
+    //////////////////////
+    // NOTE: Arena that many threads can push into at the same time without locking.
+    // Push is a fetch-add on Used of the current block. When block runs out, threads race to chain
+    // a new block with compare-and-set and losers give their block back to the memory block cache.
+    // Clear() and Deallocate() must not be called while other threads are pushing.
+    struct concurrent_arena
+    {
+        memory_block* volatile MemoryBlock;
+        size MinimalAllocationSize;
+        rstd_DebugOnly(const char* DebugName;)
+        rstd_MemoryProfilerOnly(u32 DebugId;) // set by MemoryDebug::RegisterCreateArena(), 0 means not registered
+    };
+    
+    // NOTE: Every push is rounded up to it, so pushes with smaller alignment never need padding
+    constexpr size ConcurrentArenaGranularity = 16;
+    
+#define rstd_AllocateConcurrentArena(_Size, ...) \
+InternalAllocateConcurrentArena(_Size, rstd_GetCallingInfo(), ##__VA_ARGS__)
+    
+    // NOTE: Memory is zeroed before block is published, so pushes never have to zero anything
+    static memory_block* AllocateZeroConcurrentArenaMemoryBlock
+ (size AllocationSize)
+    {
+        auto* MemBlock = PopCachedMemoryBlock(AllocationSize);
+        if(MemBlock)
+        {
+            Zero(MemBlock->Base, MemBlock->MaxHistoricalUsed);
+            MemBlock->MaxHistoricalUsed = 0;
+        }
+        else
+        {
+            AllocationSize = Align(AllocationSize, MemoryPageSize);
+            u8* Base = (u8*)PageAlloc(AllocationSize);
+            rstd_RAssert(Base, "OS Allocation call failed (probably your machine ran out of memory)");
+            
+            size Size = AllocationSize - sizeof(memory_block);
+            MemBlock = (memory_block*)(Base + Size);
+            MemBlock->Base = Base;
+            MemBlock->Size = Size;
+            MemBlock->Committed = Size;
+        }
+        MemBlock->Prev = nullptr;
+        MemBlock->Used = 0;
+        return MemBlock;
+    }
+    
+    static concurrent_arena InternalAllocateConcurrentArena
+ (size Size, calling_info CallingInfo, const char* DebugName = nullptr)
+    {
+        concurrent_arena Arena;
+        Arena.MemoryBlock = AllocateZeroConcurrentArenaMemoryBlock(Size + sizeof(memory_block));
+        Arena.MinimalAllocationSize = MegabytesToBytes((size)1);
+        rstd_DebugOnly(Arena.DebugName = DebugName;)
+        MemoryDebug::RegisterCreateArena(Arena, DebugName, CallingInfo);
+        return Arena;
+    }
+    
+    static u8* InternalPushSizeZeroAligned
+ (concurrent_arena& Arena, size Size, size Alignment, calling_info CallingInfo)
+    {
+        rstd_Assert(IsPowerOfTwo(Alignment));
+        
+        size ReservedSize = Align(Size, ConcurrentArenaGranularity);
+        if(Alignment > ConcurrentArenaGranularity)
+            ReservedSize += Alignment - ConcurrentArenaGranularity;
+        
+        for(;;)
+        {
+            auto* MemBlock = Arena.MemoryBlock;
+            ReadFence();
+            
+            // NOTE: Used only grows, so once a push didn't fit every later push into this block won't fit either
+            size UsedAfterAllocation = AtomicAdd(MemBlock->Used, ReservedSize);
+            if(UsedAfterAllocation <= MemBlock->Size)
+            {
+                u8* Memory = MemBlock->Base + (UsedAfterAllocation - ReservedSize);
+                push_size_uninitialized_ex_res Res = {};
+                Res.Memory = Memory + GetAlignmentPadding(Memory, Alignment);
+                Res.AlignmentPadding = ReservedSize - Size;
+                MemoryDebug::RegisterArenaPush(Arena, Res, Size, CallingInfo);
+                return Res.Memory;
+            }
+            
+            size AllocationSize = ReservedSize + sizeof(memory_block);
+            if(AllocationSize < Arena.MinimalAllocationSize)
+                AllocationSize = Arena.MinimalAllocationSize;
+            
+            auto* NewMemBlock = AllocateZeroConcurrentArenaMemoryBlock(AllocationSize);
+            NewMemBlock->Prev = MemBlock;
+            NewMemBlock->Used = ReservedSize;
+            
+            if(AtomicCompareAndSet((void* volatile&)Arena.MemoryBlock, (void*)NewMemBlock, (void*)MemBlock) == MemBlock)
+            {
+                MemoryDebug::RegisterArenaAllocateNextMemoryBlock(Arena, *NewMemBlock);
+                push_size_uninitialized_ex_res Res = {};
+                Res.Memory = NewMemBlock->Base + GetAlignmentPadding(NewMemBlock->Base, Alignment);
+                Res.AlignmentPadding = ReservedSize - Size;
+                MemoryDebug::RegisterArenaPush(Arena, Res, Size, CallingInfo);
+                return Res.Memory;
+            }
+            
+            NewMemBlock->Used = 0;
+            ReleaseMemoryBlock(NewMemBlock);
+        }
+    }
+    
+    static u8* InternalPushSizeZero(concurrent_arena& Arena, size Size, calling_info CallingInfo)
+    { return InternalPushSizeZeroAligned(Arena, Size, ConcurrentArenaGranularity, CallingInfo); }
+    
+    static u8* PushSizeZero(concurrent_arena& Arena, size Size, size Alignment = ConcurrentArenaGranularity)
+    { return InternalPushSizeZeroAligned(Arena, Size, Alignment, rstd_GetCallingInfo()); }
+    
+    template<class type> static type& PushStructZero
+ (concurrent_arena& Arena)
+    { return *(type*)PushSizeZero(Arena, sizeof(type), alignof(type)); }
+    
+    template<class type> static type* PushArrayZero
+ (concurrent_arena& Arena, size Count)
+    { return (type*)PushSizeZero(Arena, sizeof(type) * Count, alignof(type)); }
+    
+    template<class type> static type& PushStruct
+ (concurrent_arena& Arena, const type& Init)
+    {
+        auto& A = PushStructZero<type>(Arena);
+        A = Init;
+        return A;
+    }
+    
+    static size GetUsedBytes
+ (memory_block* MemBlock)
+    { return MemBlock->Used < MemBlock->Size ? MemBlock->Used : MemBlock->Size; }
+    
+    static size GetUsedBytes
+ (concurrent_arena& Arena)
+    {
+        size Bytes = 0;
+        for(auto* MemBlock = Arena.MemoryBlock; MemBlock; MemBlock = MemBlock->Prev)
+            Bytes += GetUsedBytes(MemBlock);
+        return Bytes;
+    }
+    
+    static void Clear
+ (concurrent_arena& Arena)
+    {
+        MemoryDebug::RegisterClearArena(Arena);
+        while(Arena.MemoryBlock->Prev)
+        {
+            auto* PrevMemBlock = Arena.MemoryBlock->Prev;
+            MemoryDebug::RegisterArenaDeallocateMemoryBlock(Arena, *Arena.MemoryBlock);
+            Arena.MemoryBlock->MaxHistoricalUsed = GetUsedBytes(Arena.MemoryBlock);
+            ReleaseMemoryBlock(Arena.MemoryBlock);
+            Arena.MemoryBlock = PrevMemBlock;
+        }
+        Zero(Arena.MemoryBlock->Base, GetUsedBytes(Arena.MemoryBlock));
+        Arena.MemoryBlock->Used = 0;
+    }
+    
+    static void Deallocate
+ (concurrent_arena& Arena)
+    {
+        auto* MemBlock = Arena.MemoryBlock;
+        while(MemBlock)
+        {
+            auto* PrevMemBlock = MemBlock->Prev;
+            MemoryDebug::RegisterArenaDeallocateMemoryBlock(Arena, *MemBlock);
+            FreeMemoryBlock(MemBlock);
+            MemBlock = PrevMemBlock;
+        }
+        Arena.MemoryBlock = nullptr;
+    }
+    
+    /////////////////////
+    // STRING INTERNER //
+    /////////////////////
+    // NOTE: Every unique string is copied to arena once and gets u32 id, so comparing interned strings
+    // is comparing ids and hash_map can be keyed by id instead of string<>. Ids start at 1, 0 means no string.
+    // Intern() locks only when string is new. Find() and GetString() never lock, so thread_pool jobs can
+    // look strings up while other threads intern. Nothing else should push to interner's arena in the meantime.
+    struct string_interner
+    {
+        struct entry
+        {
+            const char* String; // null terminated
+            u32 Count;
+            u64 Hash;
+        };
+        
+        // NOTE: Slot has hash bits in high half and id in low half (0 means empty), so probing touches
+        // entries only when hash bits match. Grown table replaces the old one, which stays in arena
+        // for readers that might still be probing it.
+        struct table
+        {
+            volatile u64* Slots;
+            u32 Mask;
+        };
+        
+        // NOTE: Entries live in chunks that never move, chunk N has FirstChunkSize << N entries
+        static constexpr u32 FirstChunkSizeLog2 = 8;
+        static constexpr u32 FirstChunkSize = 1 << FirstChunkSizeLog2;
+        static constexpr u32 ChunkCount = 32 - FirstChunkSizeLog2;
+        static constexpr u32 MinTableCapacity = 64;
+        
+        arena_ref ArenaRef;
+        entry* volatile Chunks[ChunkCount];
+        table* volatile Table;
+        volatile u32 Count;
+        mutex Mutex;
+        
+        rstd_bool Initialized()
+        { return ArenaRef; }
+        
+        string_interner()
+        {
+            for(auto& Chunk : Chunks)
+                Chunk = nullptr;
+            Table = nullptr;
+            Count = 0;
+        }
+        
+        string_interner
+ (arena_ref ArenaRef, u32 InitialCount = 0)
+        {
+            this->ArenaRef = ArenaRef;
+            for(auto& Chunk : Chunks)
+                Chunk = nullptr;
+            Table = nullptr;
+            Count = 0;
+            GrowTable(InitialCount);
+        }
+        
+        u32 GetCount()
+        {
+            u32 Res = Count;
+            ReadFence();
+            return Res;
+        }
+        
+        entry& GetEntry
+ (u32 Id)
+        {
+            // NOTE: Id can be bigger than Count for a moment, when other thread is in the middle of Intern()
+            rstd_AssertM(Id, "0 is not an id of any string");
+            u32 Index = Id - 1 + FirstChunkSize;
+            u32 ChunkIndex = 31 - CountLeadingZeros(Index) - FirstChunkSizeLog2;
+            rstd_AssertM(ChunkIndex < ChunkCount && Chunks[ChunkIndex], "% is not an id given out by this string_interner", Id);
+            return Chunks[ChunkIndex][Index - (FirstChunkSize << ChunkIndex)];
+        }
+        
+        const char* GetString
+ (u32 Id)
+        { return GetEntry(Id).String; }
+        
+        string_view GetStringView
+ (u32 Id)
+        {
+            entry& Entry = GetEntry(Id);
+            string_view Res;
+            Res.Characters = const_cast<char*>(Entry.String);
+            Res.Count = Entry.Count;
+            return Res;
+        }
+        
+        static void InsertSlot
+ (table& Table, u64 Hash, u32 Id)
+        {
+            u32 SlotIndex = (u32)Hash & Table.Mask;
+            while(Table.Slots[SlotIndex])
+                SlotIndex = (SlotIndex + 1) & Table.Mask;
+            Table.Slots[SlotIndex] = (Hash & 0xffffffff00000000) | Id;
+        }
+        
+        u32 FindInTable
+ (table& Table, string_view String, u64 Hash)
+        {
+            u32 HashBits = (u32)(Hash >> 32);
+            for(u32 SlotIndex = (u32)Hash & Table.Mask;; SlotIndex = (SlotIndex + 1) & Table.Mask)
+            {
+                u64 Slot = Table.Slots[SlotIndex];
+                if(!Slot)
+                    return 0;
+                
+                if((u32)(Slot >> 32) == HashBits)
+                {
+                    ReadFence();
+                    u32 Id = (u32)Slot;
+                    entry& Entry = GetEntry(Id);
+                    if(Entry.Count == String.Count && memcmp(Entry.String, String.Characters, String.Count) == 0)
+                        return Id;
+                }
+            }
+        }
+        
+        // NOTE: Caller has to hold the Mutex
+        void GrowTable
+ (u32 MinCount)
+        {
+            rstd_AssertM(ArenaRef, "You have to initialize string_interner before using it!");
+            
+            // NOTE: Max load factor is 1/2
+            u32 NewCapacity = MinTableCapacity;
+            while(NewCapacity / 2 < MinCount)
+                NewCapacity *= 2;
+            
+            auto& NewTable = rstd_PushStructUninitializedAligned(*ArenaRef, table);
+            NewTable.Slots = rstd_PushArrayZeroAligned(*ArenaRef, u64, NewCapacity);
+            NewTable.Mask = NewCapacity - 1;
+            for(u32 Id = 1; Id <= Count; ++Id)
+                InsertSlot(NewTable, GetEntry(Id).Hash, Id);
+            
+            WriteFence();
+            Table = &NewTable;
+        }
+        
+        // NOTE: Returns 0 if String wasn't interned
+        u32 Find
+ (string_view String)
+        {
+            if(String.Count == InvalidU32)
+                String.UpdateCount();
+            
+            table* CurrentTable = Table;
+            if(!CurrentTable)
+                return 0;
+            ReadFence();
+            return FindInTable(*CurrentTable, String, HashString(String.Characters, String.Count));
+        }
+        
+        u32 Intern
+ (string_view String)
+        {
+            if(String.Count == InvalidU32)
+                String.UpdateCount();
+            rstd_Assert(String.Count < MaxU32);
+            
+            u64 Hash = HashString(String.Characters, String.Count);
+            if(table* CurrentTable = Table)
+            {
+                ReadFence();
+                if(u32 Id = FindInTable(*CurrentTable, String, Hash))
+                    return Id;
+            }
+            
+            rstd_ScopeLock(Mutex);
+            
+            // NOTE: Other thread could intern the same string while we were waiting for the lock
+            if(Table)
+            {
+                if(u32 Id = FindInTable(*Table, String, Hash))
+                    return Id;
+            }
+            
+            u32 Id = Count + 1;
+            if(!Table || Id > (Table->Mask + 1) / 2)
+                GrowTable(Id);
+            
+            u32 Index = Id - 1 + FirstChunkSize;
+            u32 ChunkIndex = 31 - CountLeadingZeros(Index) - FirstChunkSizeLog2;
+            rstd_RAssert(Id != MaxU32 && ChunkIndex < ChunkCount, "string_interner ran out of ids");
+            if(!Chunks[ChunkIndex])
+                Chunks[ChunkIndex] = rstd_PushArrayUninitializedAligned(*ArenaRef, entry, FirstChunkSize << ChunkIndex);
+            
+            char* Copy = rstd_PushArrayUninitialized(*ArenaRef, char, String.Count + 1);
+            memcpy(Copy, String.Characters, String.Count);
+            Copy[String.Count] = 0;
+            
+            auto& Entry = Chunks[ChunkIndex][Index - (FirstChunkSize << ChunkIndex)];
+            Entry.String = Copy;
+            Entry.Count = (u32)String.Count;
+            Entry.Hash = Hash;
+            
+            // NOTE: Readers that see the slot have to see the entry and the chunk, and strings counted
+            // in Count have to be findable
+            WriteFence();
+            InsertSlot(*Table, Hash, Id);
+            WriteFence();
+            Count = Id;
+            return Id;
+        }
+    };
+    
+    ///////////
+    // FILES // 
+    ///////////
+#ifdef _WIN32
+    constexpr char FilePathSlash = '\\';
+#else
+    constexpr char FilePathSlash = '/';
+#endif
+    
+    struct file_info // TODO: What else should I put in file_info?
+    { char* Name; };
+    
+    struct file
+    {
+        void* PlatformFileHandle;
+        
+        operator rstd_bool()
+        { return PlatformFileHandle; }
+    };
+    
+    struct file_stream
+    {
+        file File;
+        u64 Pos;
+        
+        operator rstd_bool()
+        { return File; }
+    };
+    
+    enum class io_mode
+    {
+        Read,
+        Write,
+        ReadWrite,
+    };
+    
+    enum class file_error
+    {
+        NoError,
+        UnknownError,
+        FileIsMissing,
+        DirectoryOnPathIsMissing,
+        AccessToFileWasDenied,
+    };
+    
+    backward_singly_linked_list_with_counter<file_info> GetFileInfos(arena& Arena, const char* DirectoryPath);
+    i32 RemoveFile(const char* FilePath);
+    i32 RenameFile(const char* FilePath, const char* NewFilePath);
+    rstd_bool FileExists(const char* FilePath);
+    file OpenFile(const char* FilePath, io_mode);
+    rstd_bool Close(file&);
+    u32 Write(file File, u64 Pos, void* Data, u32 Size);
+    u32 Read(void* Dest, file File, u64 Pos, u32 Size);
+    rstd_bool SetFileSize(file File, u32 Size);
+    u32 GetFileSize(file File);
+    char* ReadWholeFile(arena& Arena, const char* FilePath);
+    rstd_bool CreateDirectory(const char* Path);
+    rstd_bool CreateDirectory(wchar_t* Path);
+    rstd_bool DeleteDirectory(const char* Path);
+    rstd_bool DeleteDirectory(wchar_t* Path);
+    rstd_bool DeleteDirectoryWithAllContents(const char* Path);
+    
+    static backward_singly_linked_list_with_counter<file_info> GetFileInfos(arena& Arena, rstd_stringlike& DirectoryPath)
+    { return GetFileInfos(Arena, DirectoryPath.GetCString()); }
+    
+    static i32 RemoveFile(rstd_stringlike& FilePath)
+    { return RemoveFile(FilePath.GetCString()); }
+    
+    static i32 RenameFile(rstd_stringlike& FilePath, rstd_stringlike& NewFilePath)
+    { return RenameFile(FilePath.GetCString(), NewFilePath.GetCString()); }
+    
+    static rstd_bool FileExists(rstd_stringlike& FilePath)
+    { return FileExists(FilePath.GetCString()); }
+    
+    static file OpenFile(rstd_stringlike& FilePath, io_mode Mode)
+    { return OpenFile(FilePath.GetCString(), Mode); }
+    
+    static char* ReadWholeFile(arena& Arena, rstd_stringlike& FilePath)
+    { return ReadWholeFile(Arena, FilePath.GetCString()); }
+    
+    static rstd_bool CreateDirectory(rstd_stringlike& Path)
+    { return CreateDirectory(Path.GetCString()); }
+    
+    static rstd_bool DeleteDirectory(rstd_stringlike& Path)
+    { return DeleteDirectory(Path.GetCString()); }
+    
+    static rstd_bool DeleteDirectoryWithAllContents(rstd_stringlike& Path)
+    { return DeleteDirectoryWithAllContents(Path.GetCString()); }
+    
+    static void CreateFile
+ (const char* FilePath)
+    {
+        auto File = OpenFile(FilePath, io_mode::Write);
+        Close(File);
+    }
+    
+    static void CreateFile(const rstd_stringlike& FilePath)
+    { CreateFile(FilePath.GetCString()); }
+    
+    static char* GetRelativePath
+ (char* FilePath, const char* RootDirectory)
+    {
+        char* C = FilePath;
+        while(*C)
+        {
+            if(*C == FilePathSlash)
+            {
+                ++C;
+                // TODO: This could be faster if you didn't use StringsMatch
+                //       You can create AdvanceIfStringDontMatch
+                if(StringsMatchUntilRightStringTerminates(C, RootDirectory))
+                    return C;
+            }
+            ++C;
+        }
+        return nullptr;
+    }
+    
+    static char* GetRelativePath(rstd_stringlike& FilePath, rstd_stringlike& RootDirectory)
+    { return GetRelativePath(FilePath.GetCString(), RootDirectory.GetCString()); }
+    
+    static file_stream OpenFileStream
+ (const char* FilePath, io_mode Mode)
+    {
+        auto File = OpenFile(FilePath, Mode);
+        if(Mode == io_mode::Write)
+            SetFileSize(File, 0);
+        return {File};
+    }
+    
+    static file_stream OpenFileStream(rstd_stringlike& FilePath, io_mode Mode)
+    { return OpenFileStream(FilePath.GetCString(), Mode); }
+    
+    static rstd_bool Close(file_stream& Stream)
+    { return Close(Stream.File); }
+    
+    template<class type> static u32 WriteStruct(file File, u64 Pos, type& Data, u32 Count = 1)
+    { return Write(File, Pos, (void*)&Data, (u32)sizeof(type) * Count); }
+    
+    // TODO: Should I translate \n to \r\n here on windows???
+    template<class... args> static u32 WriteString
+ (file File, u64 Pos, const char* Fmt, args... Args)
+    {
+        auto String = Format<string<1024>>(Fmt, Args...);
+        return Write(File, Pos, (void*)String.GetCString(), String.GetCount());
+    }
+    
+    template<class type> static type Read
+ (file File, u64 Pos)
+    {
+        type Res;
+        Read((void*)&Res, File, Pos, (u32)sizeof(Res));
+        return Res;
+    }
+    
+    static u32 Write
+ (file_stream& Stream, void* Data, u32 Size)
+    {
+        u32 WrittenBytes = Write(Stream.File, Stream.Pos, Data, Size);
+        rstd_Assert(WrittenBytes == Size);
+        Stream.Pos += Size;
+        return WrittenBytes;
+    }
+    
+    template<class type> static u32 WriteStruct(file_stream& Stream, type& Data, u32 Count = 1)
+    { return Write(Stream, &Data, (u32)sizeof(type) * Count); }
+    
+    template<class... args> static u32 WriteString
+ (file_stream& Stream, const char* Fmt, args... Args)
+    {
+        u32 WrittenBytes = WriteString(Stream.File, Stream.Pos, Fmt, Args...);
+        Stream.Pos += WrittenBytes;
+        return WrittenBytes;
+    }
+    
+    static u32 Read
+ (void* Dest, file_stream& Stream, u32 Size)
+    {
+        u32 ReadBytes = Read(Dest, Stream.File, Stream.Pos, Size);
+        rstd_Assert(ReadBytes == Size); // TODO: Should this assertion be here? Maybe there should be second function which just returns failure?
+        Stream.Pos += Size;
+        return ReadBytes;
+    }
+    
+    template<class type> static type Read
+ (file_stream& Stream)
+    {
+        auto Res = Read<type>(Stream.File, Stream.Pos);
+        Stream.Pos += sizeof(Res);
+        return Res;
+    }
+    
+    template<class type> static type& GetAndAdvance
+ (char** DataPtr)
+    {
+        auto& Res = *(type*)(*DataPtr);
+        *DataPtr += sizeof(type);
+        return Res;
+    }
+    
+    /////////////////////
+    // ARENA SNAPSHOTS //
+    /////////////////////
+    // NOTE: SaveArenaSnapshot() writes used bytes of every memory block of arena into a file,
+    // LoadArenaSnapshot() maps that file copy-on-write and only patches registered pointers.
+    // Pointers inside the arena have to be either:
+    // - relative_ptr, which needs no fixup as long as it points into the same memory block,
+    // - or passed in PointerLocations, those are stored as file offsets and rebased on load.
+    
+    // NOTE: Offset is counted from the relative_ptr itself, so don't copy it, assign the pointee
+    template<class type>
+        struct relative_ptr
+    {
+        i64 Offset; // 0 means nullptr
+        
+        type* Get()
+        { return Offset ? (type*)((u8*)this + Offset) : nullptr; }
+        
+        void Set
+ (type* Ptr)
+        { Offset = Ptr ? (u8*)Ptr - (u8*)this : 0; }
+        
+        relative_ptr& operator=(type* Ptr)
+        {
+            Set(Ptr);
+            return *this;
+        }
+        
+        type* operator->()
+        { return Get(); }
+        
+        type& operator*()
+        { return *Get(); }
+        
+        operator rstd_bool()
+        { return Offset != 0; }
+    };
+    
+    struct arena_snapshot
+    {
+        u8* Memory; // nullptr if loading failed
+        size Size;
+        void* Root; // Root passed to SaveArenaSnapshot()
+    };
+    
+    void* MapFile(file File, size Bytes); // copy-on-write, changes never reach the file
+    rstd_bool UnmapFile(void* Memory, size Bytes);
+    
+    // NOTE: Returns false without writing anything if Root or some pointer location doesn't live in the arena,
+    //       if some pointer points outside of it or if the file would be 4 GB or bigger (file API works with u32 sizes)
+    rstd_bool SaveArenaSnapshot(arena& Arena, const char* FilePath, void* Root,
+                                void** const* PointerLocations = nullptr, u32 PointerLocationCount = 0);
+    
+    // NOTE: Returns empty snapshot if the file is not a valid snapshot, offsets in it are checked before patching
+    arena_snapshot LoadArenaSnapshot(const char* FilePath);
+    
+    static void UnloadArenaSnapshot
+ (arena_snapshot& Snapshot)
+    {
+        UnmapFile(Snapshot.Memory, Snapshot.Size);
+        Snapshot = {};
+    }
+}
+
+#ifdef rstd_Implementation
+
+#ifdef _WIN32
+
+#pragma comment(lib, "shell32.lib")
+
+#ifndef rstd_ExcludeDebugPrintingFunctions
+#pragma comment(lib, "user32.lib")
+#endif
+
+#include <windows.h>
+
+#else // POSIX
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <linux/futex.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <wchar.h>
+
+#endif
+
+namespace rstd
+{
+    ///////////////////////
+    // MEMORY ALLOCATION //
+    ///////////////////////
+    constexpr u32 MemoryBlockCacheBucketCount = 64;
+    
+    struct memory_block_cache
+    {
+        memory_block* Buckets[MemoryBlockCacheBucketCount];
+        size CachedBytes;
+    };
+    
+    struct thread_memory_block_cache : memory_block_cache
+    {
+        ~thread_memory_block_cache();
+    };
+    
+    static memory_block_cache GlobalMemoryBlockCache;
+    static mutex GlobalMemoryBlockCacheMutex;
+    static thread_local thread_memory_block_cache ThreadMemoryBlockCache;
+    static memory_block_cache_limits MemoryBlockCacheLimits = {MegabytesToBytes((size)8), MegabytesToBytes((size)64)};
+    static memory_block_cache_stats MemoryBlockCacheStats;
+    
+    static size GetAllocationSize(memory_block* MemBlock)
+    { return MemBlock->Size + sizeof(memory_block); }
+    
+    // NOTE: Every block in bucket N is at least 2^N bytes big
+    static u32 GetMemoryBlockCacheBucketIndex
+ (size AllocationSize)
+    {
+        u32 Index = 0;
+        while(AllocationSize >>= 1)
+            ++Index;
+        return Index;
+    }
+    
+    static memory_block* PopFromMemoryBlockCache
+ (memory_block_cache& Cache, size AllocationSize)
+    {
+        u32 FloorIndex = GetMemoryBlockCacheBucketIndex(AllocationSize);
+        u32 CeilIndex = ((size)1 << FloorIndex) == AllocationSize ? FloorIndex : FloorIndex + 1;
+        
+        memory_block* Found = nullptr;
+        auto* FloorBucketBlock = Cache.Buckets[FloorIndex];
+        if(FloorBucketBlock && GetAllocationSize(FloorBucketBlock) >= AllocationSize)
+        {
+            Found = FloorBucketBlock;
+            Cache.Buckets[FloorIndex] = Found->Prev;
+        }
+        else
+        {
+            // NOTE: Blocks over twice the requested size are left for bigger requests,
+            //       small push would otherwise pin megabytes of cached memory
+            size MaxAllocationSize = 2*AllocationSize;
+            for(u32 Index = CeilIndex;
+                Index < MemoryBlockCacheBucketCount && ((size)1 << Index) <= MaxAllocationSize;
+                ++Index)
+            {
+                auto* BucketBlock = Cache.Buckets[Index];
+                if(BucketBlock && GetAllocationSize(BucketBlock) <= MaxAllocationSize)
+                {
+                    Found = BucketBlock;
+                    Cache.Buckets[Index] = Found->Prev;
+                    break;
+                }
+            }
+        }
+        
+        if(Found)
+            Cache.CachedBytes -= GetAllocationSize(Found);
+        return Found;
+    }
+    
+    static void PushToMemoryBlockCache
+ (memory_block_cache& Cache, memory_block* MemBlock)
+    {
+        u32 Index = GetMemoryBlockCacheBucketIndex(GetAllocationSize(MemBlock));
+        MemBlock->Prev = Cache.Buckets[Index];
+        Cache.Buckets[Index] = MemBlock;
+        Cache.CachedBytes += GetAllocationSize(MemBlock);
+    }
+    
+    static rstd_bool PushToGlobalMemoryBlockCache
+ (memory_block* MemBlock)
+    {
+        rstd_ScopeLock(GlobalMemoryBlockCacheMutex);
+        if(GlobalMemoryBlockCache.CachedBytes + GetAllocationSize(MemBlock) > MemoryBlockCacheLimits.MaxGlobalCacheBytes)
+            return false;
+        PushToMemoryBlockCache(GlobalMemoryBlockCache, MemBlock);
+        return true;
+    }
+    
+    thread_memory_block_cache::~thread_memory_block_cache()
+    {
+        for(auto* Bucket : Buckets)
+        {
+            while(Bucket)
+            {
+                auto* Next = Bucket->Prev;
+                if(!PushToGlobalMemoryBlockCache(Bucket))
+                    FreeMemoryBlock(Bucket);
+                Bucket = Next;
+            }
+        }
+    }
+    
+    void SetMemoryBlockCacheLimits(memory_block_cache_limits Limits)
+    { MemoryBlockCacheLimits = Limits; }
+    
+    memory_block_cache_limits GetMemoryBlockCacheLimits()
+    { return MemoryBlockCacheLimits; }
+    
+    memory_block_cache_stats GetMemoryBlockCacheStats()
+    { return MemoryBlockCacheStats; }
+    
+    memory_block* PopCachedMemoryBlock
+ (size AllocationSize)
+    {
+        auto* MemBlock = PopFromMemoryBlockCache(ThreadMemoryBlockCache, AllocationSize);
+        if(MemBlock)
+        {
+            AtomicIncrement(MemoryBlockCacheStats.ThreadCacheHits);
+            return MemBlock;
+        }
+        
+        if(GlobalMemoryBlockCache.CachedBytes)
+        {
+            rstd_ScopeLock(GlobalMemoryBlockCacheMutex);
+            MemBlock = PopFromMemoryBlockCache(GlobalMemoryBlockCache, AllocationSize);
+        }
+        
+        AtomicIncrement(MemBlock ? MemoryBlockCacheStats.GlobalCacheHits : MemoryBlockCacheStats.Misses);
+        return MemBlock;
+    }
+    
+    rstd_bool CacheMemoryBlock
+ (memory_block* MemBlock)
+    {
+        // NOTE: Blocks with decommitted pages (from ReserveArena()) are not reused,
+        //       huge page blocks go back to OS so they don't end up in arenas that decommit,
+        //       MaxHistoricalUsed of GrowsDown blocks is counted from the other end
+        if(MemBlock->Committed != MemBlock->Size || MemBlock->HugePages || MemBlock->GrowsDown)
+            return false;
+        
+        auto& ThreadCache = ThreadMemoryBlockCache;
+        if(ThreadCache.CachedBytes + GetAllocationSize(MemBlock) <= MemoryBlockCacheLimits.MaxThreadCacheBytes)
+        {
+            PushToMemoryBlockCache(ThreadCache, MemBlock);
+        }
+        else if(!PushToGlobalMemoryBlockCache(MemBlock))
+        {
+            AtomicIncrement(MemoryBlockCacheStats.BlocksReleasedToOs);
+            return false;
+        }
+        
+        AtomicIncrement(MemoryBlockCacheStats.CachedBlocks);
+        return true;
+    }
+    
+    ////////////////////////
+    // BACKGROUND ZEROING //
+    ////////////////////////
+    enum background_zeroing_state : u32
+    {
+        BackgroundZeroing_Queued,
+        BackgroundZeroing_Running,
+        BackgroundZeroing_Done,
+        BackgroundZeroing_Cancelled,
+    };
+    
+    // NOTE: Job and FinishBackgroundZeroing() take chunks of the range in turn, so whoever needs the memory
+    //       zeroes what the job didn't get to instead of waiting for it
+    constexpr size BackgroundZeroingChunkSize = 64*1024;
+    
+    struct background_zeroing_job
+    {
+        u8* Memory;
+        size Bytes;
+        volatile u32 State;
+        volatile u32 NextChunk;
+        background_zeroing_job* NextFree;
+    };
+    
+    static thread_pool* BackgroundZeroingPool;
+    static mutex BackgroundZeroingMutex;
+    static arena BackgroundZeroingJobArena;
+    static background_zeroing_job* BackgroundZeroingFreeJobs;
+    
+    void SetBackgroundZeroingPool(thread_pool* Pool)
+    { BackgroundZeroingPool = Pool; }
+    
+    static void FreeBackgroundZeroingJob
+ (background_zeroing_job* Job)
+    {
+        rstd_ScopeLock(BackgroundZeroingMutex);
+        Job->NextFree = BackgroundZeroingFreeJobs;
+        BackgroundZeroingFreeJobs = Job;
+    }
+    
+    // NOTE: Returns false when all chunks are taken. Whole range decides between non-temporal stores
+    //       and memset, chunks of big range shouldn't go through cache either
+    static rstd_bool ZeroNextBackgroundZeroingChunk
+ (background_zeroing_job* Job)
+    {
+        size Offset = (size)(AtomicIncrement(Job->NextChunk) - 1) * BackgroundZeroingChunkSize;
+        if(Offset >= Job->Bytes)
+            return false;
+        
+        size Bytes = Job->Bytes - Offset < BackgroundZeroingChunkSize ? Job->Bytes - Offset : BackgroundZeroingChunkSize;
+        if(rstd_NonTemporalZeroThreshold != 0 && Job->Bytes >= rstd_NonTemporalZeroThreshold)
+            ZeroNonTemporal(Job->Memory + Offset, Bytes);
+        else
+            memset(Job->Memory + Offset, 0, Bytes);
+        return true;
+    }
+    
+    // NOTE: Side that sees the other one finished frees the job.
+    //       Cancelled job is freed here, done job by FinishBackgroundZeroing()
+    static void BackgroundZeroingJobProc
+ (void* Data)
+    {
+        auto* Job = (background_zeroing_job*)Data;
+        if(AtomicCompareAndSet(Job->State, (u32)BackgroundZeroing_Running, (u32)BackgroundZeroing_Queued) != BackgroundZeroing_Queued)
+        {
+            FreeBackgroundZeroingJob(Job);
+            return;
+        }
+        
+        while(ZeroNextBackgroundZeroingChunk(Job));
+        AtomicSet(Job->State, (u32)BackgroundZeroing_Done);
+    }
+    
+    void StartBackgroundZeroing
+ (memory_block& MemBlock)
+    {
+#if rstd_MultiThreadingEnabled
+        auto* Pool = BackgroundZeroingPool;
+        if(!Pool)
+            return;
+        rstd_Assert(!MemBlock.BackgroundZeroing);
+        
+        background_zeroing_job* Job;
+        {
+            rstd_ScopeLock(BackgroundZeroingMutex);
+            Job = BackgroundZeroingFreeJobs;
+            if(Job)
+            {
+                BackgroundZeroingFreeJobs = Job->NextFree;
+            }
+            else
+            {
+                if(!BackgroundZeroingJobArena.MemoryBlock)
+                    BackgroundZeroingJobArena = rstd_AllocateArenaZero(KilobytesToBytes((size)64), "BackgroundZeroing");
+                Job = &rstd_PushStructUninitialized(BackgroundZeroingJobArena, background_zeroing_job);
+            }
+        }
+        
+        Job->Memory = MemBlock.Base + MemBlock.Used;
+        Job->Bytes = MemBlock.MaxHistoricalUsed - MemBlock.Used;
+        Job->State = BackgroundZeroing_Queued;
+        Job->NextChunk = 0;
+        MemBlock.BackgroundZeroing = Job;
+        PushJob(*Pool, Job, BackgroundZeroingJobProc);
+#endif
+    }
+    
+    void FinishBackgroundZeroing
+ (memory_block& MemBlock)
+    {
+        auto* Job = MemBlock.BackgroundZeroing;
+        MemBlock.BackgroundZeroing = nullptr;
+        
+        // job didn't start yet, bytes stay garbage and get zeroed on push
+        if(AtomicCompareAndSet(Job->State, (u32)BackgroundZeroing_Cancelled, (u32)BackgroundZeroing_Queued) == BackgroundZeroing_Queued)
+            return;
+        
+        // NOTE: Job is running, the wait is at most for the one chunk it is zeroing
+        while(ZeroNextBackgroundZeroingChunk(Job));
+        while(Job->State != BackgroundZeroing_Done)
+            SpinWaitPause();
+        ReadFence();
+        
+        MemBlock.MaxHistoricalUsed = (size)(Job->Memory - MemBlock.Base);
+        FreeBackgroundZeroingJob(Job);
+    }
+    
+    ///////////////////////////////
+    // GENERAL PURPOSE ALLOCATOR //
+    ///////////////////////////////
+    constexpr size GenSpanSize = 64*1024;
+    constexpr size GenSpanHeaderSize = 128;
+    constexpr size GenMaxSmallSize = 16*1024;
+    constexpr u32 GenSizeClassCount = 36;
+    constexpr u32 GenLargeSizeClass = GenSizeClassCount;
+    
+    struct gen_heap;
+    
+    // NOTE: Span header sits at the start of span and span is GenSpanSize aligned,
+    // so header of any allocation is found by masking its address
+    struct gen_span
+    {
+        gen_span* Next;
+        gen_span* Prev;
+        gen_span* NextReturned;
+        gen_heap* Heap;
+        void* FreeList; // touched only by the thread that owns Heap
+        void* volatile ThreadFreeList; // blocks freed by other threads
+        u8* LargeBase;
+        size LargeAllocationSize;
+        size BlockSize;
+        u32 SizeClass;
+        u32 UsedBlockCount;
+        u32 BumpedBlockCount; // blocks past it were never handed out
+        u32 BlockCount;
+        volatile i32 IsFull; // full spans are not linked into heap, other thread that frees into one gives it back
+        rstd_bool InHeapList;
+    };
+    
+    static_assert(sizeof(gen_span) <= GenSpanHeaderSize, "");
+    
+    struct gen_heap
+    {
+        gen_span* Spans[GenSizeClassCount]; // spans with free blocks
+        gen_span* volatile ReturnedSpans;
+        gen_heap* NextAbandoned;
+    };
+    
+    // NOTE: Heap outlives its thread, it gets adopted by the next thread that needs one
+    struct thread_gen_heap
+    {
+        gen_heap* Heap;
+        rstd_bool Destroyed; // allocations from destructors of later thread_locals borrow a heap for one call
+        ~thread_gen_heap();
+    };
+    
+    static mutex GenAllocatorMutex;
+    static arena GenSpanArena;
+    static gen_span* GenFreeSpans;
+    static gen_heap* GenAbandonedHeaps;
+    static thread_local thread_gen_heap ThreadGenHeap;
+    
+    // NOTE: 16 byte steps up to 128, then 4 classes per power of two
+    static u32 GetGenSizeClass
+ (size Size)
+    {
+        if(Size <= 128)
+            return Size ? (u32)((Size - 1) / 16) : 0;
+        
+        u32 Log = 0;
+        for(size S = Size - 1; S >>= 1;)
+            ++Log;
+        size Step = (size)1 << (Log - 2);
+        u32 IndexInPowerOfTwo = (u32)((Size - 1 - ((size)1 << Log)) / Step);
+        return 8 + (Log - 7) * 4 + IndexInPowerOfTwo;
+    }
+    
+    static size GetGenSizeClassBlockSize
+ (u32 SizeClass)
+    {
+        if(SizeClass < 8)
+            return (size)(SizeClass + 1) * 16;
+        
+        u32 Log = 7 + (SizeClass - 8) / 4;
+        u32 IndexInPowerOfTwo = (SizeClass - 8) % 4;
+        return ((size)1 << Log) + (size)(IndexInPowerOfTwo + 1) * ((size)1 << (Log - 2));
+    }
+    
+    static gen_span* GetGenSpan(void* Memory)
+    { return (gen_span*)((umm)Memory & ~(umm)(GenSpanSize - 1)); }
+    
+    static void* TakeAll(void* volatile& List)
+    {
+        void* Head;
+        do { Head = List; } while(AtomicCompareAndSet(List, (void*)nullptr, Head) != Head);
+        return Head;
+    }
+    
+    static void PushAtomically
+ (void* volatile& List, void* Node, void*& NodeNext)
+    {
+        void* Head;
+        do
+        {
+            Head = List;
+            NodeNext = Head;
+        }
+        while(AtomicCompareAndSet(List, Node, Head) != Head);
+    }
+    
+    static gen_heap* AdoptGenHeap()
+    {
+        rstd_ScopeLock(GenAllocatorMutex);
+        gen_heap* Heap;
+        if(GenAbandonedHeaps)
+        {
+            Heap = GenAbandonedHeaps;
+            GenAbandonedHeaps = Heap->NextAbandoned;
+        }
+        else
+        {
+            if(!GenSpanArena.MemoryBlock)
+                GenSpanArena = rstd_AllocateArenaZero(MegabytesToBytes((size)4), "GenAllocator");
+            GenSpanArena.MinimalAllocationSize = MegabytesToBytes((size)4);
+            Heap = &rstd_PushStructZero(GenSpanArena, gen_heap);
+        }
+        return Heap;
+    }
+    
+    static void AbandonGenHeap
+ (gen_heap* Heap)
+    {
+        rstd_ScopeLock(GenAllocatorMutex);
+        Heap->NextAbandoned = GenAbandonedHeaps;
+        GenAbandonedHeaps = Heap;
+    }
+    
+    static void LinkGenSpan
+ (gen_heap* Heap, gen_span* Span)
+    {
+        auto*& Head = Heap->Spans[Span->SizeClass];
+        Span->Prev = nullptr;
+        Span->Next = Head;
+        if(Head)
+            Head->Prev = Span;
+        Head = Span;
+        Span->InHeapList = true;
+    }
+    
+    static void UnlinkGenSpan
+ (gen_heap* Heap, gen_span* Span)
+    {
+        if(Span->Prev)
+            Span->Prev->Next = Span->Next;
+        else
+            Heap->Spans[Span->SizeClass] = Span->Next;
+        if(Span->Next)
+            Span->Next->Prev = Span->Prev;
+        Span->InHeapList = false;
+    }
+    
+    static gen_span* AllocateGenSpan
+ (gen_heap* Heap, u32 SizeClass)
+    {
+        gen_span* Span;
+        {
+            rstd_ScopeLock(GenAllocatorMutex);
+            Span = GenFreeSpans;
+            if(Span)
+                GenFreeSpans = Span->Next;
+            else
+                Span = (gen_span*)rstd_PushSizeUninitializedAligned(GenSpanArena, GenSpanSize, GenSpanSize);
+        }
+        
+        ZeroStruct(*Span);
+        Span->Heap = Heap;
+        Span->SizeClass = SizeClass;
+        Span->BlockSize = GetGenSizeClassBlockSize(SizeClass);
+        Span->BlockCount = (u32)((GenSpanSize - GenSpanHeaderSize) / Span->BlockSize);
+        return Span;
+    }
+    
+    static void ReleaseGenSpan
+ (gen_span* Span)
+    {
+        rstd_ScopeLock(GenAllocatorMutex);
+        Span->Next = GenFreeSpans;
+        GenFreeSpans = Span;
+    }
+    
+    static rstd_bool CollectThreadFreedBlocks
+ (gen_span* Span)
+    {
+        void* Blocks = TakeAll(Span->ThreadFreeList);
+        if(!Blocks)
+            return false;
+        
+        void* LastBlock = Blocks;
+        u32 BlockCount = 1;
+        for(; *(void**)LastBlock; LastBlock = *(void**)LastBlock)
+            ++BlockCount;
+        
+        *(void**)LastBlock = Span->FreeList;
+        Span->FreeList = Blocks;
+        Span->UsedBlockCount -= BlockCount;
+        return true;
+    }
+    
+    // NOTE: Spans emptied only by other threads never see a local free, they are found here
+    static void ReleaseEmptyGenSpans
+ (gen_heap* Heap)
+    {
+        for(u32 SizeClass = 0; SizeClass < GenSizeClassCount; ++SizeClass)
+        {
+            for(auto* Span = Heap->Spans[SizeClass]; Span;)
+            {
+                auto* NextSpan = Span->Next;
+                CollectThreadFreedBlocks(Span);
+                if(!Span->UsedBlockCount)
+                {
+                    UnlinkGenSpan(Heap, Span);
+                    ReleaseGenSpan(Span);
+                }
+                Span = NextSpan;
+            }
+        }
+    }
+    
+    static void* PopGenSpanBlock
+ (gen_span* Span)
+    {
+        void* Block = Span->FreeList;
+        if(!Block)
+        {
+            if(Span->BumpedBlockCount < Span->BlockCount)
+            {
+                Block = (u8*)Span + GenSpanHeaderSize + Span->BumpedBlockCount * Span->BlockSize;
+                ++Span->BumpedBlockCount;
+                ++Span->UsedBlockCount;
+                return Block;
+            }
+            
+            if(!CollectThreadFreedBlocks(Span))
+                return nullptr;
+            Block = Span->FreeList;
+        }
+        
+        Span->FreeList = *(void**)Block;
+        ++Span->UsedBlockCount;
+        return Block;
+    }
+    
+    static void LinkReturnedGenSpans
+ (gen_heap* Heap)
+    {
+        auto* Span = (gen_span*)TakeAll((void* volatile&)Heap->ReturnedSpans);
+        while(Span)
+        {
+            auto* NextReturned = Span->NextReturned;
+            LinkGenSpan(Heap, Span);
+            Span = NextReturned;
+        }
+    }
+    
+    thread_gen_heap::~thread_gen_heap()
+    {
+        Destroyed = true;
+        if(Heap)
+        {
+            LinkReturnedGenSpans(Heap);
+            ReleaseEmptyGenSpans(Heap);
+            AbandonGenHeap(Heap);
+            Heap = nullptr;
+        }
+    }
+    
+    static void* GenAllocateSmall
+ (gen_heap* Heap, size Size)
+    {
+        u32 SizeClass = GetGenSizeClass(Size);
+        if(!Heap->Spans[SizeClass] && Heap->ReturnedSpans)
+            LinkReturnedGenSpans(Heap);
+        
+        while(auto* Span = Heap->Spans[SizeClass])
+        {
+            void* Block = PopGenSpanBlock(Span);
+            if(Block)
+                return Block;
+            
+            UnlinkGenSpan(Heap, Span);
+            AtomicSet(Span->IsFull, 1);
+            
+            // NOTE: Other thread could free into the span before it saw IsFull set
+            if(Span->ThreadFreeList && AtomicCompareAndSet(Span->IsFull, 0, 1) == 1)
+                LinkGenSpan(Heap, Span);
+            
+            if(!Heap->Spans[SizeClass] && Heap->ReturnedSpans)
+                LinkReturnedGenSpans(Heap);
+        }
+        
+        auto* Span = AllocateGenSpan(Heap, SizeClass);
+        LinkGenSpan(Heap, Span);
+        return PopGenSpanBlock(Span);
+    }
+    
+    static void* GenAllocateSmall
+ (size Size)
+    {
+        auto& ThreadHeap = ThreadGenHeap;
+        if(ThreadHeap.Heap)
+            return GenAllocateSmall(ThreadHeap.Heap, Size);
+        
+        // NOTE: Heap adopted after thread_gen_heap destructor ran would never be abandoned again
+        if(ThreadHeap.Destroyed)
+        {
+            auto* Heap = AdoptGenHeap();
+            void* Block = GenAllocateSmall(Heap, Size);
+            AbandonGenHeap(Heap);
+            return Block;
+        }
+        
+        ThreadHeap.Heap = AdoptGenHeap();
+        return GenAllocateSmall(ThreadHeap.Heap, Size);
+    }
+    
+    static void GenFreeSmall
+ (gen_span* Span, void* Block)
+    {
+        auto* Heap = ThreadGenHeap.Heap;
+        if(Span->Heap == Heap)
+        {
+            *(void**)Block = Span->FreeList;
+            Span->FreeList = Block;
+            --Span->UsedBlockCount;
+            if(Span->ThreadFreeList)
+                CollectThreadFreedBlocks(Span);
+            
+            if(Span->IsFull)
+            {
+                if(AtomicCompareAndSet(Span->IsFull, 0, 1) == 1)
+                    LinkGenSpan(Heap, Span);
+            }
+            else if(!Span->UsedBlockCount && Span->InHeapList && Heap->Spans[Span->SizeClass] != Span)
+            {
+                UnlinkGenSpan(Heap, Span);
+                ReleaseGenSpan(Span);
+            }
+        }
+        else
+        {
+            PushAtomically(Span->ThreadFreeList, Block, *(void**)Block);
+            if(Span->IsFull && AtomicCompareAndSet(Span->IsFull, 0, 1) == 1)
+                PushAtomically((void* volatile&)Span->Heap->ReturnedSpans, Span, (void*&)Span->NextReturned);
+        }
+    }
+    
+    static void* GenAllocateLarge
+ (size Size)
+    {
+        // NOTE: Over-allocating by one span so header can be GenSpanSize aligned, untouched pages cost no physical memory
+        size AllocationSize = Align(GenSpanHeaderSize + Size + GenSpanSize, MemoryPageSize);
+        u8* Base = (u8*)PageAlloc(AllocationSize);
+        rstd_RAssert(Base, "OS Allocation call failed (probably your machine ran out of memory)");
+        
+        auto* Span = (gen_span*)Align((umm)Base, GenSpanSize);
+        Span->SizeClass = GenLargeSizeClass;
+        Span->LargeBase = Base;
+        Span->LargeAllocationSize = AllocationSize;
+        Span->BlockSize = AllocationSize - ((u8*)Span - Base) - GenSpanHeaderSize;
+        return (u8*)Span + GenSpanHeaderSize;
+    }
+    
+    void* GenAllocatorAlloc
+ (size Size)
+    { return Size <= GenMaxSmallSize ? GenAllocateSmall(Size) : GenAllocateLarge(Size); }
+    
+    void GenAllocatorFree
+ (void* Memory)
+    {
+        auto* Span = GetGenSpan(Memory);
+        if(Span->SizeClass == GenLargeSizeClass)
+            PageFree(Span->LargeBase, Span->LargeAllocationSize);
+        else
+            GenFreeSmall(Span, Memory);
+    }
+    
+    size GetGenAllocationSize
+ (void* Memory)
+    { return GetGenSpan(Memory)->BlockSize; }
+    
+    void* GenAllocatorRealloc
+ (void* Memory, size NewSize)
+    {
+        if(!Memory)
+            return GenAllocatorAlloc(NewSize);
+        
+        // NOTE: Shrinking by less than a half keeps the allocation
+        size Capacity = GetGenAllocationSize(Memory);
+        if(NewSize <= Capacity && NewSize >= Capacity / 2)
+            return Memory;
+        
+        void* NewMemory = GenAllocatorAlloc(NewSize);
+        memcpy(NewMemory, Memory, NewSize < Capacity ? NewSize : Capacity);
+        GenAllocatorFree(Memory);
+        return NewMemory;
+    }
+    
+    ////////////////////
+    // SCRATCH ARENAS //
+    ////////////////////
+    struct thread_scratch_arenas
+    {
+        arena Arenas[rstd_ScratchArenaCount];
+        ~thread_scratch_arenas();
+    };
+    
+    static thread_local thread_scratch_arenas ThreadScratchArenas;
+    
+    thread_scratch_arenas::~thread_scratch_arenas()
+    {
+        // NOTE: Blocks go straight to the OS, thread memory block cache might be already destroyed
+        for(auto& Arena : Arenas)
+        {
+            if(Arena.MemoryBlock)
+                DeallocateArena(Arena);
+        }
+    }
+    
+    temporary_memory GetScratch
+ (arena* const* Conflicts, u32 ConflictCount)
+    {
+        for(auto& Arena : ThreadScratchArenas.Arenas)
+        {
+            rstd_bool IsConflicting = false;
+            for(u32 ConflictIndex = 0; ConflictIndex < ConflictCount; ++ConflictIndex)
+            {
+                if(Conflicts[ConflictIndex] == &Arena)
+                {
+                    IsConflicting = true;
+                    break;
+                }
+            }
+            
+            if(!IsConflicting)
+            {
+                // NOTE: Reserving is cheap, pages get committed only when scratch is actually used
+                if(!Arena.MemoryBlock)
+                    Arena = rstd_ReserveArena(rstd_ScratchArenaReserveSize, "Scratch");
+                return BeginTemporaryMemory(Arena);
+            }
+        }
+        
+        rstd_InvalidCodePathM("All scratch arenas are conflicting, increase rstd_ScratchArenaCount");
+        return {};
+    }
+    
+    void AssertNoScratchIsInUse()
+    {
+#if rstd_Debug
+        for(auto& Arena : ThreadScratchArenas.Arenas)
+            rstd_AssertM(Arena.TempMemCount == 0, "Scratch memory wasn't ended");
+#endif
+    }
+    
+#ifdef rstd_ThreadPoolLogging
+#if rstd_ThreadPoolLogging
+#define ThreadPoolLog(_Str) InternalPrintInDebugger(_Str)
+#else
+#define ThreadPoolLog(_Str)
+#endif
+#else
+#define ThreadPoolLog(_Str)
+#endif
+    
+    /////////////////////
+    // MULTI-THREADING //
+    /////////////////////
+#if rstd_MultiThreadingEnabled
+    // NOTE: Job is copied out so its node can go to free list right away, nodes are reused by PushJob()
+    rstd_bool PopJob
+ (thread_pool_job_list& List, thread_pool_job& Job)
+    {
+        rstd_Assert(List.Mutex.Locked);
+        auto* JobNode = List.NextJobToTake;
+        if(!JobNode)
+            return false;
+        
+        if(List.NextJobToTake == List.LastJobToTake)
+            List.NextJobToTake = List.LastJobToTake = nullptr;
+        else
+            List.NextJobToTake = List.NextJobToTake->Next;
+        
+        Job = *JobNode;
+        JobNode->Next = List.JobFreeList;
+        List.JobFreeList = JobNode;
+        return true;
+    }
+    
+    static thread_pool_job_node* AllocateJobNode
+ (thread_pool_job_list& List, thread_pool_job Job)
+    {
+        rstd_Assert(List.Mutex.Locked);
+        auto* JobNode = List.JobFreeList;
+        if(JobNode)
+            List.JobFreeList = JobNode->Next;
+        else
+            JobNode = &rstd_PushStructUninitialized(List.Arena, thread_pool_job_node);
+        
+        JobNode->CallbackUserData = Job.CallbackUserData;
+        JobNode->Callback = Job.Callback;
+        JobNode->Next = nullptr;
+        return JobNode;
+    }
+#endif
+    
+    void CompleteAllJobs
+ (thread_pool& Pool)
+    {
+#if rstd_MultiThreadingEnabled
+        auto& List = Pool.JobList;
+        while(List.NextJobToTake || Pool.RunningJobCount)
+        {
+            thread_pool_job Job;
+            Lock(List.Mutex);
+            rstd_bool Popped = PopJob(List, Job);
+            Unlock(List.Mutex);
+            if(Popped)
+                Job.Callback(Job.CallbackUserData);
+        }
+#endif
+    }
+    
+    ///////////
+    // FILES //
+    ///////////
+#if rstd_FileDebugEnabled
+    
+    struct file_debug
+    {
+        struct open_file
+        {
+            string<> FilePath;
+            void* PlatformFileHandle;
+        };
+        
+        backward_singly_linked_list_with_counter<open_file> OpenFiles;
+        mutex Mutex;
+        
+        file_debug()
+        { OpenFiles = {OwnArena(rstd_AllocateArenaZero(MegabytesToBytes(1)))}; }
+        
+        void OnOpenFile
+ (const char* FilePath, void* PlatformFileHandle)
+        {
+            rstd_ScopeLock(Mutex);
+            OpenFiles.Push({FilePath, PlatformFileHandle});
+        }
+        
+        void OnCloseFile
+ (void* PlatformFileHandle)
+        {
+            rstd_ScopeLock(Mutex);
+            OpenFiles.RemoveFirstIfWithAssert(
+ [=](auto& File){ return File.PlatformFileHandle == PlatformFileHandle; });
+        }
+    };
+    
+#else
+    
+    struct file_debug
+    {
+        void OnOpenFile(const char* FilePath, void* PlatformFileHandle) {}
+        void OnCloseFile(void* PlatformFileHandle) {}
+    };
+    
+#endif
+    
+    static file_debug FileDebug;
+    
+    
+#ifdef _WIN32
+#ifndef rstd_ExcludeDebugPrintingFunctions
+    ////////////////////
+    // DEBUG PRINTING //
+    ////////////////////
+    u32 GetSystemErrorCode()
+    { return GetLastError(); }
+    
+    void InternalPrintInDebugger(const char* Message)
+    { OutputDebugStringA(Message); }
+    
+    void InternalWarningMessageBox(const char* Message)
+    { MessageBoxA(0, Message, "Warning!", MB_ICONWARNING|MB_OK); }
+    
+    void ShowErrorMessageBox(const char* Message)
+    { MessageBoxA(0, Message, "Error!", MB_ICONERROR|MB_OK); }
+    
+    void ShowErrorMessageBoxAndExitProcess
+ (const char* Message)
+    {
+        ShowErrorMessageBox(Message);
+        ExitProcess(0);
+    }
+#endif
+    
+    ///////////////////////
+    // MEMORY ALLOCATION //
+    ///////////////////////
+    void* PageAlloc(size Bytes)
+    { return VirtualAlloc(nullptr, Bytes, MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE); }
+    
+    void* HugePageAlloc
+ (size Bytes)
+    {
+        // NOTE: Large pages need SeLockMemoryPrivilege, without it we fall back to normal pages
+        size LargePageSize = GetLargePageMinimum();
+        if(LargePageSize && Bytes % LargePageSize == 0)
+        {
+            void* Memory = VirtualAlloc(nullptr, Bytes, MEM_RESERVE|MEM_COMMIT|MEM_LARGE_PAGES, PAGE_READWRITE);
+            if(Memory)
+                return Memory;
+        }
+        return PageAlloc(Bytes);
+    }
+    
+    void PageFree(void* Memory, size Bytes)
+    { VirtualFree(Memory, 0, MEM_RELEASE); }
+    
+    void* PageReserve(size Bytes)
+    { return VirtualAlloc(nullptr, Bytes, MEM_RESERVE, PAGE_NOACCESS); }
+    
+    rstd_bool PageCommit(void* Memory, size Bytes)
+    { return VirtualAlloc(Memory, Bytes, MEM_COMMIT, PAGE_READWRITE) != nullptr; }
+    
+    void PageDecommit(void* Memory, size Bytes)
+    { VirtualFree(Memory, Bytes, MEM_DECOMMIT); }
+    
+    // NOTE: Recommitted pages are zero, MEM_RESET would keep old content if pages aren't reclaimed
+    rstd_bool PageReset
+ (void* Memory, size Bytes)
+    {
+        if(!VirtualFree(Memory, Bytes, MEM_DECOMMIT))
+            return false;
+        rstd_RAssert(PageCommit(Memory, Bytes), "OS Commit call failed (probably your machine ran out of memory)");
+        return true;
+    }
+    
+    /////////////////////
+    // MULTI-THREADING //
+    /////////////////////
+    u32 AtomicIncrement
+ (volatile u32& A)
+    {
+#if rstd_MultiThreadingEnabled
+        return InterlockedIncrement(&A);
+#else
+        return ++A;
+#endif
+    }
+    
+    u32 AtomicDecrement
+ (volatile u32& A)
+    {
+#if rstd_MultiThreadingEnabled
+        return InterlockedDecrement(&A);
+#else
+        return --A;
+#endif
+    }
+    
+    size AtomicAdd
+ (volatile size& A, size Addend)
+    {
+#if rstd_MultiThreadingEnabled
+        return (size)InterlockedAdd64((volatile LONG64*)&A, (LONG64)Addend);
+#else
+        return A += Addend;
+#endif
+    }
+    
+    i32 AtomicSet
+ (volatile i32& Destination, i32 NewValue)
+    {
+#if rstd_MultiThreadingEnabled
+        i32 InitialValueInDestination = InterlockedExchange((LONG*)&Destination, NewValue);
+#else
+        i32 InitialValueInDestination = Destination;
+        Destination = NewValue;
+#endif
+        return InitialValueInDestination;
+    }
+    
+    i32 AtomicCompareAndSet
+ (volatile i32& Destination, i32 NewValue, i32 ValueThatShouldBeInDestination)
+    {
+#if rstd_MultiThreadingEnabled
+        i32 ValueThatReallyIsInDestination = InterlockedCompareExchange((volatile LONG*)&Destination,
+                                                                        NewValue, ValueThatShouldBeInDestination);
+        return ValueThatReallyIsInDestination;
+#else
+        Destination = NewValue;
+        return Destination;
+#endif
+    }
+    
+    i64 AtomicCompareAndSet
+ (volatile i64& Destination, i64 NewValue, i64 ValueThatShouldBeInDestination)
+    {
+#if rstd_MultiThreadingEnabled
+        i64 ValueThatReallyIsInDestination = InterlockedCompareExchange64(&Destination, NewValue, ValueThatShouldBeInDestination);
+        return ValueThatReallyIsInDestination;
+#else
+        Destination = NewValue;
+        return Destination;
+#endif
+    }
+    
+    void* AtomicCompareAndSet
+ (void* volatile& Destination, void* NewValue, void* ValueThatShouldBeInDestination)
+    {
+#if rstd_MultiThreadingEnabled
+        return InterlockedCompareExchangePointer(&Destination, NewValue, ValueThatShouldBeInDestination);
+#else
+        void* ValueThatReallyIsInDestination = Destination;
+        if(ValueThatReallyIsInDestination == ValueThatShouldBeInDestination)
+            Destination = NewValue;
+        return ValueThatReallyIsInDestination;
+#endif
+    }
+    
+#if rstd_MultiThreadingEnabled
+    DWORD WINAPI ThreadProc
+ (LPVOID ThreadPoolVoidPtr)
+    {
+#if rstd_ThreadPoolLogging
+        u32 ThreadId = GetThreadID();
+#endif
+        ThreadPoolLog(Format<string<>>("Thread % starts\n", ThreadId));
+        
+        thread_pool& ThreadPool = *(thread_pool*)ThreadPoolVoidPtr;
+        auto& List = ThreadPool.JobList;
+        for(;;)
+        {
+            ThreadPoolLog(Format<string<>>("Thread % at the begining of loop\n", ThreadId));
+            while(List.NextJobToTake)
+            {
+                if(TryLock(List.Mutex))
+                {
+                    ThreadPoolLog(Format<string<>>("Mutex is locked by thread: %\n", ThreadId));
+                    ThreadPoolLog(Format<string<>>("Thread % took the job\n", ThreadId));
+                    
+                    thread_pool_job CurrentJob;
+                    rstd_bool Popped = PopJob(List, CurrentJob);
+                    if(Popped)
+                        AtomicIncrement(ThreadPool.RunningJobCount);
+                    Unlock(List.Mutex);
+                    ThreadPoolLog(Format<string<>>("Mutex is unlocked by thread: %\n", ThreadId));
+                    
+                    if(Popped)
+                    {
+                        ThreadPoolLog(Format<string<>>("Thread % About to call Callback\n", ThreadId));
+                        CurrentJob.Callback(CurrentJob.CallbackUserData);
+                        rstd_DebugOnly(AssertNoScratchIsInUse());
+                        AtomicDecrement(ThreadPool.RunningJobCount);
+                    }
+                }
+            }
+            ThreadPoolLog(Format<string<>>("Thread % going to sleep\n", ThreadId));
+            WaitForSingleObjectEx(ThreadPool.SemaphoreHandle, INFINITE, FALSE);
+            ThreadPoolLog(Format<string<>>("Thread % awakes\n", ThreadId));
+        }
+    }
+#endif
+    
+    void Init
+ (thread_pool& Pool, u32 ThreadCount, arena Arena)
+    {
+#if rstd_MultiThreadingEnabled
+        Pool = {};
+        
+        Pool.JobList.Arena = Arena;
+        Pool.SemaphoreHandle = CreateSemaphore(0, 0, ThreadCount, nullptr);
+        Pool.ThreadCount = ThreadCount;
+        
+        for(u32 ThreadIndex = 0; ThreadIndex < ThreadCount; ++ThreadIndex)
+        {
+            DWORD ThreadId;
+            auto ThreadHandle = CreateThread(0, 0, ThreadProc, &Pool, 0, &ThreadId);
+            CloseHandle(ThreadHandle); // TODO: Support changing number of threads in runtime?
+        }
+#endif
+    }
+    
+    void PushJob
+ (thread_pool& Pool, void* JobUserData, thread_pool_job_callback* JobCallback)
+    {
+#if rstd_MultiThreadingEnabled
+        auto& List = Pool.JobList;
+        Lock(List.Mutex);
+        auto* JobNode = AllocateJobNode(List, {JobUserData, JobCallback});
+        ThreadPoolLog("Mutex is locked by PushJob\n");
+        if(List.NextJobToTake)
+        {
+            List.LastJobToTake->Next = JobNode;
+            List.LastJobToTake = JobNode;
+        }
+        else
+        {
+            List.NextJobToTake = List.LastJobToTake = JobNode;
+        }
+        Unlock(List.Mutex);
+        ThreadPoolLog("Mutex is unlocked by PushJob\n");
+        
+        ReleaseSemaphore(Pool.SemaphoreHandle, 1, 0);
+        ThreadPoolLog("Thread should be awoken now\n");
+#else
+        JobCallback(JobUserData);
+#endif
+    }
+    
+    template<class job_container>
+        void PushJobs
+ (thread_pool& Pool, job_container Jobs)
+    {
+#if rstd_MultiThreadingEnabled
+        auto& List = Pool.JobList;
+        
+        u32 PushedJobCount = Jobs.GetCount();
+        
+        Lock(List.Mutex);
+        ThreadPoolLog("Mutex is locked by PushJob\n");
+        
+        if(!List.NextJobToTake)
+        {
+            auto LastJob = Jobs.GetAndPopLast();
+            auto* JobNode = AllocateJobNode(List, LastJob);
+            List.NextJobToTake = List.LastJobToTake = JobNode;
         }
         
-        template<class comparison_fn>
-            void RemoveFirstIfWithAssert
- (comparison_fn Comparison)
+        for(auto Job : Jobs)
         {
-            backward_singly_linked_list<type>::RemoveFirstIfWithAssert(Comparison);	
-            --Count;
+            auto* JobNode = AllocateJobNode(List, Job);
+            List.LastJobToTake->Next = JobNode;
+            List.LastJobToTake = JobNode;
         }
         
-        template<class comparison_fn>
-            optional<type> RemoveFirstIfReturnCopy
- (comparison_fn Comparison)
+        Unlock(List.Mutex);
+        ThreadPoolLog("Mutex is unlocked by PushJob\n");
+        
+        u32 ThreadsToAwakeCount = PushedJobCount > Pool.ThreadCount ? Pool.ThreadCount : PushedJobCount;
+        LONG WorkingThreadCount = 0;
+        ThreadPoolLog(Format<string<>>("ReleaseSemaphore 1 - ThreadsToAwakeCount: %\n", ThreadsToAwakeCount));
+        if(!ReleaseSemaphore(Pool.SemaphoreHandle, ThreadsToAwakeCount, &WorkingThreadCount))
         {
-            auto Res = backward_singly_linked_list<type>::RemoveFirstIfReturnCopy(Comparison);
-            if(Res)
-                --Count;
-            return Res;
+            ThreadsToAwakeCount = Pool.ThreadCount - WorkingThreadCount;
+            ThreadPoolLog(Format<string<>>("ReleaseSemaphore 2 - ThreadsToAwakeCount: %, WorkingThreadCount: %\n", ThreadsToAwakeCount, WorkingThreadCount));
+            ReleaseSemaphore(Pool.SemaphoreHandle, ThreadsToAwakeCount, nullptr);
+        }
+#else
+        for(auto Job : Jobs)
+            Job.Callback(Job.CallbackUserData);
+#endif
+    }
+    
+    ///////////
+    // FILES //
+    ///////////
+    file_error GetLastFileError()
+    {
+        auto Error = GetLastError();
+        switch(Error)
+        {
+            case ERROR_SUCCESS: return file_error::NoError;
+            case ERROR_FILE_NOT_FOUND: return file_error::FileIsMissing;
+            case ERROR_PATH_NOT_FOUND: return file_error::DirectoryOnPathIsMissing;
+            case ERROR_INVALID_HANDLE: return file_error::DirectoryOnPathIsMissing; // TODO: Can't ERROR_INVALID_HANDLE be produced in other cases?
+            case ERROR_ACCESS_DENIED: return file_error::AccessToFileWasDenied;
+            default: return file_error::UnknownError;
+        }
+    }
+    
+    backward_singly_linked_list_with_counter<file_info> GetFileInfos
+ (arena& Arena, const char* DirectoryPath)
+    {
+        backward_singly_linked_list_with_counter<file_info> FileInfos = ShareArena(Arena);
+        
+        // TODO: Support unicode file names
+        
+        string<258> Path = DirectoryPath; // TODO: Add support for 32767 character paths! (I guess in a separate function)
+        Path += "/*";
+        
+        WIN32_FIND_DATA FindData;
+        HANDLE FindHandle = FindFirstFileA(Path.GetCString(), &FindData); // name of first found thing is "." TODO: Make sure it's true
+        if(FindHandle != INVALID_HANDLE_VALUE)
+        {
+            FindNextFileA(FindHandle, &FindData); // name of second found thing is ".." TODO: Make sure it's true
+            
+            while(FindNextFileA(FindHandle, &FindData))
+            {
+                file_info FileInfo;
+                FileInfo.Name = rstd_PushStringCopy(Arena, FindData.cFileName);
+                FileInfos.Push(FileInfo);
+            }
+            FindClose(FindHandle);
+        }
+        
+        return FileInfos;
+    }
+    
+    // TODO: Try to rename those to DeleteFile and MoveFile,
+    //       You can use :: operator after you wrap this library in rlsr namespace
+    //       Or you can do:
+    //       namespace win32
+    //       {
+    //			#include <windows.h>
+    //       }
+    
+#undef CopyFile // TODO: What to do about those stupid macros and repeated names (same name in rstd and win32)
+#undef CreateDirectory
+    
+    // TODO: Make unicode version of those functions in which path can be longer the MAX_PATH
+    
+    i32 RemoveFile(const char* FilePath)
+    { return DeleteFileA(FilePath); }
+    
+    i32 RenameFile(const char* FilePath, const char* NewFilePath)
+    { return MoveFile(FilePath, NewFilePath); }
+    
+    const rstd_bool FailIfFileWithNewPathExists = true;
+    const rstd_bool OverrideFileIfFileWithNewPathExists = false;
+    
+    rstd_bool CopyFile(const char* ExistingFilePath, const char* NewFilePath, rstd_bool FailOrOverride)
+    { return (rstd_bool)CopyFileA(ExistingFilePath, NewFilePath, (BOOL)FailOrOverride); }
+    
+    rstd_bool FileExists
+ (const char* Path)
+    {
+        u32 Attrib = GetFileAttributes(Path);
+        return Attrib != INVALID_FILE_ATTRIBUTES && !(Attrib & FILE_ATTRIBUTE_DIRECTORY);
+    }
+    
+    // TODO: Make OpenFile api support control over dwShareMode, dwCreationDisposition, dwFlagsAndAttributes
+    file OpenFile
+ (const char* FilePath, io_mode Mode)
+    {
+        file File = {};
+        
+        u32 DesiredAccess = 0;
+        u32 CreationDisposition = 0;
+        switch(Mode)
+        {
+            case io_mode::Read:
+            {
+                DesiredAccess = GENERIC_READ;
+                CreationDisposition = OPEN_EXISTING;
+            } break;
+            
+            case io_mode::Write:
+            {
+                DesiredAccess = GENERIC_WRITE;
+                CreationDisposition = OPEN_ALWAYS;
+            } break;
+            
+            case io_mode::ReadWrite:
+            {
+                DesiredAccess = GENERIC_READ | GENERIC_WRITE;
+                CreationDisposition = OPEN_ALWAYS;
+            } break;
+            
+            rstd_InvalidDefaultCase;
         }
         
-        template<class comparison_fn>
-            type RemoveFirstIfWithAssertReturnCopy
- (comparison_fn Comparison)
+        File.PlatformFileHandle = ::CreateFileA(FilePath, DesiredAccess,
+                                                FILE_SHARE_READ, 0, CreationDisposition, 0, 0);
+        if(File.PlatformFileHandle == INVALID_HANDLE_VALUE)
+            File.PlatformFileHandle = nullptr;
+        else
+            FileDebug.OnOpenFile(FilePath, File.PlatformFileHandle);
+        
+        return File;
+    }
+    
+    rstd_bool Close
+ (file& File)
+    { 
+        rstd_bool Succeded = (rstd_bool)CloseHandle(File.PlatformFileHandle);
+        if(Succeded)
+            FileDebug.OnCloseFile(File.PlatformFileHandle);
+        File.PlatformFileHandle = nullptr;
+        return Succeded;
+    }
+    
+    OVERLAPPED MakeOverlapped
+ (u64 Pos)
+    {
+        OVERLAPPED Overlapped = {};
+        Overlapped.Offset = (u32)Pos;
+        Overlapped.OffsetHigh = (u32)(Pos >> 32);
+        return Overlapped;
+    }
+    
+    u32 Write
+ (file File, u64 Pos, void* Data, u32 Size)
+    {
+        rstd_Assert(File);
+        DWORD WrittenBytes;
+        auto Overlapped = MakeOverlapped(Pos);
+        WriteFile(File.PlatformFileHandle, Data, Size, &WrittenBytes, &Overlapped);
+        // TODO: Check if GetLastError returned ERROR_IO_PENDING
+        return WrittenBytes;
+    }
+    
+    u32 Read
+ (void* Dest, file File, u64 Pos, u32 Size)
+    {
+        rstd_Assert(File);
+        DWORD ReadBytes;
+        auto Overlapped = MakeOverlapped(Pos);
+        ReadFile(File.PlatformFileHandle, Dest, Size, &ReadBytes, &Overlapped);
+        // TODO: Check if GetLastError returned ERROR_IO_PENDING
+        return ReadBytes;
+    }
+    
+    // TODO: Add u64 version of this function
+    rstd_bool SetFileSize
+ (file File, u32 Size)
+    {
+        LARGE_INTEGER FilePointer = {};
+        FilePointer.QuadPart = Size;
+        auto FileHandle = File.PlatformFileHandle;
+        auto Success = SetFilePointerEx(FileHandle, FilePointer, 0, FILE_BEGIN) && SetEndOfFile(FileHandle);
+        return (rstd_bool)Success;
+    }
+    
+    // TODO: Make this function work for size_t
+    u32 GetFileSize
+ (file File)
+    { 
+        LARGE_INTEGER Int;
+        if(GetFileSizeEx(File.PlatformFileHandle, &Int))
+            return (u32)Int.QuadPart;
+        else
+            return InvalidU32;
+    }
+    
+    void* MapFile
+ (file File, size Bytes)
+    {
+        HANDLE Mapping = CreateFileMappingA(File.PlatformFileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if(!Mapping)
+            return nullptr;
+        // NOTE: View keeps the mapping object alive
+        void* Memory = MapViewOfFile(Mapping, FILE_MAP_COPY, 0, 0, Bytes);
+        CloseHandle(Mapping);
+        return Memory;
+    }
+    
+    rstd_bool UnmapFile(void* Memory, size Bytes)
+    { return (rstd_bool)UnmapViewOfFile(Memory); }
+    
+    rstd_bool CreateDirectory(const char* Path)
+    { return ::CreateDirectoryA(Path, nullptr); }
+    
+    rstd_bool CreateDirectory(const wchar_t* Path)
+    { return CreateDirectoryW(Path, nullptr); }
+    
+    rstd_bool DeleteDirectory(const char* Path)
+    { return RemoveDirectoryA(Path); }
+    
+    // TODO: What's up with prepend "\\?\". Check the docs and test it!
+    rstd_bool DeleteDirectory(const wchar_t* Path)
+    { return RemoveDirectoryW(Path); }
+    
+    // TODO: Paths longer then MAX_PATH could be a problem here. Should I use unicode versions of DeleteFile and DeleteDirectory?
+    rstd_bool DeleteAllContentsOfDirectory
+ (const char* Path)
+    {
+        string<> SearchPath = Path;
+        SearchPath += "/*";
+        
+        WIN32_FIND_DATA FindData;
+        HANDLE FindHandle = FindFirstFileA(SearchPath.GetCString(), &FindData); // name of first found thing is "." TODO: Make sure it's true
+        if(FindHandle == INVALID_HANDLE_VALUE)
         {
-            auto Res = backward_singly_linked_list<type>::RemoveFirstIfWithAssertReturnCopy(Comparison);
-            --Count;
-            return Res;
+            return false;
         }
-        
-        rstd_bool RemoveFirstEqualTo
- (type& E)
+        else
         {
-            rstd_bool ManagedToRemove = backward_singly_linked_list<type>::RemoveFirstEqualTo(E);
-            if(ManagedToRemove)
-                --Count;
-            return ManagedToRemove;
+            FindNextFileA(FindHandle, &FindData); // name of second found thing is ".." TODO: Make sure it's true
+            
+            while(FindNextFileA(FindHandle, &FindData))
+            {
+                string<> FilePath = Path;
+                FilePath += "/";
+                FilePath += FindData.cFileName;
+                if(FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                {
+                    DeleteAllContentsOfDirectory(FilePath.GetCString());
+                    DeleteDirectory(FilePath.GetCString());
+                }
+                else
+                {
+                    DeleteFile(FilePath.GetCString());
+                }
+            }
+            FindClose(FindHandle);
+            return true;
         }
-    };
+    }
     
+    //////////
+    // TIME //
+    //////////
+    static time ConvertToTime
+ (SYSTEMTIME& St)
+    {
+        time Time;
+        Time.Year = (u32)St.wYear;
+        Time.Month = (month)St.wMonth;
+        Time.Day = (u8)St.wDay;
+        Time.DayOfWeek = St.wDayOfWeek == 0 ? day_of_week::Sunday : (day_of_week)St.wDayOfWeek;
+        Time.Hour = (u8)St.wHour;
+        Time.Minute = (u8)St.wMinute;
+        Time.Second = (u8)St.wSecond;
+        Time.Millisecond = St.wMilliseconds;
+        return Time;
+    }
     
-    /////////////////////
-    // MULTI-THREADING //
-    /////////////////////
+    time GetUtcTime()
+    {
+        SYSTEMTIME St;
+        GetSystemTime(&St);
+        return ConvertToTime(St);
+    }
     
-#ifdef _WIN32
-    static void WriteFence()
+    time GetLocalTime()
     {
-#if rstd_MultiThreadingEnabled
-        _WriteBarrier(); _mm_sfence();
-#endif
+        SYSTEMTIME St;
+        GetLocalTime(&St);
+        return ConvertToTime(St);
     }
     
-    static void ReadFence()
+    u64 GetSystemTimeAsUnixEpoch()
     {
-#if rstd_MultiThreadingEnabled
-        _ReadBarrier();
+        union file_time 
+        {
+            FILETIME FileTime;
+            u64 U64;
+        };
+        file_time Res;
+        GetSystemTimeAsFileTime(&Res.FileTime);
+        u64 DifferenceBetweenWindowsEpochAndUnixEpoch = 116444736000000000;
+        Res.U64 -= DifferenceBetweenWindowsEpochAndUnixEpoch;
+        return Res.U64;
+    }
+    
+#else // POSIX
+#ifndef rstd_ExcludeDebugPrintingFunctions
+    ////////////////////
+    // DEBUG PRINTING //
+    ////////////////////
+    u32 GetSystemErrorCode()
+    { return (u32)errno; }
+    
+    void InternalPrintInDebugger(const char* Message)
+    { fputs(Message, stderr); }
+    
+    void InternalWarningMessageBox(const char* Message)
+    { fprintf(stderr, "Warning!\n%s\n", Message); }
+    
+    void ShowErrorMessageBox(const char* Message)
+    { fprintf(stderr, "Error!\n%s\n", Message); }
+    
+    void ShowErrorMessageBoxAndExitProcess
+ (const char* Message)
+    {
+        ShowErrorMessageBox(Message);
+        exit(1);
+    }
 #endif
+    
+    ///////////////////////
+    // MEMORY ALLOCATION //
+    ///////////////////////
+    void* PageAlloc
+ (size Bytes)
+    {
+        void* Memory = mmap(nullptr, Bytes, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        return Memory == MAP_FAILED ? nullptr : Memory;
     }
     
-    static void ReadWriteFence()
+    void* HugePageAlloc
+ (size Bytes)
     {
-#if rstd_MultiThreadingEnabled
-        _ReadWriteBarrier();
+        rstd_Assert(Bytes % HugePageSize == 0);
+        
+#ifdef MAP_HUGETLB
+        // NOTE: These work only if huge pages were reserved (/proc/sys/vm/nr_hugepages)
+        void* Memory = MAP_FAILED;
+#ifdef MAP_HUGE_1GB
+        if(Bytes % GiganticPageSize == 0)
+            Memory = mmap(nullptr, Bytes, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB|MAP_HUGE_1GB, -1, 0);
+#endif
+        if(Memory == MAP_FAILED)
+            Memory = mmap(nullptr, Bytes, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+        if(Memory != MAP_FAILED)
+            return Memory;
+#endif
+        
+        // NOTE: Transparent huge pages are used only for HugePageSize aligned ranges,
+        //       so we map more and unmap the unaligned ends
+        u8* Mapping = (u8*)mmap(nullptr, Bytes + HugePageSize, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        if(Mapping == MAP_FAILED)
+            return nullptr;
+        
+        u8* Aligned = (u8*)Align((umm)Mapping, HugePageSize);
+        if(Aligned != Mapping)
+            munmap(Mapping, Aligned - Mapping);
+        u8* MappingEnd = Mapping + Bytes + HugePageSize;
+        if(Aligned + Bytes != MappingEnd)
+            munmap(Aligned + Bytes, MappingEnd - (Aligned + Bytes));
+        
+#ifdef MADV_HUGEPAGE
+        madvise(Aligned, Bytes, MADV_HUGEPAGE);
 #endif
+        return Aligned;
     }
     
-    u32 AtomicIncrement(volatile u32& A);
-    u32 AtomicDecrement(volatile u32& A);
+    void PageFree(void* Memory, size Bytes)
+    { munmap(Memory, Bytes); }
     
-    i32 AtomicSet(volatile i32& Destination, i32 NewValue);
+    void* PageReserve
+ (size Bytes)
+    {
+        void* Memory = mmap(nullptr, Bytes, PROT_NONE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+        return Memory == MAP_FAILED ? nullptr : Memory;
+    }
     
-    u32 AtomicSet(volatile u32& Destination, u32 NewValue)
-    { return AtomicSet((volatile i32&)Destination, (i32)NewValue);}
+    rstd_bool PageCommit(void* Memory, size Bytes)
+    { return mprotect(Memory, Bytes, PROT_READ|PROT_WRITE) == 0; }
     
-    i32 AtomicCompareAndSet
- (volatile i32& Destination, i32 NewValue, i32 ValueThatShouldBeInDestination);
+    void PageDecommit
+ (void* Memory, size Bytes)
+    {
+        madvise(Memory, Bytes, MADV_DONTNEED);
+        mprotect(Memory, Bytes, PROT_NONE);
+    }
     
-    i64 AtomicCompareAndSet
- (volatile i64& Destination, i64 NewValue, i64 ValueThatShouldBeInDestination);
+    // NOTE: MADV_DONTNEED on private anonymous mapping makes next touch fault in a zero page
+    rstd_bool PageReset(void* Memory, size Bytes)
+    { return madvise(Memory, Bytes, MADV_DONTNEED) == 0; }
     
-    static u32 AtomicCompareAndSet(volatile u32& Destination, u32 NewValue, u32 ValueThatShouldBeInDestination)
-    { return (u32)AtomicCompareAndSet((volatile i32&)Destination, (i32)NewValue, (i32)ValueThatShouldBeInDestination); }
+    /////////////////////
+    // MULTI-THREADING //
+    /////////////////////
+    u32 GetThreadID()
+    {
+        static thread_local u32 ThreadId = (u32)syscall(SYS_gettid);
+        return ThreadId;
+    }
     
-    // TODO: Do cast with assetion or use different intrinsic
-    static u64 AtomicCompareAndSet(volatile u64& Destination, u64 NewValue, u64 ValueThatShouldBeInDestination)
-    { return (u64)AtomicCompareAndSet((volatile i64&)Destination, (i64)NewValue, (i64)ValueThatShouldBeInDestination); }
+#if rstd_MultiThreadingEnabled
+    // NOTE: Counting semaphore on a futex word, MaxCount mimics the maximum count of win32 semaphore
+    static void WaitForSemaphore
+ (volatile u32& Count)
+    {
+        for(;;)
+        {
+            u32 Value = Count;
+            while(Value)
+            {
+                u32 ValueThatWasInCount = AtomicCompareAndSet(Count, Value - 1, Value);
+                if(ValueThatWasInCount == Value)
+                    return;
+                Value = ValueThatWasInCount;
+            }
+            syscall(SYS_futex, &Count, FUTEX_WAIT_PRIVATE, 0, nullptr, nullptr, 0);
+        }
+    }
     
-    static u32 GetThreadID()
+    static void ReleaseSemaphore
+ (volatile u32& Count, u32 ReleaseCount, u32 MaxCount)
     {
-        u8 *ThreadLocalStorage = (u8 *)__readgsqword(0x30);
-        return *(u32*)(ThreadLocalStorage + 0x48);
+        u32 Value = Count;
+        for(;;)
+        {
+            u32 NewValue = Value + ReleaseCount > MaxCount ? MaxCount : Value + ReleaseCount;
+            if(NewValue <= Value)
+                return;
+            
+            u32 ValueThatWasInCount = AtomicCompareAndSet(Count, NewValue, Value);
+            if(ValueThatWasInCount == Value)
+            {
+                ReleaseCount = NewValue - Value;
+                break;
+            }
+            Value = ValueThatWasInCount;
+        }
+        syscall(SYS_futex, &Count, FUTEX_WAKE_PRIVATE, ReleaseCount, nullptr, nullptr, 0);
     }
     
+    static void* ThreadProc
+ (void* ThreadPoolVoidPtr)
+    {
+#if rstd_ThreadPoolLogging
+        u32 ThreadId = GetThreadID();
+#endif
+        ThreadPoolLog(Format<string<>>("Thread % starts\n", ThreadId));
+        
+        thread_pool& ThreadPool = *(thread_pool*)ThreadPoolVoidPtr;
+        auto& List = ThreadPool.JobList;
+        for(;;)
+        {
+            ReadFence();
+            while(List.NextJobToTake)
+            {
+                if(TryLock(List.Mutex))
+                {
+                    thread_pool_job CurrentJob;
+                    rstd_bool Popped = PopJob(List, CurrentJob);
+                    if(Popped)
+                        AtomicIncrement(ThreadPool.RunningJobCount);
+                    Unlock(List.Mutex);
+                    
+                    if(Popped)
+                    {
+                        ThreadPoolLog(Format<string<>>("Thread % took the job\n", ThreadId));
+                        CurrentJob.Callback(CurrentJob.CallbackUserData);
+                        rstd_DebugOnly(AssertNoScratchIsInUse());
+                        AtomicDecrement(ThreadPool.RunningJobCount);
+                    }
+                }
+                ReadFence();
+            }
+            ThreadPoolLog(Format<string<>>("Thread % going to sleep\n", ThreadId));
+            WaitForSemaphore(ThreadPool.SemaphoreCount);
+            ThreadPoolLog(Format<string<>>("Thread % awakes\n", ThreadId));
+        }
+        return nullptr;
+    }
 #endif
     
-    struct mutex
-    { volatile i32 Locked = 0; };
-    
-    static void Lock
- (volatile i32& Locked)
+    void Init
+ (thread_pool& Pool, u32 ThreadCount, arena Arena)
     {
 #if rstd_MultiThreadingEnabled
-        while(Locked || AtomicCompareAndSet(Locked, 1, 0) != 0);
+        Pool = {};
+        
+        Pool.JobList.Arena = Arena;
+        Pool.ThreadCount = ThreadCount;
+        
+        pthread_attr_t Attributes;
+        pthread_attr_init(&Attributes);
+        pthread_attr_setdetachstate(&Attributes, PTHREAD_CREATE_DETACHED);
+        for(u32 ThreadIndex = 0; ThreadIndex < ThreadCount; ++ThreadIndex)
+        {
+            pthread_t Thread;
+            pthread_create(&Thread, &Attributes, ThreadProc, &Pool); // TODO: Support changing number of threads in runtime?
+        }
+        pthread_attr_destroy(&Attributes);
 #endif
     }
     
-    static void Lock(mutex& Mutex)
-    { Lock(Mutex.Locked); }
-    
-    static rstd_bool TryLock
- (volatile i32& Locked)
+    void PushJob
+ (thread_pool& Pool, void* JobUserData, thread_pool_job_callback* JobCallback)
     {
 #if rstd_MultiThreadingEnabled
-        return !Locked && AtomicCompareAndSet(Locked, 1, 0) == 0;
+        auto& List = Pool.JobList;
+        Lock(List.Mutex);
+        auto* JobNode = AllocateJobNode(List, {JobUserData, JobCallback});
+        if(List.NextJobToTake)
+        {
+            List.LastJobToTake->Next = JobNode;
+            List.LastJobToTake = JobNode;
+        }
+        else
+        {
+            List.NextJobToTake = List.LastJobToTake = JobNode;
+        }
+        Unlock(List.Mutex);
+        
+        ReleaseSemaphore(Pool.SemaphoreCount, 1, Pool.ThreadCount);
 #else
-        return true;
+        JobCallback(JobUserData);
 #endif
     }
     
-    static rstd_bool TryLock(mutex& Mutex)
-    { return TryLock(Mutex.Locked); }
-    
-    static void Unlock
- (volatile i32& Locked)
+    template<class job_container>
+        void PushJobs
+ (thread_pool& Pool, job_container Jobs)
     {
 #if rstd_MultiThreadingEnabled
-        Locked = 0;
+        auto& List = Pool.JobList;
+        
+        u32 PushedJobCount = Jobs.GetCount();
+        
+        Lock(List.Mutex);
+        
+        if(!List.NextJobToTake)
+        {
+            auto LastJob = Jobs.GetAndPopLast();
+            auto* JobNode = AllocateJobNode(List, LastJob);
+            List.NextJobToTake = List.LastJobToTake = JobNode;
+        }
+        
+        for(auto Job : Jobs)
+        {
+            auto* JobNode = AllocateJobNode(List, Job);
+            List.LastJobToTake->Next = JobNode;
+            List.LastJobToTake = JobNode;
+        }
+        
+        Unlock(List.Mutex);
+        
+        ReleaseSemaphore(Pool.SemaphoreCount, PushedJobCount, Pool.ThreadCount);
+#else
+        for(auto Job : Jobs)
+            Job.Callback(Job.CallbackUserData);
 #endif
     }
     
-    static void Unlock(mutex& Mutex)
-    { Unlock(Mutex.Locked); }
-    
-#define rstd_ScopeLock(_Mutex) \
-rstd::Lock(_Mutex); \
-rstd_defer(rstd::Unlock(_Mutex)); \
-    
-    struct thread_pool;
-    
-    typedef void thread_pool_job_callback(void* Data);
+    ///////////
+    // FILES //
+    ///////////
+    static int GetFileDescriptor(file File)
+    { return (int)((umm)File.PlatformFileHandle - 1); }
     
-    struct thread_pool_job
+    file_error GetLastFileError()
     {
-        void* CallbackUserData;
-        thread_pool_job_callback* Callback;
-    };
-    
-    struct thread_pool_job_node : thread_pool_job
-    { thread_pool_job* Next; };
+        switch(errno)
+        {
+            case 0: return file_error::NoError;
+            case ENOENT: return file_error::FileIsMissing;
+            case ENOTDIR: return file_error::DirectoryOnPathIsMissing;
+            case EACCES: return file_error::AccessToFileWasDenied;
+            case EPERM: return file_error::AccessToFileWasDenied;
+            default: return file_error::UnknownError;
+        }
+    }
     
-    struct thread_pool_job_list
-    {
-        thread_pool_job_node* NextJobToTake;
-        thread_pool_job_node* LastJobToTake;
-        thread_pool_job_node* JobFreeList;
-        arena Arena;
-        mutex Mutex;
-    };
+    static rstd_bool IsDotOrDotDot(const char* Name)
+    { return Name[0] == '.' && (Name[1] == 0 || (Name[1] == '.' && Name[2] == 0)); }
     
-    struct thread_pool
+    backward_singly_linked_list_with_counter<file_info> GetFileInfos
+ (arena& Arena, const char* DirectoryPath)
     {
-        thread_pool_job_list JobList;
-        u32 RunningJobCount;
-        void* SemaphoreHandle;
-        u32 ThreadCount;
-    };
+        backward_singly_linked_list_with_counter<file_info> FileInfos = ShareArena(Arena);
+        
+        DIR* Directory = opendir(DirectoryPath);
+        if(Directory)
+        {
+            while(dirent* Entry = readdir(Directory))
+            {
+                if(IsDotOrDotDot(Entry->d_name))
+                    continue;
+                
+                file_info FileInfo;
+                FileInfo.Name = rstd_PushStringCopy(Arena, Entry->d_name);
+                FileInfos.Push(FileInfo);
+            }
+            closedir(Directory);
+        }
+        
+        return FileInfos;
+    }
     
-    void Init(thread_pool& Pool, u32 ThreadCount, arena ArenaResponsibleOnlyForAllocatingJobs);
-    void PushJob(thread_pool&, void* JobUserData, thread_pool_job_callback* JobCallback);
-    template<class job_container> void PushJobs(thread_pool& Pool, job_container Jobs);
+    i32 RemoveFile(const char* FilePath)
+    { return unlink(FilePath) == 0; }
     
-    ///////////
-    // FILES // 
-    ///////////
-    constexpr char FilePathSlash = '\\';
+    i32 RenameFile(const char* FilePath, const char* NewFilePath)
+    { return rename(FilePath, NewFilePath) == 0; }
     
-    struct file_info // TODO: What else should I put in file_info?
-    { char* Name; };
+    const rstd_bool FailIfFileWithNewPathExists = true;
+    const rstd_bool OverrideFileIfFileWithNewPathExists = false;
     
-    struct file
+    rstd_bool CopyFile
+ (const char* ExistingFilePath, const char* NewFilePath, rstd_bool FailOrOverride)
     {
-        void* PlatformFileHandle;
+        int Source = open(ExistingFilePath, O_RDONLY|O_CLOEXEC);
+        if(Source == -1)
+            return false;
+        rstd_defer(close(Source));
         
-        operator rstd_bool()
-        { return PlatformFileHandle; }
-    };
-    
-    struct file_stream
-    {
-        file File;
-        u64 Pos;
+        int Flags = O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC;
+        if(FailOrOverride == FailIfFileWithNewPathExists)
+            Flags |= O_EXCL;
+        int Dest = open(NewFilePath, Flags, 0644);
+        if(Dest == -1)
+            return false;
+        rstd_defer(close(Dest));
         
-        operator rstd_bool()
-        { return File; }
-    };
+        u8 Buffer[64*1024];
+        for(;;)
+        {
+            ssize_t ReadBytes = read(Source, Buffer, sizeof(Buffer));
+            if(ReadBytes == 0)
+                return true;
+            if(ReadBytes < 0)
+                return false;
+            
+            for(ssize_t WrittenBytes = 0; WrittenBytes < ReadBytes;)
+            {
+                ssize_t Written = write(Dest, Buffer + WrittenBytes, ReadBytes - WrittenBytes);
+                if(Written <= 0)
+                    return false;
+                WrittenBytes += Written;
+            }
+        }
+    }
     
-    enum class io_mode
+    rstd_bool FileExists
+ (const char* Path)
     {
-        Read,
-        Write,
-        ReadWrite,
-    };
+        struct stat Stat;
+        return stat(Path, &Stat) == 0 && S_ISREG(Stat.st_mode);
+    }
     
-    enum class file_error
+    file OpenFile
+ (const char* FilePath, io_mode Mode)
     {
-        NoError,
-        UnknownError,
-        FileIsMissing,
-        DirectoryOnPathIsMissing,
-        AccessToFileWasDenied,
-    };
+        file File = {};
+        
+        int Flags = O_CLOEXEC;
+        switch(Mode)
+        {
+            case io_mode::Read: Flags |= O_RDONLY; break;
+            case io_mode::Write: Flags |= O_WRONLY|O_CREAT; break;
+            case io_mode::ReadWrite: Flags |= O_RDWR|O_CREAT; break;
+            rstd_InvalidDefaultCase;
+        }
+        
+        int FileDescriptor = open(FilePath, Flags, 0644);
+        if(FileDescriptor != -1)
+        {
+            // NOTE: Descriptor is stored with +1 so that descriptor 0 isn't treated as invalid file
+            File.PlatformFileHandle = (void*)((umm)FileDescriptor + 1);
+            FileDebug.OnOpenFile(FilePath, File.PlatformFileHandle);
+        }
+        
+        return File;
+    }
     
-    backward_singly_linked_list_with_counter<file_info> GetFileInfos(arena& Arena, const char* DirectoryPath);
-    i32 RemoveFile(const char* FilePath);
-    i32 RenameFile(const char* FilePath, const char* NewFilePath);
-    rstd_bool FileExists(const char* FilePath);
-    file OpenFile(const char* FilePath, io_mode);
-    rstd_bool Close(file&);
-    u32 Write(file File, u64 Pos, void* Data, u32 Size);
-    u32 Read(void* Dest, file File, u64 Pos, u32 Size);
-    rstd_bool SetFileSize(file File, u32 Size);
-    u32 GetFileSize(file File);
-    char* ReadWholeFile(arena& Arena, const char* FilePath);
-    rstd_bool CreateDirectory(const char* Path);
-    rstd_bool CreateDirectory(wchar_t* Path);
-    rstd_bool DeleteDirectory(const char* Path);
-    rstd_bool DeleteDirectory(wchar_t* Path);
-    rstd_bool DeleteDirectoryWithAllContents(const char* Path);
+    rstd_bool Close
+ (file& File)
+    { 
+        rstd_bool Succeded = close(GetFileDescriptor(File)) == 0;
+        if(Succeded)
+            FileDebug.OnCloseFile(File.PlatformFileHandle);
+        File.PlatformFileHandle = nullptr;
+        return Succeded;
+    }
     
-    static backward_singly_linked_list_with_counter<file_info> GetFileInfos(arena& Arena, rstd_stringlike& DirectoryPath)
-    { return GetFileInfos(Arena, DirectoryPath.GetCString()); }
+    u32 Write
+ (file File, u64 Pos, void* Data, u32 Size)
+    {
+        rstd_Assert(File);
+        u32 WrittenBytes = 0;
+        while(WrittenBytes < Size)
+        {
+            ssize_t Written = pwrite(GetFileDescriptor(File), (u8*)Data + WrittenBytes,
+                                     Size - WrittenBytes, (off_t)(Pos + WrittenBytes));
+            if(Written <= 0)
+                break;
+            WrittenBytes += (u32)Written;
+        }
+        return WrittenBytes;
+    }
     
-    static i32 RemoveFile(rstd_stringlike& FilePath)
-    { return RemoveFile(FilePath.GetCString()); }
+    u32 Read
+ (void* Dest, file File, u64 Pos, u32 Size)
+    {
+        rstd_Assert(File);
+        u32 ReadBytes = 0;
+        while(ReadBytes < Size)
+        {
+            ssize_t Read = pread(GetFileDescriptor(File), (u8*)Dest + ReadBytes,
+                                 Size - ReadBytes, (off_t)(Pos + ReadBytes));
+            if(Read <= 0)
+                break;
+            ReadBytes += (u32)Read;
+        }
+        return ReadBytes;
+    }
     
-    static i32 RenameFile(rstd_stringlike& FilePath, rstd_stringlike& NewFilePath)
-    { return RenameFile(FilePath.GetCString(), NewFilePath.GetCString()); }
+    rstd_bool SetFileSize(file File, u32 Size)
+    { return ftruncate(GetFileDescriptor(File), (off_t)Size) == 0; }
     
-    static rstd_bool FileExists(rstd_stringlike& FilePath)
-    { return FileExists(FilePath.GetCString()); }
+    u32 GetFileSize
+ (file File)
+    { 
+        struct stat Stat;
+        if(fstat(GetFileDescriptor(File), &Stat) == 0)
+            return (u32)Stat.st_size;
+        else
+            return InvalidU32;
+    }
     
-    static file OpenFile(rstd_stringlike& FilePath, io_mode Mode)
-    { return OpenFile(FilePath.GetCString(), Mode); }
+    void* MapFile
+ (file File, size Bytes)
+    {
+        void* Memory = mmap(nullptr, Bytes, PROT_READ|PROT_WRITE, MAP_PRIVATE, GetFileDescriptor(File), 0);
+        return Memory == MAP_FAILED ? nullptr : Memory;
+    }
     
-    static char* ReadWholeFile(arena& Arena, rstd_stringlike& FilePath)
-    { return ReadWholeFile(Arena, FilePath.GetCString()); }
+    rstd_bool UnmapFile(void* Memory, size Bytes)
+    { return munmap(Memory, Bytes) == 0; }
     
-    static rstd_bool CreateDirectory(rstd_stringlike& Path)
-    { return CreateDirectory(Path.GetCString()); }
+    rstd_bool CreateDirectory(const char* Path)
+    { return mkdir(Path, 0755) == 0; }
     
-    static rstd_bool DeleteDirectory(rstd_stringlike& Path)
-    { return DeleteDirectory(Path.GetCString()); }
+    rstd_bool CreateDirectory
+ (const wchar_t* Path)
+    {
+        string<1024> MultiBytePath;
+        MultiBytePath.Count = wcstombs(MultiBytePath.Characters, Path, MultiBytePath.GetMaxCount());
+        if(MultiBytePath.Count == (size)-1)
+            return false;
+        MultiBytePath.Characters[MultiBytePath.Count] = 0;
+        return CreateDirectory(MultiBytePath.GetCString());
+    }
     
-    static rstd_bool DeleteDirectoryWithAllContents(rstd_stringlike& Path)
-    { return DeleteDirectoryWithAllContents(Path.GetCString()); }
+    rstd_bool DeleteDirectory(const char* Path)
+    { return rmdir(Path) == 0; }
     
-    static void CreateFile
- (const char* FilePath)
+    rstd_bool DeleteDirectory
+ (const wchar_t* Path)
     {
-        auto File = OpenFile(FilePath, io_mode::Write);
-        Close(File);
+        string<1024> MultiBytePath;
+        MultiBytePath.Count = wcstombs(MultiBytePath.Characters, Path, MultiBytePath.GetMaxCount());
+        if(MultiBytePath.Count == (size)-1)
+            return false;
+        MultiBytePath.Characters[MultiBytePath.Count] = 0;
+        return DeleteDirectory(MultiBytePath.GetCString());
     }
     
-    static void CreateFile(const rstd_stringlike& FilePath)
-    { CreateFile(FilePath.GetCString()); }
-    
-    static char* GetRelativePath
- (char* FilePath, const char* RootDirectory)
+    rstd_bool DeleteAllContentsOfDirectory
+ (const char* Path)
     {
-        char* C = FilePath;
-        while(*C)
+        DIR* Directory = opendir(Path);
+        if(!Directory)
+            return false;
+        
+        while(dirent* Entry = readdir(Directory))
         {
-            if(*C == '\\')
+            if(IsDotOrDotDot(Entry->d_name))
+                continue;
+            
+            string<> FilePath = Path;
+            FilePath += "/";
+            FilePath += Entry->d_name;
+            
+            struct stat Stat;
+            if(lstat(FilePath.GetCString(), &Stat) == 0 && S_ISDIR(Stat.st_mode))
             {
-                ++C;
-                // TODO: This could be faster if you didn't use StringsMatch
-                //       You can create AdvanceIfStringDontMatch
-                if(StringsMatchUntilRightStringTerminates(C, RootDirectory))
-                    return C;
+                DeleteAllContentsOfDirectory(FilePath.GetCString());
+                DeleteDirectory(FilePath.GetCString());
+            }
+            else
+            {
+                unlink(FilePath.GetCString());
             }
-            ++C;
         }
-        return nullptr;
-    }
-    
-    static char* GetRelativePath(rstd_stringlike& FilePath, rstd_stringlike& RootDirectory)
-    { return GetRelativePath(FilePath.GetCString(), RootDirectory.GetCString()); }
-    
-    static file_stream OpenFileStream
- (const char* FilePath, io_mode Mode)
-    {
-        auto File = OpenFile(FilePath, Mode);
-        if(Mode == io_mode::Write)
-            SetFileSize(File, 0);
-        return {File};
-    }
-    
-    static file_stream OpenFileStream(rstd_stringlike& FilePath, io_mode Mode)
-    { return OpenFileStream(FilePath.GetCString(), Mode); }
-    
-    static rstd_bool Close(file_stream& Stream)
-    { return Close(Stream.File); }
-    
-    template<class type> static u32 WriteStruct(file File, u64 Pos, type& Data, u32 Count = 1)
-    { return Write(File, Pos, (void*)&Data, (u32)sizeof(type) * Count); }
-    
-    // TODO: Should I translate \n to \r\n here on windows???
-    template<class... args> static u32 WriteString
- (file File, u64 Pos, const char* Fmt, args... Args)
-    {
-        auto String = Format<string<1024>>(Fmt, Args...);
-        return Write(File, Pos, (void*)String.GetCString(), String.GetCount());
+        closedir(Directory);
+        return true;
     }
     
-    template<class type> static type Read
- (file File, u64 Pos)
+    //////////
+    // TIME //
+    //////////
+    static time ConvertToTime
+ (tm& Tm, long Nanoseconds)
     {
-        type Res;
-        Read((void*)&Res, File, Pos, (u32)sizeof(Res));
-        return Res;
+        time Time;
+        Time.Year = (u32)Tm.tm_year + 1900;
+        Time.Month = (month)(Tm.tm_mon + 1);
+        Time.Day = (u8)Tm.tm_mday;
+        Time.DayOfWeek = Tm.tm_wday == 0 ? day_of_week::Sunday : (day_of_week)Tm.tm_wday;
+        Time.Hour = (u8)Tm.tm_hour;
+        Time.Minute = (u8)Tm.tm_min;
+        Time.Second = (u8)Tm.tm_sec;
+        Time.Millisecond = (u16)(Nanoseconds / 1000000);
+        return Time;
     }
     
-    static u32 Write
- (file_stream& Stream, void* Data, u32 Size)
+    time GetUtcTime()
     {
-        u32 WrittenBytes = Write(Stream.File, Stream.Pos, Data, Size);
-        rstd_Assert(WrittenBytes == Size);
-        Stream.Pos += Size;
-        return WrittenBytes;
+        timespec Ts;
+        clock_gettime(CLOCK_REALTIME, &Ts);
+        tm Tm;
+        gmtime_r(&Ts.tv_sec, &Tm);
+        return ConvertToTime(Tm, Ts.tv_nsec);
     }
     
-    template<class type> static u32 WriteStruct(file_stream& Stream, type& Data, u32 Count = 1)
-    { return Write(Stream, &Data, (u32)sizeof(type) * Count); }
-    
-    template<class... args> static u32 WriteString
- (file_stream& Stream, const char* Fmt, args... Args)
+    time GetLocalTime()
     {
-        u32 WrittenBytes = WriteString(Stream.File, Stream.Pos, Fmt, Args...);
-        Stream.Pos += WrittenBytes;
-        return WrittenBytes;
+        timespec Ts;
+        clock_gettime(CLOCK_REALTIME, &Ts);
+        tm Tm;
+        localtime_r(&Ts.tv_sec, &Tm);
+        return ConvertToTime(Tm, Ts.tv_nsec);
     }
     
-    static u32 Read
- (void* Dest, file_stream& Stream, u32 Size)
+    // NOTE: Returns the same units as win32 FILETIME (100 nanosecond intervals)
+    u64 GetSystemTimeAsUnixEpoch()
     {
-        u32 ReadBytes = Read(Dest, Stream.File, Stream.Pos, Size);
-        rstd_Assert(ReadBytes == Size); // TODO: Should this assertion be here? Maybe there should be second function which just returns failure?
-        Stream.Pos += Size;
-        return ReadBytes;
+        timespec Ts;
+        clock_gettime(CLOCK_REALTIME, &Ts);
+        return (u64)Ts.tv_sec * 10000000 + (u64)Ts.tv_nsec / 100;
     }
     
-    template<class type> static type Read
- (file_stream& Stream)
-    {
-        auto Res = Read<type>(Stream.File, Stream.Pos);
-        Stream.Pos += sizeof(Res);
-        return Res;
-    }
+#endif // _WIN32
     
-    template<class type> static type& GetAndAdvance
- (char** DataPtr)
+    ///////////
+    // FILES //
+    ///////////
+    char* ReadWholeFile
+ (arena& Arena, const char* FilePath)
     {
-        auto& Res = *(type*)(*DataPtr);
-        *DataPtr += sizeof(type);
-        return Res;
+        auto File = OpenFile(FilePath, io_mode::Read);
+        rstd_defer(Close(File));
+        
+        u32 FileSize = GetFileSize(File);
+        if(FileSize == 0 || FileSize == InvalidU32)
+        {
+            return nullptr;
+        }
+        else
+        {
+            void* Content = rstd_PushSizeUninitialized(Arena, FileSize + 1);
+            Read(Content, File, (u32)0, FileSize);
+            char* Res = (char*)Content;
+            Res[FileSize] = 0;
+            return Res;
+        }
     }
-}
-
-#ifdef rstd_Implementation
-
-#ifdef _WIN32
-
-#pragma comment(lib, "shell32.lib")
-
-#ifndef rstd_ExcludeDebugPrintingFunctions
-#pragma comment(lib, "user32.lib")
-#endif
-
-#include <windows.h>
-
-namespace rstd
-{
-#ifndef rstd_ExcludeDebugPrintingFunctions
-    ////////////////////
-    // DEBUG PRINTING //
-    ////////////////////
-    u32 GetSystemErrorCode()
-    { return GetLastError(); }
-    
-    void InternalPrintInDebugger(const char* Message)
-    { OutputDebugStringA(Message); }
-    
-    void InternalWarningMessageBox(const char* Message)
-    { MessageBoxA(0, Message, "Warning!", MB_ICONWARNING|MB_OK); }
     
-    void ShowErrorMessageBox(const char* Message)
-    { MessageBoxA(0, Message, "Error!", MB_ICONERROR|MB_OK); }
-    
-    void ShowErrorMessageBoxAndExitProcess
- (const char* Message)
+    rstd_bool DeleteDirectoryWithAllContents
+ (const char* Path)
     {
-        ShowErrorMessageBox(Message);
-        ExitProcess(0);
+        rstd_bool Success = DeleteAllContentsOfDirectory(Path);
+        if(Success)
+            DeleteDirectory(Path);
+        return Success;
     }
-#endif
-    
-    ///////////////////////
-    // MEMORY ALLOCATION //
-    ///////////////////////
-    void* PageAlloc(size Bytes)
-    { return VirtualAlloc(nullptr, Bytes, MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE); }
-    
-    void PageFree(void* Memory)
-    { VirtualFree(Memory, 0, MEM_RELEASE); }
-    
-#ifdef rstd_ThreadPoolLogging
-#if rstd_ThreadPoolLogging
-#define ThreadPoolLog(_Str) InternalPrintInDebugger(_Str)
-#else
-#define ThreadPoolLog(_Str)
-#endif
-#else
-#define ThreadPoolLog(_Str)
-#endif
     
     /////////////////////
-    // MULTI-THREADING //
+    // ARENA SNAPSHOTS //
     /////////////////////
-    u32 AtomicIncrement
- (volatile u32& A)
-    {
-#if rstd_MultiThreadingEnabled
-        return InterlockedIncrement(&A);
-#else
-        return ++A;
-#endif
-    }
+    // NOTE: File layout: header, fixup table (file offsets of pointers), then Used bytes of memory blocks,
+    //       oldest first. Every block keeps its offset within page, so alignment of pushes survives mapping.
+    //       Pointers in the file hold file offsets of their targets, 0 is nullptr.
+    struct arena_snapshot_header
+    {
+        u32 Magic;
+        u32 Version;
+        u32 BlockCount;
+        u32 FixupCount;
+        u64 RootOffset;
+        u64 FileSize;
+    };
     
-    u32 AtomicDecrement
- (volatile u32& A)
-    {
-#if rstd_MultiThreadingEnabled
-        return InterlockedDecrement(&A);
-#else
-        return --A;
-#endif
-    }
+    constexpr u32 ArenaSnapshotMagic = 'r' | 's' << 8 | 'a' << 16 | 's' << 24;
+    constexpr u32 ArenaSnapshotVersion = 1;
     
-    i32 AtomicSet
- (volatile i32& Destination, i32 NewValue)
+    static u64 GetArenaSnapshotOffset
+ (memory_block** Blocks, u64* BlockOffsets, u32 BlockCount, void* Ptr)
     {
-#if rstd_MultiThreadingEnabled
-        i32 InitialValueInDestination = InterlockedExchange((LONG*)&Destination, NewValue);
-#else
-        i32 InitialValueInDestination = Destination;
-        Destination = NewValue;
-#endif
-        return InitialValueInDestination;
+        for(u32 BlockIndex = 0; BlockIndex < BlockCount; ++BlockIndex)
+        {
+            auto* MemBlock = Blocks[BlockIndex];
+            if((u8*)Ptr >= MemBlock->Base && (u8*)Ptr <= MemBlock->Base + MemBlock->Used)
+                return BlockOffsets[BlockIndex] + ((u8*)Ptr - MemBlock->Base);
+        }
+        return 0;
     }
     
-    i32 AtomicCompareAndSet
- (volatile i32& Destination, i32 NewValue, i32 ValueThatShouldBeInDestination)
+    rstd_bool SaveArenaSnapshot
+ (arena& Arena, const char* FilePath, void* Root, void** const* PointerLocations, u32 PointerLocationCount)
     {
-#if rstd_MultiThreadingEnabled
-        i32 ValueThatReallyIsInDestination = InterlockedCompareExchange((volatile LONG*)&Destination,
-                                                                        NewValue, ValueThatShouldBeInDestination);
-        return ValueThatReallyIsInDestination;
-#else
-        Destination = NewValue;
-        return Destination;
-#endif
+        rstd_AssertM(!(Arena.Flags & ArenaFlag_GrowsDown), "Snapshots of GrowsDown arenas are not supported");
+        
+        scope_temporary_memory ScratchScope(GetScratch(Arena));
+        arena& Scratch = *ScratchScope.TempMem.Arena;
+        
+        u32 BlockCount = GetMemoryBlockCount(Arena);
+        auto** Blocks = rstd_PushArrayUninitialized(Scratch, memory_block*, BlockCount);
+        u64* BlockOffsets = rstd_PushArrayUninitialized(Scratch, u64, BlockCount);
+        u32 BlockIndex = BlockCount;
+        for(auto* MemBlock = Arena.MemoryBlock; MemBlock; MemBlock = MemBlock->Prev)
+            Blocks[--BlockIndex] = MemBlock;
+        
+        u64 FileSize = sizeof(arena_snapshot_header) + (u64)PointerLocationCount * sizeof(u64);
+        for(BlockIndex = 0; BlockIndex < BlockCount; ++BlockIndex)
+        {
+            FileSize = Align(FileSize, MemoryPageSize) + ((umm)Blocks[BlockIndex]->Base & (MemoryPageSize - 1));
+            BlockOffsets[BlockIndex] = FileSize;
+            FileSize += Blocks[BlockIndex]->Used;
+        }
+        
+        if(FileSize >= InvalidU32)
+            return false;
+        
+        arena_snapshot_header Header;
+        Header.Magic = ArenaSnapshotMagic;
+        Header.Version = ArenaSnapshotVersion;
+        Header.BlockCount = BlockCount;
+        Header.FixupCount = PointerLocationCount;
+        Header.RootOffset = GetArenaSnapshotOffset(Blocks, BlockOffsets, BlockCount, Root);
+        Header.FileSize = FileSize;
+        if(Root && !Header.RootOffset)
+            return false;
+        
+        // NOTE: Every pointer is checked before the file gets created, so bad input never leaves a half written file
+        u64* LocationOffsets = rstd_PushArrayUninitialized(Scratch, u64, PointerLocationCount);
+        u64* TargetOffsets = rstd_PushArrayUninitialized(Scratch, u64, PointerLocationCount);
+        for(u32 FixupIndex = 0; FixupIndex < PointerLocationCount; ++FixupIndex)
+        {
+            void** Location = PointerLocations[FixupIndex];
+            LocationOffsets[FixupIndex] = GetArenaSnapshotOffset(Blocks, BlockOffsets, BlockCount, Location);
+            TargetOffsets[FixupIndex] = *Location ? GetArenaSnapshotOffset(Blocks, BlockOffsets, BlockCount, *Location) : 0;
+            if(!LocationOffsets[FixupIndex] || (*Location && !TargetOffsets[FixupIndex]))
+                return false;
+        }
+        
+        auto Stream = OpenFileStream(FilePath, io_mode::Write);
+        if(!Stream)
+            return false;
+        rstd_defer(Close(Stream));
+        
+        rstd_bool Success = WriteStruct(Stream, Header) == sizeof(Header);
+        
+        for(BlockIndex = 0; BlockIndex < BlockCount; ++BlockIndex)
+        {
+            u32 Used = (u32)Blocks[BlockIndex]->Used;
+            Success &= Write(Stream.File, BlockOffsets[BlockIndex], Blocks[BlockIndex]->Base, Used) == Used;
+        }
+        
+        for(u32 FixupIndex = 0; FixupIndex < PointerLocationCount; ++FixupIndex)
+        {
+            u64 FixupTablePos = sizeof(arena_snapshot_header) + FixupIndex * sizeof(u64);
+            Success &= WriteStruct(Stream.File, FixupTablePos, LocationOffsets[FixupIndex]) == sizeof(u64);
+            Success &= WriteStruct(Stream.File, LocationOffsets[FixupIndex], TargetOffsets[FixupIndex]) == sizeof(u64);
+        }
+        
+        return Success;
     }
     
-    i64 AtomicCompareAndSet
- (volatile i64& Destination, i64 NewValue, i64 ValueThatShouldBeInDestination)
+    arena_snapshot LoadArenaSnapshot
+ (const char* FilePath)
     {
-#if rstd_MultiThreadingEnabled
-        i64 ValueThatReallyIsInDestination = InterlockedCompareExchange64(&Destination, NewValue, ValueThatShouldBeInDestination);
-        return ValueThatReallyIsInDestination;
-#else
-        Destination = NewValue;
-        return Destination;
-#endif
+        arena_snapshot Snapshot = {};
+        
+        auto File = OpenFile(FilePath, io_mode::Read);
+        if(!File)
+            return Snapshot;
+        rstd_defer(Close(File));
+        
+        u32 FileSize = GetFileSize(File);
+        if(FileSize == InvalidU32 || FileSize < sizeof(arena_snapshot_header))
+            return Snapshot;
+        
+        u8* Memory = (u8*)MapFile(File, FileSize);
+        if(!Memory)
+            return Snapshot;
+        
+        // NOTE: Locations, targets and root have to be in block data after the fixup table. Location inside the header
+        //       or the table would let patching rewrite offsets that were already checked
+        auto& Header = *(arena_snapshot_header*)Memory;
+        u64 DataOffset = sizeof(arena_snapshot_header) + (u64)Header.FixupCount * sizeof(u64);
+        rstd_bool Valid = Header.Magic == ArenaSnapshotMagic && Header.Version == ArenaSnapshotVersion && Header.FileSize == FileSize &&
+            DataOffset <= FileSize && (!Header.RootOffset || (Header.RootOffset >= DataOffset && Header.RootOffset < FileSize));
+        
+        // NOTE: Whole file is checked first, damaged or foreign file must not make us write outside of the mapping
+        u64* Fixups = (u64*)(Memory + sizeof(arena_snapshot_header));
+        for(u32 FixupIndex = 0; Valid && FixupIndex < Header.FixupCount; ++FixupIndex)
+        {
+            u64 LocationOffset = Fixups[FixupIndex];
+            Valid = LocationOffset >= DataOffset && LocationOffset <= FileSize - sizeof(u64) && LocationOffset % alignof(u64) == 0;
+            if(Valid)
+            {
+                u64 TargetOffset = *(u64*)(Memory + LocationOffset);
+                Valid = !TargetOffset || (TargetOffset >= DataOffset && TargetOffset < FileSize);
+            }
+        }
+        
+        if(!Valid)
+        {
+            UnmapFile(Memory, FileSize);
+            return Snapshot;
+        }
+        
+        // NOTE: Only pages with pointers get copied, the rest stays shared with page cache
+        for(u32 FixupIndex = 0; FixupIndex < Header.FixupCount; ++FixupIndex)
+        {
+            u8** Location = (u8**)(Memory + Fixups[FixupIndex]);
+            u64 TargetOffset = *(u64*)Location;
+            *Location = TargetOffset ? Memory + TargetOffset : nullptr;
+        }
+        
+        Snapshot.Memory = Memory;
+        Snapshot.Size = FileSize;
+        Snapshot.Root = Header.RootOffset ? Memory + Header.RootOffset : nullptr;
+        return Snapshot;
     }
     
-#if rstd_MultiThreadingEnabled
-    thread_pool_job* PopJob
- (thread_pool_job_list& List)
-    {
-        rstd_Assert(List.Mutex.Locked);
-        auto* JobToDo = List.NextJobToTake;
-        if(List.NextJobToTake == List.LastJobToTake)
-            List.NextJobToTake = List.LastJobToTake = nullptr;
-        else
-            List.NextJobToTake = List.LastJobToTake;
-        return JobToDo;
-    }
-#endif
     
-#if rstd_MultiThreadingEnabled
-    DWORD WINAPI ThreadProc
- (LPVOID ThreadPoolVoidPtr)
+#if rstd_MemoryProfilerEnabled
+    //////////////////
+    // MEMORY DEBUG //
+    //////////////////
+    namespace MemoryDebug
     {
-#if rstd_ThreadPoolLogging
-        u32 ThreadId = GetThreadID();
-#endif
-        ThreadPoolLog(Format<string<>>("Thread % starts\n", ThreadId));
+        enum class event_type : u8
+        {
+            CreateArena,
+            ArenaPush,
+            AllocateNextMemoryBlock,
+            DeallocateMemoryBlock,
+            BeginTemporaryMemory,
+            EndTemporaryMemory,
+            GenAlloc,
+            GenFree,
+            ClearArena,
+            ShrinkLastPush,
+        };
+        
+        // NOTE: Fits into one cache line. calling_info is split so that Line doesn't need its own padding
+        struct event
+        {
+            const char* FilePath;
+            const char* Function;
+            const char* MemoryGroupName; // nullptr means "Others"
+            union
+            {
+                void* Memory; // GenAlloc, GenFree
+                const char* ArenaName; // CreateArena
+                u64 PushCount; // ArenaPush, pushes coalesced into the event while recording
+            };
+            union
+            {
+                size Extra; // alignment padding of push, unused bytes of previous memory block
+                const char* MasterArenaName; // CreateArena
+            };
+            size Size; // push size or memory block size
+            u32 Line;
+            u32 ArenaId;
+            f32 SampleWeight; // how many allocations the event stands for, 1 if it wasn't sampled
+            event_type Type;
+            arena_growth_policy GrowthPolicy;
+            u8 AllocationType;
+            rstd_bool Sampled;
+        };
+        static_assert(sizeof(event) <= 64, "");
+        
+        constexpr u32 EventBufferCapacity = 1024;
+        
+        // NOTE: Merged amounts of push events that their thread can still coalesce into, by event index modulo depth
+        constexpr u32 ArenaPushCoalesceDepth = 4;
+        
+        struct merged_push
+        {
+            size Size;
+            size Extra;
+            u64 PushCount;
+        };
+        
+        struct event_buffer
+        {
+            event_buffer* Next;
+            u64 SubmitTime;
+            volatile u32 EventCount; // written by owning thread once event is filled
+            u32 MergedCount; // written under State.Mutex, queries merge buffers that are still being filled
+            merged_push MergedPushes[ArenaPushCoalesceDepth];
+            alignas(64) event Events[EventBufferCapacity];
+        };
         
-        thread_pool& ThreadPool = *(thread_pool*)ThreadPoolVoidPtr;
-        auto& List = ThreadPool.JobList;
-        for(;;)
+        struct memory_group
         {
-            ThreadPoolLog(Format<string<>>("Thread % at the begining of loop\n", ThreadId));
-            while(List.NextJobToTake)
+            const char* Name;
+            u64 NameHash;
+            statistics Stats;
+        };
+        
+        struct gen_allocation
+        {
+            void* Memory;
+            size Size; // number of frees for EarlyGenFrees
+            u32 MemoryGroupIndex;
+            u32 SiteIndex;
+        };
+        
+        // NOTE: Open addressing with linear probing and backward shift deletion, keyed by pointer
+        struct gen_allocation_table
+        {
+            gen_allocation* Slots;
+            u32 Capacity;
+            u32 Count;
+        };
+        
+        struct allocation_site_data
+        {
+            allocation_site Site;
+            f64 Count; // fractional when sampling
+        };
+        
+        // NOTE: Live push bytes of one site in one arena, given back to the site when the arena is cleared or deallocated
+        // NOTE: Live pushes of one call site into one arena within one memory group,
+        //       released from all statistics when the arena is cleared or deallocated
+        struct arena_site_bytes
+        {
+            u32 ArenaId;
+            u32 SiteIndex;
+            u32 MemoryGroupIndex;
+            u32 NextInArena; // index + 1, 0 ends the list
+            size Bytes;
+            size AlignmentPadding;
+        };
+        
+        struct thread_state;
+        
+        struct state
+        {
+            mutex BuffersMutex; // guards buffer queues, thread list and Buffer of every thread
+            event_buffer* FirstFullBuffer;
+            event_buffer* LastFullBuffer;
+            event_buffer* FreeBuffers;
+            thread_state* FirstThread;
+            
+            mutex Mutex; // held while events are merged, guards everything below
+            arena Arena;
+            arena_debug_data* Arenas; // indexed by arena DebugId
+            u32 ArenaCapacity;
+            memory_group* MemoryGroups;
+            u32 MemoryGroupCount;
+            u32 MemoryGroupCapacity;
+            u32* MemoryGroupSlots; // MemoryGroupIndex + 1, keyed by NameHash
+            u32 MemoryGroupSlotCount;
+            const char* LastMemoryGroupName;
+            u32 LastMemoryGroupIndex;
+            gen_allocation_table GenAllocations;
+            gen_allocation_table EarlyGenFrees; // free was merged before its allocation (different threads)
+            statistics Stats;
+            
+            // NOTE: Slot arrays below hold element index + 1, 0 is empty slot
+            allocation_site_data* Sites;
+            u32 SiteCount;
+            u32 SiteCapacity;
+            u32* SiteSlots; // keyed by FilePath and Line
+            u32 SiteSlotCount;
+            arena_site_bytes* ArenaSites;
+            u32 ArenaSiteCount; // including ones in free list
+            u32 ArenaSiteCapacity;
+            u32 FirstFreeArenaSite; // index + 1
+            u32 LiveArenaSiteCount;
+            u32* ArenaSiteSlots; // keyed by ArenaId and SiteIndex
+            u32 ArenaSiteSlotCount;
+            u32* ArenaSiteLists; // first arena_site_bytes index + 1, indexed by arena DebugId
+            u32 ArenaSiteListCapacity;
+            
+            file_stream TraceStream;
+            u8* TraceBuffer;
+            u32 TraceBufferUsed;
+            gen_allocation_table TraceStringIds; // string id in Size
+            u32 NextTraceStringId;
+            u64 TraceStartTime;
+            u64 LastTraceTime;
+            rstd_bool Tracing;
+            
+            u64 SampleCount;
+            
+            // NOTE: Live sampled gen allocations, so that frees of allocations that weren't sampled can be dropped
+            //       without taking a lock. Filter counts them per pointer hash and is written under SampledMutex
+            mutex SampledMutex;
+            gen_allocation_table SampledGenAllocations;
+            volatile u32 SampledGenAllocationFilter[4096];
+            
+            size SamplingInterval;
+            volatile u32 NextArenaDebugId;
+            volatile rstd_bool Initialized;
+        };
+        
+        static state State;
+        
+        // NOTE: Trivially destructible, so that access doesn't go through thread_local init check on every push
+        struct thread_state
+        {
+            event_buffer* Buffer;
+            const char* CurrentMemoryGroup;
+            u32 NoRegistrationDepth;
+            rstd_bool JustCalledNextCallMemoryGroup;
+            thread_state* PrevThread;
+            thread_state* NextThread;
+        };
+        
+        static thread_local thread_state ThreadState;
+        
+        // NOTE: Touched when thread takes its first buffer and joins State.FirstThread list,
+        //       which registers the destructor that submits the buffer and leaves the list on thread exit
+        struct thread_exit
+        {
+            rstd_bool Listed;
+            ~thread_exit();
+        };
+        
+        static thread_local thread_exit ThreadExit;
+        
+        struct sampling_state
+        {
+            i64 BytesUntilSample;
+            random_sequence Random; // zero until thread makes its first sampling decision
+        };
+        
+        static thread_local sampling_state SamplingState;
+        
+        struct scope_no_alloc_registration
+        {
+            scope_no_alloc_registration()
+            { ++ThreadState.NoRegistrationDepth; }
+            
+            ~scope_no_alloc_registration()
+            { --ThreadState.NoRegistrationDepth; }
+        };
+        
+#define ScopeNoAllocRegistration scope_no_alloc_registration ScopeNoAllocRegis
+        
+        // NOTE: Profiler memory comes straight from OS so that it doesn't show up in its own statistics
+        static void* GrowArray
+ (void* Array, u32 Count, u32* Capacity, u32 RequiredCapacity, size ElementSize)
+        {
+            if(RequiredCapacity <= *Capacity)
+                return Array;
+            
+            u32 NewCapacity = *Capacity ? *Capacity : 64;
+            while(NewCapacity < RequiredCapacity)
+                NewCapacity *= 2;
+            
+            void* NewArray = PageAlloc(Align(NewCapacity * ElementSize, MemoryPageSize));
+            rstd_RAssert(NewArray, "OS Allocation call failed (probably your machine ran out of memory)");
+            if(Array)
             {
-                if(TryLock(List.Mutex))
+                memcpy(NewArray, Array, Count * ElementSize);
+                PageFree(Array, Align(*Capacity * ElementSize, MemoryPageSize));
+            }
+            *Capacity = NewCapacity;
+            return NewArray;
+        }
+        
+        static u32 HashPointer(void* Ptr)
+        { return (u32)(((u64)(umm)Ptr * 0x9E3779B97F4A7C15) >> 32); }
+        
+        static gen_allocation* Find
+ (gen_allocation_table& Table, void* Memory)
+        {
+            if(!Table.Count)
+                return nullptr;
+            
+            u32 Mask = Table.Capacity - 1;
+            for(u32 SlotIndex = HashPointer(Memory) & Mask;; SlotIndex = (SlotIndex + 1) & Mask)
+            {
+                auto& Slot = Table.Slots[SlotIndex];
+                if(Slot.Memory == Memory)
+                    return &Slot;
+                if(!Slot.Memory)
+                    return nullptr;
+            }
+        }
+        
+        static gen_allocation& Insert
+ (gen_allocation_table& Table, void* Memory)
+        {
+            // NOTE: Table is kept at most half full
+            if((Table.Count + 1) * 2 > Table.Capacity)
+            {
+                gen_allocation_table OldTable = Table;
+                Table.Capacity = OldTable.Capacity ? OldTable.Capacity * 2 : 1024;
+                Table.Count = 0;
+                Table.Slots = (gen_allocation*)PageAlloc(Align(Table.Capacity * sizeof(gen_allocation), MemoryPageSize));
+                rstd_RAssert(Table.Slots, "OS Allocation call failed (probably your machine ran out of memory)");
+                for(u32 SlotIndex = 0; SlotIndex < OldTable.Capacity; ++SlotIndex)
                 {
-                    ThreadPoolLog(Format<string<>>("Mutex is locked by thread: %\n", ThreadId));
-                    ThreadPoolLog(Format<string<>>("Thread % took the job\n", ThreadId));
-                    
-                    auto* CurrentJob = PopJob(List);
-                    
-                    AtomicIncrement(ThreadPool.RunningJobCount);
-                    Unlock(List.Mutex);
-                    ThreadPoolLog(Format<string<>>("Mutex is unlocked by thread: %\n", ThreadId));
-                    
-                    ThreadPoolLog(Format<string<>>("Thread % About to call Callback\n", ThreadId));
-                    CurrentJob->Callback(CurrentJob->CallbackUserData);
-                    AtomicDecrement(ThreadPool.RunningJobCount);
+                    auto& OldSlot = OldTable.Slots[SlotIndex];
+                    if(OldSlot.Memory)
+                        Insert(Table, OldSlot.Memory) = OldSlot;
                 }
+                if(OldTable.Slots)
+                    PageFree(OldTable.Slots, Align(OldTable.Capacity * sizeof(gen_allocation), MemoryPageSize));
             }
-            ThreadPoolLog(Format<string<>>("Thread % going to sleep\n", ThreadId));
-            WaitForSingleObjectEx(ThreadPool.SemaphoreHandle, INFINITE, FALSE);
-            ThreadPoolLog(Format<string<>>("Thread % awakes\n", ThreadId));
+            
+            u32 Mask = Table.Capacity - 1;
+            u32 SlotIndex = HashPointer(Memory) & Mask;
+            while(Table.Slots[SlotIndex].Memory)
+                SlotIndex = (SlotIndex + 1) & Mask;
+            
+            auto& Slot = Table.Slots[SlotIndex];
+            Slot.Memory = Memory;
+            ++Table.Count;
+            return Slot;
         }
-    }
-#endif
-    
-    void Init
- (thread_pool& Pool, u32 ThreadCount, arena Arena)
-    {
-#if rstd_MultiThreadingEnabled
-        Pool = {};
         
-        Pool.JobList.Arena = Arena;
-        Pool.SemaphoreHandle = CreateSemaphore(0, 0, ThreadCount, nullptr);
-        Pool.ThreadCount = ThreadCount;
+        static void Remove
+ (gen_allocation_table& Table, gen_allocation* Removed)
+        {
+            u32 Mask = Table.Capacity - 1;
+            u32 HoleIndex = (u32)(Removed - Table.Slots);
+            for(u32 SlotIndex = (HoleIndex + 1) & Mask;; SlotIndex = (SlotIndex + 1) & Mask)
+            {
+                auto& Slot = Table.Slots[SlotIndex];
+                if(!Slot.Memory)
+                    break;
+                
+                // NOTE: Slot can fill the hole only if hole lies between its home slot and the slot itself
+                u32 HomeIndex = HashPointer(Slot.Memory) & Mask;
+                if(((SlotIndex - HomeIndex) & Mask) >= ((SlotIndex - HoleIndex) & Mask))
+                {
+                    Table.Slots[HoleIndex] = Slot;
+                    HoleIndex = SlotIndex;
+                }
+            }
+            Table.Slots[HoleIndex].Memory = nullptr;
+            --Table.Count;
+        }
         
-        for(u32 ThreadIndex = 0; ThreadIndex < ThreadCount; ++ThreadIndex)
+        static u32 AddMemoryGroup
+ (const char* Name, u64 NameHash)
         {
-            DWORD ThreadId;
-            auto ThreadHandle = CreateThread(0, 0, ThreadProc, &Pool, 0, &ThreadId);
-            CloseHandle(ThreadHandle); // TODO: Support changing number of threads in runtime?
+            State.MemoryGroups = (memory_group*)GrowArray(State.MemoryGroups, State.MemoryGroupCount, &State.MemoryGroupCapacity,
+                                                          State.MemoryGroupCount + 1, sizeof(memory_group));
+            u32 MemoryGroupIndex = State.MemoryGroupCount++;
+            auto& MemoryGroup = State.MemoryGroups[MemoryGroupIndex];
+            MemoryGroup.Name = Name;
+            MemoryGroup.NameHash = NameHash;
+            ZeroStruct(MemoryGroup.Stats);
+            
+            if(State.MemoryGroupCount * 2 > State.MemoryGroupSlotCount)
+            {
+                if(State.MemoryGroupSlots)
+                    PageFree(State.MemoryGroupSlots, Align(State.MemoryGroupSlotCount * sizeof(u32), MemoryPageSize));
+                State.MemoryGroupSlotCount = State.MemoryGroupSlotCount ? State.MemoryGroupSlotCount * 2 : 64;
+                State.MemoryGroupSlots = (u32*)PageAlloc(Align(State.MemoryGroupSlotCount * sizeof(u32), MemoryPageSize));
+                rstd_RAssert(State.MemoryGroupSlots, "OS Allocation call failed (probably your machine ran out of memory)");
+                for(u32 GroupIndex = 0; GroupIndex < State.MemoryGroupCount; ++GroupIndex)
+                {
+                    u32 Mask = State.MemoryGroupSlotCount - 1;
+                    u32 SlotIndex = (u32)State.MemoryGroups[GroupIndex].NameHash & Mask;
+                    while(State.MemoryGroupSlots[SlotIndex])
+                        SlotIndex = (SlotIndex + 1) & Mask;
+                    State.MemoryGroupSlots[SlotIndex] = GroupIndex + 1;
+                }
+            }
+            else
+            {
+                u32 Mask = State.MemoryGroupSlotCount - 1;
+                u32 SlotIndex = (u32)NameHash & Mask;
+                while(State.MemoryGroupSlots[SlotIndex])
+                    SlotIndex = (SlotIndex + 1) & Mask;
+                State.MemoryGroupSlots[SlotIndex] = MemoryGroupIndex + 1;
+            }
+            
+            return MemoryGroupIndex;
         }
-#endif
-    }
-    
-    void PushJob
- (thread_pool& Pool, void* JobUserData, thread_pool_job_callback* JobCallback)
-    {
-#if rstd_MultiThreadingEnabled
-        auto& List = Pool.JobList;
-        auto* JobNode = &rstd_PushStructZero(List.Arena, thread_pool_job_node);
-        JobNode->CallbackUserData = JobUserData;
-        JobNode->Callback = JobCallback;
         
-        Lock(List.Mutex);
-        ThreadPoolLog("Mutex is locked by PushJob\n");
-        if(List.NextJobToTake)
+        // NOTE: Groups are the same if their names match, nullptr is "Others" group
+        static u32 GetMemoryGroupIndex
+ (const char* Name)
         {
-            List.LastJobToTake->Next = JobNode;
-            List.LastJobToTake = JobNode;
+            if(!Name)
+                return 0;
+            if(Name == State.LastMemoryGroupName)
+                return State.LastMemoryGroupIndex;
+            
+            u64 NameHash = HashString(Name);
+            u32 Mask = State.MemoryGroupSlotCount - 1;
+            u32 MemoryGroupIndex = InvalidU32;
+            for(u32 SlotIndex = (u32)NameHash & Mask; State.MemoryGroupSlots[SlotIndex]; SlotIndex = (SlotIndex + 1) & Mask)
+            {
+                auto& MemoryGroup = State.MemoryGroups[State.MemoryGroupSlots[SlotIndex] - 1];
+                if(MemoryGroup.NameHash == NameHash && strcmp(MemoryGroup.Name, Name) == 0)
+                {
+                    MemoryGroupIndex = State.MemoryGroupSlots[SlotIndex] - 1;
+                    break;
+                }
+            }
+            
+            if(MemoryGroupIndex == InvalidU32)
+                MemoryGroupIndex = AddMemoryGroup(Name, NameHash);
+            
+            State.LastMemoryGroupName = Name;
+            State.LastMemoryGroupIndex = MemoryGroupIndex;
+            return MemoryGroupIndex;
         }
-        else
+        
+        static arena_debug_data& GetArenaDebug
+ (u32 ArenaDebugId)
         {
-            List.NextJobToTake = List.LastJobToTake = JobNode;
+            if(ArenaDebugId >= State.ArenaCapacity)
+            {
+                u32 OldCapacity = State.ArenaCapacity;
+                State.Arenas = (arena_debug_data*)GrowArray(State.Arenas, OldCapacity, &State.ArenaCapacity,
+                                                            ArenaDebugId + 1, sizeof(arena_debug_data));
+            }
+            return State.Arenas[ArenaDebugId];
         }
-        Unlock(List.Mutex);
-        ThreadPoolLog("Mutex is unlocked by PushJob\n");
         
-        ReleaseSemaphore(Pool.SemaphoreHandle, 1, 0);
-        ThreadPoolLog("Thread should be awoken now\n");
-#else
-        JobCallback(JobUserData);
-#endif
-    }
-    
-    template<class job_container>
-        void PushJobs
- (thread_pool& Pool, job_container Jobs)
-    {
-#if rstd_MultiThreadingEnabled
-        auto& List = Pool.JobList;
+        static u32 HashU64(u64 Key)
+        { return (u32)((Key * 0x9E3779B97F4A7C15) >> 32); }
         
-        u32 PushedJobCount = Jobs.GetCount();
+        static u32 HashSite(const char* FilePath, u32 Line)
+        { return HashU64((u64)(umm)FilePath ^ ((u64)Line << 40)); }
         
-        Lock(List.Mutex);
-        ThreadPoolLog("Mutex is locked by PushJob\n");
+        static u32 HashArenaSite(u32 ArenaId, u32 SiteIndex, u32 MemoryGroupIndex)
+        { return HashU64((((u64)ArenaId << 32) | SiteIndex) ^ ((u64)MemoryGroupIndex << 48)); }
+        
+        static u32 HashArenaSite(arena_site_bytes& ArenaSite)
+        { return HashArenaSite(ArenaSite.ArenaId, ArenaSite.SiteIndex, ArenaSite.MemoryGroupIndex); }
+        
+        static void InsertSlot
+ (u32* Slots, u32 SlotCount, u32 Hash, u32 ElementIndex)
+        {
+            u32 Mask = SlotCount - 1;
+            u32 SlotIndex = Hash & Mask;
+            while(Slots[SlotIndex])
+                SlotIndex = (SlotIndex + 1) & Mask;
+            Slots[SlotIndex] = ElementIndex + 1;
+        }
+        
+        // NOTE: Returns new zeroed slot array, old one is freed
+        static u32* ReallocateSlots
+ (u32* Slots, u32* SlotCount)
+        {
+            if(Slots)
+                PageFree(Slots, Align(*SlotCount * sizeof(u32), MemoryPageSize));
+            *SlotCount = *SlotCount ? *SlotCount * 2 : 1024;
+            u32* NewSlots = (u32*)PageAlloc(Align(*SlotCount * sizeof(u32), MemoryPageSize));
+            rstd_RAssert(NewSlots, "OS Allocation call failed (probably your machine ran out of memory)");
+            return NewSlots;
+        }
+        
+        // NOTE: Sites are the same if their FilePath pointer and Line match
+        static allocation_site_data& GetSite
+ (const char* FilePath, const char* Function, u32 Line, u32* SiteIndexDest = nullptr)
+        {
+            if((State.SiteCount + 1) * 2 > State.SiteSlotCount)
+            {
+                State.SiteSlots = ReallocateSlots(State.SiteSlots, &State.SiteSlotCount);
+                for(u32 SiteIndex = 0; SiteIndex < State.SiteCount; ++SiteIndex)
+                {
+                    auto& CallingInfo = State.Sites[SiteIndex].Site.CallingInfo;
+                    InsertSlot(State.SiteSlots, State.SiteSlotCount, HashSite(CallingInfo.FilePath, CallingInfo.Line), SiteIndex);
+                }
+            }
+            
+            u32 Hash = HashSite(FilePath, Line);
+            u32 Mask = State.SiteSlotCount - 1;
+            for(u32 SlotIndex = Hash & Mask; State.SiteSlots[SlotIndex]; SlotIndex = (SlotIndex + 1) & Mask)
+            {
+                u32 SiteIndex = State.SiteSlots[SlotIndex] - 1;
+                auto& Site = State.Sites[SiteIndex];
+                if(Site.Site.CallingInfo.FilePath == FilePath && Site.Site.CallingInfo.Line == Line)
+                {
+                    if(SiteIndexDest)
+                        *SiteIndexDest = SiteIndex;
+                    return Site;
+                }
+            }
+            
+            State.Sites = (allocation_site_data*)GrowArray(State.Sites, State.SiteCount, &State.SiteCapacity,
+                                                           State.SiteCount + 1, sizeof(allocation_site_data));
+            u32 SiteIndex = State.SiteCount++;
+            InsertSlot(State.SiteSlots, State.SiteSlotCount, Hash, SiteIndex);
+            
+            auto& Site = State.Sites[SiteIndex];
+            ZeroStruct(Site);
+            Site.Site.CallingInfo = {FilePath, Function, Line};
+            if(SiteIndexDest)
+                *SiteIndexDest = SiteIndex;
+            return Site;
+        }
+        
+        static void AddSiteLiveBytes
+ (allocation_site_data& Site, size Bytes)
+        {
+            Site.Site.LiveBytes += Bytes;
+            if(Site.Site.LiveBytes > Site.Site.PeakLiveBytes)
+                Site.Site.PeakLiveBytes = Site.Site.LiveBytes;
+        }
+        
+        static arena_site_bytes& GetArenaSite
+ (u32 ArenaId, u32 SiteIndex, u32 MemoryGroupIndex)
+        {
+            if((State.LiveArenaSiteCount + 1) * 2 > State.ArenaSiteSlotCount)
+            {
+                State.ArenaSiteSlots = ReallocateSlots(State.ArenaSiteSlots, &State.ArenaSiteSlotCount);
+                for(u32 ArenaListIndex = 0; ArenaListIndex < State.ArenaSiteListCapacity; ++ArenaListIndex)
+                {
+                    for(u32 Entry = State.ArenaSiteLists[ArenaListIndex]; Entry; Entry = State.ArenaSites[Entry - 1].NextInArena)
+                    {
+                        auto& ArenaSite = State.ArenaSites[Entry - 1];
+                        InsertSlot(State.ArenaSiteSlots, State.ArenaSiteSlotCount, HashArenaSite(ArenaSite), Entry - 1);
+                    }
+                }
+            }
+            
+            u32 Hash = HashArenaSite(ArenaId, SiteIndex, MemoryGroupIndex);
+            u32 Mask = State.ArenaSiteSlotCount - 1;
+            for(u32 SlotIndex = Hash & Mask; State.ArenaSiteSlots[SlotIndex]; SlotIndex = (SlotIndex + 1) & Mask)
+            {
+                auto& ArenaSite = State.ArenaSites[State.ArenaSiteSlots[SlotIndex] - 1];
+                if(ArenaSite.ArenaId == ArenaId && ArenaSite.SiteIndex == SiteIndex && ArenaSite.MemoryGroupIndex == MemoryGroupIndex)
+                    return ArenaSite;
+            }
+            
+            u32 EntryIndex;
+            if(State.FirstFreeArenaSite)
+            {
+                EntryIndex = State.FirstFreeArenaSite - 1;
+                State.FirstFreeArenaSite = State.ArenaSites[EntryIndex].NextInArena;
+            }
+            else
+            {
+                State.ArenaSites = (arena_site_bytes*)GrowArray(State.ArenaSites, State.ArenaSiteCount, &State.ArenaSiteCapacity,
+                                                                State.ArenaSiteCount + 1, sizeof(arena_site_bytes));
+                EntryIndex = State.ArenaSiteCount++;
+            }
+            
+            if(ArenaId >= State.ArenaSiteListCapacity)
+            {
+                State.ArenaSiteLists = (u32*)GrowArray(State.ArenaSiteLists, State.ArenaSiteListCapacity, &State.ArenaSiteListCapacity,
+                                                       ArenaId + 1, sizeof(u32));
+            }
+            
+            auto& ArenaSite = State.ArenaSites[EntryIndex];
+            ArenaSite.ArenaId = ArenaId;
+            ArenaSite.SiteIndex = SiteIndex;
+            ArenaSite.MemoryGroupIndex = MemoryGroupIndex;
+            ArenaSite.Bytes = 0;
+            ArenaSite.AlignmentPadding = 0;
+            ArenaSite.NextInArena = State.ArenaSiteLists[ArenaId];
+            State.ArenaSiteLists[ArenaId] = EntryIndex + 1;
+            InsertSlot(State.ArenaSiteSlots, State.ArenaSiteSlotCount, Hash, EntryIndex);
+            ++State.LiveArenaSiteCount;
+            return ArenaSite;
+        }
+        
+        static void RemoveArenaSiteSlot
+ (u32 EntryIndex)
+        {
+            auto& Removed = State.ArenaSites[EntryIndex];
+            u32 Mask = State.ArenaSiteSlotCount - 1;
+            u32 HoleIndex = HashArenaSite(Removed) & Mask;
+            while(State.ArenaSiteSlots[HoleIndex] != EntryIndex + 1)
+                HoleIndex = (HoleIndex + 1) & Mask;
+            
+            // NOTE: Backward shift deletion, same as in gen_allocation_table
+            for(u32 SlotIndex = (HoleIndex + 1) & Mask; State.ArenaSiteSlots[SlotIndex]; SlotIndex = (SlotIndex + 1) & Mask)
+            {
+                auto& ArenaSite = State.ArenaSites[State.ArenaSiteSlots[SlotIndex] - 1];
+                u32 HomeIndex = HashArenaSite(ArenaSite) & Mask;
+                if(((SlotIndex - HomeIndex) & Mask) >= ((SlotIndex - HoleIndex) & Mask))
+                {
+                    State.ArenaSiteSlots[HoleIndex] = State.ArenaSiteSlots[SlotIndex];
+                    HoleIndex = SlotIndex;
+                }
+            }
+            State.ArenaSiteSlots[HoleIndex] = 0;
+        }
+        
+        static void AddStatistic
+ (size* Statistic, size* MaxStatistic, size Delta)
+        {
+            *Statistic += Delta;
+            if(*Statistic > *MaxStatistic)
+                *MaxStatistic = *Statistic;
+        }
+        
+        static void AddUsedAndSubtractUnused
+ (statistics* Stats, size Delta)
+        {
+            AddStatistic(&Stats->Used, &Stats->UsedPeak, Delta);
+            Stats->Unused -= Delta;
+        }
+        
+        // NOTE: Every field is read and written once, pushes are the most common event
+        static void AddPush
+ (statistics* Stats, size Size, size AlignmentPadding)
+        {
+            size Used = Stats->Used + Size;
+            Stats->Used = Used;
+            if(Used > Stats->UsedPeak)
+                Stats->UsedPeak = Used;
+            Stats->Unused -= Size + AlignmentPadding;
+            Stats->AlignmentPadding += AlignmentPadding;
+        }
+        
+        static void AddSizeAndUnused
+ (statistics* Stats, size Delta)
+        { 
+            AddStatistic(&Stats->Size, &Stats->SizePeak, Delta);
+            Stats->Unused += Delta;
+        }
+        
+        static void RemovePush
+ (statistics* Stats, size Size, size AlignmentPadding)
+        {
+            Stats->Used -= Size;
+            Stats->Unused += Size + AlignmentPadding;
+            Stats->AlignmentPadding -= AlignmentPadding;
+        }
+        
+        static void SubtractUsedAndAddUnused
+ (statistics* Stats, size Delta)
+        { 
+            Stats->Used -= Delta;
+            Stats->Unused += Delta;
+        }
+        
+        static void SubtractSizeAndUnused
+ (statistics* Stats, size SizeDelta, size UnusedDelta)
+        { 
+            Stats->Size -= SizeDelta; 
+            Stats->Unused -= UnusedDelta;
+        }
+        
+        static void AlterStatsOnMemoryBlockAllocation
+ (statistics* Stats, size NewMemoryBlockSize, size PrevMemoryBlockUnusedBytes)
+        {
+            AddSizeAndUnused(Stats, NewMemoryBlockSize);
+            Stats->Unused -= PrevMemoryBlockUnusedBytes;
+            Stats->Wasted += PrevMemoryBlockUnusedBytes;
+        }
         
-        if(!List.NextJobToTake)
+        static void AlterStatsOnMemoryBlockDeallocation
+ (statistics* Stats, size MemoryBlockToDeallocateSize, size PrevMemoryBlockUnusedBytes)
         {
-            auto LastJob = Jobs.GetAndPopLast();
-            auto* JobNode = rstd_PushStruct(&List.Arena, thread_pool_job_node{LastJob});
-            List.NextJobToTake = List.LastJobToTake = JobNode;
+            SubtractSizeAndUnused(Stats, MemoryBlockToDeallocateSize, MemoryBlockToDeallocateSize);
+            Stats->Unused += PrevMemoryBlockUnusedBytes;
+            Stats->Wasted -= PrevMemoryBlockUnusedBytes;
         }
         
-        for(auto Job : Jobs)
+        // NOTE: All pushes into the arena stop being live
+        static void ReleaseArenaSites
+ (u32 ArenaId)
         {
-            auto* JobNode = rstd_PushStruct(&List.Arena, thread_pool_job_node{Job});
-            List.LastJobToTake->Next = JobNode;
-            List.LastJobToTake = JobNode;
+            if(ArenaId >= State.ArenaSiteListCapacity)
+                return;
+            
+            auto& ArenaDebug = GetArenaDebug(ArenaId);
+            for(u32 Entry = State.ArenaSiteLists[ArenaId]; Entry;)
+            {
+                auto& ArenaSite = State.ArenaSites[Entry - 1];
+                State.Sites[ArenaSite.SiteIndex].Site.LiveBytes -= ArenaSite.Bytes;
+                RemovePush(&ArenaDebug.Stats, ArenaSite.Bytes, ArenaSite.AlignmentPadding);
+                RemovePush(&State.MemoryGroups[ArenaSite.MemoryGroupIndex].Stats, ArenaSite.Bytes, ArenaSite.AlignmentPadding);
+                RemovePush(&State.Stats, ArenaSite.Bytes, ArenaSite.AlignmentPadding);
+                RemoveArenaSiteSlot(Entry - 1);
+                --State.LiveArenaSiteCount;
+                
+                u32 Next = ArenaSite.NextInArena;
+                ArenaSite.NextInArena = State.FirstFreeArenaSite;
+                State.FirstFreeArenaSite = Entry;
+                Entry = Next;
+            }
+            State.ArenaSiteLists[ArenaId] = 0;
         }
         
-        Unlock(List.Mutex);
-        ThreadPoolLog("Mutex is unlocked by PushJob\n");
+        static size Scale
+ (size Bytes, f32 SampleWeight)
+        { return SampleWeight == 1.f ? Bytes : (size)((f64)Bytes * SampleWeight + 0.5); }
         
-        u32 ThreadsToAwakeCount = PushedJobCount > Pool.ThreadCount ? Pool.ThreadCount : PushedJobCount;
-        LONG WorkingThreadCount = 0;
-        ThreadPoolLog(Format<string<>>("ReleaseSemaphore 1 - ThreadsToAwakeCount: %\n", ThreadsToAwakeCount));
-        if(!ReleaseSemaphore(Pool.SemaphoreHandle, ThreadsToAwakeCount, &WorkingThreadCount))
+        constexpr u32 TraceBufferSize = 64*1024;
+        
+        static void FlushTraceBuffer()
         {
-            ThreadsToAwakeCount = Pool.ThreadCount - WorkingThreadCount;
-            ThreadPoolLog(Format<string<>>("ReleaseSemaphore 2 - ThreadsToAwakeCount: %, WorkingThreadCount: %\n", ThreadsToAwakeCount, WorkingThreadCount));
-            ReleaseSemaphore(Pool.SemaphoreHandle, ThreadsToAwakeCount, nullptr);
+            if(State.TraceBufferUsed)
+                Write(State.TraceStream, State.TraceBuffer, State.TraceBufferUsed);
+            State.TraceBufferUsed = 0;
         }
-#else
-        for(auto Job : Jobs)
-            Job.Callback(Job.CallbackUserData);
-#endif
-    }
-    
-    void CompleteAllJobs
- (thread_pool& Pool)
-    {
-#if rstd_MultiThreadingEnabled
-        auto& List = Pool.JobList;
-        while(List.NextJobToTake || Pool.RunningJobCount)
+        
+        static void WriteTraceBytes
+ (const void* Data, u32 Size)
         {
-            Lock(List.Mutex);
-            auto* Job = PopJob(List);
-            Unlock(List.Mutex);
-            if(Job)
-                Job->Callback(Job->CallbackUserData);
+            if(State.TraceBufferUsed + Size > TraceBufferSize)
+                FlushTraceBuffer();
+            if(Size > TraceBufferSize)
+            {
+                Write(State.TraceStream, (void*)Data, Size);
+                return;
+            }
+            memcpy(State.TraceBuffer + State.TraceBufferUsed, Data, Size);
+            State.TraceBufferUsed += Size;
         }
-#endif
-    }
-    
-    ///////////
-    // FILES //
-    ///////////
-#if rstd_FileDebugEnabled
-    
-    struct file_debug
-    {
-        struct open_file
-        {
-            string<> FilePath;
-            void* PlatformFileHandle;
-        };
         
-        backward_singly_linked_list_with_counter<open_file> OpenFiles;
-        mutex Mutex;
+        static void WriteTraceVarint
+ (u64 Value)
+        {
+            u8 Bytes[10];
+            u32 ByteCount = 0;
+            do
+            {
+                u8 Byte = Value & 0x7F;
+                Value >>= 7;
+                Bytes[ByteCount++] = Value ? (Byte | 0x80) : Byte;
+            } while(Value);
+            WriteTraceBytes(Bytes, ByteCount);
+        }
         
-        file_debug()
-        { OpenFiles = {OwnArena(rstd_AllocateArenaZero(MegabytesToBytes(1)))}; }
+        static void WriteTraceRecordType
+ (trace_record_type Type)
+        {
+            u8 Byte = (u8)Type;
+            WriteTraceBytes(&Byte, 1);
+        }
         
-        void OnOpenFile
- (const char* FilePath, void* PlatformFileHandle)
+        // NOTE: Strings are identified by pointer, same as memory groups and sites
+        static u32 GetTraceStringId
+ (const char* String)
         {
-            rstd_ScopeLock(Mutex);
-            OpenFiles.Push({FilePath, PlatformFileHandle});
+            if(!String)
+                return 0;
+            if(auto* Found = Find(State.TraceStringIds, (void*)String))
+                return (u32)Found->Size;
+            
+            u32 Id = ++State.NextTraceStringId;
+            Insert(State.TraceStringIds, (void*)String).Size = Id;
+            
+            u32 Length = (u32)strlen(String);
+            WriteTraceRecordType(trace_record_type::String);
+            WriteTraceVarint(Id);
+            WriteTraceVarint(Length);
+            WriteTraceBytes(String, Length);
+            return Id;
         }
         
-        void OnCloseFile
- (void* PlatformFileHandle)
+        static void WriteTraceTime
+ (u64 Time)
         {
-            rstd_ScopeLock(Mutex);
-            OpenFiles.RemoveFirstIfWithAssert(
- [=](auto& File){ return File.PlatformFileHandle == PlatformFileHandle; });
+            if(Time <= State.LastTraceTime)
+                return;
+            State.LastTraceTime = Time;
+            WriteTraceRecordType(trace_record_type::Time);
+            WriteTraceVarint(Time - State.TraceStartTime);
         }
-    };
-    
-#else
-    
-    struct file_debug
-    {
-        void OnOpenFile(const char* FilePath, void* PlatformFileHandle) {}
-        void OnCloseFile(void* PlatformFileHandle) {}
-    };
-    
-#endif
-    
-    static file_debug FileDebug;
-    
-    
-    file_error GetLastFileError()
-    {
-        auto Error = GetLastError();
-        switch(Error)
+        
+        // NOTE: Strings have to be written before the record that refers to them
+        static void WriteTraceEvent
+ (event& Event, size Size, size Extra, f64 Count)
         {
-            case ERROR_SUCCESS: return file_error::NoError;
-            case ERROR_FILE_NOT_FOUND: return file_error::FileIsMissing;
-            case ERROR_PATH_NOT_FOUND: return file_error::DirectoryOnPathIsMissing;
-            case ERROR_INVALID_HANDLE: return file_error::DirectoryOnPathIsMissing; // TODO: Can't ERROR_INVALID_HANDLE be produced in other cases?
-            case ERROR_ACCESS_DENIED: return file_error::AccessToFileWasDenied;
-            default: return file_error::UnknownError;
+            switch(Event.Type)
+            {
+                case event_type::CreateArena:
+                {
+                    u32 NameId = GetTraceStringId(Event.ArenaName);
+                    u32 MasterNameId = GetTraceStringId(Event.MasterArenaName);
+                    u32 MemoryGroupId = GetTraceStringId(Event.MemoryGroupName);
+                    u32 FileId = GetTraceStringId(Event.FilePath);
+                    u32 FunctionId = GetTraceStringId(Event.Function);
+                    WriteTraceRecordType(trace_record_type::CreateArena);
+                    WriteTraceVarint(Event.ArenaId);
+                    WriteTraceVarint(NameId);
+                    WriteTraceVarint(MasterNameId);
+                    WriteTraceVarint(MemoryGroupId);
+                    WriteTraceVarint(FileId);
+                    WriteTraceVarint(FunctionId);
+                    WriteTraceVarint(Event.Line);
+                    WriteTraceVarint(Size);
+                    WriteTraceVarint((u64)Event.GrowthPolicy);
+                } break;
+                
+                case event_type::ArenaPush:
+                {
+                    u32 MemoryGroupId = GetTraceStringId(Event.MemoryGroupName);
+                    u32 FileId = GetTraceStringId(Event.FilePath);
+                    u32 FunctionId = GetTraceStringId(Event.Function);
+                    WriteTraceRecordType(trace_record_type::ArenaPush);
+                    WriteTraceVarint(Event.ArenaId);
+                    WriteTraceVarint(MemoryGroupId);
+                    WriteTraceVarint(FileId);
+                    WriteTraceVarint(FunctionId);
+                    WriteTraceVarint(Event.Line);
+                    WriteTraceVarint((u64)(Count + 0.5));
+                    WriteTraceVarint(Size);
+                    WriteTraceVarint(Extra);
+                } break;
+                
+                case event_type::AllocateNextMemoryBlock:
+                {
+                    WriteTraceRecordType(trace_record_type::AllocateNextMemoryBlock);
+                    WriteTraceVarint(Event.ArenaId);
+                    WriteTraceVarint(Size);
+                    WriteTraceVarint(Extra);
+                    WriteTraceVarint((u64)Event.GrowthPolicy);
+                } break;
+                
+                case event_type::DeallocateMemoryBlock:
+                {
+                    WriteTraceRecordType(trace_record_type::DeallocateMemoryBlock);
+                    WriteTraceVarint(Event.ArenaId);
+                    WriteTraceVarint(Size);
+                    WriteTraceVarint(Extra);
+                } break;
+                
+                case event_type::ShrinkLastPush:
+                {
+                    u32 MemoryGroupId = GetTraceStringId(Event.MemoryGroupName);
+                    u32 FileId = GetTraceStringId(Event.FilePath);
+                    u32 FunctionId = GetTraceStringId(Event.Function);
+                    WriteTraceRecordType(trace_record_type::ShrinkLastPush);
+                    WriteTraceVarint(Event.ArenaId);
+                    WriteTraceVarint(MemoryGroupId);
+                    WriteTraceVarint(FileId);
+                    WriteTraceVarint(FunctionId);
+                    WriteTraceVarint(Event.Line);
+                    WriteTraceVarint(Size);
+                } break;
+                
+                case event_type::BeginTemporaryMemory:
+                case event_type::EndTemporaryMemory:
+                case event_type::ClearArena:
+                {
+                    WriteTraceRecordType(Event.Type == event_type::BeginTemporaryMemory ? trace_record_type::BeginTemporaryMemory :
+                                         Event.Type == event_type::EndTemporaryMemory ? trace_record_type::EndTemporaryMemory :
+                                         trace_record_type::ClearArena);
+                    WriteTraceVarint(Event.ArenaId);
+                } break;
+                
+                case event_type::GenAlloc:
+                {
+                    u32 MemoryGroupId = GetTraceStringId(Event.MemoryGroupName);
+                    u32 FileId = GetTraceStringId(Event.FilePath);
+                    u32 FunctionId = GetTraceStringId(Event.Function);
+                    WriteTraceRecordType(trace_record_type::GenAlloc);
+                    WriteTraceVarint((u64)(umm)Event.Memory);
+                    WriteTraceVarint(MemoryGroupId);
+                    WriteTraceVarint(FileId);
+                    WriteTraceVarint(FunctionId);
+                    WriteTraceVarint(Event.Line);
+                    WriteTraceVarint(Size);
+                } break;
+                
+                case event_type::GenFree:
+                {
+                    WriteTraceRecordType(trace_record_type::GenFree);
+                    WriteTraceVarint((u64)(umm)Event.Memory);
+                } break;
+            }
         }
-    }
-    
-    backward_singly_linked_list_with_counter<file_info> GetFileInfos
- (arena& Arena, const char* DirectoryPath)
-    {
-        backward_singly_linked_list_with_counter<file_info> FileInfos = ShareArena(Arena);
         
-        // TODO: Support unicode file names
+        // NOTE: Event can stand for a run of pushes from one site, Size and AlignmentPadding are already scaled
+        static void MergeArenaPush
+ (event& Event, size Size, size AlignmentPadding, f64 Count)
+        {
+            if(State.Tracing)
+                WriteTraceEvent(Event, Size, AlignmentPadding, Count);
+            
+            u32 SiteIndex;
+            auto& Site = GetSite(Event.FilePath, Event.Function, Event.Line, &SiteIndex);
+            Site.Count += Count;
+            Site.Site.Bytes += Size;
+            
+            auto& ArenaDebug = GetArenaDebug(Event.ArenaId);
+            if(ArenaDebug.TemporaryMemoryDepth)
+                return;
+            
+            u32 MemoryGroupIndex = GetMemoryGroupIndex(Event.MemoryGroupName);
+            AddSiteLiveBytes(Site, Size);
+            auto& ArenaSite = GetArenaSite(Event.ArenaId, SiteIndex, MemoryGroupIndex);
+            ArenaSite.Bytes += Size;
+            ArenaSite.AlignmentPadding += AlignmentPadding;
+            
+            auto& GroupStats = State.MemoryGroups[MemoryGroupIndex].Stats;
+            AddPush(&ArenaDebug.Stats, Size, AlignmentPadding);
+            AddPush(&GroupStats, Size, AlignmentPadding);
+            AddPush(&State.Stats, Size, AlignmentPadding);
+        }
         
-        string<258> Path = DirectoryPath; // TODO: Add support for 32767 character paths! (I guess in a separate function)
-        Path += "/*";
+        // NOTE: Events of one thread are merged in order. Events of different threads may come
+        //       in different order than they happened, that's why unknown arenas are created on first use
+        //       and frees that come before their allocation wait in EarlyGenFrees
+        static void MergeEvent
+ (event& Event)
+        {
+            if(State.Tracing && Event.Type != event_type::ArenaPush && Event.Type != event_type::ShrinkLastPush)
+            {
+                size Size = Event.Type == event_type::GenAlloc ? Scale(Event.Size, Event.SampleWeight) : Event.Size;
+                WriteTraceEvent(Event, Size, Event.Type == event_type::CreateArena ? 0 : Event.Extra, Event.SampleWeight);
+            }
+            
+            switch(Event.Type)
+            {
+                case event_type::CreateArena:
+                {
+                    auto& ArenaDebug = GetArenaDebug(Event.ArenaId);
+                    ArenaDebug.MasterArenaName = Event.MasterArenaName;
+                    ArenaDebug.MemoryGroupName = State.MemoryGroups[GetMemoryGroupIndex(Event.MemoryGroupName)].Name;
+                    ArenaDebug.CreationCallingInfo = {Event.FilePath, Event.Function, Event.Line};
+                    ArenaDebug.GrowthPolicy = Event.GrowthPolicy;
+                    // NOTE: Blocks of concurrent arena can be registered by other threads before their creation is merged
+                    ++ArenaDebug.MemoryBlockCount;
+                    ArenaDebug.Deallocated = false;
+                    
+                    if(Event.ArenaName)
+                    {
+                        ArenaDebug.Name = Event.ArenaName;
+                    }
+                    else
+                    {
+                        auto& Name = rstd_PushStructUninitialized(State.Arena, allocator_name);
+                        Name = Format<allocator_name>("nameless %", Event.ArenaId);
+                        ArenaDebug.Name = Name.GetCString();
+                        ArenaDebug.HasNamelessName = true;
+                    }
+                    
+                    AddSizeAndUnused(&ArenaDebug.Stats, Event.Size);
+                    AddSizeAndUnused(&State.MemoryGroups[GetMemoryGroupIndex(Event.MemoryGroupName)].Stats, Event.Size);
+                    AddSizeAndUnused(&State.Stats, Event.Size);
+                } break;
+                
+                case event_type::ArenaPush:
+                {
+                    MergeArenaPush(Event, Scale(Event.Size, Event.SampleWeight), Scale(Event.Extra, Event.SampleWeight),
+                                   (f64)Event.PushCount * Event.SampleWeight);
+                } break;
+                
+                case event_type::AllocateNextMemoryBlock:
+                {
+                    auto& ArenaDebug = GetArenaDebug(Event.ArenaId);
+                    ++ArenaDebug.MemoryBlockCount;
+                    ArenaDebug.GrowthPolicy = Event.GrowthPolicy;
+                    AlterStatsOnMemoryBlockAllocation(&ArenaDebug.Stats, Event.Size, Event.Extra);
+                    AlterStatsOnMemoryBlockAllocation(&State.MemoryGroups[GetMemoryGroupIndex(ArenaDebug.MemoryGroupName)].Stats,
+                                                      Event.Size, Event.Extra);
+                    AlterStatsOnMemoryBlockAllocation(&State.Stats, Event.Size, Event.Extra);
+                } break;
+                
+                case event_type::DeallocateMemoryBlock:
+                {
+                    auto& ArenaDebug = GetArenaDebug(Event.ArenaId);
+                    if(--ArenaDebug.MemoryBlockCount == 0)
+                    {
+                        ArenaDebug.Deallocated = true;
+                        ReleaseArenaSites(Event.ArenaId);
+                    }
+                    AlterStatsOnMemoryBlockDeallocation(&ArenaDebug.Stats, Event.Size, Event.Extra);
+                    AlterStatsOnMemoryBlockDeallocation(&State.MemoryGroups[GetMemoryGroupIndex(ArenaDebug.MemoryGroupName)].Stats,
+                                                        Event.Size, Event.Extra);
+                    AlterStatsOnMemoryBlockDeallocation(&State.Stats, Event.Size, Event.Extra);
+                } break;
+                
+                case event_type::BeginTemporaryMemory:
+                {
+                    ++GetArenaDebug(Event.ArenaId).TemporaryMemoryDepth;
+                } break;
+                
+                case event_type::EndTemporaryMemory:
+                {
+                    --GetArenaDebug(Event.ArenaId).TemporaryMemoryDepth;
+                } break;
+                
+                case event_type::GenAlloc:
+                {
+                    if(!Event.Memory)
+                        break;
+                    
+                    u32 SiteIndex;
+                    size Size = Scale(Event.Size, Event.SampleWeight);
+                    auto& Site = GetSite(Event.FilePath, Event.Function, Event.Line, &SiteIndex);
+                    Site.Count += Event.SampleWeight;
+                    Site.Site.Bytes += Size;
+                    
+                    if(auto* EarlyFree = Find(State.EarlyGenFrees, Event.Memory))
+                    {
+                        if(--EarlyFree->Size == 0)
+                            Remove(State.EarlyGenFrees, EarlyFree);
+                        break;
+                    }
+                    
+                    u32 MemoryGroupIndex = GetMemoryGroupIndex(Event.MemoryGroupName);
+                    auto& Alloc = Insert(State.GenAllocations, Event.Memory);
+                    Alloc.Size = Size;
+                    Alloc.MemoryGroupIndex = MemoryGroupIndex;
+                    Alloc.SiteIndex = SiteIndex;
+                    AddSiteLiveBytes(Site, Size);
+                    
+                    auto& GroupStats = State.MemoryGroups[MemoryGroupIndex].Stats;
+                    AddUsedAndSubtractUnused(&GroupStats, Size);
+                    AddSizeAndUnused(&GroupStats, Size);
+                    AddUsedAndSubtractUnused(&State.Stats, Size);
+                    AddSizeAndUnused(&State.Stats, Size);
+                } break;
+                
+                case event_type::GenFree:
+                {
+                    if(!Event.Memory)
+                        break;
+                    
+                    auto* Alloc = Find(State.GenAllocations, Event.Memory);
+                    if(!Alloc)
+                    {
+                        auto* EarlyFree = Find(State.EarlyGenFrees, Event.Memory);
+                        if(!EarlyFree)
+                        {
+                            EarlyFree = &Insert(State.EarlyGenFrees, Event.Memory);
+                            EarlyFree->Size = 0;
+                        }
+                        ++EarlyFree->Size;
+                        break;
+                    }
+                    
+                    State.Sites[Alloc->SiteIndex].Site.LiveBytes -= Alloc->Size;
+                    auto& GroupStats = State.MemoryGroups[Alloc->MemoryGroupIndex].Stats;
+                    SubtractUsedAndAddUnused(&GroupStats, Alloc->Size);
+                    SubtractSizeAndUnused(&GroupStats, Alloc->Size, 0);
+                    SubtractUsedAndAddUnused(&State.Stats, Alloc->Size);
+                    SubtractSizeAndUnused(&State.Stats, Alloc->Size, 0);
+                    Remove(State.GenAllocations, Alloc);
+                } break;
+                
+                case event_type::ShrinkLastPush:
+                {
+                    auto& ArenaDebug = GetArenaDebug(Event.ArenaId);
+                    if(ArenaDebug.TemporaryMemoryDepth)
+                        break;
+                    
+                    // NOTE: Given back bytes are taken from the newest pushes of the same memory group, whichever site
+                    //       made them. Size is clamped to what is live so release of the arena never subtracts it twice,
+                    //       trace gets the clamped size too
+                    u32 MemoryGroupIndex = GetMemoryGroupIndex(Event.MemoryGroupName);
+                    size Size = 0;
+                    u32 Entry = Event.ArenaId < State.ArenaSiteListCapacity ? State.ArenaSiteLists[Event.ArenaId] : 0;
+                    for(; Entry && Size < Event.Size; Entry = State.ArenaSites[Entry - 1].NextInArena)
+                    {
+                        auto& ArenaSite = State.ArenaSites[Entry - 1];
+                        if(ArenaSite.MemoryGroupIndex != MemoryGroupIndex)
+                            continue;
+                        
+                        size Bytes = Event.Size - Size < ArenaSite.Bytes ? Event.Size - Size : ArenaSite.Bytes;
+                        ArenaSite.Bytes -= Bytes;
+                        State.Sites[ArenaSite.SiteIndex].Site.LiveBytes -= Bytes;
+                        Size += Bytes;
+                    }
+                    
+                    if(State.Tracing)
+                        WriteTraceEvent(Event, Size, 0, 1);
+                    SubtractUsedAndAddUnused(&ArenaDebug.Stats, Size);
+                    SubtractUsedAndAddUnused(&State.MemoryGroups[MemoryGroupIndex].Stats, Size);
+                    SubtractUsedAndAddUnused(&State.Stats, Size);
+                } break;
+                
+                case event_type::ClearArena:
+                {
+                    // NOTE: Pushes into arenas created before Init() share id 0, those are never released
+                    if(Event.ArenaId)
+                        ReleaseArenaSites(Event.ArenaId);
+                } break;
+            }
+        }
         
-        WIN32_FIND_DATA FindData;
-        HANDLE FindHandle = FindFirstFileA(Path.GetCString(), &FindData); // name of first found thing is "." TODO: Make sure it's true
-        if(FindHandle != INVALID_HANDLE_VALUE)
+        // NOTE: Owner of buffer that isn't full may still be adding events and growing its last pushes,
+        //       so those are merged again later as a difference. Values only grow, so reading them while
+        //       they are written loses nothing
+        static void MergeBufferEvents
+ (event_buffer* Buffer)
         {
-            FindNextFileA(FindHandle, &FindData); // name of second found thing is ".." TODO: Make sure it's true
+            u32 EventCount = Buffer->EventCount;
+            ReadFence();
             
-            while(FindNextFileA(FindHandle, &FindData))
+            u32 EventIndex = Buffer->MergedCount > ArenaPushCoalesceDepth ? Buffer->MergedCount - ArenaPushCoalesceDepth : 0;
+            for(; EventIndex < Buffer->MergedCount; ++EventIndex)
             {
-                file_info FileInfo;
-                FileInfo.Name = rstd_PushStringCopy(Arena, FindData.cFileName);
-                FileInfos.Push(FileInfo);
+                auto& Event = Buffer->Events[EventIndex];
+                if(Event.Type != event_type::ArenaPush || Event.Sampled)
+                    continue;
+                
+                auto& Merged = Buffer->MergedPushes[EventIndex % ArenaPushCoalesceDepth];
+                merged_push Current = {*(volatile size*)&Event.Size, *(volatile size*)&Event.Extra, *(volatile u64*)&Event.PushCount};
+                if(Current.Size != Merged.Size || Current.Extra != Merged.Extra || Current.PushCount != Merged.PushCount)
+                    MergeArenaPush(Event, Current.Size - Merged.Size, Current.Extra - Merged.Extra, (f64)(Current.PushCount - Merged.PushCount));
+                Merged = Current;
             }
-            FindClose(FindHandle);
+            
+            for(; EventIndex < EventCount; ++EventIndex)
+            {
+                auto& Event = Buffer->Events[EventIndex];
+                State.SampleCount += Event.Sampled;
+                if(Event.Type == event_type::ArenaPush && !Event.Sampled)
+                {
+                    auto& Merged = Buffer->MergedPushes[EventIndex % ArenaPushCoalesceDepth];
+                    Merged = {*(volatile size*)&Event.Size, *(volatile size*)&Event.Extra, *(volatile u64*)&Event.PushCount};
+                    MergeArenaPush(Event, Merged.Size, Merged.Extra, (f64)Merged.PushCount);
+                }
+                else
+                {
+                    MergeEvent(Event);
+                }
+            }
+            Buffer->MergedCount = EventCount;
         }
         
-        return FileInfos;
-    }
-    
-    // TODO: Try to rename those to DeleteFile and MoveFile,
-    //       You can use :: operator after you wrap this library in rlsr namespace
-    //       Or you can do:
-    //       namespace win32
-    //       {
-    //			#include <windows.h>
-    //       }
-    
-#undef CopyFile // TODO: What to do about those stupid macros and repeated names (same name in rstd and win32)
-#undef CreateDirectory
-    
-    // TODO: Make unicode version of those functions in which path can be longer the MAX_PATH
-    
-    i32 RemoveFile(const char* FilePath)
-    { return DeleteFileA(FilePath); }
-    
-    i32 RenameFile(const char* FilePath, const char* NewFilePath)
-    { return MoveFile(FilePath, NewFilePath); }
-    
-    const rstd_bool FailIfFileWithNewPathExists = true;
-    const rstd_bool OverrideFileIfFileWithNewPathExists = false;
-    
-    rstd_bool CopyFile(const char* ExistingFilePath, const char* NewFilePath, rstd_bool FailOrOverride)
-    { return (rstd_bool)CopyFileA(ExistingFilePath, NewFilePath, (BOOL)FailOrOverride); }
-    
-    rstd_bool FileExists
- (const char* Path)
-    {
-        u32 Attrib = GetFileAttributes(Path);
-        return Attrib != INVALID_FILE_ATTRIBUTES && !(Attrib & FILE_ATTRIBUTE_DIRECTORY);
-    }
-    
-    // TODO: Make OpenFile api support control over dwShareMode, dwCreationDisposition, dwFlagsAndAttributes
-    file OpenFile
- (const char* FilePath, io_mode Mode)
-    {
-        file File = {};
+        // NOTE: Called with BuffersMutex held, returns last buffer of the list
+        static event_buffer* MergeFullBufferList
+ (event_buffer* Buffers)
+        {
+            event_buffer* LastBuffer = nullptr;
+            for(auto* Buffer = Buffers; Buffer; Buffer = Buffer->Next)
+            {
+                if(State.Tracing)
+                    WriteTraceTime(Buffer->SubmitTime);
+                
+                MergeBufferEvents(Buffer);
+                Buffer->EventCount = 0;
+                Buffer->MergedCount = 0;
+                LastBuffer = Buffer;
+            }
+            return LastBuffer;
+        }
         
-        u32 DesiredAccess = 0;
-        u32 CreationDisposition = 0;
-        switch(Mode)
+        static void MergeFullBuffers()
         {
-            case io_mode::Read:
+            event_buffer* Buffers;
             {
-                DesiredAccess = GENERIC_READ;
-                CreationDisposition = OPEN_EXISTING;
-            } break;
+                rstd_ScopeLock(State.BuffersMutex);
+                Buffers = State.FirstFullBuffer;
+                State.FirstFullBuffer = State.LastFullBuffer = nullptr;
+            }
             
-            case io_mode::Write:
-            {
-                DesiredAccess = GENERIC_WRITE;
-                CreationDisposition = OPEN_ALWAYS;
-            } break;
+            event_buffer* LastBuffer = MergeFullBufferList(Buffers);
             
-            case io_mode::ReadWrite:
-            {
-                DesiredAccess = GENERIC_READ | GENERIC_WRITE;
-                CreationDisposition = OPEN_ALWAYS;
-            } break;
+            if(State.Tracing)
+                FlushTraceBuffer();
             
-            rstd_InvalidDefaultCase;
+            if(LastBuffer)
+            {
+                rstd_ScopeLock(State.BuffersMutex);
+                LastBuffer->Next = State.FreeBuffers;
+                State.FreeBuffers = Buffers;
+            }
         }
         
-        File.PlatformFileHandle = ::CreateFileA(FilePath, DesiredAccess,
-                                                FILE_SHARE_READ, 0, CreationDisposition, 0, 0);
-        if(File.PlatformFileHandle == INVALID_HANDLE_VALUE)
-            File.PlatformFileHandle = nullptr;
-        else
-            FileDebug.OnOpenFile(FilePath, File.PlatformFileHandle);
-        
-        return File;
-    }
-    
-    rstd_bool Close
- (file& File)
-    { 
-        rstd_bool Succeded = (rstd_bool)CloseHandle(File.PlatformFileHandle);
-        if(Succeded)
-            FileDebug.OnCloseFile(File.PlatformFileHandle);
-        File.PlatformFileHandle = nullptr;
-        return Succeded;
-    }
-    
-    OVERLAPPED MakeOverlapped
- (u64 Pos)
-    {
-        OVERLAPPED Overlapped = {};
-        Overlapped.Offset = (u32)Pos;
-        Overlapped.OffsetHigh = (u32)(Pos >> 32);
-        return Overlapped;
-    }
-    
-    u32 Write
- (file File, u64 Pos, void* Data, u32 Size)
-    {
-        rstd_Assert(File);
-        DWORD WrittenBytes;
-        auto Overlapped = MakeOverlapped(Pos);
-        WriteFile(File.PlatformFileHandle, Data, Size, &WrittenBytes, &Overlapped);
-        // TODO: Check if GetLastError returned ERROR_IO_PENDING
-        return WrittenBytes;
-    }
-    
-    u32 Read
- (void* Dest, file File, u64 Pos, u32 Size)
-    {
-        rstd_Assert(File);
-        DWORD ReadBytes;
-        auto Overlapped = MakeOverlapped(Pos);
-        ReadFile(File.PlatformFileHandle, Dest, Size, &ReadBytes, &Overlapped);
-        // TODO: Check if GetLastError returned ERROR_IO_PENDING
-        return ReadBytes;
-    }
-    
-    // TODO: Add u64 version of this function
-    rstd_bool SetFileSize
- (file File, u32 Size)
-    {
-        LARGE_INTEGER FilePointer = {};
-        FilePointer.QuadPart = Size;
-        auto FileHandle = File.PlatformFileHandle;
-        auto Success = SetFilePointerEx(FileHandle, FilePointer, 0, FILE_BEGIN) && SetEndOfFile(FileHandle);
-        return (rstd_bool)Success;
-    }
-    
-    // TODO: Make this function work for size_t
-    u32 GetFileSize
- (file File)
-    { 
-        LARGE_INTEGER Int;
-        if(GetFileSizeEx(File.PlatformFileHandle, &Int))
-            return (u32)Int.QuadPart;
-        else
-            return InvalidU32;
-    }
-    
-    char* ReadWholeFile
- (arena& Arena, const char* FilePath)
-    {
-        auto File = OpenFile(FilePath, io_mode::Read);
-        rstd_defer(Close(File));
-        
-        u32 FileSize = GetFileSize(File);
-        if(FileSize == 0 || FileSize == InvalidU32)
+        // NOTE: BuffersMutex is held all the time so that no thread can submit its buffer in the middle and have
+        //       its events merged out of order. Threads only wait for it when they need a new buffer
+        static void MergeAllBuffers()
         {
-            return nullptr;
+            rstd_ScopeLock(State.BuffersMutex);
+            auto* Buffers = State.FirstFullBuffer;
+            State.FirstFullBuffer = State.LastFullBuffer = nullptr;
+            if(auto* LastBuffer = MergeFullBufferList(Buffers))
+            {
+                LastBuffer->Next = State.FreeBuffers;
+                State.FreeBuffers = Buffers;
+            }
+            
+            if(State.Tracing)
+                WriteTraceTime(GetSystemTimeAsUnixEpoch());
+            for(auto* Thread = State.FirstThread; Thread; Thread = Thread->NextThread)
+            {
+                if(Thread->Buffer)
+                    MergeBufferEvents(Thread->Buffer);
+            }
+            
+            if(State.Tracing)
+                FlushTraceBuffer();
         }
-        else
+        
+        // NOTE: Called with BuffersMutex held
+        static void SubmitBuffer
+ (thread_state& Thread)
         {
-            void* Content = rstd_PushSizeUninitialized(Arena, FileSize + 1);
-            Read(Content, File, (u32)0, FileSize);
-            char* Res = (char*)Content;
-            Res[FileSize] = 0;
-            return Res;
+            auto* Buffer = Thread.Buffer;
+            Buffer->Next = nullptr;
+            Buffer->SubmitTime = GetSystemTimeAsUnixEpoch();
+            if(State.LastFullBuffer)
+                State.LastFullBuffer->Next = Buffer;
+            else
+                State.FirstFullBuffer = Buffer;
+            State.LastFullBuffer = Buffer;
+            Thread.Buffer = nullptr;
         }
-    }
-    
-    rstd_bool CreateDirectory(const char* Path)
-    { return ::CreateDirectoryA(Path, nullptr); }
-    
-    rstd_bool CreateDirectory(const wchar_t* Path)
-    { return CreateDirectoryW(Path, nullptr); }
-    
-    rstd_bool DeleteDirectory(const char* Path)
-    { return RemoveDirectoryA(Path); }
-    
-    // TODO: What's up with prepend "\\?\". Check the docs and test it!
-    rstd_bool DeleteDirectory(const wchar_t* Path)
-    { return RemoveDirectoryW(Path); }
-    
-    // TODO: Paths longer then MAX_PATH could be a problem here. Should I use unicode versions of DeleteFile and DeleteDirectory?
-    rstd_bool DeleteAllContentsOfDirectory
- (const char* Path)
-    {
-        string<> SearchPath = Path;
-        SearchPath += "/*";
         
-        WIN32_FIND_DATA FindData;
-        HANDLE FindHandle = FindFirstFileA(SearchPath.GetCString(), &FindData); // name of first found thing is "." TODO: Make sure it's true
-        if(FindHandle == INVALID_HANDLE_VALUE)
+        // NOTE: Events that come after this (e.g. from destructors of other thread_locals) are dropped
+        thread_exit::~thread_exit()
         {
-            return false;
+            auto& Thread = ThreadState;
+            rstd_ScopeLock(State.BuffersMutex);
+            if(Thread.Buffer)
+                SubmitBuffer(Thread);
+            
+            if(Thread.PrevThread)
+                Thread.PrevThread->NextThread = Thread.NextThread;
+            else
+                State.FirstThread = Thread.NextThread;
+            if(Thread.NextThread)
+                Thread.NextThread->PrevThread = Thread.PrevThread;
+            Thread.NoRegistrationDepth = 1;
         }
-        else
+        
+        // NOTE: Event is seen by merging only after PublishEvent()
+        static event* AddEvent
+ (event_type Type)
         {
-            FindNextFileA(FindHandle, &FindData); // name of second found thing is ".." TODO: Make sure it's true
+            auto& Thread = ThreadState;
+            if(!State.Initialized || Thread.NoRegistrationDepth)
+                return nullptr;
             
-            while(FindNextFileA(FindHandle, &FindData))
+            if(Thread.Buffer && Thread.Buffer->EventCount == EventBufferCapacity)
             {
-                string<> FilePath = Path;
-                FilePath += "/";
-                FilePath += FindData.cFileName;
-                if(FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
                 {
-                    DeleteAllContentsOfDirectory(FilePath.GetCString());
-                    DeleteDirectory(FilePath.GetCString());
+                    rstd_ScopeLock(State.BuffersMutex);
+                    SubmitBuffer(Thread);
+                }
+                
+                // NOTE: Thread that doesn't get the lock just goes on, someone else is merging
+                if(TryLock(State.Mutex))
+                {
+                    ScopeNoAllocRegistration;
+                    MergeFullBuffers();
+                    Unlock(State.Mutex);
+                }
+            }
+            
+            if(!Thread.Buffer)
+            {
+                rstd_ScopeLock(State.BuffersMutex);
+                auto* Buffer = State.FreeBuffers;
+                if(Buffer)
+                {
+                    State.FreeBuffers = Buffer->Next;
                 }
                 else
                 {
-                    DeleteFile(FilePath.GetCString());
+                    Buffer = (event_buffer*)PageAlloc(Align(sizeof(event_buffer), MemoryPageSize));
+                    rstd_RAssert(Buffer, "OS Allocation call failed (probably your machine ran out of memory)");
+                }
+                Thread.Buffer = Buffer;
+                
+                if(!ThreadExit.Listed)
+                {
+                    ThreadExit.Listed = true;
+                    Thread.NextThread = State.FirstThread;
+                    if(State.FirstThread)
+                        State.FirstThread->PrevThread = &Thread;
+                    State.FirstThread = &Thread;
                 }
             }
-            FindClose(FindHandle);
-            return true;
+            
+            event* Event = Thread.Buffer->Events + Thread.Buffer->EventCount;
+            Event->Type = Type;
+            Event->MemoryGroupName = Thread.CurrentMemoryGroup;
+            Event->SampleWeight = 1;
+            Event->Sampled = false;
+            return Event;
         }
-    }
-    
-    rstd_bool DeleteDirectoryWithAllContents
- (const char* Path)
-    {
-        rstd_bool Success = DeleteAllContentsOfDirectory(Path);
-        if(Success)
-            DeleteDirectory(Path);
-        return Success;
-    }
-    
-    //////////
-    // TIME //
-    //////////
-    static time ConvertToTime
- (SYSTEMTIME& St)
-    {
-        time Time;
-        Time.Year = (u32)St.wYear;
-        Time.Month = (month)St.wMonth;
-        Time.Day = (u8)St.wDay;
-        Time.DayOfWeek = St.wDayOfWeek == 0 ? day_of_week::Sunday : (day_of_week)St.wDayOfWeek;
-        Time.Hour = (u8)St.wHour;
-        Time.Minute = (u8)St.wMinute;
-        Time.Second = (u8)St.wSecond;
-        Time.Millisecond = St.wMilliseconds;
-        return Time;
-    }
-    
-    time GetUtcTime()
-    {
-        SYSTEMTIME St;
-        GetSystemTime(&St);
-        return ConvertToTime(St);
-    }
-    
-    time GetLocalTime()
-    {
-        SYSTEMTIME St;
-        GetLocalTime(&St);
-        return ConvertToTime(St);
-    }
-    
-    u64 GetSystemTimeAsUnixEpoch()
-    {
-        union file_time 
-        {
-            FILETIME FileTime;
-            u64 U64;
-        };
-        file_time Res;
-        GetSystemTimeAsFileTime(&Res.FileTime);
-        u64 DifferenceBetweenWindowsEpochAndUnixEpoch = 116444736000000000;
-        Res.U64 -= DifferenceBetweenWindowsEpochAndUnixEpoch;
-        return Res.U64;
-    }
-    
-#endif // _WIN32
-    
-#if rstd_MemoryProfilerEnabled
-    //////////////////
-    // MEMORY DEBUG //
-    //////////////////
-    namespace MemoryDebug
-    {
-        struct statistics
-        {
-            u32
-                Used, UsedPeak,
-            Size, SizePeak,
-            Wasted, Unused;
-        };
-        
-        struct arena_debug_data
-        {
-            doubly_linked_list<memory_block> MemoryBlocks;
-            const char* Name;
-            const char* MasterArenaName;
-            statistics Stats;
-            calling_info CreationCallingInfo;
-            rstd_bool HasNamelessName;
-            rstd_bool TemporaryMemory;
-        };
         
-        struct allocation
+        // NOTE: Queries merge buffers of other threads while they are filled, so event is counted once it's written
+        static void PublishEvent()
         {
-            calling_info CallingInfo;
-            const char* AllocatorName;
-            void* Memory;
-            u32 Size;
-            allocation_type Type;
-        };
+            auto* Buffer = ThreadState.Buffer;
+            WriteFence();
+            Buffer->EventCount = Buffer->EventCount + 1;
+        }
         
-        struct deallocation
+        static void AddArenaEvent
+ (event_type Type, u32 ArenaId)
         {
-            void* Memory;
-            allocation_type Type;
-        };
+            if(auto* Event = AddEvent(Type))
+            {
+                Event->ArenaId = ArenaId;
+                PublishEvent();
+            }
+        }
         
-        struct memory_group
+        static void SetCallingInfo
+ (event* Event, calling_info CallingInfo)
         {
-            doubly_linked_list_with_counter<arena_debug_data> Arenas;
-            doubly_linked_list<allocation> Allocations;
-            doubly_linked_list<deallocation> Deallocations;
-            const char* Name;
-        };
+            Event->FilePath = CallingInfo.FilePath;
+            Event->Function = CallingInfo.Function;
+            Event->Line = CallingInfo.Line;
+        }
         
-        struct state
+        static i64 GetNextSampleDistance
+ (random_sequence& Random)
         {
-            arena Arena;
-            doubly_linked_list<memory_group> MemoryGroups;
-            doubly_linked_list<allocator_name> NamelessAllocatorNames;
-            statistics Stats;
-            memory_group* OthersMemoryGroup;
-            memory_group* CurrentMemoryGroup;
-            u32 NextArenaDebugId;
-            u32 NamelessAllocatorIndex;
-            rstd_bool JustCalledNextAllocationMemoryGroup;
-            rstd_bool RegisterAllocations;
-        };
-        
-        global state State;
+            // NOTE: Exponentially distributed distances make sampled bytes a Poisson process,
+            //       so whether allocation gets sampled doesn't depend on allocations before it
+            f64 Uniform = (f64)RandomU32(Random) / 4294967296.0;
+            return (i64)(-log(Uniform) * (f64)State.SamplingInterval) + 1;
+        }
         
-        struct scope_no_alloc_registration
+        // NOTE: Returns weight of sampled allocation or 0 if it isn't sampled
+        static f32 SampleAllocation
+ (size Size)
         {
-            scope_no_alloc_registration()
-            { State.RegisterAllocations = false; }
+            auto& Sampling = SamplingState;
+            Sampling.BytesUntilSample -= (i64)Size;
+            if(Sampling.BytesUntilSample > 0)
+                return 0;
             
-            ~scope_no_alloc_registration()
-            { State.RegisterAllocations = true; }
-        };
-        
-#define ScopeNoAllocRegistration scope_no_alloc_registration ScopeNoAllocRegis
+            if(!Sampling.Random.A)
+            {
+                Sampling.Random.A = (MakeRandomSequenceFromTime().A ^ HashPointer(&Sampling)) | 1;
+                Sampling.BytesUntilSample = GetNextSampleDistance(Sampling.Random) - (i64)Size;
+                if(Sampling.BytesUntilSample > 0)
+                    return 0;
+            }
+            
+            Sampling.BytesUntilSample = GetNextSampleDistance(Sampling.Random);
+            
+            // NOTE: Allocation of Size bytes gets sampled with probability 1 - e^(-Size / SamplingInterval)
+            f64 Probability = -expm1(-(f64)Size / (f64)State.SamplingInterval);
+            return Probability > 0 ? (f32)(1.0 / Probability) : 1.f;
+        }
         
-        memory_group* AddMemoryGroup
- (const char* Name)
+        static void EndNextCallMemoryGroup()
         {
-            ScopeNoAllocRegistration;
-            auto& MemoryGroup = State.MemoryGroups.PushUninitialized();
-            MemoryGroup.Name = Name;
-            MemoryGroup.Arenas = ShareArena(State.Arena);
-            MemoryGroup.Allocations = ShareArena(State.Arena);
-            MemoryGroup.Deallocations = ShareArena(State.Arena);
-            return &MemoryGroup;
+            auto& Thread = ThreadState;
+            if(Thread.JustCalledNextCallMemoryGroup)
+            {
+                Thread.JustCalledNextCallMemoryGroup = false;
+                Thread.CurrentMemoryGroup = nullptr;
+            }
         }
         
-        void Init()
+        void Init
+ (size SamplingInterval)
         {
+            if(State.Initialized)
+                return;
+            
             ScopeNoAllocRegistration;
-            State.Arena = AllocateArenaZero(MegabytesToBytes(2), "Memory debug");
-            State.MemoryGroups = ShareArena(State.Arena);
-            State.NamelessAllocatorNames = ShareArena(State.Arena);
-            State.OthersMemoryGroup = AddMemoryGroup("Others");
-            State.CurrentMemoryGroup = State.OthersMemoryGroup;
-            State.RegisterAllocations = true;
+            rstd_ScopeLock(State.Mutex);
+            State.SamplingInterval = SamplingInterval;
+            State.Arena = rstd_AllocateArenaZero(MegabytesToBytes(2), "Memory debug");
+            AddMemoryGroup("Others", HashString("Others"));
+            GetArenaDebug(0).Name = "Unregistered";
+            State.Initialized = true;
         }
         
-        void BeginMemoryGroup
+        void BeginMemoryGroup(const char* Name)
+        { ThreadState.CurrentMemoryGroup = Name; }
+        
+        void EndMemoryGroup()
+        { ThreadState.CurrentMemoryGroup = nullptr; }
+        
+        void NextCallMemoryGroup
  (const char* Name)
         {
-            auto* MemoryGroup = Find(State.MemoryGroups, [=]
- (auto Group){ return strcmp(Group.Name, Name) == 0; });
+            BeginMemoryGroup(Name);
+            ThreadState.JustCalledNextCallMemoryGroup = true;
+        }
+        
+        // NOTE: Returns new arena id, 0 if registration is off
+        static u32 InternalRegisterCreateArena
+ (size Size, arena_growth_policy GrowthPolicy, const char* ArenaName, const char* MasterArenaName, calling_info CallingInfo)
+        {
+            auto* Event = AddEvent(event_type::CreateArena);
+            if(!Event)
+                return 0;
             
-            if(!MemoryGroup)
-                MemoryGroup = AddMemoryGroup(Name);
+            u32 ArenaId = AtomicIncrement(State.NextArenaDebugId);
+            SetCallingInfo(Event, CallingInfo);
+            Event->ArenaName = ArenaName;
+            Event->MasterArenaName = MasterArenaName;
+            Event->Size = Size;
+            Event->ArenaId = ArenaId;
+            Event->GrowthPolicy = GrowthPolicy;
+            PublishEvent();
             
-            State.CurrentMemoryGroup = MemoryGroup;
+            EndNextCallMemoryGroup();
+            return ArenaId;
         }
         
-        void EndMemoryGroup()
-        { State.CurrentMemoryGroup = State.OthersMemoryGroup; }
+        void RegisterCreateArena
+ (arena& Arena, const char* ArenaName, const char* MasterArenaName, calling_info CallingInfo)
+        {
+            Arena.DebugId = InternalRegisterCreateArena(Arena.MemoryBlock->Size, Arena.GrowthPolicy,
+                                                        ArenaName, MasterArenaName, CallingInfo);
+            rstd_DebugOnly(if(Arena.DebugId) Arena.DebugName = ArenaName;)
+        }
         
-        void NextCallMemoryGroup
- (const char* Name)
+        void RegisterCreateArena
+ (concurrent_arena& Arena, const char* ArenaName, calling_info CallingInfo)
         {
-            BeginMemoryGroup(Name);
-            State.JustCalledNextAllocationMemoryGroup = true;
+            Arena.DebugId = InternalRegisterCreateArena(Arena.MemoryBlock->Size, arena_growth_policy::Fixed,
+                                                        ArenaName, nullptr, CallingInfo);
         }
         
-        struct scope_memory_group
+        // NOTE: Recorded as clear, block deallocations that follow drop the arena
+        void RegisterDeallocateArena
+ (arena& Arena, calling_info)
+        { AddArenaEvent(event_type::ClearArena, Arena.DebugId); }
+        
+        void RegisterClearArena
+ (arena& Arena)
+        { AddArenaEvent(event_type::ClearArena, Arena.DebugId); }
+        
+        void RegisterClearArena
+ (concurrent_arena& Arena)
+        { AddArenaEvent(event_type::ClearArena, Arena.DebugId); }
+        
+        void RegisterArenaAllocateNextMemoryBlock
+ (arena& Arena)
         {
-            scope_memory_group(char* Name)
-            { BeginMemoryGroup(Name); }
+            auto* Event = AddEvent(event_type::AllocateNextMemoryBlock);
+            if(!Event)
+                return;
             
-            ~scope_memory_group()
-            { EndMemoryGroup(); }
-        };
+            auto* NewMemBlock = Arena.MemoryBlock;
+            rstd_AssertM(NewMemBlock->Prev, "Pay attention to word 'Next' in function name");
+            
+            Event->Size = NewMemBlock->Size;
+            Event->Extra = GetUnusedBytes(*NewMemBlock->Prev);
+            Event->ArenaId = Arena.DebugId;
+            Event->GrowthPolicy = Arena.GrowthPolicy;
+            PublishEvent();
+        }
         
-#define ScopeMemoryGroup(_Name) scope_memory_group ScopeMemGroup##__LINE__(_Name)
+        void RegisterArenaDeallocateMemoryBlock
+ (arena& Arena)
+        {
+            auto* Event = AddEvent(event_type::DeallocateMemoryBlock);
+            if(!Event)
+                return;
+            
+            auto& MemBlockToDeallocate = *Arena.MemoryBlock;
+            auto* PrevMemBlock = MemBlockToDeallocate.Prev;
+            Event->Size = MemBlockToDeallocate.Size;
+            Event->Extra = PrevMemBlock ? GetUnusedBytes(*PrevMemBlock) : 0;
+            Event->ArenaId = Arena.DebugId;
+            PublishEvent();
+        }
         
-        static void EndNextCallMemoryGroup()
+        // NOTE: Tail of full block is left to pushes racing for it, so it stays counted as unused instead of wasted
+        void RegisterArenaAllocateNextMemoryBlock
+ (concurrent_arena& Arena, memory_block& NewMemBlock)
         {
-            if(State.JustCalledNextAllocationMemoryGroup)
+            if(auto* Event = AddEvent(event_type::AllocateNextMemoryBlock))
             {
-                State.JustCalledNextAllocationMemoryGroup = false;
-                State.CurrentMemoryGroup = State.OthersMemoryGroup;
+                Event->Size = NewMemBlock.Size;
+                Event->ArenaId = Arena.DebugId;
+                Event->GrowthPolicy = arena_growth_policy::Fixed;
+                PublishEvent();
             }
         }
         
-        static void AddStatistic
- (u32* Statistic, u32* MaxStatistic, u32 Delta)
+        void RegisterArenaDeallocateMemoryBlock
+ (concurrent_arena& Arena, memory_block& MemBlock)
         {
-            *Statistic += Delta;
-            if(*Statistic > *MaxStatistic)
-                *MaxStatistic = *Statistic;
+            if(auto* Event = AddEvent(event_type::DeallocateMemoryBlock))
+            {
+                Event->Size = MemBlock.Size;
+                Event->ArenaId = Arena.DebugId;
+                PublishEvent();
+            }
         }
         
-        static void AddUsedAndSubtractUnused
- (statistics* Stats, u32 Delta)
-        {
-            AddStatistic(&Stats->Used, &Stats->UsedPeak, Delta);
-            Stats->Unused -= Delta;
-        }
+        void RegisterBeginTemporaryMemory
+ (temporary_memory TempMem)
+        { AddArenaEvent(event_type::BeginTemporaryMemory, TempMem.Arena->DebugId); }
         
-        static void AddSizeAndUnused
- (statistics* Stats, u32 Delta)
-        { 
-            AddStatistic(&Stats->Size, &Stats->SizePeak, Delta);
-            Stats->Unused += Delta;
+        void RegisterEndTemporaryMemory
+ (temporary_memory TempMem)
+        { AddArenaEvent(event_type::EndTemporaryMemory, TempMem.Arena->DebugId); }
+        
+        // NOTE: Push from the same place as one of the last few push events only grows that event. Push loops from
+        //       a few places then cost some compares and adds instead of writing and merging 64 byte event each.
+        //       Look back stops at any other event, pushes are only reordered among pushes
+        static rstd_bool TryCoalesceArenaPush
+ (u32 ArenaId, const push_size_uninitialized_ex_res& Res, size Size,
+  allocation_type AllocationType, calling_info& CallingInfo)
+        {
+            auto& Thread = ThreadState;
+            auto* Buffer = Thread.Buffer;
+            if(State.SamplingInterval || !Buffer || Thread.NoRegistrationDepth || Thread.JustCalledNextCallMemoryGroup)
+                return false;
+            
+            u32 Depth = Buffer->EventCount < ArenaPushCoalesceDepth ? Buffer->EventCount : ArenaPushCoalesceDepth;
+            for(event* Event = Buffer->Events + Buffer->EventCount - 1; Depth; --Depth, --Event)
+            {
+                if(Event->Type != event_type::ArenaPush)
+                    return false;
+                
+                if(Event->Line == CallingInfo.Line && Event->FilePath == CallingInfo.FilePath && Event->ArenaId == ArenaId &&
+                   Event->MemoryGroupName == Thread.CurrentMemoryGroup && Event->AllocationType == (u8)AllocationType)
+                {
+                    Event->Size += Size;
+                    Event->Extra += Res.AlignmentPadding;
+                    ++Event->PushCount;
+                    return true;
+                }
+            }
+            return false;
         }
         
-        static void SubtractUsedAndAddUnused
- (statistics* Stats, u32 Delta)
-        { 
-            Stats->Used -= Delta;
-            Stats->Unused += Delta;
+        static void InternalRegisterArenaPush
+ (u32 ArenaId, const push_size_uninitialized_ex_res& Res, size Size,
+  allocation_type AllocationType, calling_info CallingInfo)
+        {
+            f32 SampleWeight = 1;
+            if(State.SamplingInterval)
+            {
+                SampleWeight = SampleAllocation(Size + Res.AlignmentPadding);
+                if(!SampleWeight)
+                {
+                    EndNextCallMemoryGroup();
+                    return;
+                }
+            }
+            
+            auto* Event = AddEvent(event_type::ArenaPush);
+            if(!Event)
+                return;
+            
+            SetCallingInfo(Event, CallingInfo);
+            Event->PushCount = 1;
+            Event->Size = Size;
+            Event->Extra = Res.AlignmentPadding;
+            Event->ArenaId = ArenaId;
+            Event->SampleWeight = SampleWeight;
+            Event->AllocationType = (u8)AllocationType;
+            Event->Sampled = State.SamplingInterval != 0;
+            PublishEvent();
+            
+            EndNextCallMemoryGroup();
         }
         
-        static void SubtractSizeAndUnused
- (statistics* Stats, u32 SizeDelta, u32 UnusedDelta)
-        { 
-            Stats->Size -= SizeDelta; 
-            Stats->Unused -= UnusedDelta;
+        void RegisterArenaPush
+ (arena& Arena, const push_size_uninitialized_ex_res& Res, size Size,
+  allocation_type AllocationType, calling_info CallingInfo)
+        {
+            if(!TryCoalesceArenaPush(Arena.DebugId, Res, Size, AllocationType, CallingInfo))
+                InternalRegisterArenaPush(Arena.DebugId, Res, Size, AllocationType, CallingInfo);
         }
         
-        static void AlterStatsOnMemoryBlockAllocation
- (statistics* Stats, u32 NewMemoryBlockSize, u32 PrevMemoryBlockUnusedBytes)
+        void RegisterArenaPush
+ (concurrent_arena& Arena, const push_size_uninitialized_ex_res& Res, size Size, calling_info CallingInfo)
         {
-            AddSizeAndUnused(Stats, NewMemoryBlockSize);
-            Stats->Unused -= PrevMemoryBlockUnusedBytes;
-            Stats->Wasted += PrevMemoryBlockUnusedBytes;
+            if(!TryCoalesceArenaPush(Arena.DebugId, Res, Size, allocation_type::ArenaPushZero, CallingInfo))
+                InternalRegisterArenaPush(Arena.DebugId, Res, Size, allocation_type::ArenaPushZero, CallingInfo);
         }
         
-        static void AlterStatsOnMemoryBlockDeallocation
- (statistics* Stats, u32 MemoryBlockToDeallocateSize, u32 PrevMemoryBlockUnusedBytes)
+        // NOTE: Sampled pushes can't be matched with shrinks, so shrinks are recorded only without sampling
+        void RegisterArenaShrinkLastPush
+ (arena& Arena, size Size, calling_info CallingInfo)
         {
-            SubtractSizeAndUnused(Stats, MemoryBlockToDeallocateSize, PrevMemoryBlockUnusedBytes);
-            Stats->Unused += PrevMemoryBlockUnusedBytes;
-            Stats->Wasted -= PrevMemoryBlockUnusedBytes;
+            if(!State.SamplingInterval)
+            {
+                if(auto* Event = AddEvent(event_type::ShrinkLastPush))
+                {
+                    SetCallingInfo(Event, CallingInfo);
+                    Event->Size = Size;
+                    Event->ArenaId = Arena.DebugId;
+                    PublishEvent();
+                }
+            }
+            EndNextCallMemoryGroup();
         }
         
-        void RegisterCreateArena
- (arena& Arena, const char* ArenaName, const char* MasterArenaName, calling_info CallingInfo)
+        void RegisterGenAlloc
+ (void* Memory, size Size, calling_info CallingInfo)
         {
-            if(!State.RegisterAllocations)
-                return;
-            
-            ScopeNoAllocRegistration;
-            
-            auto& MemGroup = *State.CurrentMemoryGroup;
-            auto& ArenaDebug = MemGroup.Arenas.PushZero();
-            
-            ArenaDebug.MemoryBlocks = ShareArena(State.Arena);
-            ArenaDebug.MemoryBlocks.Push(*Arena.MemoryBlock);
-            
-            u32 ArenaSize = Arena.MemoryBlock->Size;
-            AddSizeAndUnused(&ArenaDebug.Stats, ArenaSize);
-            AddSizeAndUnused(&State.Stats, ArenaSize);
-            
-            ArenaDebug.CreationCallingInfo = CallingInfo;
-            
-            if(ArenaName)
+            f32 SampleWeight = 1;
+            if(State.SamplingInterval && Memory)
             {
-                Arena.DebugName = ArenaDebug.Name = ArenaName;
+                SampleWeight = SampleAllocation(Size);
+                if(!SampleWeight)
+                {
+                    EndNextCallMemoryGroup();
+                    return;
+                }
             }
-            else
+            
+            auto* Event = AddEvent(event_type::GenAlloc);
+            if(!Event)
+                return;
+            
+            if(State.SamplingInterval && Memory)
             {
-                u32 MemGroupArenaCount = MemGroup.Arenas.GetCount();
-                auto& Name = State.NamelessAllocatorNames.PushUninitialized();
-                Name = Format<allocator_name>("nameless %", MemGroupArenaCount);
-                Arena.DebugName = ArenaDebug.Name = Name;
-                ArenaDebug.HasNamelessName = true;
+                rstd_ScopeLock(State.SampledMutex);
+                Insert(State.SampledGenAllocations, Memory);
+                AtomicIncrement(State.SampledGenAllocationFilter[HashPointer(Memory) & (rstd_ArrayCount(State.SampledGenAllocationFilter) - 1)]);
             }
             
-            ArenaDebug.MasterArenaName = MasterArenaName;
+            SetCallingInfo(Event, CallingInfo);
+            Event->Memory = Memory;
+            Event->Size = Size;
+            Event->SampleWeight = SampleWeight;
+            Event->AllocationType = (u8)allocation_type::GenAlloc;
+            Event->Sampled = State.SamplingInterval != 0;
+            PublishEvent();
             
             EndNextCallMemoryGroup();
         }
         
-        static arena_debug_data& GetArenaDebug
- (arena Arena)
+        void RegisterGenFree
+ (void* Memory, calling_info CallingInfo)
         {
-            arena_debug_data* ArenaDebug = nullptr;
-            
-            for(auto& MemGroup : State.MemoryGroups)
+            if(State.SamplingInterval && Memory)
             {
-                ArenaDebug = Find(MemGroup.Arenas,
- [=](auto Ad){ return Ad.Name == Arena.DebugName; });
+                auto& FilterCount = State.SampledGenAllocationFilter[HashPointer(Memory) & (rstd_ArrayCount(State.SampledGenAllocationFilter) - 1)];
+                if(!FilterCount)
+                    return;
                 
-                if(ArenaDebug)
-                    break;
+                rstd_ScopeLock(State.SampledMutex);
+                auto* Sampled = Find(State.SampledGenAllocations, Memory);
+                if(!Sampled)
+                    return;
+                Remove(State.SampledGenAllocations, Sampled);
+                AtomicDecrement(FilterCount);
             }
             
-            rstd_Assert(ArenaDebug);
-            return *ArenaDebug;
+            auto* Event = AddEvent(event_type::GenFree);
+            if(!Event)
+                return;
+            
+            SetCallingInfo(Event, CallingInfo);
+            Event->Memory = Memory;
+            PublishEvent();
         }
         
-        void RegisterArenaAllocateNextMemoryBlock
- (arena Arena)
+        void Flush()
         {
-            if(!State.RegisterAllocations)
-                return;
-            
             ScopeNoAllocRegistration;
-            
-            auto* NewMemBlock = Arena.MemoryBlock;
-            auto& ArenaDebug = GetArenaDebug(Arena);
-            ArenaDebug.MemoryBlocks.Push(*NewMemBlock);
-            
-            rstd_AssertM(NewMemBlock->Prev, "Pay attention to word 'Next' in function name");
-            
-            u32 PrevMemBlockUnused = GetUnusedBytes(*NewMemBlock->Prev);
-            AlterStatsOnMemoryBlockAllocation(&ArenaDebug.Stats, NewMemBlock->Size, PrevMemBlockUnused);
-            AlterStatsOnMemoryBlockAllocation(&State.Stats, NewMemBlock->Size, PrevMemBlockUnused);
+            rstd_ScopeLock(State.Mutex);
+            MergeAllBuffers();
         }
         
-        void RegisterArenaDeallocateMemoryBlock
- (arena Arena)
+        statistics GetStatistics()
         {
-            if(!State.RegisterAllocations)
-                return;
-            
-            ScopeNoAllocRegistration;
-            
-            auto& MemBlockToDeallocate = *Arena.MemoryBlock;
-            auto& ArenaDebug = GetArenaDebug(Arena);
-            ArenaDebug.MemoryBlocks.PopLast();
-            
-            auto* PrevMemBlock = MemBlockToDeallocate.Prev;
-            u32 PrevMemBlockUnused = PrevMemBlock ? GetUnusedBytes(*PrevMemBlock) : 0;
-            AlterStatsOnMemoryBlockDeallocation(&ArenaDebug.Stats, MemBlockToDeallocate.Size, PrevMemBlockUnused);
-            AlterStatsOnMemoryBlockDeallocation(&State.Stats, MemBlockToDeallocate.Size, PrevMemBlockUnused);
+            Flush();
+            rstd_ScopeLock(State.Mutex);
+            return State.Stats;
+        }
+        
+        rstd_bool GetMemoryGroupStatistics
+ (const char* MemoryGroupName, statistics* Dest)
+        {
+            Flush();
+            rstd_ScopeLock(State.Mutex);
+            for(u32 MemoryGroupIndex = 0; MemoryGroupIndex < State.MemoryGroupCount; ++MemoryGroupIndex)
+            {
+                auto& MemoryGroup = State.MemoryGroups[MemoryGroupIndex];
+                if(strcmp(MemoryGroup.Name, MemoryGroupName) == 0)
+                {
+                    *Dest = MemoryGroup.Stats;
+                    return true;
+                }
+            }
+            return false;
         }
         
-        void SetDebugTemporaryMemory
- (temporary_memory TempMem, rstd_bool Flag)
+        static rstd_bool GetArenaDebugData
+ (u32 ArenaId, arena_debug_data* Dest)
         {
-            auto& ArenaDebug = GetArenaDebug(*TempMem.Arena);
-            ArenaDebug.TemporaryMemory = Flag;
+            Flush();
+            rstd_ScopeLock(State.Mutex);
+            if(!ArenaId || ArenaId >= State.ArenaCapacity)
+                return false;
+            *Dest = State.Arenas[ArenaId];
+            return true;
         }
         
-        void RegisterBeginTemporaryMemory(temporary_memory TempMem)
-        { SetDebugTemporaryMemory(TempMem, true); }
+        rstd_bool GetArenaDebugData(arena& Arena, arena_debug_data* Dest)
+        { return GetArenaDebugData(Arena.DebugId, Dest); }
         
-        void RegisterEndTemporaryMemory(temporary_memory TempMem)
-        { SetDebugTemporaryMemory(TempMem, false); }
+        rstd_bool GetArenaDebugData(concurrent_arena& Arena, arena_debug_data* Dest)
+        { return GetArenaDebugData(Arena.DebugId, Dest); }
         
-        void RegisterArenaPush
- (arena Arena, push_size_uninitialized_ex_res Res, size Size,
-  allocation_type AllocationType, calling_info CallingInfo)
+        u32 GetUnmatchedGenFreeCount()
         {
-            if(!State.RegisterAllocations)
-                return;
-            
-            ScopeNoAllocRegistration;
-            
-            auto& DebugArena = GetArenaDebug(Arena);
+            Flush();
+            rstd_ScopeLock(State.Mutex);
+            return State.EarlyGenFrees.Count;
+        }
+        
+        size GetSamplingInterval()
+        { return State.SamplingInterval; }
+        
+        u64 GetSampleCount()
+        {
+            Flush();
+            rstd_ScopeLock(State.Mutex);
+            return State.SampleCount;
+        }
+        
+        rstd_bool BeginTrace
+ (const char* FilePath)
+        {
+            Flush();
+            rstd_ScopeLock(State.Mutex);
+            if(State.Tracing)
+                return false;
             
-            if(DebugArena.TemporaryMemory)
-                return;
+            State.TraceStream = OpenFileStream(FilePath, io_mode::Write);
+            if(!State.TraceStream)
+                return false;
             
-            allocation Alloc = {CallingInfo, DebugArena.Name, Res.Memory, Size, AllocationType};
-            auto& MemGroup = *State.CurrentMemoryGroup;
-            MemGroup.Allocations.PushFront(Alloc);
+            State.TraceBuffer = (u8*)PageAlloc(TraceBufferSize);
+            rstd_RAssert(State.TraceBuffer, "OS Allocation call failed (probably your machine ran out of memory)");
+            State.TraceBufferUsed = 0;
+            State.NextTraceStringId = 0;
+            State.TraceStartTime = State.LastTraceTime = GetSystemTimeAsUnixEpoch();
             
-            auto& DebugMemBlock = DebugArena.MemoryBlocks.GetLast();
-            DebugMemBlock = *Arena.MemoryBlock;
-            AddUsedAndSubtractUnused(&DebugArena.Stats, Size);
-            AddUsedAndSubtractUnused(&State.Stats, Size);
+            trace_file_header Header;
+            Header.Magic = TraceFileMagic;
+            Header.Version = TraceFileVersion;
+            Header.SamplingInterval = State.SamplingInterval;
+            Header.StartTime = State.TraceStartTime;
+            WriteStruct(State.TraceStream, Header);
             
-            EndNextCallMemoryGroup();
+            State.Tracing = true;
+            return true;
         }
         
-        void RegisterGenAlloc
- (void* Memory, size Size, calling_info CallingInfo)
+        void EndTrace()
         {
-            if(!State.RegisterAllocations)
+            Flush();
+            rstd_ScopeLock(State.Mutex);
+            if(!State.Tracing)
                 return;
             
-            ScopeNoAllocRegistration;
+            WriteTraceTime(GetSystemTimeAsUnixEpoch());
+            FlushTraceBuffer();
+            Close(State.TraceStream);
+            PageFree(State.TraceBuffer, TraceBufferSize);
+            State.TraceBuffer = nullptr;
+            if(State.TraceStringIds.Slots)
+                PageFree(State.TraceStringIds.Slots, Align(State.TraceStringIds.Capacity * sizeof(gen_allocation), MemoryPageSize));
+            ZeroStruct(State.TraceStringIds);
+            State.Tracing = false;
+        }
+        
+        u32 GetAllocationSiteCount()
+        {
+            Flush();
+            rstd_ScopeLock(State.Mutex);
+            return State.SiteCount;
+        }
+        
+        static size GetAllocationSiteKey
+ (allocation_site& Site, allocation_site_order Order)
+        {
+            switch(Order)
+            {
+                case allocation_site_order::Bytes: return Site.Bytes;
+                case allocation_site_order::Count: return Site.Count;
+                case allocation_site_order::LiveBytes: return Site.LiveBytes;
+                case allocation_site_order::PeakLiveBytes: return Site.PeakLiveBytes;
+            }
+            return 0;
+        }
+        
+        u32 GetTopAllocationSites
+ (allocation_site* Dest, u32 MaxSiteCount, allocation_site_order Order)
+        {
+            Flush();
+            rstd_ScopeLock(State.Mutex);
             
-            allocation Alloc = {CallingInfo, "malloc", Memory, Size, allocation_type::GenAlloc};
-            auto& MemGroup = *State.CurrentMemoryGroup;
-            MemGroup.Allocations.PushFront(Alloc);
-            AddUsedAndSubtractUnused(&State.Stats, Size);
-            AddSizeAndUnused(&State.Stats, Size);
-            EndNextCallMemoryGroup();
+            u32 SiteCount = State.SiteCount;
+            if(!SiteCount || !MaxSiteCount)
+                return 0;
+            
+            size SitesSize = Align(SiteCount * sizeof(allocation_site), MemoryPageSize);
+            auto* Sites = (allocation_site*)PageAlloc(SitesSize);
+            rstd_RAssert(Sites, "OS Allocation call failed (probably your machine ran out of memory)");
+            for(u32 SiteIndex = 0; SiteIndex < SiteCount; ++SiteIndex)
+            {
+                Sites[SiteIndex] = State.Sites[SiteIndex].Site;
+                Sites[SiteIndex].Count = (u64)(State.Sites[SiteIndex].Count + 0.5);
+            }
+            
+            u32 ResultCount = SiteCount < MaxSiteCount ? SiteCount : MaxSiteCount;
+            std::partial_sort(Sites, Sites + ResultCount, Sites + SiteCount,
+                              [Order](allocation_site& A, allocation_site& B)
+                              { return GetAllocationSiteKey(A, Order) > GetAllocationSiteKey(B, Order); });
+            memcpy(Dest, Sites, ResultCount * sizeof(allocation_site));
+            PageFree(Sites, SitesSize);
+            return ResultCount;
         }
         
-        void RegisterGenFree
- (void* Memory, calling_info CallingInfo)
+        rstd_bool DumpAllocationSites
+ (const char* FilePath, allocation_site_dump_format DumpFormat, u32 MaxSiteCount, allocation_site_order Order)
         {
-            if(!State.RegisterAllocations)
-                return;
+            auto Stream = OpenFileStream(FilePath, io_mode::Write);
+            if(!Stream)
+                return false;
             
-            ScopeNoAllocRegistration;
+            u32 SiteCount = GetAllocationSiteCount();
+            if(SiteCount > MaxSiteCount)
+                SiteCount = MaxSiteCount;
+            size SitesSize = Align((SiteCount ? SiteCount : 1) * sizeof(allocation_site), MemoryPageSize);
+            auto* Sites = (allocation_site*)PageAlloc(SitesSize);
+            rstd_RAssert(Sites, "OS Allocation call failed (probably your machine ran out of memory)");
+            SiteCount = GetTopAllocationSites(Sites, SiteCount, Order);
             
-            auto& MemGroup = *State.CurrentMemoryGroup;
+            if(DumpFormat == allocation_site_dump_format::Csv)
+                WriteString(Stream, "file,line,function,count,bytes,live_bytes,peak_live_bytes\n");
+            else if(State.SamplingInterval)
+                WriteString(Stream, "Sampled every % bytes on average, numbers are estimates\n", (u64)State.SamplingInterval);
             
-            auto AllocComparison = [=](auto Alloc){ return Alloc.Memory == Memory; };
-            auto* FoundAlloc = Find(MemGroup.Allocations, AllocComparison);
-            if(!FoundAlloc)
+            for(u32 SiteIndex = 0; SiteIndex < SiteCount; ++SiteIndex)
             {
-                for(auto& Mg : State.MemoryGroups)
+                auto& Site = Sites[SiteIndex];
+                auto& CallingInfo = Site.CallingInfo;
+                if(DumpFormat == allocation_site_dump_format::Csv)
                 {
-                    if(&Mg != &MemGroup)	
-                    {
-                        FoundAlloc = Find(Mg.Allocations, AllocComparison);
-                        if(FoundAlloc)
-                            break;
-                    }	
+                    WriteString(Stream, "\"%\",%,\"%\",%,%,%,%\n", CallingInfo.FilePath, CallingInfo.Line, CallingInfo.Function,
+                                Site.Count, (u64)Site.Bytes, (u64)Site.LiveBytes, (u64)Site.PeakLiveBytes);
                 }
-            }
-            
-            if(FoundAlloc)
-            {
-                MemGroup.Allocations.Remove(FoundAlloc);
-                MemGroup.Deallocations.Push({FoundAlloc->Memory, allocation_type::GenAlloc});
-                SubtractUsedAndAddUnused(&State.Stats, FoundAlloc->Size);
-                SubtractSizeAndUnused(&State.Stats, FoundAlloc->Size, 0);
-            }
-            else
-            {
-                auto DeallocComparison = [=](auto Dealloc){ return Dealloc.Memory == Memory; };
-                auto* FoundFreedMemory = Find(MemGroup.Deallocations, DeallocComparison);
-                if(!FoundFreedMemory)
+                else
                 {
-                    for(auto& Mg : State.MemoryGroups)
-                    {
-                        if(&Mg != &MemGroup)	
-                        {
-                            FoundFreedMemory = Find(Mg.Deallocations, DeallocComparison);
-                            if(FoundFreedMemory)
-                                break;
-                        }	
-                    }
+                    WriteString(Stream, "%:% %() - % allocations, % total, % live, % peak live\n",
+                                CallingInfo.FilePath, CallingInfo.Line, CallingInfo.Function, Site.Count,
+                                GetChoppedSizeText((u64)Site.Bytes), GetChoppedSizeText((u64)Site.LiveBytes),
+                                GetChoppedSizeText((u64)Site.PeakLiveBytes));
                 }
-                
-                rstd_InvalidCodePathM(FoundFreedMemory ?
-                                      "Memory was already freed!" : "Memory was never allocated!");
             }
+            
+            PageFree(Sites, SitesSize);
+            return Close(Stream);
         }
     }
     